@@ -34,6 +34,24 @@ extern "C" JNIEXPORT void JNICALL Java_JniPerfBenchmark_perfSOAUncheckedCall(JNI
   ScopedObjectAccessUnchecked soa(Thread::Current());
 }
 
+extern "C" JNIEXPORT void JNICALL Java_JniPerfBenchmark_perfNewDeleteLocalRef(JNIEnv* env,
+                                                                             jobject obj,
+                                                                             jint n) {
+  for (jint i = 0; i < n; ++i) {
+    jobject ref = env->NewLocalRef(obj);
+    env->DeleteLocalRef(ref);
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL Java_JniPerfBenchmark_perfNewLocalRefs(JNIEnv* env,
+                                                                        jobject obj,
+                                                                        jint n) {
+  // Leave the local references to be freed on return.
+  for (jint i = 0; i < n; ++i) {
+    env->NewLocalRef(obj);
+  }
+}
+
 }  // namespace
 
 }  // namespace art
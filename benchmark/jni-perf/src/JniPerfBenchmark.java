@@ -20,6 +20,8 @@ public class JniPerfBenchmark {
   native void perfJniEmptyCall();
   native void perfSOACall();
   native void perfSOAUncheckedCall();
+  native void perfNewDeleteLocalRef(int n);
+  native void perfNewLocalRefs(int n);
 
   public void timeFastJNI(int N) {
     // TODO: This might be an intrinsic.
@@ -46,6 +48,17 @@ public class JniPerfBenchmark {
     }
   }
 
+  public void timeNewDeleteLocalRef(int N) {
+    perfNewDeleteLocalRef(N);
+  }
+
+  // Keeps more local references alive than the initial capacity of the local reference table.
+  public void timeNewLocalRefs(int N) {
+    for (long i = 0; i < N; i++) {
+      perfNewLocalRefs(1024);
+    }
+  }
+
   {
     System.loadLibrary("artbenchmark");
   }
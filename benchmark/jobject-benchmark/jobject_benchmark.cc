@@ -34,6 +34,27 @@ extern "C" JNIEXPORT void JNICALL Java_JObjectBenchmark_timeAddRemoveLocal(
   }
 }
 
+extern "C" JNIEXPORT void JNICALL Java_JObjectBenchmark_timeNewDeleteLocalRef(
+    JNIEnv* env, jobject jobj, jint reps) {
+  for (jint i = 0; i < reps; ++i) {
+    jobject ref = env->NewLocalRef(jobj);
+    env->DeleteLocalRef(ref);
+  }
+}
+
+// Keeps more local references alive than the initial capacity of the local reference table.
+extern "C" JNIEXPORT void JNICALL Java_JObjectBenchmark_timeNewManyLocalRefs(
+    JNIEnv* env, jobject jobj, jint reps) {
+  static constexpr jint kNumRefs = 2048;
+  for (jint i = 0; i < reps; ++i) {
+    CHECK_EQ(env->PushLocalFrame(kNumRefs), JNI_OK);
+    for (jint j = 0; j < kNumRefs; ++j) {
+      env->NewLocalRef(jobj);
+    }
+    env->PopLocalFrame(nullptr);
+  }
+}
+
 extern "C" JNIEXPORT void JNICALL Java_JObjectBenchmark_timeDecodeLocal(
     JNIEnv* env, jobject jobj, jint reps) {
   ScopedObjectAccess soa(env);
@@ -19,6 +19,8 @@ public class JObjectBenchmark {
     // Make sure to link methods before benchmark starts.
     System.loadLibrary("artbenchmark");
     timeAddRemoveLocal(1);
+    timeNewDeleteLocalRef(1);
+    timeNewManyLocalRefs(1);
     timeDecodeLocal(1);
     timeAddRemoveGlobal(1);
     timeDecodeGlobal(1);
@@ -28,6 +30,8 @@ public class JObjectBenchmark {
   }
 
   public native void timeAddRemoveLocal(int reps);
+  public native void timeNewDeleteLocalRef(int reps);
+  public native void timeNewManyLocalRefs(int reps);
   public native void timeDecodeLocal(int reps);
   public native void timeAddRemoveGlobal(int reps);
   public native void timeDecodeGlobal(int reps);
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class StringTranscodingBenchmark {
+    // Compressed when string compression is enabled.
+    private static final String ASCII = repeat("The quick brown fox jumps over the lazy dog. ", 20);
+    // Mostly ASCII with a few two- and three-byte characters, like most text.
+    private static final String MIXED = repeat("Café naïve €1 quick brown fox. ", 20);
+
+    static {
+        System.loadLibrary("artbenchmark");
+    }
+
+    private static String repeat(String s, int count) {
+        StringBuilder sb = new StringBuilder();
+        for (int i = 0; i < count; ++i) {
+            sb.append(s);
+        }
+        return sb.toString();
+    }
+
+    public void timeGetStringUTFCharsAscii(int count) {
+        getStringUTFChars(ASCII, count);
+    }
+
+    public void timeGetStringUTFCharsMixed(int count) {
+        getStringUTFChars(MIXED, count);
+    }
+
+    public void timeGetStringRegionAscii(int count) {
+        getStringRegion(ASCII, count);
+    }
+
+    public void timeGetStringUTFRegionMixed(int count) {
+        getStringUTFRegion(MIXED, count);
+    }
+
+    public void timeNewStringUTFAscii(int count) {
+        newStringUTF(ASCII, count);
+    }
+
+    public void timeNewStringUTFMixed(int count) {
+        newStringUTF(MIXED, count);
+    }
+
+    public void timeNewStringAscii(int count) {
+        newString(ASCII, count);
+    }
+
+    public void timeToCharArrayAscii(int count) {
+        String s = ASCII;
+        for (int i = 0; i < count; ++i) {
+            s.toCharArray();
+        }
+    }
+
+    private static native void getStringUTFChars(String s, int reps);
+    private static native void getStringRegion(String s, int reps);
+    private static native void getStringUTFRegion(String s, int reps);
+    private static native void newStringUTF(String s, int reps);
+    private static native void newString(String s, int reps);
+}
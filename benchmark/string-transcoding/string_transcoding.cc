@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vector>
+
+#include "jni.h"
+
+namespace art {
+
+namespace {
+
+extern "C" JNIEXPORT void JNICALL Java_StringTranscodingBenchmark_getStringUTFChars(
+    JNIEnv* env, jclass, jstring s, jint reps) {
+  for (jint i = 0; i < reps; ++i) {
+    const char* chars = env->GetStringUTFChars(s, nullptr);
+    env->ReleaseStringUTFChars(s, chars);
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL Java_StringTranscodingBenchmark_getStringRegion(
+    JNIEnv* env, jclass, jstring s, jint reps) {
+  jsize length = env->GetStringLength(s);
+  std::vector<jchar> buffer(length);
+  for (jint i = 0; i < reps; ++i) {
+    env->GetStringRegion(s, 0, length, buffer.data());
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL Java_StringTranscodingBenchmark_getStringUTFRegion(
+    JNIEnv* env, jclass, jstring s, jint reps) {
+  jsize length = env->GetStringLength(s);
+  std::vector<char> buffer(env->GetStringUTFLength(s) + 1);
+  for (jint i = 0; i < reps; ++i) {
+    env->GetStringUTFRegion(s, 0, length, buffer.data());
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL Java_StringTranscodingBenchmark_newStringUTF(
+    JNIEnv* env, jclass, jstring s, jint reps) {
+  const char* chars = env->GetStringUTFChars(s, nullptr);
+  for (jint i = 0; i < reps; ++i) {
+    env->DeleteLocalRef(env->NewStringUTF(chars));
+  }
+  env->ReleaseStringUTFChars(s, chars);
+}
+
+extern "C" JNIEXPORT void JNICALL Java_StringTranscodingBenchmark_newString(
+    JNIEnv* env, jclass, jstring s, jint reps) {
+  jsize length = env->GetStringLength(s);
+  std::vector<jchar> buffer(length);
+  env->GetStringRegion(s, 0, length, buffer.data());
+  for (jint i = 0; i < reps; ++i) {
+    env->DeleteLocalRef(env->NewString(buffer.data(), length));
+  }
+}
+
+}  // namespace
+
+}  // namespace art
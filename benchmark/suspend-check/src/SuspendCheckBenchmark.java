@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class SuspendCheckBenchmark {
+    private static final int[] array = new int[1024];
+
+    static {
+        for (int i = 0; i < array.length; ++i) {
+            array[i] = i;
+        }
+    }
+
+    public void timeEmptyLoop(int count) {
+        for (int i = 0; i < count; ++i) {
+            $noinline$emptyLoop(1024);
+        }
+    }
+
+    public void timeArraySum(int count) {
+        int[] a = array;
+        for (int i = 0; i < count; ++i) {
+            $noinline$arraySum(a);
+        }
+    }
+
+    public void timeNestedLoops(int count) {
+        for (int i = 0; i < count; ++i) {
+            $noinline$nestedLoops(32);
+        }
+    }
+
+    public void timeLinkedListWalk(int count) {
+        Node list = null;
+        for (int i = 0; i < 1024; ++i) {
+            list = new Node(i, list);
+        }
+        for (int i = 0; i < count; ++i) {
+            $noinline$walk(list);
+        }
+    }
+
+    private static int $noinline$emptyLoop(int n) {
+        int i = 0;
+        while (i < n) {
+            ++i;
+        }
+        return i;
+    }
+
+    private static int $noinline$arraySum(int[] a) {
+        int sum = 0;
+        for (int i = 0; i < a.length; ++i) {
+            sum += a[i];
+        }
+        return sum;
+    }
+
+    private static int $noinline$nestedLoops(int n) {
+        int sum = 0;
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) {
+                sum += i ^ j;
+            }
+        }
+        return sum;
+    }
+
+    private static int $noinline$walk(Node node) {
+        int sum = 0;
+        while (node != null) {
+            sum += node.value;
+            node = node.next;
+        }
+        return sum;
+    }
+
+    private static class Node {
+        Node(int value, Node next) {
+            this.value = value;
+            this.next = next;
+        }
+
+        final int value;
+        final Node next;
+    }
+}
@@ -59,6 +59,7 @@
 #include "handle_scope-inl.h"
 #include "intrinsics_enum.h"
 #include "jni/jni_internal.h"
+#include "jni/native_optimization_list.h"
 #include "linker/linker_patch.h"
 #include "mirror/class-inl.h"
 #include "mirror/class_loader.h"
@@ -573,9 +574,10 @@ static void CompileMethodQuick(
           InstructionSetHasGenericJniStub(driver->GetCompilerOptions().GetInstructionSet())) {
         // Leaving this empty will trigger the generic JNI version
       } else {
-        // Query any JNI optimization annotations such as @FastNative or @CriticalNative.
-        access_flags |= annotations::GetNativeMethodAnnotationAccessFlags(
-            dex_file, dex_file.GetClassDef(class_def_idx), method_idx);
+        // Query any JNI optimization annotations such as @FastNative or @CriticalNative, or
+        // the native optimization list given to the runtime.
+        access_flags |= NativeOptimizationList::GetNativeMethodAccessFlags(
+            dex_file, dex_file.GetClassDef(class_def_idx), method_idx, access_flags);
 
         compiled_method = driver->GetCompiler()->JniCompile(
             access_flags, method_idx, dex_file, dex_cache);
@@ -1402,8 +1404,7 @@ class ParallelCompilationManager {
                              const DexFile* dex_file,
                              const std::vector<const DexFile*>& dex_files,
                              ThreadPool* thread_pool)
-    : index_(0),
-      class_linker_(class_linker),
+    : class_linker_(class_linker),
       class_loader_(class_loader),
       compiler_(compiler),
       dex_file_(dex_file),
@@ -1445,58 +1446,27 @@ class ParallelCompilationManager {
     self->AssertNoPendingException();
     CHECK_GT(work_units, 0U);
 
-    index_.store(begin, std::memory_order_relaxed);
-    for (size_t i = 0; i < work_units; ++i) {
-      thread_pool_->AddTask(self, new ForAllClosureLambda<Fn>(this, end, fn));
-    }
-    thread_pool_->StartWorkers(self);
-
     // Ensure we're suspended while we're blocked waiting for the other threads to finish (worker
     // thread destructor's called below perform join).
     CHECK_NE(self->GetState(), kRunnable);
 
-    // Wait for all the worker threads to finish.
-    thread_pool_->Wait(self, true, false);
+    // Process the indexes on the workers and on this thread, and wait for all of them.
+    thread_pool_->ParallelFor(self,
+                              begin,
+                              end,
+                              /* grain */ 1u,
+                              work_units,
+                              [&fn](size_t index) {
+                                fn(index);
+                                Thread::Current()->AssertNoPendingException();
+                              });
 
     // And stop the workers accepting jobs.
     thread_pool_->StopWorkers(self);
   }
 
-  size_t NextIndex() {
-    return index_.fetch_add(1, std::memory_order_seq_cst);
-  }
 
  private:
-  template <typename Fn>
-  class ForAllClosureLambda : public Task {
-   public:
-    ForAllClosureLambda(ParallelCompilationManager* manager, size_t end, Fn fn)
-        : manager_(manager),
-          end_(end),
-          fn_(fn) {}
-
-    void Run(Thread* self) override {
-      while (true) {
-        const size_t index = manager_->NextIndex();
-        if (UNLIKELY(index >= end_)) {
-          break;
-        }
-        fn_(index);
-        self->AssertNoPendingException();
-      }
-    }
-
-    void Finalize() override {
-      delete this;
-    }
-
-   private:
-    ParallelCompilationManager* const manager_;
-    const size_t end_;
-    Fn fn_;
-  };
-
-  AtomicInteger index_;
   ClassLinker* const class_linker_;
   const jobject class_loader_;
   CompilerDriver* const compiler_;
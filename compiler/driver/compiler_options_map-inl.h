@@ -80,6 +80,9 @@ inline bool ReadCompilerOptions(Base& map, CompilerOptions* options, std::string
   if (map.Exists(Base::CountHotnessInCompiledCode)) {
     options->count_hotness_in_compiled_code_ = true;
   }
+  if (map.Exists(Base::ImplicitSuspendChecks)) {
+    options->implicit_suspend_checks_ = true;
+  }
 
   if (map.Exists(Base::DumpTimings)) {
     options->dump_timings_ = true;
@@ -144,6 +147,9 @@ inline void AddCompilerOptionsArgumentParserOptions(Builder& b) {
       .Define({"--count-hotness-in-compiled-code"})
           .IntoKey(Map::CountHotnessInCompiledCode)
 
+      .Define({"--implicit-suspend-checks"})
+          .IntoKey(Map::ImplicitSuspendChecks)
+
       .Define({"--dump-timings"})
           .IntoKey(Map::DumpTimings)
 
@@ -1767,6 +1767,15 @@ void CodeGeneratorARM64::GenerateMemoryBarrier(MemBarrierKind kind) {
 
 void InstructionCodeGeneratorARM64::GenerateSuspendCheck(HSuspendCheck* instruction,
                                                          HBasicBlock* successor) {
+  // The runtime only saves the lower halves of the vector registers, so with SIMD we need the
+  // slow path to spill them.
+  if (codegen_->GetCompilerOptions().GetImplicitSuspendChecks() && !GetGraph()->HasSIMD()) {
+    GenerateImplicitSuspendCheck(instruction);
+    if (successor != nullptr) {
+      __ B(codegen_->GetLabelOf(successor));
+    }
+    return;
+  }
   SuspendCheckSlowPathARM64* slow_path =
       down_cast<SuspendCheckSlowPathARM64*>(instruction->GetSlowPath());
   if (slow_path == nullptr) {
@@ -1795,6 +1804,22 @@ void InstructionCodeGeneratorARM64::GenerateSuspendCheck(HSuspendCheck* instruct
   }
 }
 
+void InstructionCodeGeneratorARM64::GenerateImplicitSuspendCheck(HSuspendCheck* instruction) {
+  // Load the suspend trigger, which points to itself unless a suspend or checkpoint is requested,
+  // and read through it. A null trigger faults and the SuspensionHandler redirects us to
+  // art_quick_test_suspend, returning right after the faulting load.
+  UseScratchRegisterScope temps(codegen_->GetVIXLAssembler());
+  Register temp = temps.AcquireX();
+  // Ensure that the two loads and RecordPcInfo are not separated by pools, the fault handler
+  // expects the loads back to back.
+  EmissionCheckScope guard(GetVIXLAssembler(), 2 * kMaxMacroInstructionSizeInBytes);
+  const int32_t trigger_offset =
+      Thread::ThreadSuspendTriggerOffset<kArm64PointerSize>().Int32Value();
+  __ Ldr(temp, MemOperand(tr, trigger_offset));
+  __ Ldr(wzr, MemOperand(temp));
+  codegen_->RecordPcInfo(instruction, instruction->GetDexPc());
+}
+
 InstructionCodeGeneratorARM64::InstructionCodeGeneratorARM64(HGraph* graph,
                                                              CodeGeneratorARM64* codegen)
       : InstructionCodeGenerator(graph, codegen),
@@ -282,6 +282,7 @@ class InstructionCodeGeneratorARM64 : public InstructionCodeGenerator {
   void GenerateBitstringTypeCheckCompare(HTypeCheckInstruction* check,
                                          vixl::aarch64::Register temp);
   void GenerateSuspendCheck(HSuspendCheck* instruction, HBasicBlock* successor);
+  void GenerateImplicitSuspendCheck(HSuspendCheck* instruction);
   void HandleBinaryOp(HBinaryOperation* instr);
 
   void HandleFieldSet(HInstruction* instruction,
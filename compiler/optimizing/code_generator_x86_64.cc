@@ -332,6 +332,49 @@ class LoadStringSlowPathX86_64 : public SlowPathCode {
   DISALLOW_COPY_AND_ASSIGN(LoadStringSlowPathX86_64);
 };
 
+class NewObjectSlowPathX86_64 : public SlowPathCode {
+ public:
+  NewObjectSlowPathX86_64(HInstruction* instruction, QuickEntrypointEnum entrypoint)
+      : SlowPathCode(instruction), entrypoint_(entrypoint) {
+    DCHECK(instruction->IsNewInstance() || instruction->IsNewArray());
+  }
+
+  void EmitNativeCode(CodeGenerator* codegen) override {
+    LocationSummary* locations = instruction_->GetLocations();
+    DCHECK(!locations->GetLiveRegisters()->ContainsCoreRegister(locations->Out().reg()));
+
+    CodeGeneratorX86_64* x86_64_codegen = down_cast<CodeGeneratorX86_64*>(codegen);
+    __ Bind(GetEntryLabel());
+    SaveLiveRegisters(codegen, locations);
+
+    InvokeRuntimeCallingConvention calling_convention;
+    x86_64_codegen->Move(Location::RegisterLocation(calling_convention.GetRegisterAt(0)),
+                         locations->InAt(0));
+    if (instruction_->IsNewArray()) {
+      // Inline allocation is only used for arrays of constant length.
+      __ movl(calling_convention.GetRegisterAt(1),
+              Immediate(instruction_->AsNewArray()->GetLength()->AsIntConstant()->GetValue()));
+    }
+    x86_64_codegen->InvokeRuntime(entrypoint_, instruction_, instruction_->GetDexPc(), this);
+    if (instruction_->IsNewArray()) {
+      CheckEntrypointTypes<kQuickAllocArrayResolved, void*, mirror::Class*, int32_t>();
+    } else {
+      CheckEntrypointTypes<kQuickAllocObjectWithChecks, void*, mirror::Class*>();
+    }
+    x86_64_codegen->Move(locations->Out(), Location::RegisterLocation(RAX));
+    RestoreLiveRegisters(codegen, locations);
+
+    __ jmp(GetExitLabel());
+  }
+
+  const char* GetDescription() const override { return "NewObjectSlowPathX86_64"; }
+
+ private:
+  const QuickEntrypointEnum entrypoint_;
+
+  DISALLOW_COPY_AND_ASSIGN(NewObjectSlowPathX86_64);
+};
+
 class TypeCheckSlowPathX86_64 : public SlowPathCode {
  public:
   TypeCheckSlowPathX86_64(HInstruction* instruction, bool is_fatal)
@@ -4347,7 +4390,103 @@ void InstructionCodeGeneratorX86_64::VisitUShr(HUShr* ushr) {
   HandleShift(ushr);
 }
 
+// Only the concurrent copying collector satisfies every mutator allocation from a TLAB. With the
+// other collectors an inline allocation would almost always end up on the slow path.
+static constexpr bool kUseInlineTlabAllocation = kUseReadBarrier;
+
+// Larger arrays are left to the entrypoints, which may put them in the large object space.
+static constexpr size_t kMaxInlineArrayAllocationSize = 1 * KB;
+
+static bool CanAllocateInline(HNewInstance* instruction) {
+  // Only classes known to be initialized, and therefore neither finalizable nor waiting for
+  // their initializer, are allocated inline. The resolved entrypoint initializes the class and
+  // the one with checks may need to throw, both are better left to the runtime.
+  return kUseInlineTlabAllocation &&
+      instruction->GetEntrypoint() == kQuickAllocObjectInitialized;
+}
+
+// Returns the aligned size of an array allocated by `entrypoint` with `length` elements.
+static size_t ComputeArrayAllocationSize(QuickEntrypointEnum entrypoint, int32_t length) {
+  size_t component_size_shift;
+  switch (entrypoint) {
+    case kQuickAllocArrayResolved8: component_size_shift = 0u; break;
+    case kQuickAllocArrayResolved16: component_size_shift = 1u; break;
+    case kQuickAllocArrayResolved32: component_size_shift = 2u; break;
+    case kQuickAllocArrayResolved64: component_size_shift = 3u; break;
+    default:
+      LOG(FATAL) << "Unexpected array allocation entrypoint " << entrypoint;
+      UNREACHABLE();
+  }
+  size_t data_offset = mirror::Array::DataOffset(1u << component_size_shift).Uint32Value();
+  return RoundUp(data_offset + (static_cast<size_t>(length) << component_size_shift),
+                 kObjectAlignment);
+}
+
+static bool CanAllocateInline(HNewArray* instruction) {
+  if (!kUseInlineTlabAllocation || !instruction->GetLength()->IsIntConstant()) {
+    return false;
+  }
+  int32_t length = instruction->GetLength()->AsIntConstant()->GetValue();
+  if (length < 0) {
+    return false;
+  }
+  QuickEntrypointEnum entrypoint =
+      CodeGenerator::GetArrayAllocationEntrypoint(instruction->GetLoadClass()->GetClass());
+  return ComputeArrayAllocationSize(entrypoint, length) <= kMaxInlineArrayAllocationSize;
+}
+
+void InstructionCodeGeneratorX86_64::GenerateTlabAllocation(HInstruction* instruction,
+                                                            QuickEntrypointEnum entrypoint) {
+  LocationSummary* locations = instruction->GetLocations();
+  CpuRegister cls = locations->InAt(0).AsRegister<CpuRegister>();
+  CpuRegister out = locations->Out().AsRegister<CpuRegister>();
+  CpuRegister end = locations->GetTemp(0).AsRegister<CpuRegister>();
+  SlowPathCode* slow_path =
+      new (codegen_->GetScopedAllocator()) NewObjectSlowPathX86_64(instruction, entrypoint);
+  codegen_->AddSlowPath(slow_path);
+
+  // Without a TLAB or while the entrypoints must not be bypassed, thread_local_inline_end is null
+  // and the comparison below sends us to the slow path.
+  __ gs()->movq(out, Address::Absolute(Thread::ThreadLocalPosOffset<kX86_64PointerSize>(),
+                                       /* no_rip */ true));
+  // The caller loaded the zero-extended 32-bit object size, so the addition cannot wrap around.
+  __ addq(end, out);
+  __ gs()->cmpq(end, Address::Absolute(Thread::ThreadLocalInlineEndOffset<kX86_64PointerSize>(),
+                                       /* no_rip */ true));
+  __ j(kAbove, slow_path->GetEntryLabel());
+  __ gs()->movq(Address::Absolute(Thread::ThreadLocalPosOffset<kX86_64PointerSize>(),
+                                  /* no_rip */ true),
+                end);
+  __ gs()->addq(Address::Absolute(Thread::ThreadLocalObjectsOffset<kX86_64PointerSize>(),
+                                  /* no_rip */ true),
+                Immediate(1));
+  // The TLAB is zeroed, we only need to install the class and, for arrays, the length.
+  // No fence needed for x86.
+  uint32_t class_offset = mirror::Object::ClassOffset().Uint32Value();
+  if (kPoisonHeapReferences) {
+    __ movl(end, cls);
+    __ PoisonHeapReference(end);
+    __ movl(Address(out, class_offset), end);
+  } else {
+    __ movl(Address(out, class_offset), cls);
+  }
+  if (instruction->IsNewArray()) {
+    int32_t length = instruction->AsNewArray()->GetLength()->AsIntConstant()->GetValue();
+    __ movl(Address(out, mirror::Array::LengthOffset().Uint32Value()), Immediate(length));
+  }
+  __ Bind(slow_path->GetExitLabel());
+}
+
 void LocationsBuilderX86_64::VisitNewInstance(HNewInstance* instruction) {
+  if (CanAllocateInline(instruction)) {
+    LocationSummary* locations = new (GetGraph()->GetAllocator()) LocationSummary(
+        instruction, LocationSummary::kCallOnSlowPath);
+    locations->SetInAt(0, Location::RequiresRegister());
+    // The class is needed after the output has been written.
+    locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
+    locations->AddTemp(Location::RequiresRegister());  // The object size, then the new TLAB pos.
+    return;
+  }
   LocationSummary* locations = new (GetGraph()->GetAllocator()) LocationSummary(
       instruction, LocationSummary::kCallOnMainOnly);
   InvokeRuntimeCallingConvention calling_convention;
@@ -4356,12 +4495,31 @@ void LocationsBuilderX86_64::VisitNewInstance(HNewInstance* instruction) {
 }
 
 void InstructionCodeGeneratorX86_64::VisitNewInstance(HNewInstance* instruction) {
+  if (CanAllocateInline(instruction)) {
+    LocationSummary* locations = instruction->GetLocations();
+    CpuRegister cls = locations->InAt(0).AsRegister<CpuRegister>();
+    // The class is initialized and not finalizable, this is its rounded up object size.
+    __ movl(locations->GetTemp(0).AsRegister<CpuRegister>(),
+            Address(cls, mirror::Class::ObjectSizeAllocFastPathOffset().Uint32Value()));
+    GenerateTlabAllocation(instruction, instruction->GetEntrypoint());
+    return;
+  }
   codegen_->InvokeRuntime(instruction->GetEntrypoint(), instruction, instruction->GetDexPc());
   CheckEntrypointTypes<kQuickAllocObjectWithChecks, void*, mirror::Class*>();
   DCHECK(!codegen_->IsLeafMethod());
 }
 
 void LocationsBuilderX86_64::VisitNewArray(HNewArray* instruction) {
+  if (CanAllocateInline(instruction)) {
+    LocationSummary* locations = new (GetGraph()->GetAllocator()) LocationSummary(
+        instruction, LocationSummary::kCallOnSlowPath);
+    locations->SetInAt(0, Location::RequiresRegister());
+    locations->SetInAt(1, Location::ConstantLocation(instruction->GetLength()->AsConstant()));
+    // The class is needed after the output has been written.
+    locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
+    locations->AddTemp(Location::RequiresRegister());  // The array size, then the new TLAB pos.
+    return;
+  }
   LocationSummary* locations = new (GetGraph()->GetAllocator()) LocationSummary(
       instruction, LocationSummary::kCallOnMainOnly);
   InvokeRuntimeCallingConvention calling_convention;
@@ -4375,6 +4533,14 @@ void InstructionCodeGeneratorX86_64::VisitNewArray(HNewArray* instruction) {
   // of poisoning the reference.
   QuickEntrypointEnum entrypoint =
       CodeGenerator::GetArrayAllocationEntrypoint(instruction->GetLoadClass()->GetClass());
+  if (CanAllocateInline(instruction)) {
+    int32_t length = instruction->GetLength()->AsIntConstant()->GetValue();
+    size_t size = ComputeArrayAllocationSize(entrypoint, length);
+    __ movl(instruction->GetLocations()->GetTemp(0).AsRegister<CpuRegister>(),
+            Immediate(dchecked_integral_cast<int32_t>(size)));
+    GenerateTlabAllocation(instruction, entrypoint);
+    return;
+  }
   codegen_->InvokeRuntime(entrypoint, instruction, instruction->GetDexPc());
   CheckEntrypointTypes<kQuickAllocArrayResolved, void*, mirror::Class*, int32_t>();
   DCHECK(!codegen_->IsLeafMethod());
@@ -208,6 +208,9 @@ class InstructionCodeGeneratorX86_64 : public InstructionCodeGenerator {
   // the suspend call.
   void GenerateSuspendCheck(HSuspendCheck* instruction, HBasicBlock* successor);
   void GenerateClassInitializationCheck(SlowPathCode* slow_path, CpuRegister class_reg);
+  // Bump-allocates `instruction` (an HNewInstance or HNewArray) from the TLAB, calling
+  // `entrypoint` on a slow path when it does not fit. Temp 0 must hold the object size.
+  void GenerateTlabAllocation(HInstruction* instruction, QuickEntrypointEnum entrypoint);
   void GenerateBitstringTypeCheckCompare(HTypeCheckInstruction* check, CpuRegister temp);
   void HandleBitwiseOperation(HBinaryOperation* operation);
   void GenerateRemFP(HRem* rem);
@@ -460,13 +460,15 @@ static bool AlwaysThrows(CompilerDriver* const compiler_driver, ArtMethod* metho
 
 bool HInliner::TryInline(HInvoke* invoke_instruction) {
   if (invoke_instruction->IsInvokeUnresolved() ||
-      invoke_instruction->IsInvokePolymorphic() ||
       invoke_instruction->IsInvokeCustom()) {
     return false;  // Don't bother to move further if we know the method is unresolved or the
-                   // invocation is polymorphic (invoke-{polymorphic,custom}).
+                   // call site is bound at runtime (invoke-custom).
   }
 
   ScopedObjectAccess soa(Thread::Current());
+  if (invoke_instruction->IsInvokePolymorphic()) {
+    return TryInlineMethodHandleInvoke(invoke_instruction->AsInvokePolymorphic());
+  }
   uint32_t method_index = invoke_instruction->GetDexMethodIndex();
   const DexFile& caller_dex_file = *caller_compilation_unit_.GetDexFile();
   LOG_TRY() << caller_dex_file.PrettyMethod(method_index);
@@ -530,6 +532,271 @@ bool HInliner::TryInline(HInvoke* invoke_instruction) {
   return TryInlineFromInlineCache(caller_dex_file, invoke_instruction, resolved_method);
 }
 
+// Returns whether invoking a method handle for `target_id` with the prototype `site_proto`
+// needs no asType() conversion, i.e. whether MethodHandle.invokeExact() cannot throw
+// WrongMethodTypeException. Both are from `dex_file`, so types compare by index.
+static bool IsExactMethodHandleType(const DexFile& dex_file,
+                                    const DexFile::ProtoId& site_proto,
+                                    const DexFile::MethodId& target_id,
+                                    bool has_receiver) {
+  const DexFile::ProtoId& target_proto = dex_file.GetMethodPrototype(target_id);
+  if (site_proto.return_type_idx_ != target_proto.return_type_idx_) {
+    return false;
+  }
+  const DexFile::TypeList* site_params = dex_file.GetProtoParameters(site_proto);
+  const DexFile::TypeList* target_params = dex_file.GetProtoParameters(target_proto);
+  size_t site_size = (site_params == nullptr) ? 0u : site_params->Size();
+  size_t target_size = (target_params == nullptr) ? 0u : target_params->Size();
+  size_t offset = has_receiver ? 1u : 0u;
+  if (site_size != target_size + offset) {
+    return false;
+  }
+  if (has_receiver && site_params->GetTypeItem(0).type_idx_ != target_id.class_idx_) {
+    return false;
+  }
+  for (size_t i = 0; i != target_size; ++i) {
+    if (site_params->GetTypeItem(i + offset).type_idx_ != target_params->GetTypeItem(i).type_idx_) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns the class of the method compiled in `unit`, or null if it is not resolved.
+static ObjPtr<mirror::Class> LookupCompilingClass(const DexCompilationUnit& unit)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  const DexFile::MethodId& method_id = unit.GetDexFile()->GetMethodId(unit.GetDexMethodIndex());
+  return unit.GetClassLinker()->LookupResolvedType(
+      method_id.class_idx_, unit.GetDexCache().Get(), unit.GetClassLoader().Get());
+}
+
+// Returns whether all types of `proto` are resolved in `unit`, so that creating the
+// MethodType of a method handle with that prototype does not need to resolve anything.
+static bool AreProtoTypesResolved(const DexCompilationUnit& unit, const DexFile::ProtoId& proto)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  ClassLinker* class_linker = unit.GetClassLinker();
+  ObjPtr<mirror::DexCache> dex_cache = unit.GetDexCache().Get();
+  ObjPtr<mirror::ClassLoader> class_loader = unit.GetClassLoader().Get();
+  dex::TypeIndex return_type_idx = proto.return_type_idx_;
+  if (class_linker->LookupResolvedType(return_type_idx, dex_cache, class_loader) == nullptr) {
+    return false;
+  }
+  const DexFile::TypeList* params = unit.GetDexFile()->GetProtoParameters(proto);
+  for (size_t i = 0, size = (params == nullptr) ? 0u : params->Size(); i != size; ++i) {
+    dex::TypeIndex type_idx = params->GetTypeItem(i).type_idx_;
+    if (class_linker->LookupResolvedType(type_idx, dex_cache, class_loader) == nullptr) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool HInliner::TryInlineMethodHandleInvoke(HInvokePolymorphic* invoke_instruction) {
+  // Only MethodHandle.invoke() and invokeExact() on a `const-method-handle` can be resolved
+  // statically. VarHandle accessors and handles computed at runtime stay on the runtime path.
+  const DexFile& caller_dex_file = *caller_compilation_unit_.GetDexFile();
+  const DexFile::MethodId& invoked_id =
+      caller_dex_file.GetMethodId(invoke_instruction->GetDexMethodIndex());
+  if (strcmp(caller_dex_file.GetMethodDeclaringClassDescriptor(invoked_id),
+             "Ljava/lang/invoke/MethodHandle;") != 0) {
+    return false;
+  }
+  HInstruction* handle = invoke_instruction->InputAt(0);
+  if (handle->IsNullCheck()) {
+    handle = handle->InputAt(0);
+  }
+  if (!handle->IsLoadMethodHandle() ||
+      !IsSameDexFile(handle->AsLoadMethodHandle()->GetDexFile(), caller_dex_file)) {
+    return false;
+  }
+
+  const DexFile::MethodHandleItem& handle_item =
+      caller_dex_file.GetMethodHandle(handle->AsLoadMethodHandle()->GetMethodHandleIndex());
+  DexFile::MethodHandleType handle_type =
+      static_cast<DexFile::MethodHandleType>(handle_item.method_handle_type_);
+  bool is_static;
+  switch (handle_type) {
+    case DexFile::MethodHandleType::kInvokeStatic:
+      is_static = true;
+      break;
+    case DexFile::MethodHandleType::kInvokeInstance:
+    case DexFile::MethodHandleType::kInvokeDirect:
+      is_static = false;
+      break;
+    default:
+      // Field accessors, constructors and interface handles are transforms or need an
+      // interface dispatch, keep them on the runtime path.
+      return false;
+  }
+  const DexFile::MethodId& target_id =
+      caller_dex_file.GetMethodId(handle_item.field_or_method_idx_);
+  if (!IsExactMethodHandleType(caller_dex_file,
+                               caller_dex_file.GetProtoId(invoke_instruction->GetProtoIndex()),
+                               target_id,
+                               /* has_receiver */ !is_static)) {
+    LOG_FAIL_NO_STAT() << "Not inlining method handle invoke with a type conversion";
+    return false;
+  }
+
+  // The handle is loaded by the HLoadMethodHandle which runs before the inlined code and
+  // throws any resolution or access error. We only need the target it resolves to.
+  ClassLinker* class_linker = caller_compilation_unit_.GetClassLinker();
+  ArtMethod* resolved_method =
+      class_linker->LookupResolvedMethod(handle_item.field_or_method_idx_,
+                                         caller_compilation_unit_.GetDexCache().Get(),
+                                         caller_compilation_unit_.GetClassLoader().Get());
+  if (resolved_method == nullptr ||
+      resolved_method->IsStatic() != is_static ||
+      resolved_method->GetDeclaringClass()->IsInterface()) {
+    LOG_FAIL_NO_STAT() << "Method handle target of " << caller_dex_file.PrettyMethod(
+        handle_item.field_or_method_idx_) << " is not resolved to a class method";
+    return false;
+  }
+  if (handle_type == DexFile::MethodHandleType::kInvokeDirect && !resolved_method->IsPrivate()) {
+    return false;  // A non-private kInvokeDirect handle has invoke-super semantics.
+  }
+  ObjPtr<mirror::Class> outermost_class = LookupCompilingClass(outer_compilation_unit_);
+  ObjPtr<mirror::Class> target_class = resolved_method->GetDeclaringClass();
+  if (is_static) {
+    // Invoking the handle initializes the class, which we cannot do in the inlined code.
+    // The JIT can rely on an initialized class staying initialized. Otherwise, as for
+    // HClinitCheck, a static method runs only once its own class is initializing.
+    bool is_initialized =
+        (!Runtime::Current()->IsAotCompiler() && target_class->IsInitialized()) ||
+        (outer_compilation_unit_.IsStatic() && outermost_class == target_class);
+    if (!is_initialized) {
+      LOG_FAIL_NO_STAT() << "Method handle target " << resolved_method->PrettyMethod()
+                         << " may need a class initialization check";
+      return false;
+    }
+  }
+
+  // Once the target is inlined, the handle itself is needed only for its resolution errors.
+  // The HLoadMethodHandle can be dropped when the resolution cannot fail, i.e. the handle is
+  // loaded in the outermost method, which can access the target, and all types of the
+  // target's prototype are resolved. The JIT can rely on them staying resolved. For AOT we
+  // require the target to be in the compiled class.
+  bool can_remove_load =
+      (&caller_compilation_unit_ == &outer_compilation_unit_) &&
+      outermost_class != nullptr &&
+      (!Runtime::Current()->IsAotCompiler() || outermost_class == target_class) &&
+      outermost_class->CanAccessMember(target_class, resolved_method->GetAccessFlags()) &&
+      AreProtoTypesResolved(caller_compilation_unit_,
+                            caller_dex_file.GetMethodPrototype(target_id));
+
+  // Build a regular invoke of the target from the handle's arguments, and inline it.
+  uint32_t dex_pc = invoke_instruction->GetDexPc();
+  HInvoke* new_invoke = nullptr;
+  if (!is_static && !resolved_method->IsPrivate()) {
+    new_invoke = new (graph_->GetAllocator()) HInvokeVirtual(
+        graph_->GetAllocator(),
+        invoke_instruction->GetNumberOfArguments() - 1u,
+        invoke_instruction->GetType(),
+        dex_pc,
+        handle_item.field_or_method_idx_,
+        resolved_method,
+        resolved_method->GetMethodIndex());
+  } else {
+    new_invoke = new (graph_->GetAllocator()) HInvokeStaticOrDirect(
+        graph_->GetAllocator(),
+        invoke_instruction->GetNumberOfArguments() - 1u,
+        invoke_instruction->GetType(),
+        dex_pc,
+        handle_item.field_or_method_idx_,
+        resolved_method,
+        HSharpening::SharpenInvokeStaticOrDirect(resolved_method, codegen_),
+        is_static ? kStatic : kDirect,
+        MethodReference(resolved_method->GetDexFile(), resolved_method->GetDexMethodIndex()),
+        HInvokeStaticOrDirect::ClinitCheckRequirement::kNone);
+    if (HInvokeStaticOrDirect::NeedsCurrentMethodInput(
+            new_invoke->AsInvokeStaticOrDirect()->GetMethodLoadKind())) {
+      new_invoke->SetArgumentAt(new_invoke->AsInvokeStaticOrDirect()->GetSpecialInputIndex(),
+                                graph_->GetCurrentMethod());
+    }
+  }
+  HNullCheck* null_check = nullptr;
+  if (!is_static) {
+    // The receiver is an ordinary argument of invokeExact() and has not been null checked.
+    HInstruction* receiver = invoke_instruction->InputAt(1u);
+    null_check = new (graph_->GetAllocator()) HNullCheck(receiver, dex_pc);
+    null_check->SetReferenceTypeInfo(receiver->GetReferenceTypeInfo());
+    invoke_instruction->GetBlock()->InsertInstructionBefore(null_check, invoke_instruction);
+    null_check->CopyEnvironmentFrom(invoke_instruction->GetEnvironment());
+  }
+  for (size_t index = 0; index != new_invoke->GetNumberOfArguments(); ++index) {
+    new_invoke->SetArgumentAt(index, (index == 0u && null_check != nullptr)
+        ? null_check
+        : invoke_instruction->InputAt(index + 1u));
+  }
+  invoke_instruction->GetBlock()->InsertInstructionBefore(new_invoke, invoke_instruction);
+  new_invoke->CopyEnvironmentFrom(invoke_instruction->GetEnvironment());
+  if (invoke_instruction->GetType() == DataType::Type::kReference) {
+    new_invoke->SetReferenceTypeInfo(invoke_instruction->GetReferenceTypeInfo());
+  }
+
+  ArtMethod* actual_method = resolved_method;
+  bool cha_devirtualize = false;
+  if (new_invoke->IsInvokeVirtual()) {
+    actual_method = FindVirtualOrInterfaceTarget(new_invoke, resolved_method);
+    if (actual_method == nullptr) {
+      actual_method = TryCHADevirtualization(resolved_method);
+      cha_devirtualize = (actual_method != nullptr);
+    }
+  }
+
+  HInstruction* cursor = new_invoke->GetPrevious();
+  HBasicBlock* bb_cursor = new_invoke->GetBlock();
+  HInstruction* return_replacement = nullptr;
+  if (actual_method == nullptr ||
+      !TryBuildAndInline(new_invoke,
+                         actual_method,
+                         ReferenceTypeInfo::CreateInvalid(),
+                         &return_replacement)) {
+    // Leave the call to the runtime; it must not be replaced by a direct call as the
+    // runtime decodes the caller's invoke-polymorphic when resolving the callee.
+    new_invoke->GetBlock()->RemoveInstruction(new_invoke);
+    if (null_check != nullptr) {
+      null_check->GetBlock()->RemoveInstruction(null_check);
+    }
+    return false;
+  }
+
+  if (cha_devirtualize) {
+    AddCHAGuard(new_invoke, dex_pc, cursor, bb_cursor);
+    outermost_graph_->AddCHASingleImplementationDependency(resolved_method);
+    MaybeRecordStat(stats_, MethodCompilationStat::kCHAInline);
+  }
+  if (return_replacement != nullptr) {
+    invoke_instruction->ReplaceWith(return_replacement);
+  }
+  HInstruction* handle_input = invoke_instruction->InputAt(0);
+  invoke_instruction->GetBlock()->RemoveInstruction(invoke_instruction);
+  new_invoke->GetBlock()->RemoveInstruction(new_invoke);
+  if (can_remove_load) {
+    // The handle may still be needed by an environment, e.g. for deoptimization, which
+    // re-executes the invoke-polymorphic in the interpreter. Keep the load in that case.
+    if (handle_input->IsNullCheck() && !handle_input->HasUses()) {
+      HInstruction* null_checked = handle_input->InputAt(0);
+      handle_input->GetBlock()->RemoveInstruction(handle_input);
+      handle_input = null_checked;
+    }
+    if (!handle_input->HasUses()) {
+      DCHECK(handle_input->IsLoadMethodHandle());
+      handle_input->GetBlock()->RemoveInstruction(handle_input);
+    }
+  }
+  FixUpReturnReferenceType(actual_method, return_replacement);
+  if (ReturnTypeMoreSpecific(new_invoke, return_replacement)) {
+    ReferenceTypePropagation(graph_,
+                             outer_compilation_unit_.GetClassLoader(),
+                             outer_compilation_unit_.GetDexCache(),
+                             handles_,
+                             /* is_first_run */ false).Run();
+  }
+  MaybeRecordStat(stats_, MethodCompilationStat::kInlinedMethodHandleInvoke);
+  return true;
+}
+
 static Handle<mirror::ObjectArray<mirror::Class>> AllocateInlineCacheHolder(
     const DexCompilationUnit& compilation_unit,
     StackHandleScope<1>* hs)
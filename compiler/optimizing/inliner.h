@@ -29,6 +29,7 @@ class CompilerDriver;
 class DexCompilationUnit;
 class HGraph;
 class HInvoke;
+class HInvokePolymorphic;
 class OptimizingCompilerStats;
 
 class HInliner : public HOptimization {
@@ -76,6 +77,12 @@ class HInliner : public HOptimization {
 
   bool TryInline(HInvoke* invoke_instruction);
 
+  // Try to inline the target of MethodHandle.invoke() or invokeExact() called on a constant
+  // method handle whose type matches the call site exactly. The handle is still loaded, so
+  // resolution and access errors are thrown as before, unless its resolution cannot fail.
+  bool TryInlineMethodHandleInvoke(HInvokePolymorphic* invoke_instruction)
+    REQUIRES_SHARED(Locks::mutator_lock_);
+
   // Try to inline `resolved_method` in place of `invoke_instruction`. `do_rtp` is whether
   // reference type propagation can run after the inlining. If the inlining is successful, this
   // method will replace and remove the `invoke_instruction`. If `cha_devirtualize` is true,
@@ -1027,7 +1027,8 @@ bool HInstructionBuilder::BuildInvokePolymorphic(uint32_t dex_pc,
                                                         number_of_arguments,
                                                         return_type,
                                                         dex_pc,
-                                                        method_idx);
+                                                        method_idx,
+                                                        proto_idx);
   return HandleInvoke(invoke, operands, shorty, /* is_unresolved */ false);
 }
 
@@ -4411,7 +4411,8 @@ class HInvokePolymorphic final : public HInvoke {
                      uint32_t number_of_arguments,
                      DataType::Type return_type,
                      uint32_t dex_pc,
-                     uint32_t dex_method_index)
+                     uint32_t dex_method_index,
+                     dex::ProtoIndex proto_index)
       : HInvoke(kInvokePolymorphic,
                 allocator,
                 number_of_arguments,
@@ -4420,15 +4421,22 @@ class HInvokePolymorphic final : public HInvoke {
                 dex_pc,
                 dex_method_index,
                 nullptr,
-                kVirtual) {
+                kVirtual),
+        proto_index_(proto_index) {
   }
 
   bool IsClonable() const override { return true; }
 
+  // The prototype of the call site, i.e. the type the method handle is invoked with.
+  dex::ProtoIndex GetProtoIndex() const { return proto_index_; }
+
   DECLARE_INSTRUCTION(InvokePolymorphic);
 
  protected:
   DEFAULT_COPY_CONSTRUCTOR(InvokePolymorphic);
+
+ private:
+  const dex::ProtoIndex proto_index_;
 };
 
 class HInvokeCustom final : public HInvoke {
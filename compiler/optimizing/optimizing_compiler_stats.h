@@ -73,6 +73,7 @@ enum class MethodCompilationStat {
   kSelectGenerated,
   kRemovedInstanceOf,
   kInlinedInvokeVirtualOrInterface,
+  kInlinedMethodHandleInvoke,
   kImplicitNullCheckGenerated,
   kExplicitNullCheckGenerated,
   kSimplifyIf,
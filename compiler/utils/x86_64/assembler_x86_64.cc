@@ -2664,6 +2664,14 @@ void X86_64Assembler::addq(CpuRegister dst, const Address& address) {
 }
 
 
+void X86_64Assembler::addq(const Address& address, const Immediate& imm) {
+  CHECK(imm.is_int32());  // addq only supports 32b immediate.
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitRex64(address);
+  EmitComplex(0, address, imm);
+}
+
+
 void X86_64Assembler::addq(CpuRegister dst, CpuRegister src) {
   AssemblerBuffer::EnsureCapacity ensured(&buffer_);
   // 0x01 is addq r/m64 <- r/m64 + r64, with op1 in r/m and op2 in reg: so reverse EmitRex64
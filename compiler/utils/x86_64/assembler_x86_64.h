@@ -707,6 +707,7 @@ class X86_64Assembler final : public Assembler {
   void addq(CpuRegister reg, const Immediate& imm);
   void addq(CpuRegister dst, CpuRegister src);
   void addq(CpuRegister dst, const Address& address);
+  void addq(const Address& address, const Immediate& imm);
 
   void subl(CpuRegister dst, CpuRegister src);
   void subl(CpuRegister reg, const Immediate& imm);
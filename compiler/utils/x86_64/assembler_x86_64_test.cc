@@ -1041,6 +1041,12 @@ TEST_F(AssemblerX86_64Test, AddqAddr) {
   DriverStr(RepeatRA(&x86_64::X86_64Assembler::addq, "addq {mem}, %{reg}"), "addq");
 }
 
+TEST_F(AssemblerX86_64Test, AddqAddrImm) {
+  DriverStr(RepeatAI(&x86_64::X86_64Assembler::addq,
+                     /*imm_bytes*/ 4U,
+                     "addq ${imm}, {mem}"), "addq");  // only imm32
+}
+
 TEST_F(AssemblerX86_64Test, SubqAddr) {
   DriverStr(RepeatRA(&x86_64::X86_64Assembler::subq, "subq {mem}, %{reg}"), "subq");
 }
@@ -78,6 +78,7 @@
 #include "gc/verification.h"
 #include "interpreter/unstarted_runtime.h"
 #include "jni/java_vm_ext.h"
+#include "jni/native_optimization_list.h"
 #include "linker/buffered_output_stream.h"
 #include "linker/elf_writer.h"
 #include "linker/elf_writer_quick.h"
@@ -353,6 +354,11 @@ NO_RETURN static void Usage(const char* fmt, ...) {
   UsageError("");
   UsageError("  --dump-timings: display a breakdown of where time was spent");
   UsageError("");
+  UsageError("  --implicit-suspend-checks: poll the thread's suspend trigger in suspend checks");
+  UsageError("      instead of testing the thread flags, relying on the runtime's fault handler.");
+  UsageError("      Only honored on arm64. The oat file is recorded as needing the handler and");
+  UsageError("      is rejected by runtimes that do not install it, see -Xcompiler-option.");
+  UsageError("");
   UsageError("  --dump-pass-timings: display a breakdown of time spent in optimization");
   UsageError("      passes for each compiled method.");
   UsageError("");
@@ -1063,6 +1069,12 @@ class Dex2Oat final {
         CompilerFilter::NameOfFilter(compiler_options_->GetCompilerFilter()));
     key_value_store_->Put(OatHeader::kConcurrentCopying,
                           kUseReadBarrier ? OatHeader::kTrueValue : OatHeader::kFalseValue);
+    // Only the arm64 code generator emits polls of the suspend trigger.
+    bool implicit_suspend_checks = compiler_options_->GetImplicitSuspendChecks() &&
+        compiler_options_->GetInstructionSet() == InstructionSet::kArm64;
+    key_value_store_->Put(
+        OatHeader::kImplicitSuspendChecksKey,
+        implicit_suspend_checks ? OatHeader::kTrueValue : OatHeader::kFalseValue);
   }
 
   // This simple forward is here so the string specializations below don't look out of place.
@@ -1487,6 +1499,19 @@ class Dex2Oat final {
       key_value_store_->Put(OatHeader::kCompilationReasonKey, compilation_reason_);
     }
 
+    if (runtime_options.Exists(RuntimeArgumentMap::NativeOptimizationList)) {
+      // Record the list used for the JNI stubs so that the runtime can reject them if its list
+      // is different.
+      std::string error_msg;
+      std::unique_ptr<NativeOptimizationList> list = NativeOptimizationList::Create(
+          runtime_options.GetOrDefault(RuntimeArgumentMap::NativeOptimizationList), &error_msg);
+      if (list == nullptr) {
+        LOG(ERROR) << error_msg;
+        return dex2oat::ReturnCode::kOther;
+      }
+      key_value_store_->Put(OatHeader::kNativeOptimizationListKey, list->GetChecksum());
+    }
+
     if (IsBootImage() && image_filenames_.size() > 1) {
       // If we're compiling the boot image, store the boot classpath into the Key-Value store.
       // We need this for the multi-image case.
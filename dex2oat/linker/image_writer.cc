@@ -845,6 +845,11 @@ void ImageWriter::PrepareDexCacheArraySlots() {
         << "; possibly in class path";
     DexCacheArraysLayout layout(target_ptr_size_, dex_file);
     DCHECK(layout.Valid());
+    // The arrays are copied with the layout's sizes, which must match the slot indexing.
+    DCHECK_EQ(layout.NumTypes(), dex_cache->NumResolvedTypes());
+    DCHECK_EQ(layout.NumMethods(), dex_cache->NumResolvedMethods());
+    DCHECK_EQ(layout.NumFields(), dex_cache->NumResolvedFields());
+    DCHECK_EQ(layout.NumStrings(), dex_cache->NumStrings());
     size_t oat_index = GetOatIndexForDexCache(dex_cache);
     ImageInfo& image_info = GetImageInfo(oat_index);
     uint32_t start = image_info.dex_cache_array_starts_.Get(dex_file);
@@ -2615,9 +2620,10 @@ void ImageWriter::CopyAndFixupNativeData(size_t oat_index) {
     temp_intern_table.VisitRoots(&root_visitor, kVisitRootFlagAllRoots);
     // Record relocations. (The root visitor does not get to see the slot addresses.)
     MutexLock lock(Thread::Current(), *Locks::intern_table_lock_);
-    DCHECK(!temp_intern_table.strong_interns_.tables_.empty());
-    DCHECK(!temp_intern_table.strong_interns_.tables_[0].empty());  // Inserted at the beginning.
-    for (const GcRoot<mirror::String>& slot : temp_intern_table.strong_interns_.tables_[0]) {
+    DCHECK(!temp_intern_table.image_strong_interns_.tables_.empty());
+    // Inserted at the beginning.
+    DCHECK(!temp_intern_table.image_strong_interns_.tables_[0].empty());
+    for (const GcRoot<mirror::String>& slot : temp_intern_table.image_strong_interns_.tables_[0]) {
       RecordImageRelocation(&slot, oat_index);
     }
   }
@@ -2647,8 +2653,8 @@ void ImageWriter::CopyAndFixupNativeData(size_t oat_index) {
     // but the relocation works fine for these "adjusted" references.
     ReaderMutexLock lock(self, temp_class_table.lock_);
     DCHECK(!temp_class_table.classes_.empty());
-    DCHECK(!temp_class_table.classes_[0].empty());  // The ClassSet was inserted at the beginning.
-    for (const ClassTable::TableSlot& slot : temp_class_table.classes_[0]) {
+    DCHECK(!temp_class_table.classes_[0]->empty());  // The ClassSet was inserted at the beginning.
+    for (const ClassTable::TableSlot& slot : *temp_class_table.classes_[0]) {
       RecordImageRelocation(&slot, oat_index);
     }
   }
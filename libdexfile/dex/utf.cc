@@ -16,10 +16,17 @@
 
 #include "utf.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 #include <android-base/logging.h>
 #include <android-base/stringprintf.h>
 #include <android-base/strings.h>
 
+#include "base/bit_utils.h"
 #include "base/casts.h"
 #include "utf-inl.h"
 
@@ -27,6 +34,118 @@ namespace art {
 
 using android::base::StringAppendF;
 
+// The ASCII kernels below use SSE2 on x86 and NEON on arm64, both part of the baseline of these
+// instruction sets, and handle the tail and other architectures with scalar loops. Their inputs
+// are usually short or memory bound, so wider vectors needing runtime dispatch are not worth it.
+static constexpr size_t kVectorSize = 16u;
+
+static inline constexpr bool IsAscii(uint16_t ch) {
+  // Same as mirror::String::IsASCII(): zero is not encoded as a single byte in modified UTF-8.
+  return (ch - 1u) < 0x7fu;
+}
+
+size_t CountLeadingAsciiChars(const uint8_t* chars, size_t char_count) {
+  size_t i = 0u;
+#if defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + kVectorSize <= char_count; i += kVectorSize) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(chars + i));
+    // As signed bytes, exactly the ASCII characters are greater than zero.
+    uint32_t ascii_mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(v, zero)));
+    if (ascii_mask != 0xffffu) {
+      return i + CTZ(~ascii_mask);
+    }
+  }
+#elif defined(__aarch64__)
+  const uint8x16_t one = vdupq_n_u8(1u);
+  for (; i + kVectorSize <= char_count; i += kVectorSize) {
+    uint8x16_t v = vld1q_u8(chars + i);
+    if (vmaxvq_u8(vsubq_u8(v, one)) >= 0x7fu) {
+      break;
+    }
+  }
+#endif
+  while (i != char_count && IsAscii(chars[i])) {
+    ++i;
+  }
+  return i;
+}
+
+size_t CountLeadingAsciiChars(const uint16_t* chars, size_t char_count) {
+  static constexpr size_t kCharsPerVector = kVectorSize / sizeof(uint16_t);
+  size_t i = 0u;
+#if defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i limit = _mm_set1_epi16(0x80);
+  for (; i + kCharsPerVector <= char_count; i += kCharsPerVector) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(chars + i));
+    // As signed 16-bit values, exactly the ASCII characters are in (0, 0x80).
+    __m128i ascii = _mm_and_si128(_mm_cmpgt_epi16(v, zero), _mm_cmplt_epi16(v, limit));
+    uint32_t ascii_mask = static_cast<uint32_t>(_mm_movemask_epi8(ascii));
+    if (ascii_mask != 0xffffu) {
+      return i + CTZ(~ascii_mask) / sizeof(uint16_t);
+    }
+  }
+#elif defined(__aarch64__)
+  const uint16x8_t one = vdupq_n_u16(1u);
+  for (; i + kCharsPerVector <= char_count; i += kCharsPerVector) {
+    uint16x8_t v = vld1q_u16(chars + i);
+    if (vmaxvq_u16(vsubq_u16(v, one)) >= 0x7fu) {
+      break;
+    }
+  }
+#endif
+  while (i != char_count && IsAscii(chars[i])) {
+    ++i;
+  }
+  return i;
+}
+
+void ConvertAsciiToUtf16(uint16_t* utf16_out, const uint8_t* ascii_in, size_t char_count) {
+  size_t i = 0u;
+#if defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + kVectorSize <= char_count; i += kVectorSize) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ascii_in + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(utf16_out + i), _mm_unpacklo_epi8(v, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(utf16_out + i + kVectorSize / 2u),
+                     _mm_unpackhi_epi8(v, zero));
+  }
+#elif defined(__aarch64__)
+  for (; i + kVectorSize <= char_count; i += kVectorSize) {
+    uint8x16_t v = vld1q_u8(ascii_in + i);
+    vst1q_u16(utf16_out + i, vmovl_u8(vget_low_u8(v)));
+    vst1q_u16(utf16_out + i + kVectorSize / 2u, vmovl_high_u8(v));
+  }
+#endif
+  for (; i != char_count; ++i) {
+    utf16_out[i] = ascii_in[i];
+  }
+}
+
+void ConvertUtf16ToAscii(uint8_t* ascii_out, const uint16_t* utf16_in, size_t char_count) {
+  size_t i = 0u;
+#if defined(__SSE2__)
+  for (; i + kVectorSize <= char_count; i += kVectorSize) {
+    __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(utf16_in + i));
+    __m128i high =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(utf16_in + i + kVectorSize / 2u));
+    // Saturation does not change characters below 0x100.
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(ascii_out + i), _mm_packus_epi16(low, high));
+  }
+#elif defined(__aarch64__)
+  for (; i + kVectorSize <= char_count; i += kVectorSize) {
+    uint16x8_t low = vld1q_u16(utf16_in + i);
+    uint16x8_t high = vld1q_u16(utf16_in + i + kVectorSize / 2u);
+    vst1q_u8(ascii_out + i, vmovn_high_u16(vmovn_u16(low), high));
+  }
+#endif
+  for (; i != char_count; ++i) {
+    DCHECK_LT(utf16_in[i], 0x100u);
+    ascii_out[i] = static_cast<uint8_t>(utf16_in[i]);
+  }
+}
+
 // This is used only from debugger and test code.
 size_t CountModifiedUtf8Chars(const char* utf8) {
   return CountModifiedUtf8Chars(utf8, strlen(utf8));
@@ -51,11 +170,19 @@ size_t CountModifiedUtf8Chars(const char* utf8, size_t byte_count) {
   DCHECK_LE(byte_count, strlen(utf8));
   size_t len = 0;
   const char* end = utf8 + byte_count;
-  for (; utf8 < end; ++utf8) {
-    int ic = *utf8;
+  while (utf8 < end) {
+    // Skip a run of one-byte encodings at once.
+    size_t ascii_count =
+        CountLeadingAsciiChars(reinterpret_cast<const uint8_t*>(utf8), end - utf8);
+    len += ascii_count;
+    utf8 += ascii_count;
+    if (utf8 == end) {
+      break;
+    }
+    int ic = *utf8++;
     len++;
-    if (LIKELY((ic & 0x80) == 0)) {
-      // One-byte encoding.
+    if ((ic & 0x80) == 0) {
+      // One-byte encoding of '\0', not valid in modified UTF-8.
       continue;
     }
     // Two- or three-byte encoding.
@@ -100,16 +227,19 @@ void ConvertModifiedUtf8ToUtf16(uint16_t* utf16_data_out, size_t out_chars,
 
   if (LIKELY(out_chars == in_bytes)) {
     // Common case where all characters are ASCII.
-    for (const char *p = in_start; p < in_end;) {
-      // Safe even if char is signed because ASCII characters always have
-      // the high bit cleared.
-      *out_p++ = dchecked_integral_cast<uint16_t>(*p++);
-    }
+    ConvertAsciiToUtf16(out_p, reinterpret_cast<const uint8_t*>(in_start), in_bytes);
     return;
   }
 
   // String contains non-ASCII characters.
   for (const char *p = in_start; p < in_end;) {
+    size_t ascii_count = CountLeadingAsciiChars(reinterpret_cast<const uint8_t*>(p), in_end - p);
+    ConvertAsciiToUtf16(out_p, reinterpret_cast<const uint8_t*>(p), ascii_count);
+    out_p += ascii_count;
+    p += ascii_count;
+    if (p == in_end) {
+      break;
+    }
     const uint32_t ch = GetUtf16FromUtf8(&p);
     const uint16_t leading = GetLeadingUtf16Char(ch);
     const uint16_t trailing = GetTrailingUtf16Char(ch);
@@ -125,51 +255,54 @@ void ConvertUtf16ToModifiedUtf8(char* utf8_out, size_t byte_count,
                                 const uint16_t* utf16_in, size_t char_count) {
   if (LIKELY(byte_count == char_count)) {
     // Common case where all characters are ASCII.
-    const uint16_t *utf16_end = utf16_in + char_count;
-    for (const uint16_t *p = utf16_in; p < utf16_end;) {
-      *utf8_out++ = dchecked_integral_cast<char>(*p++);
-    }
+    ConvertUtf16ToAscii(reinterpret_cast<uint8_t*>(utf8_out), utf16_in, char_count);
     return;
   }
 
   // String contains non-ASCII characters.
-  while (char_count--) {
+  while (char_count != 0u) {
+    size_t ascii_count = CountLeadingAsciiChars(utf16_in, char_count);
+    ConvertUtf16ToAscii(reinterpret_cast<uint8_t*>(utf8_out), utf16_in, ascii_count);
+    utf8_out += ascii_count;
+    utf16_in += ascii_count;
+    char_count -= ascii_count;
+    if (char_count == 0u) {
+      break;
+    }
     const uint16_t ch = *utf16_in++;
-    if (ch > 0 && ch <= 0x7f) {
-      *utf8_out++ = ch;
-    } else {
-      // Char_count == 0 here implies we've encountered an unpaired
-      // surrogate and we have no choice but to encode it as 3-byte UTF
-      // sequence. Note that unpaired surrogates can occur as a part of
-      // "normal" operation.
-      if ((ch >= 0xd800 && ch <= 0xdbff) && (char_count > 0)) {
-        const uint16_t ch2 = *utf16_in;
-
-        // Check if the other half of the pair is within the expected
-        // range. If it isn't, we will have to emit both "halves" as
-        // separate 3 byte sequences.
-        if (ch2 >= 0xdc00 && ch2 <= 0xdfff) {
-          utf16_in++;
-          char_count--;
-          const uint32_t code_point = (ch << 10) + ch2 - 0x035fdc00;
-          *utf8_out++ = (code_point >> 18) | 0xf0;
-          *utf8_out++ = ((code_point >> 12) & 0x3f) | 0x80;
-          *utf8_out++ = ((code_point >> 6) & 0x3f) | 0x80;
-          *utf8_out++ = (code_point & 0x3f) | 0x80;
-          continue;
-        }
+    --char_count;
+    DCHECK(!IsAscii(ch));
+    // Char_count == 0 here implies we've encountered an unpaired
+    // surrogate and we have no choice but to encode it as 3-byte UTF
+    // sequence. Note that unpaired surrogates can occur as a part of
+    // "normal" operation.
+    if ((ch >= 0xd800 && ch <= 0xdbff) && (char_count > 0)) {
+      const uint16_t ch2 = *utf16_in;
+
+      // Check if the other half of the pair is within the expected
+      // range. If it isn't, we will have to emit both "halves" as
+      // separate 3 byte sequences.
+      if (ch2 >= 0xdc00 && ch2 <= 0xdfff) {
+        utf16_in++;
+        char_count--;
+        const uint32_t code_point = (ch << 10) + ch2 - 0x035fdc00;
+        *utf8_out++ = (code_point >> 18) | 0xf0;
+        *utf8_out++ = ((code_point >> 12) & 0x3f) | 0x80;
+        *utf8_out++ = ((code_point >> 6) & 0x3f) | 0x80;
+        *utf8_out++ = (code_point & 0x3f) | 0x80;
+        continue;
       }
+    }
 
-      if (ch > 0x07ff) {
-        // Three byte encoding.
-        *utf8_out++ = (ch >> 12) | 0xe0;
-        *utf8_out++ = ((ch >> 6) & 0x3f) | 0x80;
-        *utf8_out++ = (ch & 0x3f) | 0x80;
-      } else /*(ch > 0x7f || ch == 0)*/ {
-        // Two byte encoding.
-        *utf8_out++ = (ch >> 6) | 0xc0;
-        *utf8_out++ = (ch & 0x3f) | 0x80;
-      }
+    if (ch > 0x07ff) {
+      // Three byte encoding.
+      *utf8_out++ = (ch >> 12) | 0xe0;
+      *utf8_out++ = ((ch >> 6) & 0x3f) | 0x80;
+      *utf8_out++ = (ch & 0x3f) | 0x80;
+    } else /*(ch > 0x7f || ch == 0)*/ {
+      // Two byte encoding.
+      *utf8_out++ = (ch >> 6) | 0xc0;
+      *utf8_out++ = (ch & 0x3f) | 0x80;
     }
   }
 }
@@ -239,11 +372,15 @@ size_t CountUtf8Bytes(const uint16_t* chars, size_t char_count) {
   size_t result = 0;
   const uint16_t *end = chars + char_count;
   while (chars < end) {
-    const uint16_t ch = *chars++;
-    if (LIKELY(ch != 0 && ch < 0x80)) {
-      result++;
-      continue;
+    // One byte per ASCII character.
+    size_t ascii_count = CountLeadingAsciiChars(chars, end - chars);
+    result += ascii_count;
+    chars += ascii_count;
+    if (chars == end) {
+      break;
     }
+    const uint16_t ch = *chars++;
+    DCHECK(!IsAscii(ch));
     if (ch < 0x800) {
       result += 2;
       continue;
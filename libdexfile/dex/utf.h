@@ -73,6 +73,24 @@ int CompareModifiedUtf8ToUtf16AsCodePointValues(const char* utf8, const uint16_t
 void ConvertUtf16ToModifiedUtf8(char* utf8_out, size_t byte_count,
                                 const uint16_t* utf16_in, size_t char_count);
 
+/*
+ * Return the number of leading characters in the range 0x01-0x7f, i.e. those that are encoded
+ * as a single byte in modified UTF-8 and can be stored in a compressed string. These use SIMD
+ * where available, so prefer them to per-character loops over long strings.
+ */
+size_t CountLeadingAsciiChars(const uint8_t* chars, size_t char_count);
+size_t CountLeadingAsciiChars(const uint16_t* chars, size_t char_count);
+
+/*
+ * Widen 8-bit characters, e.g. of a compressed string, to UTF-16.
+ */
+void ConvertAsciiToUtf16(uint16_t* utf16_out, const uint8_t* ascii_in, size_t char_count);
+
+/*
+ * Narrow UTF-16 characters to 8 bits. All characters must be below 0x100.
+ */
+void ConvertUtf16ToAscii(uint8_t* ascii_out, const uint16_t* utf16_in, size_t char_count);
+
 /*
  * The java.lang.String hashCode() algorithm.
  */
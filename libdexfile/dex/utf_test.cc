@@ -17,6 +17,7 @@
 #include "utf.h"
 
 #include <map>
+#include <random>
 #include <vector>
 
 #include "gtest/gtest.h"
@@ -378,4 +379,111 @@ TEST_F(UtfTest, ExhaustiveBidirectionalCodePointCheck) {
   }
 }
 
+// Random UTF-16 strings made of ASCII runs of varying length mixed with other characters,
+// including '\0', unpaired surrogates and surrogate pairs, to exercise both the vectorized
+// and the scalar paths at all alignments.
+static std::vector<uint16_t> RandomUtf16String(std::mt19937* rng) {
+  std::uniform_int_distribution<size_t> length_dist(0u, 100u);
+  std::uniform_int_distribution<uint32_t> kind_dist(0u, 9u);
+  std::uniform_int_distribution<uint16_t> ascii_dist(1u, 0x7fu);
+  std::uniform_int_distribution<uint16_t> char_dist(0u, 0xffffu);
+  std::vector<uint16_t> result;
+  size_t length = length_dist(*rng);
+  while (result.size() < length) {
+    switch (kind_dist(*rng)) {
+      case 0:
+        result.push_back(0u);
+        break;
+      case 1:
+        result.push_back(char_dist(*rng) & 0x7ffu);
+        break;
+      case 2:
+        result.push_back(char_dist(*rng));
+        break;
+      case 3: {
+        uint16_t first;
+        uint16_t second;
+        codePointToSurrogatePair(0x10000u + (char_dist(*rng) << 4), first, second);
+        result.push_back(first);
+        result.push_back(second);
+        break;
+      }
+      default: {
+        size_t run = length_dist(*rng) / 2u;
+        for (size_t i = 0; i != run; ++i) {
+          result.push_back(ascii_dist(*rng));
+        }
+        break;
+      }
+    }
+  }
+  return result;
+}
+
+TEST_F(UtfTest, RandomConversionsMatchReference) {
+  std::mt19937 rng(42u);
+  for (size_t iteration = 0; iteration != 20000u; ++iteration) {
+    std::vector<uint16_t> utf16 = RandomUtf16String(&rng);
+    const size_t char_count = utf16.size();
+
+    size_t byte_count = CountUtf8Bytes(utf16.data(), char_count);
+    ASSERT_EQ(CountUtf8Bytes_reference(utf16.data(), char_count), byte_count);
+
+    std::vector<char> utf8(byte_count + 1u, '\0');
+    std::vector<char> utf8_reference(byte_count + 1u, '\0');
+    ConvertUtf16ToModifiedUtf8(utf8.data(), byte_count, utf16.data(), char_count);
+    ConvertUtf16ToModifiedUtf8_reference(utf8_reference.data(), utf16.data(), char_count);
+    ASSERT_EQ(utf8_reference, utf8);
+
+    ASSERT_EQ(CountModifiedUtf8Chars_reference(utf8.data()),
+              CountModifiedUtf8Chars(utf8.data(), byte_count));
+    ASSERT_EQ(char_count, CountModifiedUtf8Chars(utf8.data(), byte_count));
+
+    std::vector<uint16_t> decoded(char_count + 1u, 0u);
+    ConvertModifiedUtf8ToUtf16(decoded.data(), char_count, utf8.data(), byte_count);
+    decoded.resize(char_count);
+    ASSERT_EQ(utf16, decoded);
+  }
+}
+
+TEST_F(UtfTest, AsciiKernels) {
+  std::mt19937 rng(42u);
+  std::uniform_int_distribution<size_t> length_dist(0u, 80u);
+  std::uniform_int_distribution<uint16_t> ascii_dist(1u, 0x7fu);
+  for (size_t iteration = 0; iteration != 5000u; ++iteration) {
+    size_t length = length_dist(rng);
+    std::vector<uint16_t> chars(length);
+    for (uint16_t& c : chars) {
+      c = ascii_dist(rng);
+    }
+    std::vector<uint8_t> bytes(length);
+    ConvertUtf16ToAscii(bytes.data(), chars.data(), length);
+    for (size_t i = 0; i != length; ++i) {
+      ASSERT_EQ(chars[i], bytes[i]);
+    }
+    std::vector<uint16_t> widened(length);
+    ConvertAsciiToUtf16(widened.data(), bytes.data(), length);
+    ASSERT_EQ(chars, widened);
+    ASSERT_EQ(length, CountLeadingAsciiChars(chars.data(), length));
+    ASSERT_EQ(length, CountLeadingAsciiChars(bytes.data(), length));
+
+    // Each kind of non-ASCII character stops the count at its position.
+    if (length != 0u) {
+      size_t position = length_dist(rng) % length;
+      for (uint16_t non_ascii : { 0x0000, 0x0080, 0x00ff, 0x0100, 0x7fff, 0x8000, 0xffff }) {
+        uint16_t saved_char = chars[position];
+        chars[position] = non_ascii;
+        ASSERT_EQ(position, CountLeadingAsciiChars(chars.data(), length)) << non_ascii;
+        chars[position] = saved_char;
+        if (non_ascii < 0x100u) {
+          uint8_t saved_byte = bytes[position];
+          bytes[position] = static_cast<uint8_t>(non_ascii);
+          ASSERT_EQ(position, CountLeadingAsciiChars(bytes.data(), length)) << non_ascii;
+          bytes[position] = saved_byte;
+        }
+      }
+    }
+  }
+}
+
 }  // namespace art
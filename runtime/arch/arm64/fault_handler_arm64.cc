@@ -29,7 +29,7 @@
 
 extern "C" void art_quick_throw_stack_overflow();
 extern "C" void art_quick_throw_null_pointer_exception_from_signal();
-extern "C" void art_quick_implicit_suspend();
+extern "C" void art_quick_test_suspend();
 
 //
 // ARM64 specific fault handler functions.
@@ -89,64 +89,49 @@ bool NullPointerHandler::Action(int sig ATTRIBUTE_UNUSED, siginfo_t* info, void*
   return true;
 }
 
-// A suspend check is done using the following instruction sequence:
-//      0xf7223228: f9405640  ldr x0, [x18, #168]
-// .. some intervening instructions
-//      0xf7223230: f9400000  ldr x0, [x0]
-
-// The offset from r18 is Thread::ThreadSuspendTriggerOffset().
-// To check for a suspend check, we examine the instructions that caused
-// the fault (at PC-4 and PC).
+// An implicit suspend check is done using the following instruction sequence, where xN is a
+// scratch register:
+//      0x7f7d2c6c: f9405670  ldr x16, [x19, #168]
+//      0x7f7d2c70: b940021f  ldr wzr, [x16]
+// The offset from x19 (xSELF) is Thread::ThreadSuspendTriggerOffset(). The trigger points to
+// itself unless a suspend or checkpoint has been requested, in which case it is null and the
+// second load faults. To check for a suspend check, we examine the instructions at PC-4 and PC.
 bool SuspensionHandler::Action(int sig ATTRIBUTE_UNUSED, siginfo_t* info ATTRIBUTE_UNUSED,
                                void* context) {
-  // These are the instructions to check for.  The first one is the ldr x0,[r18,#xxx]
-  // where xxx is the offset of the suspend trigger.
-  uint32_t checkinst1 = 0xf9400240 |
-      (Thread::ThreadSuspendTriggerOffset<PointerSize::k64>().Int32Value() << 7);
-  uint32_t checkinst2 = 0xf9400000;
-
   struct ucontext *uc = reinterpret_cast<struct ucontext *>(context);
   struct sigcontext *sc = reinterpret_cast<struct sigcontext*>(&uc->uc_mcontext);
-  uint8_t* ptr2 = reinterpret_cast<uint8_t*>(sc->pc);
-  uint8_t* ptr1 = ptr2 - 4;
   VLOG(signals) << "checking suspend";
 
-  uint32_t inst2 = *reinterpret_cast<uint32_t*>(ptr2);
-  VLOG(signals) << "inst2: " << std::hex << inst2 << " checkinst2: " << checkinst2;
-  if (inst2 != checkinst2) {
+  // ldr wzr, [xN, #0]
+  uint32_t inst2 = *reinterpret_cast<uint32_t*>(sc->pc);
+  VLOG(signals) << "inst2: " << std::hex << inst2;
+  if ((inst2 & 0xfffffc1f) != 0xb940001f) {
     // Second instruction is not good, not ours.
     return false;
   }
-
-  // The first instruction can a little bit up the stream due to load hoisting
-  // in the compiler.
-  uint8_t* limit = ptr1 - 80;   // Compiler will hoist to a max of 20 instructions.
-  bool found = false;
-  while (ptr1 > limit) {
-    uint32_t inst1 = *reinterpret_cast<uint32_t*>(ptr1);
-    VLOG(signals) << "inst1: " << std::hex << inst1 << " checkinst1: " << checkinst1;
-    if (inst1 == checkinst1) {
-      found = true;
-      break;
-    }
-    ptr1 -= 4;
-  }
-  if (found) {
-    VLOG(signals) << "suspend check match";
-    // This is a suspend check.  Arrange for the signal handler to return to
-    // art_quick_implicit_suspend.  Also set LR so that after the suspend check it
-    // will resume the instruction (current PC + 4).  PC points to the
-    // ldr x0,[x0,#0] instruction (r0 will be 0, set by the trigger).
-
-    sc->regs[30] = sc->pc + 4;
-    sc->pc = reinterpret_cast<uintptr_t>(art_quick_implicit_suspend);
-
-    // Now remove the suspend trigger that caused this fault.
-    Thread::Current()->RemoveSuspendTrigger();
-    VLOG(signals) << "removed suspend trigger invoking test suspend";
-    return true;
+  const uint32_t reg = (inst2 >> 5) & 0x1f;
+
+  // ldr xN, [x19, #offset]
+  const uint32_t offset = Thread::ThreadSuspendTriggerOffset<PointerSize::k64>().Uint32Value();
+  uint32_t checkinst1 = 0xf9400000 | ((offset / 8) << 10) | (static_cast<uint32_t>(TR) << 5) | reg;
+  uint32_t inst1 = *reinterpret_cast<uint32_t*>(sc->pc - 4);
+  VLOG(signals) << "inst1: " << std::hex << inst1 << " checkinst1: " << checkinst1;
+  if (inst1 != checkinst1) {
+    return false;
   }
-  return false;
+
+  VLOG(signals) << "suspend check match";
+  // This is a suspend check. Arrange for the signal handler to return to art_quick_test_suspend,
+  // which saves every register as the compiled code expects for a suspend check. Also set LR so
+  // that after the suspend check it resumes after the faulting load, where the compiler recorded
+  // the stack map. LR is not live in compiled code outside calls.
+  sc->regs[30] = sc->pc + 4;
+  sc->pc = reinterpret_cast<uintptr_t>(art_quick_test_suspend);
+
+  // Now remove the suspend trigger that caused this fault.
+  Thread::Current()->RemoveSuspendTrigger();
+  VLOG(signals) << "removed suspend trigger invoking test suspend";
+  return true;
 }
 
 bool StackOverflowHandler::Action(int sig ATTRIBUTE_UNUSED, siginfo_t* info ATTRIBUTE_UNUSED,
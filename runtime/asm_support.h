@@ -102,7 +102,7 @@ ADD_TEST_EQ(THREAD_LOCAL_ALLOC_STACK_END_OFFSET,
 // Offset of field Thread::interpreter_cache_. This is aligned on a 16 byte boundary so we need to
 // round up depending on the size of tlsPtr_.
 #define THREAD_INTERPRETER_CACHE_OFFSET \
-  (ALIGN_UP((THREAD_CARD_TABLE_OFFSET + 301 * __SIZEOF_POINTER__), 16))
+  (ALIGN_UP((THREAD_CARD_TABLE_OFFSET + 302 * __SIZEOF_POINTER__), 16))
 ADD_TEST_EQ(THREAD_INTERPRETER_CACHE_OFFSET,
             art::Thread::InterpreterCacheOffset<POINTER_SIZE>().Int32Value())
 
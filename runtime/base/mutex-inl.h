@@ -156,19 +156,55 @@ inline void BaseMutex::RegisterAsUnlocked(Thread* self) {
   }
 }
 
+#if ART_USE_FUTEXES
+inline AtomicInteger* ReaderWriterMutex::GetReaderSlot(const Thread* self) const {
+  return &reader_slots_[static_cast<uint32_t>(self->GetTid()) % kNumReaderSlots].count;
+}
+
+inline bool ReaderWriterMutex::TryBiasedSharedLock(Thread* self) {
+  // A thread records a single biased share, further shares go through the state word.
+  if (reader_slots_ == nullptr ||
+      self == nullptr ||
+      self->GetBiasedReaderMutex() != nullptr ||
+      !reader_bias_.load(std::memory_order_relaxed)) {
+    return false;
+  }
+  AtomicInteger* slot = GetReaderSlot(self);
+  slot->fetch_add(1, std::memory_order_seq_cst);
+  // A writer sets state_ before it looks at the slots, so either we see it here or it waits for
+  // our share to go away.
+  if (LIKELY(state_.load(std::memory_order_seq_cst) >= 0)) {
+    self->SetBiasedReaderMutex(this);
+    return true;
+  }
+  ReleaseReaderSlot(slot);
+  return false;
+}
+
+inline void ReaderWriterMutex::ReleaseReaderSlot(AtomicInteger* slot) {
+  if (slot->fetch_sub(1, std::memory_order_seq_cst) == 1 &&
+      UNLIKELY(state_.load(std::memory_order_seq_cst) < 0)) {
+    // A writer may be waiting for the slot to drain.
+    futex(slot->Address(), FUTEX_WAKE, -1, nullptr, nullptr, 0);
+  }
+}
+#endif
+
 inline void ReaderWriterMutex::SharedLock(Thread* self) {
   DCHECK(self == nullptr || self == Thread::Current());
 #if ART_USE_FUTEXES
-  bool done = false;
-  do {
-    int32_t cur_state = state_.load(std::memory_order_relaxed);
-    if (LIKELY(cur_state >= 0)) {
-      // Add as an extra reader.
-      done = state_.CompareAndSetWeakAcquire(cur_state, cur_state + 1);
-    } else {
-      HandleSharedLockContention(self, cur_state);
-    }
-  } while (!done);
+  if (!TryBiasedSharedLock(self)) {
+    bool done = false;
+    do {
+      int32_t cur_state = state_.load(std::memory_order_relaxed);
+      if (LIKELY(cur_state >= 0)) {
+        // Add as an extra reader.
+        done = state_.CompareAndSetWeakAcquire(cur_state, cur_state + 1);
+      } else {
+        HandleSharedLockContention(self, cur_state);
+      }
+    } while (!done);
+  }
 #else
   CHECK_MUTEX_CALL(pthread_rwlock_rdlock, (&rwlock_));
 #endif
@@ -183,6 +219,11 @@ inline void ReaderWriterMutex::SharedUnlock(Thread* self) {
   AssertSharedHeld(self);
   RegisterAsUnlocked(self);
 #if ART_USE_FUTEXES
+  if (self != nullptr && self->GetBiasedReaderMutex() == this) {
+    self->SetBiasedReaderMutex(nullptr);
+    ReleaseReaderSlot(GetReaderSlot(self));
+    return;
+  }
   bool done = false;
   do {
     int32_t cur_state = state_.load(std::memory_order_relaxed);
@@ -601,13 +601,16 @@ void Mutex::WakeupToRespondToEmptyCheckpoint() {
 #endif
 }
 
-ReaderWriterMutex::ReaderWriterMutex(const char* name, LockLevel level)
+ReaderWriterMutex::ReaderWriterMutex(const char* name, LockLevel level, bool reader_biased)
     : BaseMutex(name, level)
 #if ART_USE_FUTEXES
-    , state_(0), num_pending_readers_(0), num_pending_writers_(0)
+    , state_(0), num_pending_readers_(0), num_pending_writers_(0),
+    reader_slots_(reader_biased ? new ReaderSlot[kNumReaderSlots] : nullptr),
+    reader_bias_(reader_biased), reader_bias_inhibit_until_ns_(0u)
 #endif
 {
 #if !ART_USE_FUTEXES
+  UNUSED(reader_biased);
   CHECK_MUTEX_CALL(pthread_rwlock_init, (&rwlock_, nullptr));
 #endif
   exclusive_owner_.store(0 /* pid */, std::memory_order_relaxed);
@@ -619,6 +622,12 @@ ReaderWriterMutex::~ReaderWriterMutex() {
   CHECK_EQ(GetExclusiveOwnerTid(), 0);
   CHECK_EQ(num_pending_readers_.load(std::memory_order_relaxed), 0);
   CHECK_EQ(num_pending_writers_.load(std::memory_order_relaxed), 0);
+  if (reader_slots_ != nullptr) {
+    for (size_t i = 0; i != kNumReaderSlots; ++i) {
+      CHECK_EQ(reader_slots_[i].count.load(std::memory_order_relaxed), 0);
+    }
+    delete[] reader_slots_;
+  }
 #else
   // We can't use CHECK_MUTEX_CALL here because on shutdown a suspended daemon thread
   // may still be using locks.
@@ -659,6 +668,9 @@ void ReaderWriterMutex::ExclusiveLock(Thread* self) {
     }
   } while (!done);
   DCHECK_EQ(state_.load(std::memory_order_relaxed), -1);
+  if (reader_slots_ != nullptr) {
+    WaitForBiasedReaders(/* end_abs_ts */ nullptr);
+  }
 #else
   CHECK_MUTEX_CALL(pthread_rwlock_wrlock, (&rwlock_));
 #endif
@@ -696,6 +708,9 @@ void ReaderWriterMutex::ExclusiveUnlock(Thread* self) {
       LOG(FATAL) << "Unexpected state_:" << cur_state << " for " << name_;
     }
   } while (!done);
+  if (reader_slots_ != nullptr) {
+    MaybeRestoreReaderBias();
+  }
 #else
   exclusive_owner_.store(0 /* pid */, std::memory_order_relaxed);
   CHECK_MUTEX_CALL(pthread_rwlock_unlock, (&rwlock_));
@@ -741,6 +756,16 @@ bool ReaderWriterMutex::ExclusiveLockWithTimeout(Thread* self, int64_t ms, int32
       --num_pending_writers_;
     }
   } while (!done);
+  if (reader_slots_ != nullptr && !WaitForBiasedReaders(&end_abs_ts)) {
+    // Timed out waiting for the biased readers, give the state back and wake anybody who blocked
+    // on it in the meantime.
+    state_.store(0, std::memory_order_seq_cst);
+    if (num_pending_readers_.load(std::memory_order_seq_cst) > 0 ||
+        num_pending_writers_.load(std::memory_order_seq_cst) > 0) {
+      futex(state_.Address(), FUTEX_WAKE, -1, nullptr, nullptr, 0);
+    }
+    return false;
+  }
 #else
   timespec ts;
   InitTimeSpec(true, CLOCK_REALTIME, ms, ns, &ts);
@@ -761,6 +786,55 @@ bool ReaderWriterMutex::ExclusiveLockWithTimeout(Thread* self, int64_t ms, int32
 #endif
 
 #if ART_USE_FUTEXES
+bool ReaderWriterMutex::WaitForBiasedReaders(const timespec* end_abs_ts) {
+  DCHECK_EQ(state_.load(std::memory_order_relaxed), -1);
+  // New readers see state_ and take the slow path, so the slots can only drain.
+  uint64_t wait_start_ns = 0u;
+  for (size_t i = 0; i != kNumReaderSlots; ++i) {
+    AtomicInteger* slot = &reader_slots_[i].count;
+    int32_t count;
+    while ((count = slot->load(std::memory_order_seq_cst)) != 0) {
+      if (wait_start_ns == 0u) {
+        wait_start_ns = NanoTime();
+      }
+      timespec rel_ts;
+      const timespec* timeout = nullptr;
+      if (end_abs_ts != nullptr) {
+        timespec now_abs_ts;
+        InitTimeSpec(true, CLOCK_MONOTONIC, 0, 0, &now_abs_ts);
+        if (ComputeRelativeTimeSpec(&rel_ts, *end_abs_ts, now_abs_ts)) {
+          return false;  // Timed out.
+        }
+        timeout = &rel_ts;
+      }
+      if (futex(slot->Address(), FUTEX_WAIT, count, timeout, nullptr, 0) != 0) {
+        if (errno == ETIMEDOUT) {
+          return false;  // Timed out.
+        } else if ((errno != EAGAIN) && (errno != EINTR)) {
+          PLOG(FATAL) << "futex wait failed for " << name_;
+        }
+      }
+    }
+  }
+  if (wait_start_ns != 0u) {
+    // Readers held us up. Keep new readers on state_ for a while, so that a mutex which is
+    // written often does not keep paying for draining the slots.
+    const uint64_t now_ns = NanoTime();
+    reader_bias_.store(false, std::memory_order_relaxed);
+    reader_bias_inhibit_until_ns_.store(
+        now_ns + kReaderBiasInhibitMultiplier * (now_ns - wait_start_ns),
+        std::memory_order_relaxed);
+  }
+  return true;
+}
+
+void ReaderWriterMutex::MaybeRestoreReaderBias() {
+  if (!reader_bias_.load(std::memory_order_relaxed) &&
+      NanoTime() >= reader_bias_inhibit_until_ns_.load(std::memory_order_relaxed)) {
+    reader_bias_.store(true, std::memory_order_relaxed);
+  }
+}
+
 void ReaderWriterMutex::HandleSharedLockContention(Thread* self, int32_t cur_state) {
   // Owner holds it exclusively, hang up.
   ScopedContentionRecorder scr(this, SafeGetTid(self), GetExclusiveOwnerTid());
@@ -825,6 +899,8 @@ void ReaderWriterMutex::Dump(std::ostream& os) const {
       << " state=" << state_.load(std::memory_order_seq_cst)
       << " num_pending_writers=" << num_pending_writers_.load(std::memory_order_seq_cst)
       << " num_pending_readers=" << num_pending_readers_.load(std::memory_order_seq_cst)
+      << " reader_biased=" << (reader_slots_ != nullptr &&
+                               reader_bias_.load(std::memory_order_seq_cst))
 #endif
       << " ";
   DumpContention(os);
@@ -62,6 +62,7 @@ enum LockLevel : uint8_t {
   kSwapMutexesLock,
   kUnexpectedSignalLock,
   kThreadSuspendCountLock,
+  kThreadHandshakeLock,
   kAbortLock,
   kNativeDebugInterfaceLock,
   kSignalHandlingLock,
@@ -93,6 +94,7 @@ enum LockLevel : uint8_t {
   kAllocSpaceLock,
   kBumpPointerSpaceBlockLock,
   kArenaPoolLock,
+  kInternTableShardLock,
   kInternTableLock,
   kOatFileSecondaryLookupLock,
   kHostDlOpenHandlesLock,
@@ -335,10 +337,19 @@ class LOCKABLE Mutex : public BaseMutex {
 // Exclusive | Block         | Free            | Block            | error
 // Shared(n) | Block         | error           | SharedLock(n+1)* | Shared(n-1) or Free
 // * for large values of n the SharedLock may block.
+//
+// A reader-biased ReaderWriterMutex lets attached threads take a share by incrementing one of a
+// set of per-thread reader slots instead of the shared state word, so that readers on different
+// cores do not fight over a single cache line. An exclusive owner first takes the state word and
+// then waits for every slot to drain. Writers that had to wait for readers turn the bias off for
+// a while, in proportion to how long they waited, so write-heavy mutexes fall back to the state
+// word.
 std::ostream& operator<<(std::ostream& os, const ReaderWriterMutex& mu);
 class SHARED_LOCKABLE ReaderWriterMutex : public BaseMutex {
  public:
-  explicit ReaderWriterMutex(const char* name, LockLevel level = kDefaultMutexLevel);
+  explicit ReaderWriterMutex(const char* name,
+                             LockLevel level = kDefaultMutexLevel,
+                             bool reader_biased = false);
   ~ReaderWriterMutex();
 
   virtual bool IsReaderWriterMutex() const { return true; }
@@ -422,10 +433,37 @@ class SHARED_LOCKABLE ReaderWriterMutex : public BaseMutex {
 
  private:
 #if ART_USE_FUTEXES
+  // Number of reader slots of a reader-biased mutex, threads are spread over them by thread id.
+  static constexpr size_t kNumReaderSlots = 64;
+  // Writers that waited for biased readers turn the bias off for this many times their wait.
+  static constexpr uint64_t kReaderBiasInhibitMultiplier = 9;
+
+  // Reader slots live on their own cache line.
+  struct alignas(64) ReaderSlot {
+    AtomicInteger count;
+  };
+
   // Out-of-inline path for handling contention for a SharedLock.
   void HandleSharedLockContention(Thread* self, int32_t cur_state);
 
-  // -1 implies held exclusive, +ve shared held by state_ many owners.
+  // Try to take a share through the reader slot of `self`, returns false if the mutex is not
+  // reader-biased, the bias is off or a writer holds the mutex.
+  ALWAYS_INLINE bool TryBiasedSharedLock(Thread* self);
+
+  // Give up a share taken through `slot`, waking a writer waiting for the slot to drain.
+  ALWAYS_INLINE void ReleaseReaderSlot(AtomicInteger* slot);
+
+  ALWAYS_INLINE AtomicInteger* GetReaderSlot(const Thread* self) const;
+
+  // Called by a thread that has set state_ to -1, waits until no share is held through a reader
+  // slot. Returns false if `end_abs_ts` is not null and the wait timed out.
+  bool WaitForBiasedReaders(const timespec* end_abs_ts);
+
+  // Turn the reader bias back on once the inhibition period of the last waiting writer is over.
+  void MaybeRestoreReaderBias();
+
+  // -1 implies held exclusive, +ve shared held by state_ many owners. Shares held through the
+  // reader slots are not counted.
   AtomicInteger state_;
   // Exclusive owner. Modification guarded by this mutex.
   Atomic<pid_t> exclusive_owner_;
@@ -433,6 +471,13 @@ class SHARED_LOCKABLE ReaderWriterMutex : public BaseMutex {
   AtomicInteger num_pending_readers_;
   // Number of contenders waiting to be the writer.
   AtomicInteger num_pending_writers_;
+  // Null unless the mutex is reader-biased.
+  ReaderSlot* const reader_slots_;
+  // Whether readers should try their slot first. Only a hint, exclusive owners always wait for
+  // the slots to drain.
+  Atomic<bool> reader_bias_;
+  // NanoTime() before which the reader bias stays off.
+  Atomic<uint64_t> reader_bias_inhibit_until_ns_;
 #else
   pthread_rwlock_t rwlock_;
   Atomic<pid_t> exclusive_owner_;  // Writes guarded by rwlock_. Asynchronous reads are OK.
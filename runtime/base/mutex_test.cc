@@ -171,4 +171,52 @@ TEST_F(MutexTest, SharedTryLockUnlock) {
   SharedTryLockUnlockTest();
 }
 
+struct BiasedReaderWait {
+  BiasedReaderWait() : mu("test rwmutex", kDefaultMutexLevel, /* reader_biased */ true) {}
+
+  ReaderWriterMutex mu;
+  Atomic<bool> writer_done;
+};
+
+static void* BiasedReaderWaitCallback(void* arg) NO_THREAD_SAFETY_ANALYSIS {
+  BiasedReaderWait* state = reinterpret_cast<BiasedReaderWait*>(arg);
+  state->mu.ExclusiveLock(Thread::Current());
+  state->writer_done.store(true, std::memory_order_seq_cst);
+  state->mu.ExclusiveUnlock(Thread::Current());
+  return nullptr;
+}
+
+// GCC has trouble with our mutex tests, so we have to turn off thread safety analysis.
+static void BiasedReaderWaitTest() NO_THREAD_SAFETY_ANALYSIS {
+  BiasedReaderWait state;
+  Thread* self = Thread::Current();
+  state.mu.SharedLock(self);
+  state.mu.AssertSharedHeld(self);
+#if ART_USE_FUTEXES
+  // The share was taken through the reader slot, not the state word.
+  EXPECT_EQ(0, state.mu.GetExclusiveOwnerTid());
+#endif
+
+  pthread_t pthread;
+  int pthread_create_result = pthread_create(&pthread, nullptr, BiasedReaderWaitCallback, &state);
+  ASSERT_EQ(0, pthread_create_result);
+  // The writer must wait for the biased reader.
+  usleep(10000);
+  EXPECT_FALSE(state.writer_done.load(std::memory_order_seq_cst));
+  state.mu.SharedUnlock(self);
+  state.mu.AssertNotHeld(self);
+  EXPECT_EQ(pthread_join(pthread, nullptr), 0);
+  EXPECT_TRUE(state.writer_done.load(std::memory_order_seq_cst));
+
+  // Shares can still be taken once the writer is gone, whether or not the bias is back on.
+  state.mu.SharedLock(self);
+  state.mu.SharedUnlock(self);
+  state.mu.ExclusiveLock(self);
+  state.mu.ExclusiveUnlock(self);
+}
+
+TEST_F(MutexTest, BiasedReaderWait) {
+  BiasedReaderWaitTest();
+}
+
 }  // namespace art
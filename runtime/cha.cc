@@ -76,6 +76,11 @@ void ClassHierarchyAnalysis::RemoveDependentsWithMethodHeaders(
       map_it++;
     }
   }
+
+  // Freed code is not on any stack, so it no longer needs a deferred deoptimization.
+  for (OatQuickMethodHeader* method_header : method_headers) {
+    pending_deopt_headers_.erase(method_header);
+  }
 }
 
 void ClassHierarchyAnalysis::ResetSingleImplementationInHierarchy(ObjPtr<mirror::Class> klass,
@@ -211,8 +216,7 @@ class CHAStackVisitor final  : public StackVisitor {
       // This compiled version doesn't have should_deoptimize flag. Skip.
       return true;
     }
-    auto it = std::find(method_headers_.begin(), method_headers_.end(), method_header);
-    if (it == method_headers_.end()) {
+    if (method_headers_.find(method_header) == method_headers_.end()) {
       // Not in the list of method headers that should be deoptimized.
       return true;
     }
@@ -677,6 +681,15 @@ void ClassHierarchyAnalysis::InvalidateSingleImplementationMethods(
           }
           RemoveAllDependenciesFor(invalidated);
         }
+        if (!dependent_method_headers.empty()) {
+          // A compiled method can depend on several invalidated methods, count it once.
+          ++num_invalidating_loads_;
+          num_invalidated_methods_ += dependent_method_headers.size();
+          max_invalidated_methods_per_load_ =
+              std::max<uint64_t>(max_invalidated_methods_per_load_,
+                                 dependent_method_headers.size());
+          DeferDeoptimization(&dependent_method_headers);
+        }
       }
       // Since we are still loading the class that invalidated the code it's fine we have this after
       // getting rid of the dependency. Any calls would need to be with the old version (since the
@@ -694,13 +707,85 @@ void ClassHierarchyAnalysis::InvalidateSingleImplementationMethods(
     if (dependent_method_headers.empty()) {
       return;
     }
-    // Deoptimze compiled code on stack that should have been invalidated.
-    CHACheckpoint checkpoint(dependent_method_headers);
-    size_t threads_running_checkpoint = runtime->GetThreadList()->RunCheckpoint(&checkpoint);
-    if (threads_running_checkpoint != 0) {
-      checkpoint.WaitForThreadsToRunThroughCheckpoint(threads_running_checkpoint);
+    DeoptimizeDependents(self, dependent_method_headers);
+  }
+}
+
+void ClassHierarchyAnalysis::DeoptimizeDependents(
+    Thread* self,
+    const std::unordered_set<OatQuickMethodHeader*>& method_headers) {
+  {
+    MutexLock cha_mu(self, *Locks::cha_lock_);
+    ++num_deopt_checkpoints_;
+  }
+  // Deoptimze compiled code on stack that should have been invalidated.
+  CHACheckpoint checkpoint(method_headers);
+  size_t threads_running_checkpoint =
+      Runtime::Current()->GetThreadList()->RunCheckpoint(&checkpoint);
+  if (threads_running_checkpoint != 0) {
+    checkpoint.WaitForThreadsToRunThroughCheckpoint(threads_running_checkpoint);
+  }
+}
+
+bool ClassHierarchyAnalysis::DeferDeoptimization(
+    std::unordered_set<OatQuickMethodHeader*>* method_headers) {
+  if (batch_depth_ == 0u) {
+    return false;
+  }
+  // Leave the deoptimization to the end of the batch. The class being loaded cannot be
+  // instantiated before that, see FlushPendingDeoptimizations().
+  pending_deopt_headers_.insert(method_headers->begin(), method_headers->end());
+  has_pending_deopt_.store(true, std::memory_order_release);
+  method_headers->clear();
+  return true;
+}
+
+void ClassHierarchyAnalysis::BeginBatch() {
+  MutexLock cha_mu(Thread::Current(), *Locks::cha_lock_);
+  ++batch_depth_;
+}
+
+void ClassHierarchyAnalysis::EndBatch() {
+  Thread* self = Thread::Current();
+  {
+    MutexLock cha_mu(self, *Locks::cha_lock_);
+    DCHECK_NE(batch_depth_, 0u);
+    --batch_depth_;
+    if (batch_depth_ != 0u) {
+      return;
     }
   }
+  FlushPendingDeoptimizations(self);
+}
+
+void ClassHierarchyAnalysis::FlushPendingDeoptimizations(Thread* self) {
+  if (!has_pending_deopt_.load(std::memory_order_acquire)) {
+    return;
+  }
+  std::unordered_set<OatQuickMethodHeader*> method_headers;
+  {
+    MutexLock cha_mu(self, *Locks::cha_lock_);
+    method_headers = pending_deopt_headers_;
+  }
+  if (!method_headers.empty()) {
+    DeoptimizeDependents(self, method_headers);
+  }
+  // Only drop the headers once their frames are deoptimized. Until then, a concurrent flush
+  // for another class initialization must not return early; it runs its own checkpoint.
+  MutexLock cha_mu(self, *Locks::cha_lock_);
+  for (OatQuickMethodHeader* method_header : method_headers) {
+    pending_deopt_headers_.erase(method_header);
+  }
+  if (pending_deopt_headers_.empty()) {
+    has_pending_deopt_.store(false, std::memory_order_relaxed);
+  }
+}
+
+void ClassHierarchyAnalysis::DumpForSigQuit(std::ostream& os) {
+  MutexLock cha_mu(Thread::Current(), *Locks::cha_lock_);
+  os << "CHA: " << num_invalidating_loads_ << " class loads invalidated "
+     << num_invalidated_methods_ << " compiled methods (max " << max_invalidated_methods_per_load_
+     << " per class load) in " << num_deopt_checkpoints_ << " deoptimization checkpoints\n";
 }
 
 void ClassHierarchyAnalysis::RemoveDependenciesForLinearAlloc(const LinearAlloc* linear_alloc) {
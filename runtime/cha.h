@@ -17,10 +17,13 @@
 #ifndef ART_RUNTIME_CHA_H_
 #define ART_RUNTIME_CHA_H_
 
+#include <atomic>
+#include <iosfwd>
 #include <unordered_map>
 #include <unordered_set>
 
 #include "base/enums.h"
+#include "base/macros.h"
 #include "base/mutex.h"
 #include "handle.h"
 #include "mirror/class.h"
@@ -30,6 +33,7 @@ namespace art {
 
 class ArtMethod;
 class LinearAlloc;
+class Thread;
 
 /**
  * Class Hierarchy Analysis (CHA) tries to devirtualize virtual calls into
@@ -72,6 +76,14 @@ class LinearAlloc;
  * after it is invalidated. Care needs to be taken between cha_lock_ and
  * JitCodeCache::lock_ to guarantee the atomicity.
  *
+ * Loading many classes at once, e.g. when a plugin is loaded, can invalidate
+ * code with each class. To avoid a checkpoint per class, class loads can be
+ * batched, see BeginBatch(). Within a batch, single-implementation status and
+ * entrypoints are still updated eagerly but deoptimization of frames on stack
+ * is deferred, and done in one checkpoint when the batch ends. That is safe as
+ * long as no instance of a newly loaded class exists, so the checkpoint also
+ * runs before any class is initialized.
+ *
  * We base our CHA on dynamically linked class profiles instead of doing static
  * analysis. Static analysis can be too aggressive due to dynamic class loading
  * at runtime, and too conservative since some classes may not be really loaded
@@ -129,6 +141,21 @@ class ClassHierarchyAnalysis {
   void RemoveDependenciesForLinearAlloc(const LinearAlloc* linear_alloc)
       REQUIRES(!Locks::cha_lock_);
 
+  // Open and close a batch of class loads. While any batch is open, frames of compiled code
+  // invalidated by class loads are deoptimized in one checkpoint when the last batch is closed
+  // instead of one checkpoint per class load. Batches may nest and overlap between threads.
+  void BeginBatch() REQUIRES(!Locks::cha_lock_);
+  void EndBatch() REQUIRES(!Locks::cha_lock_) REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Deoptimize frames of invalidated compiled code deferred by a batch. Called before a class is
+  // initialized since only instances of newly loaded classes can break the assumptions of that
+  // code.
+  void FlushPendingDeoptimizations(Thread* self)
+      REQUIRES(!Locks::cha_lock_) REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Dump the invalidation statistics for SIGQUIT.
+  void DumpForSigQuit(std::ostream& os) REQUIRES(!Locks::cha_lock_);
+
  private:
   void InitSingleImplementationFlag(Handle<mirror::Class> klass,
                                     ArtMethod* method,
@@ -166,14 +193,66 @@ class ClassHierarchyAnalysis {
       std::unordered_set<ArtMethod*>& invalidated_single_impl_methods)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // If a batch is open, queue `method_headers` for deoptimization at its end, clear them and
+  // return true. Otherwise leave them to the caller and return false.
+  bool DeferDeoptimization(std::unordered_set<OatQuickMethodHeader*>* method_headers)
+      REQUIRES(Locks::cha_lock_);
+
+  // Run a checkpoint that deoptimizes frames of compiled code with the given method headers.
+  void DeoptimizeDependents(Thread* self,
+                            const std::unordered_set<OatQuickMethodHeader*>& method_headers)
+      REQUIRES(!Locks::cha_lock_) REQUIRES_SHARED(Locks::mutator_lock_);
+
   // A map that maps a method to a set of compiled code that assumes that method has a
   // single implementation, which is used to do CHA-based devirtualization.
   std::unordered_map<ArtMethod*, ListOfDependentPairs> cha_dependency_map_
     GUARDED_BY(Locks::cha_lock_);
 
+  // Number of open batches.
+  size_t batch_depth_ GUARDED_BY(Locks::cha_lock_) = 0u;
+
+  // Method headers of invalidated compiled code whose frames are yet to be deoptimized because
+  // of an open batch. Entries are only removed once the checkpoint has run.
+  std::unordered_set<OatQuickMethodHeader*> pending_deopt_headers_ GUARDED_BY(Locks::cha_lock_);
+
+  // Whether pending_deopt_headers_ may be non-empty, to keep cha_lock_ off the class
+  // initialization path.
+  std::atomic<bool> has_pending_deopt_{false};
+
+  // Invalidation statistics: class loads that invalidated compiled code, the compiled methods
+  // they invalidated in total and at most for one class load, and the checkpoints run.
+  uint64_t num_invalidating_loads_ GUARDED_BY(Locks::cha_lock_) = 0u;
+  uint64_t num_invalidated_methods_ GUARDED_BY(Locks::cha_lock_) = 0u;
+  uint64_t max_invalidated_methods_per_load_ GUARDED_BY(Locks::cha_lock_) = 0u;
+  uint64_t num_deopt_checkpoints_ GUARDED_BY(Locks::cha_lock_) = 0u;
+
+  ART_FRIEND_TEST(CHATest, CHABatchDefersDeoptimization);
+  ART_FRIEND_TEST(CHATest, CHAFlushBeforeClassInitialization);
+
   DISALLOW_COPY_AND_ASSIGN(ClassHierarchyAnalysis);
 };
 
+// Keeps a batch of class loads open for its lifetime, see ClassHierarchyAnalysis::BeginBatch().
+class ScopedCHABatch {
+ public:
+  explicit ScopedCHABatch(ClassHierarchyAnalysis* cha) REQUIRES(!Locks::cha_lock_) : cha_(cha) {
+    if (cha_ != nullptr) {
+      cha_->BeginBatch();
+    }
+  }
+
+  ~ScopedCHABatch() REQUIRES(!Locks::cha_lock_) REQUIRES_SHARED(Locks::mutator_lock_) {
+    if (cha_ != nullptr) {
+      cha_->EndBatch();
+    }
+  }
+
+ private:
+  ClassHierarchyAnalysis* const cha_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedCHABatch);
+};
+
 }  // namespace art
 
 #endif  // ART_RUNTIME_CHA_H_
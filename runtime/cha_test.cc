@@ -16,7 +16,13 @@
 
 #include "cha.h"
 
+#include <sstream>
+
+#include "class_linker.h"
 #include "common_runtime_test.h"
+#include "handle_scope-inl.h"
+#include "mirror/class_loader.h"
+#include "scoped_thread_state_change-inl.h"
 
 namespace art {
 
@@ -90,4 +96,108 @@ TEST_F(CHATest, CHACheckDependency) {
   ASSERT_TRUE(cha.GetDependents(METHOD3).empty());
 }
 
+TEST_F(CHATest, CHABatchWithoutInvalidations) {
+  ScopedObjectAccess soa(Thread::Current());
+  ClassHierarchyAnalysis cha;
+
+  // Nested batches without invalidated code must not run any checkpoint.
+  cha.BeginBatch();
+  cha.BeginBatch();
+  cha.EndBatch();
+  cha.EndBatch();
+  cha.FlushPendingDeoptimizations(soa.Self());
+
+  std::ostringstream oss;
+  cha.DumpForSigQuit(oss);
+  EXPECT_EQ("CHA: 0 class loads invalidated 0 compiled methods (max 0 per class load) in 0 "
+            "deoptimization checkpoints\n",
+            oss.str());
+}
+
+TEST_F(CHATest, CHABatchDefersDeoptimization) {
+  ScopedObjectAccess soa(Thread::Current());
+  ClassHierarchyAnalysis cha;
+  std::unordered_set<OatQuickMethodHeader*> method_headers = { METHOD_HEADER1, METHOD_HEADER2 };
+
+  // Without a batch, the invalidating class load deoptimizes right away.
+  {
+    MutexLock cha_mu(soa.Self(), *Locks::cha_lock_);
+    ASSERT_FALSE(cha.DeferDeoptimization(&method_headers));
+    ASSERT_EQ(2u, method_headers.size());
+  }
+
+  cha.BeginBatch();
+  cha.BeginBatch();
+  {
+    MutexLock cha_mu(soa.Self(), *Locks::cha_lock_);
+    ASSERT_TRUE(cha.DeferDeoptimization(&method_headers));
+    ASSERT_TRUE(method_headers.empty());
+    ASSERT_EQ(2u, cha.pending_deopt_headers_.size());
+  }
+
+  // Closing the inner batch leaves the deoptimization to the outer one.
+  cha.EndBatch();
+  {
+    MutexLock cha_mu(soa.Self(), *Locks::cha_lock_);
+    ASSERT_EQ(0u, cha.num_deopt_checkpoints_);
+    ASSERT_EQ(2u, cha.pending_deopt_headers_.size());
+  }
+
+  // Closing the outer batch deoptimizes everything in one checkpoint.
+  cha.EndBatch();
+  {
+    MutexLock cha_mu(soa.Self(), *Locks::cha_lock_);
+    ASSERT_EQ(1u, cha.num_deopt_checkpoints_);
+    ASSERT_TRUE(cha.pending_deopt_headers_.empty());
+  }
+
+  // Freed code no longer needs to be deoptimized.
+  cha.BeginBatch();
+  method_headers = { METHOD_HEADER3 };
+  {
+    MutexLock cha_mu(soa.Self(), *Locks::cha_lock_);
+    ASSERT_TRUE(cha.DeferDeoptimization(&method_headers));
+    cha.RemoveDependentsWithMethodHeaders({ METHOD_HEADER3 });
+    ASSERT_TRUE(cha.pending_deopt_headers_.empty());
+  }
+  cha.EndBatch();
+  MutexLock cha_mu(soa.Self(), *Locks::cha_lock_);
+  ASSERT_EQ(1u, cha.num_deopt_checkpoints_);
+}
+
+TEST_F(CHATest, CHAFlushBeforeClassInitialization) {
+  ScopedObjectAccess soa(Thread::Current());
+  ClassHierarchyAnalysis* cha = class_linker_->GetClassHierarchyAnalysis();
+  ASSERT_TRUE(cha != nullptr);
+  StackHandleScope<2> hs(soa.Self());
+  Handle<mirror::ClassLoader> class_loader(
+      hs.NewHandle(soa.Decode<mirror::ClassLoader>(LoadDex("Statics"))));
+  Handle<mirror::Class> statics(
+      hs.NewHandle(class_linker_->FindClass(soa.Self(), "LStatics;", class_loader)));
+  ASSERT_TRUE(statics != nullptr);
+  ASSERT_FALSE(statics->IsInitialized());
+
+  // Code invalidated by a class load in an open batch is deoptimized before any class is
+  // initialized, not when the batch ends.
+  std::unordered_set<OatQuickMethodHeader*> method_headers = { METHOD_HEADER1 };
+  uint64_t num_deopt_checkpoints;
+  cha->BeginBatch();
+  {
+    MutexLock cha_mu(soa.Self(), *Locks::cha_lock_);
+    ASSERT_TRUE(cha->DeferDeoptimization(&method_headers));
+    num_deopt_checkpoints = cha->num_deopt_checkpoints_;
+  }
+  ASSERT_TRUE(class_linker_->EnsureInitialized(soa.Self(), statics, true, true));
+  {
+    MutexLock cha_mu(soa.Self(), *Locks::cha_lock_);
+    ASSERT_EQ(num_deopt_checkpoints + 1u, cha->num_deopt_checkpoints_);
+    ASSERT_TRUE(cha->pending_deopt_headers_.empty());
+  }
+
+  // Nothing is left for the end of the batch.
+  cha->EndBatch();
+  MutexLock cha_mu(soa.Self(), *Locks::cha_lock_);
+  ASSERT_EQ(num_deopt_checkpoints + 1u, cha->num_deopt_checkpoints_);
+}
+
 }  // namespace art
@@ -86,6 +86,7 @@
 #include "jit/jit_code_cache.h"
 #include "jni/java_vm_ext.h"
 #include "jni/jni_internal.h"
+#include "jni/native_optimization_list.h"
 #include "linear_alloc.h"
 #include "mirror/call_site.h"
 #include "mirror/class-inl.h"
@@ -125,6 +126,7 @@
 #include "scoped_thread_state_change-inl.h"
 #include "thread-inl.h"
 #include "thread_list.h"
+#include "thread_pool.h"
 #include "trace.h"
 #include "utils/dex_cache_arrays_layout-inl.h"
 #include "verifier/method_verifier.h"
@@ -795,6 +797,16 @@ bool ClassLinker::InitWithoutImage(std::vector<std::unique_ptr<const DexFile>> b
   SetClassRoot(ClassRoot::kJavaLangStackTraceElementArrayClass,
                FindSystemClass(self, "[Ljava/lang/StackTraceElement;"));
 
+  // Set up the box classes, used to unbox reflective arguments.
+  SetClassRoot(ClassRoot::kJavaLangBoolean, FindSystemClass(self, "Ljava/lang/Boolean;"));
+  SetClassRoot(ClassRoot::kJavaLangByte, FindSystemClass(self, "Ljava/lang/Byte;"));
+  SetClassRoot(ClassRoot::kJavaLangCharacter, FindSystemClass(self, "Ljava/lang/Character;"));
+  SetClassRoot(ClassRoot::kJavaLangDouble, FindSystemClass(self, "Ljava/lang/Double;"));
+  SetClassRoot(ClassRoot::kJavaLangFloat, FindSystemClass(self, "Ljava/lang/Float;"));
+  SetClassRoot(ClassRoot::kJavaLangInteger, FindSystemClass(self, "Ljava/lang/Integer;"));
+  SetClassRoot(ClassRoot::kJavaLangLong, FindSystemClass(self, "Ljava/lang/Long;"));
+  SetClassRoot(ClassRoot::kJavaLangShort, FindSystemClass(self, "Ljava/lang/Short;"));
+
   // Create conflict tables that depend on the class linker.
   runtime->FixupConflictTables();
 
@@ -2218,6 +2230,8 @@ void ClassLinker::DeleteClassLoader(Thread* self, const ClassLoaderData& data, b
     // If we don't have a JIT, we need to manually remove the CHA dependencies manually.
     cha_->RemoveDependenciesForLinearAlloc(data.allocator);
   }
+  // Hidden API decisions are cached by member address, which may be reused after this.
+  runtime->InvalidateHiddenApiDecisions();
   // Cleanup references to single implementation ArtMethods that will be deleted.
   if (cleanup_cha) {
     CHAOnDeleteUpdateClassVisitor visitor(data.allocator);
@@ -2804,33 +2818,39 @@ ObjPtr<mirror::Class> ClassLinker::DefineClass(Thread* self,
     return nullptr;
   }
 
-  // Finish loading (if necessary) by finding parents
-  CHECK(!klass->IsLoaded());
-  if (!LoadSuperAndInterfaces(klass, *new_dex_file)) {
-    // Loading failed.
-    if (!klass->IsErroneous()) {
-      mirror::Class::SetStatus(klass, ClassStatus::kErrorUnresolved, self);
-    }
-    return nullptr;
-  }
-  CHECK(klass->IsLoaded());
-
-  // At this point the class is loaded. Publish a ClassLoad event.
-  // Note: this may be a temporary class. It is a listener's responsibility to handle this.
-  Runtime::Current()->GetRuntimeCallbacks()->ClassLoad(klass);
-
-  // Link the class (if necessary)
-  CHECK(!klass->IsResolved());
   // TODO: Use fast jobjects?
   auto interfaces = hs.NewHandle<mirror::ObjectArray<mirror::Class>>(nullptr);
-
   MutableHandle<mirror::Class> h_new_class = hs.NewHandle<mirror::Class>(nullptr);
-  if (!LinkClass(self, descriptor, klass, interfaces, &h_new_class)) {
-    // Linking failed.
-    if (!klass->IsErroneous()) {
-      mirror::Class::SetStatus(klass, ClassStatus::kErrorUnresolved, self);
+  {
+    // Loading the parents and linking can invalidate CHA assumptions for each class in the
+    // hierarchy. Deoptimize frames of the invalidated code in one checkpoint once this class is
+    // linked. The checkpoint may suspend, so the batch ends before any object is returned.
+    ScopedCHABatch cha_batch(cha_.get());
+
+    // Finish loading (if necessary) by finding parents
+    CHECK(!klass->IsLoaded());
+    if (!LoadSuperAndInterfaces(klass, *new_dex_file)) {
+      // Loading failed.
+      if (!klass->IsErroneous()) {
+        mirror::Class::SetStatus(klass, ClassStatus::kErrorUnresolved, self);
+      }
+      return nullptr;
+    }
+    CHECK(klass->IsLoaded());
+
+    // At this point the class is loaded. Publish a ClassLoad event.
+    // Note: this may be a temporary class. It is a listener's responsibility to handle this.
+    Runtime::Current()->GetRuntimeCallbacks()->ClassLoad(klass);
+
+    // Link the class (if necessary)
+    CHECK(!klass->IsResolved());
+    if (!LinkClass(self, descriptor, klass, interfaces, &h_new_class)) {
+      // Linking failed.
+      if (!klass->IsErroneous()) {
+        mirror::Class::SetStatus(klass, ClassStatus::kErrorUnresolved, self);
+      }
+      return nullptr;
     }
-    return nullptr;
   }
   self->AssertNoPendingException();
   CHECK(h_new_class != nullptr) << descriptor;
@@ -3002,6 +3022,30 @@ bool ClassLinker::ShouldUseInterpreterEntrypoint(ArtMethod* method, const void*
   return false;
 }
 
+// Returns whether the compiled JNI stub of a native method from `oat_file` was compiled for the
+// same @FastNative or @CriticalNative flags as the method has with the current
+// native optimization list.
+static bool IsCompiledJniStubUsable(ArtMethod* method, const OatFile* oat_file)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  DCHECK(method->IsNative());
+  const NativeOptimizationList* list = Runtime::Current()->GetNativeOptimizationList();
+  const char* oat_list_checksum =
+      oat_file->GetOatHeader().GetStoreValueByKey(OatHeader::kNativeOptimizationListKey);
+  if (oat_list_checksum == nullptr) {
+    if (list == nullptr) {
+      return true;
+    }
+    // Only the methods in the list can have different flags.
+    std::string error_msg;
+    return list->GetAccessFlags(*method->GetDexFile(),
+                                method->GetDexMethodIndex(),
+                                method->GetAccessFlags(),
+                                &error_msg) == 0u;
+  }
+  // We do not know which methods were in the list the oat file was compiled with.
+  return list != nullptr && list->GetChecksum() == oat_list_checksum;
+}
+
 void ClassLinker::FixupStaticTrampolines(ObjPtr<mirror::Class> klass) {
   ScopedAssertNoThreadSuspension sants(__FUNCTION__);
   DCHECK(klass->IsInitialized()) << klass->PrettyDescriptor();
@@ -3036,6 +3080,11 @@ void ClassLinker::FixupStaticTrampolines(ObjPtr<mirror::Class> klass) {
     if (has_oat_class) {
       OatFile::OatMethod oat_method = oat_class.GetOatMethod(method_index);
       quick_code = oat_method.GetQuickCode();
+      if (quick_code != nullptr &&
+          method->IsNative() &&
+          !IsCompiledJniStubUsable(method, oat_class.GetOatFile())) {
+        quick_code = nullptr;
+      }
     }
     // Check whether the method is native, in which case it's generic JNI.
     if (quick_code == nullptr && method->IsNative()) {
@@ -3076,6 +3125,12 @@ static void LinkCode(ClassLinker* class_linker,
     // non-abstract methods also get their code pointers.
     const OatFile::OatMethod oat_method = oat_class->GetOatMethod(class_def_method_index);
     oat_method.LinkMethod(method);
+    if (method->IsNative() &&
+        method->GetEntryPointFromQuickCompiledCode() != nullptr &&
+        !IsCompiledJniStubUsable(method, oat_class->GetOatFile())) {
+      // Use the generic JNI stub instead.
+      method->SetEntryPointFromQuickCompiledCode(nullptr);
+    }
   }
 
   // Install entry point from interpreter.
@@ -3377,9 +3432,9 @@ void ClassLinker::LoadMethod(const DexFile& dex_file,
     }
   }
   if (UNLIKELY((access_flags & kAccNative) != 0u)) {
-    // Check if the native method is annotated with @FastNative or @CriticalNative.
-    access_flags |= annotations::GetNativeMethodAnnotationAccessFlags(
-        dex_file, dst->GetClassDef(), dex_method_idx);
+    // Check if the native method is annotated or listed as @FastNative or @CriticalNative.
+    access_flags |= NativeOptimizationList::GetNativeMethodAccessFlags(
+        dex_file, dst->GetClassDef(), dex_method_idx, access_flags);
   }
   dst->SetAccessFlags(access_flags);
 }
@@ -4058,6 +4113,127 @@ void ClassLinker::LookupClasses(const char* descriptor,
   VisitClassLoaders(&visitor);
 }
 
+size_t ClassLinker::PreloadClasses(Thread* self,
+                                   jobject class_loader,
+                                   const std::vector<std::string>& descriptors,
+                                   size_t num_threads) {
+  static constexpr uint32_t kNotLoaded = std::numeric_limits<uint32_t>::max();
+  static constexpr size_t kGrain = 16u;
+  if (descriptors.empty()) {
+    return 0u;
+  }
+  const uint64_t start_time = NanoTime();
+  num_threads = std::max<size_t>(1u, std::min(num_threads, descriptors.size()));
+  // Pool workers are runtime threads and never call into Java class loaders. Make the calling
+  // thread, which also runs tasks, behave the same way for the duration of the preloading.
+  const bool was_runtime_thread = self->IsRuntimeThread();
+  self->SetIsRuntimeThread(true);
+  ThreadPool pool("Class preloading thread pool", num_threads - 1u);
+  // The classes are not initialized here, so CHA invalidations can be batched.
+  if (cha_ != nullptr) {
+    cha_->BeginBatch();
+  }
+
+  // Load and link. FindClass handles superclasses and interfaces being loaded concurrently by
+  // other workers, so only the depth of each class in its superclass chain is recorded here.
+  std::vector<uint32_t> depths(descriptors.size(), kNotLoaded);
+  auto load_class = [&](size_t index) {
+    Thread* worker = Thread::Current();
+    ScopedObjectAccess soa(worker);
+    StackHandleScope<1> hs(worker);
+    Handle<mirror::ClassLoader> loader =
+        hs.NewHandle(soa.Decode<mirror::ClassLoader>(class_loader));
+    ObjPtr<mirror::Class> klass = FindClass(worker, descriptors[index].c_str(), loader);
+    if (klass == nullptr) {
+      worker->ClearException();
+      return;
+    }
+    uint32_t depth = 0u;
+    for (ObjPtr<mirror::Class> k = klass->GetSuperClass(); k != nullptr; k = k->GetSuperClass()) {
+      ++depth;
+    }
+    depths[index] = depth;
+  };
+  pool.ParallelFor(self, 0u, descriptors.size(), kGrain, num_threads, load_class);
+
+  // Verify one superclass depth at a time. VerifyClass verifies the supertypes first while
+  // holding the class lock, so this ordering keeps workers from blocking on each other.
+  std::vector<size_t> order;
+  order.reserve(descriptors.size());
+  for (size_t index = 0; index != descriptors.size(); ++index) {
+    if (depths[index] != kNotLoaded) {
+      order.push_back(index);
+    }
+  }
+  std::stable_sort(order.begin(), order.end(), [&depths](size_t lhs, size_t rhs) {
+    return depths[lhs] < depths[rhs];
+  });
+  auto verify_class = [&](size_t position) {
+    Thread* worker = Thread::Current();
+    ScopedObjectAccess soa(worker);
+    StackHandleScope<2> hs(worker);
+    Handle<mirror::ClassLoader> loader =
+        hs.NewHandle(soa.Decode<mirror::ClassLoader>(class_loader));
+    Handle<mirror::Class> klass =
+        hs.NewHandle(LookupClass(worker, descriptors[order[position]].c_str(), loader.Get()));
+    if (klass != nullptr && !klass->IsVerified() && !klass->IsErroneous()) {
+      VerifyClass(worker, klass);
+      worker->ClearException();
+    }
+  };
+  for (size_t level_begin = 0; level_begin != order.size(); ) {
+    const uint32_t depth = depths[order[level_begin]];
+    size_t level_end = level_begin + 1u;
+    while (level_end != order.size() && depths[order[level_end]] == depth) {
+      ++level_end;
+    }
+    pool.ParallelFor(self, level_begin, level_end, kGrain, num_threads, verify_class);
+    level_begin = level_end;
+  }
+  if (cha_ != nullptr) {
+    ScopedObjectAccess soa(self);
+    cha_->EndBatch();
+  }
+  self->SetIsRuntimeThread(was_runtime_thread);
+
+  VLOG(class_linker) << "Preloaded " << order.size() << " of " << descriptors.size()
+                     << " classes with " << num_threads << " threads in "
+                     << PrettyDuration(NanoTime() - start_time);
+  return order.size();
+}
+
+size_t ClassLinker::PreloadProfileClasses(Thread* self,
+                                          jobject class_loader,
+                                          const std::string& profile_file,
+                                          size_t num_threads) {
+  ProfileCompilationInfo profile;
+  std::unique_ptr<File> file(OS::OpenFileForReading(profile_file.c_str()));
+  if (file == nullptr || !profile.Load(file->Fd())) {
+    LOG(WARNING) << "Could not load class preloading profile " << profile_file;
+    return 0u;
+  }
+  std::vector<std::string> descriptors;
+  {
+    ScopedObjectAccess soa(self);
+    std::vector<const DexFile*> dex_files(GetBootClassPath().begin(), GetBootClassPath().end());
+    StackHandleScope<1> hs(self);
+    Handle<mirror::ClassLoader> loader =
+        hs.NewHandle(soa.Decode<mirror::ClassLoader>(class_loader));
+    if (loader != nullptr && IsPathOrDexClassLoader(soa, loader)) {
+      VisitClassLoaderDexFiles(soa, loader, [&dex_files](const DexFile* dex_file) {
+        dex_files.push_back(dex_file);
+        return true;  // Continue with the next DexFile.
+      });
+    }
+    for (const std::string& descriptor : profile.GetClassDescriptors(dex_files)) {
+      descriptors.push_back(descriptor);
+    }
+  }
+  // Sort for a deterministic work distribution between runs.
+  std::sort(descriptors.begin(), descriptors.end());
+  return PreloadClasses(self, class_loader, descriptors, num_threads);
+}
+
 bool ClassLinker::AttemptSupertypeVerification(Thread* self,
                                                Handle<mirror::Class> klass,
                                                Handle<mirror::Class> supertype) {
@@ -4577,6 +4753,11 @@ ObjPtr<mirror::Class> ClassLinker::CreateProxyClass(ScopedObjectAccessAlreadyRun
 
   Runtime::Current()->GetRuntimeCallbacks()->ClassPrepare(temp_klass, klass);
 
+  // The proxy class is initialized right away, see InitializeClass().
+  if (cha_ != nullptr) {
+    cha_->FlushPendingDeoptimizations(self);
+  }
+
   // SubtypeCheckInfo::Initialized must happen-before any new-instance for that type.
   // See also ClassLinker::EnsureInitialized().
   if (kBitstringSubtypeCheckEnabled) {
@@ -4762,6 +4943,12 @@ bool ClassLinker::InitializeClass(Thread* self, Handle<mirror::Class> klass,
     return false;
   }
 
+  // If `klass` was loaded in a CHA batch, compiled code that it invalidated may still be on
+  // stack. Deoptimize it before `klass` can be instantiated.
+  if (cha_ != nullptr) {
+    cha_->FlushPendingDeoptimizations(self);
+  }
+
   self->AllowThreadSuspension();
   uint64_t t0;
   {
@@ -8727,6 +8914,10 @@ void ClassLinker::DumpForSigQuit(std::ostream& os) {
   ReaderMutexLock mu(soa.Self(), *Locks::classlinker_classes_lock_);
   os << "Zygote loaded classes=" << NumZygoteClasses() << " post zygote classes="
      << NumNonZygoteClasses() << "\n";
+  mirror::DexCache::DumpStats(os);
+  if (cha_ != nullptr) {
+    cha_->DumpForSigQuit(os);
+  }
   ReaderMutexLock mu2(soa.Self(), *Locks::dex_lock_);
   os << "Dumping registered class loaders\n";
   size_t class_loader_index = 0;
@@ -9035,6 +9226,7 @@ void ClassLinker::CleanupClassLoaders() {
       ObjPtr<mirror::ClassLoader> class_loader =
           ObjPtr<mirror::ClassLoader>::DownCast(self->DecodeJObject(data.weak_root));
       if (class_loader != nullptr) {
+        data.class_table->ReclaimRetiredClassSets();
         ++it;
       } else {
         VLOG(class_linker) << "Freeing class loader";
@@ -9042,6 +9234,7 @@ void ClassLinker::CleanupClassLoaders() {
         it = class_loaders_.erase(it);
       }
     }
+    boot_class_table_->ReclaimRetiredClassSets();
   }
   for (ClassLoaderData& data : to_delete) {
     // CHA unloading analysis and SingleImplementaion cleanups are required.
@@ -196,6 +196,25 @@ class ClassLinker {
       REQUIRES(!Locks::classlinker_classes_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Load, link and verify the classes with the given descriptors in 'class_loader' using
+  // 'num_threads' threads, including the calling one. Classes are verified after all of their
+  // superclasses, level by level, and are not initialized. Only class loaders that the runtime
+  // can walk without calling into Java are supported; classes that cannot be found are skipped.
+  // Returns the number of classes that were loaded.
+  size_t PreloadClasses(Thread* self,
+                        jobject class_loader,
+                        const std::vector<std::string>& descriptors,
+                        size_t num_threads)
+      REQUIRES(!Locks::mutator_lock_);
+
+  // Preload the classes recorded in 'profile_file' for the boot class path and the dex files
+  // of 'class_loader'. See PreloadClasses.
+  size_t PreloadProfileClasses(Thread* self,
+                               jobject class_loader,
+                               const std::string& profile_file,
+                               size_t num_threads)
+      REQUIRES(!Locks::mutator_lock_);
+
   ObjPtr<mirror::Class> FindPrimitiveClass(char type) REQUIRES_SHARED(Locks::mutator_lock_);
 
   void DumpForSigQuit(std::ostream& os) REQUIRES(!Locks::classlinker_classes_lock_);
@@ -606,7 +625,8 @@ class ClassLinker {
   // entries are roots, but potentially not image classes.
   void DropFindArrayClassCache() REQUIRES_SHARED(Locks::mutator_lock_);
 
-  // Clean up class loaders, this needs to happen after JNI weak globals are cleared.
+  // Clean up class loaders, this needs to happen after JNI weak globals are cleared. Also frees
+  // the class sets that class tables kept for lock-free lookups, see ClassTable.
   void CleanupClassLoaders()
       REQUIRES(!Locks::classlinker_classes_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
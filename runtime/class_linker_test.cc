@@ -889,6 +889,30 @@ TEST_F(ClassLinkerTest, FindClassNested) {
   EXPECT_EQ(1U, inner->NumDirectMethods());
 }
 
+TEST_F(ClassLinkerTest, PreloadClasses) {
+  jobject jclass_loader = LoadDexInPathClassLoader("Interfaces", nullptr);
+  // Subclasses come before their supertypes and one class does not exist.
+  std::vector<std::string> descriptors = {
+      "LInterfaces$B;", "LInterfaces$A;", "LInterfaces$K;", "LInterfaces;", "LDoesNotExist;"
+  };
+  Thread* self = Thread::Current();
+  EXPECT_EQ(4u, class_linker_->PreloadClasses(self, jclass_loader, descriptors, 2u));
+
+  ScopedObjectAccess soa(self);
+  ObjPtr<mirror::ClassLoader> class_loader = soa.Decode<mirror::ClassLoader>(jclass_loader);
+  for (size_t i = 0; i != 4u; ++i) {
+    ObjPtr<mirror::Class> klass =
+        class_linker_->LookupClass(self, descriptors[i].c_str(), class_loader);
+    ASSERT_TRUE(klass != nullptr) << descriptors[i];
+    EXPECT_TRUE(klass->IsResolved()) << descriptors[i];
+    EXPECT_TRUE(klass->IsVerified()) << descriptors[i];
+    EXPECT_FALSE(klass->IsInitialized()) << descriptors[i];
+  }
+  EXPECT_TRUE(class_linker_->LookupClass(self, "LDoesNotExist;", class_loader) == nullptr);
+  EXPECT_FALSE(self->IsExceptionPending());
+  EXPECT_FALSE(self->IsRuntimeThread());
+}
+
 TEST_F(ClassLinkerTest, FindClass_Primitives) {
   ScopedObjectAccess soa(Thread::Current());
   const std::string expected("BCDFIJSZV");
@@ -81,6 +81,14 @@ class VarHandle;
   M(kJavaLangThrowable,                     "Ljava/lang/Throwable;",                      mirror::Throwable)                                        \
   M(kJavaLangClassNotFoundException,        "Ljava/lang/ClassNotFoundException;",         detail::NoMirrorType<detail::ClassNotFoundExceptionTag>)  \
   M(kJavaLangStackTraceElement,             "Ljava/lang/StackTraceElement;",              mirror::StackTraceElement)                                \
+  M(kJavaLangBoolean,                       "Ljava/lang/Boolean;",                        detail::NoMirrorType<detail::BooleanBoxTag>)              \
+  M(kJavaLangByte,                          "Ljava/lang/Byte;",                           detail::NoMirrorType<detail::ByteBoxTag>)                 \
+  M(kJavaLangCharacter,                     "Ljava/lang/Character;",                      detail::NoMirrorType<detail::CharacterBoxTag>)            \
+  M(kJavaLangDouble,                        "Ljava/lang/Double;",                         detail::NoMirrorType<detail::DoubleBoxTag>)               \
+  M(kJavaLangFloat,                         "Ljava/lang/Float;",                          detail::NoMirrorType<detail::FloatBoxTag>)                \
+  M(kJavaLangInteger,                       "Ljava/lang/Integer;",                        detail::NoMirrorType<detail::IntegerBoxTag>)              \
+  M(kJavaLangLong,                          "Ljava/lang/Long;",                           detail::NoMirrorType<detail::LongBoxTag>)                 \
+  M(kJavaLangShort,                         "Ljava/lang/Short;",                          detail::NoMirrorType<detail::ShortBoxTag>)                \
   M(kDalvikSystemEmulatedStackFrame,        "Ldalvik/system/EmulatedStackFrame;",         mirror::EmulatedStackFrame)                               \
   M(kPrimitiveBoolean,                      "Z",                                          detail::NoMirrorType<uint8_t>)                            \
   M(kPrimitiveByte,                         "B",                                          detail::NoMirrorType<int8_t>)                             \
@@ -145,6 +153,14 @@ inline ObjPtr<mirror::Class> GetClassRoot(ClassRoot class_root)
 namespace detail {
 
 class ClassNotFoundExceptionTag;
+class BooleanBoxTag;
+class ByteBoxTag;
+class CharacterBoxTag;
+class DoubleBoxTag;
+class FloatBoxTag;
+class IntegerBoxTag;
+class LongBoxTag;
+class ShortBoxTag;
 template <class Tag> struct NoMirrorType;
 
 template <class MirrorType>
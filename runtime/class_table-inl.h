@@ -28,8 +28,8 @@ namespace art {
 template<class Visitor>
 void ClassTable::VisitRoots(Visitor& visitor) {
   ReaderMutexLock mu(Thread::Current(), lock_);
-  for (ClassSet& class_set : classes_) {
-    for (TableSlot& table_slot : class_set) {
+  for (std::unique_ptr<ClassSet>& class_set : classes_) {
+    for (TableSlot& table_slot : *class_set) {
       table_slot.VisitRoot(visitor);
     }
   }
@@ -46,8 +46,8 @@ void ClassTable::VisitRoots(Visitor& visitor) {
 template<class Visitor>
 void ClassTable::VisitRoots(const Visitor& visitor) {
   ReaderMutexLock mu(Thread::Current(), lock_);
-  for (ClassSet& class_set : classes_) {
-    for (TableSlot& table_slot : class_set) {
+  for (std::unique_ptr<ClassSet>& class_set : classes_) {
+    for (TableSlot& table_slot : *class_set) {
       table_slot.VisitRoot(visitor);
     }
   }
@@ -64,8 +64,8 @@ void ClassTable::VisitRoots(const Visitor& visitor) {
 template <typename Visitor, ReadBarrierOption kReadBarrierOption>
 bool ClassTable::Visit(Visitor& visitor) {
   ReaderMutexLock mu(Thread::Current(), lock_);
-  for (ClassSet& class_set : classes_) {
-    for (TableSlot& table_slot : class_set) {
+  for (std::unique_ptr<ClassSet>& class_set : classes_) {
+    for (TableSlot& table_slot : *class_set) {
       if (!visitor(table_slot.Read<kReadBarrierOption>())) {
         return false;
       }
@@ -77,8 +77,8 @@ bool ClassTable::Visit(Visitor& visitor) {
 template <typename Visitor, ReadBarrierOption kReadBarrierOption>
 bool ClassTable::Visit(const Visitor& visitor) {
   ReaderMutexLock mu(Thread::Current(), lock_);
-  for (ClassSet& class_set : classes_) {
-    for (TableSlot& table_slot : class_set) {
+  for (std::unique_ptr<ClassSet>& class_set : classes_) {
+    for (TableSlot& table_slot : *class_set) {
       if (!visitor(table_slot.Read<kReadBarrierOption>())) {
         return false;
       }
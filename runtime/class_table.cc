@@ -22,23 +22,110 @@
 
 namespace art {
 
-ClassTable::ClassTable() : lock_("Class loader classes", kClassLoaderClassesLock) {
+ClassTable::ClassTable()
+    : lock_("Class loader classes", kClassLoaderClassesLock),
+      published_classes_(nullptr),
+      num_reclaimable_class_set_lists_(0u),
+      num_reclaimable_retired_classes_(0u),
+      remove_sequence_(0u) {
   Runtime* const runtime = Runtime::Current();
-  classes_.push_back(ClassSet(runtime->GetHashTableMinLoadFactor(),
-                              runtime->GetHashTableMaxLoadFactor()));
+  classes_.push_back(std::make_unique<ClassSet>(runtime->GetHashTableMinLoadFactor(),
+                                                runtime->GetHashTableMaxLoadFactor()));
+  class_set_lists_.push_back(std::make_unique<ClassSetList>(1u, classes_.back().get()));
+  published_classes_.store(class_set_lists_.back().get(), std::memory_order_relaxed);
+}
+
+void ClassTable::PublishClassSets() {
+  std::unique_ptr<ClassSetList> list = std::make_unique<ClassSetList>();
+  list->reserve(classes_.size());
+  for (const std::unique_ptr<ClassSet>& class_set : classes_) {
+    list->push_back(class_set.get());
+  }
+  published_classes_.store(list.get(), std::memory_order_release);
+  class_set_lists_.push_back(std::move(list));
+}
+
+ClassTable::ClassSet& ClassTable::PrepareInsert() {
+  ClassSet* const current = classes_.back().get();
+  if (current->size() < current->ElementsUntilExpand()) {
+    return *current;
+  }
+  // Grow the set like HashSet::Expand() does, but into a copy so that lock-free lookups can
+  // keep reading the current bucket array.
+  std::unique_ptr<ClassSet> grown =
+      std::make_unique<ClassSet>(current->GetMinLoadFactor(), current->GetMaxLoadFactor());
+  grown->reserve(static_cast<size_t>(
+      current->size() * current->GetMaxLoadFactor() / current->GetMinLoadFactor()));
+  for (const TableSlot& slot : *current) {
+    grown->insert(slot);
+  }
+  DCHECK_LT(grown->size(), grown->ElementsUntilExpand());
+  retired_classes_.push_back(std::move(classes_.back()));
+  classes_.back() = std::move(grown);
+  PublishClassSets();
+  return *classes_.back();
+}
+
+template <typename Key>
+inline mirror::Class* ClassTable::LookupInSets(const ClassSetList& sets,
+                                               const Key& key,
+                                               size_t hash) {
+  for (const ClassSet* class_set : sets) {
+    auto it = class_set->FindWithHash(key, hash);
+    if (it != class_set->end()) {
+      return it->Read();
+    }
+  }
+  return nullptr;
+}
+
+template <typename Key>
+inline mirror::Class* ClassTable::LookupLockFree(const Key& key, size_t hash) {
+  const uint32_t sequence = remove_sequence_.load(std::memory_order_acquire);
+  mirror::Class* result =
+      LookupInSets(*published_classes_.load(std::memory_order_acquire), key, hash);
+  if (result == nullptr) {
+    // Order the reads of the slots before checking for a concurrent Remove().
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (UNLIKELY((sequence & 1u) != 0u ||
+                 remove_sequence_.load(std::memory_order_relaxed) != sequence)) {
+      ReaderMutexLock mu(Thread::Current(), lock_);
+      return LookupInSets(*published_classes_.load(std::memory_order_relaxed), key, hash);
+    }
+  }
+  return result;
+}
+
+void ClassTable::ReclaimRetiredClassSets() {
+  WriterMutexLock mu(Thread::Current(), lock_);
+  DCHECK_LT(num_reclaimable_class_set_lists_, class_set_lists_.size());
+  DCHECK_LE(num_reclaimable_retired_classes_, retired_classes_.size());
+  class_set_lists_.erase(class_set_lists_.begin(),
+                         class_set_lists_.begin() + num_reclaimable_class_set_lists_);
+  retired_classes_.erase(retired_classes_.begin(),
+                         retired_classes_.begin() + num_reclaimable_retired_classes_);
+  // Lookups may have loaded the lists replaced since the last call until just now.
+  num_reclaimable_class_set_lists_ = class_set_lists_.size() - 1u;
+  num_reclaimable_retired_classes_ = retired_classes_.size();
+}
+
+size_t ClassTable::NumRetiredClassSets() const {
+  ReaderMutexLock mu(Thread::Current(), lock_);
+  return class_set_lists_.size() - 1u + retired_classes_.size();
 }
 
 void ClassTable::FreezeSnapshot() {
   WriterMutexLock mu(Thread::Current(), lock_);
-  classes_.push_back(ClassSet());
+  classes_.push_back(std::make_unique<ClassSet>());
+  PublishClassSets();
 }
 
 bool ClassTable::Contains(ObjPtr<mirror::Class> klass) {
   ReaderMutexLock mu(Thread::Current(), lock_);
   TableSlot slot(klass);
-  for (ClassSet& class_set : classes_) {
-    auto it = class_set.find(slot);
-    if (it != class_set.end()) {
+  for (const std::unique_ptr<ClassSet>& class_set : classes_) {
+    auto it = class_set->find(slot);
+    if (it != class_set->end()) {
       return it->Read() == klass;
     }
   }
@@ -46,15 +133,8 @@ bool ClassTable::Contains(ObjPtr<mirror::Class> klass) {
 }
 
 mirror::Class* ClassTable::LookupByDescriptor(ObjPtr<mirror::Class> klass) {
-  ReaderMutexLock mu(Thread::Current(), lock_);
-  TableSlot slot(klass);
-  for (ClassSet& class_set : classes_) {
-    auto it = class_set.find(slot);
-    if (it != class_set.end()) {
-      return it->Read();
-    }
-  }
-  return nullptr;
+  const uint32_t hash = TableSlot::HashDescriptor(klass);
+  return LookupLockFree(TableSlot(klass, hash), hash);
 }
 
 // To take into account http://b/35845221
@@ -67,10 +147,10 @@ mirror::Class* ClassTable::UpdateClass(const char* descriptor, mirror::Class* kl
   WriterMutexLock mu(Thread::Current(), lock_);
   // Should only be updating latest table.
   DescriptorHashPair pair(descriptor, hash);
-  auto existing_it = classes_.back().FindWithHash(pair, hash);
-  if (kIsDebugBuild && existing_it == classes_.back().end()) {
-    for (const ClassSet& class_set : classes_) {
-      if (class_set.FindWithHash(pair, hash) != class_set.end()) {
+  auto existing_it = classes_.back()->FindWithHash(pair, hash);
+  if (kIsDebugBuild && existing_it == classes_.back()->end()) {
+    for (const std::unique_ptr<ClassSet>& class_set : classes_) {
+      if (class_set->FindWithHash(pair, hash) != class_set->end()) {
         LOG(FATAL) << "Updating class found in frozen table " << descriptor;
       }
     }
@@ -83,7 +163,7 @@ mirror::Class* ClassTable::UpdateClass(const char* descriptor, mirror::Class* kl
   CHECK(!klass->IsTemp()) << descriptor;
   VerifyObject(klass);
   // Update the element in the hash set with the new class. This is safe to do since the descriptor
-  // doesn't change.
+  // doesn't change, lock-free lookups see either the old or the new class.
   *existing_it = TableSlot(klass, hash);
   return existing;
 }
@@ -105,91 +185,90 @@ size_t ClassTable::NumZygoteClasses(ObjPtr<mirror::ClassLoader> defining_loader)
   ReaderMutexLock mu(Thread::Current(), lock_);
   size_t sum = 0;
   for (size_t i = 0; i < classes_.size() - 1; ++i) {
-    sum += CountDefiningLoaderClasses(defining_loader, classes_[i]);
+    sum += CountDefiningLoaderClasses(defining_loader, *classes_[i]);
   }
   return sum;
 }
 
 size_t ClassTable::NumNonZygoteClasses(ObjPtr<mirror::ClassLoader> defining_loader) const {
   ReaderMutexLock mu(Thread::Current(), lock_);
-  return CountDefiningLoaderClasses(defining_loader, classes_.back());
+  return CountDefiningLoaderClasses(defining_loader, *classes_.back());
 }
 
 size_t ClassTable::NumReferencedZygoteClasses() const {
   ReaderMutexLock mu(Thread::Current(), lock_);
   size_t sum = 0;
   for (size_t i = 0; i < classes_.size() - 1; ++i) {
-    sum += classes_[i].size();
+    sum += classes_[i]->size();
   }
   return sum;
 }
 
 size_t ClassTable::NumReferencedNonZygoteClasses() const {
   ReaderMutexLock mu(Thread::Current(), lock_);
-  return classes_.back().size();
+  return classes_.back()->size();
 }
 
 mirror::Class* ClassTable::Lookup(const char* descriptor, size_t hash) {
   DescriptorHashPair pair(descriptor, hash);
-  ReaderMutexLock mu(Thread::Current(), lock_);
-  for (ClassSet& class_set : classes_) {
-    auto it = class_set.FindWithHash(pair, hash);
-    if (it != class_set.end()) {
-      return it->Read();
-    }
-  }
-  return nullptr;
+  return LookupLockFree(pair, hash);
 }
 
 ObjPtr<mirror::Class> ClassTable::TryInsert(ObjPtr<mirror::Class> klass) {
   TableSlot slot(klass);
   WriterMutexLock mu(Thread::Current(), lock_);
-  for (ClassSet& class_set : classes_) {
-    auto it = class_set.find(slot);
-    if (it != class_set.end()) {
+  for (const std::unique_ptr<ClassSet>& class_set : classes_) {
+    auto it = class_set->find(slot);
+    if (it != class_set->end()) {
       return it->Read();
     }
   }
-  classes_.back().insert(slot);
+  PrepareInsert().insert(slot);
   return klass;
 }
 
 void ClassTable::Insert(ObjPtr<mirror::Class> klass) {
   const uint32_t hash = TableSlot::HashDescriptor(klass);
   WriterMutexLock mu(Thread::Current(), lock_);
-  classes_.back().InsertWithHash(TableSlot(klass, hash), hash);
+  PrepareInsert().InsertWithHash(TableSlot(klass, hash), hash);
 }
 
 void ClassTable::CopyWithoutLocks(const ClassTable& source_table) {
   if (kIsDebugBuild) {
-    for (ClassSet& class_set : classes_) {
-      CHECK(class_set.empty());
+    for (const std::unique_ptr<ClassSet>& class_set : classes_) {
+      CHECK(class_set->empty());
     }
   }
-  for (const ClassSet& class_set : source_table.classes_) {
-    for (const TableSlot& slot : class_set) {
-      classes_.back().insert(slot);
+  for (const std::unique_ptr<ClassSet>& class_set : source_table.classes_) {
+    for (const TableSlot& slot : *class_set) {
+      PrepareInsert().insert(slot);
     }
   }
 }
 
 void ClassTable::InsertWithoutLocks(ObjPtr<mirror::Class> klass) {
   const uint32_t hash = TableSlot::HashDescriptor(klass);
-  classes_.back().InsertWithHash(TableSlot(klass, hash), hash);
+  PrepareInsert().InsertWithHash(TableSlot(klass, hash), hash);
 }
 
 void ClassTable::InsertWithHash(ObjPtr<mirror::Class> klass, size_t hash) {
   WriterMutexLock mu(Thread::Current(), lock_);
-  classes_.back().InsertWithHash(TableSlot(klass, hash), hash);
+  PrepareInsert().InsertWithHash(TableSlot(klass, hash), hash);
 }
 
 bool ClassTable::Remove(const char* descriptor) {
   DescriptorHashPair pair(descriptor, ComputeModifiedUtf8Hash(descriptor));
   WriterMutexLock mu(Thread::Current(), lock_);
-  for (ClassSet& class_set : classes_) {
-    auto it = class_set.find(pair);
-    if (it != class_set.end()) {
-      class_set.erase(it);
+  for (const std::unique_ptr<ClassSet>& class_set : classes_) {
+    auto it = class_set->find(pair);
+    if (it != class_set->end()) {
+      // Erasing moves later entries of the probe sequence back, make concurrent lock-free
+      // lookups that miss retry with the lock held.
+      const uint32_t sequence = remove_sequence_.load(std::memory_order_relaxed);
+      remove_sequence_.store(sequence + 1u, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      class_set->erase(it);
+      remove_sequence_.store(sequence + 2u, std::memory_order_release);
       return true;
     }
   }
@@ -266,8 +345,8 @@ size_t ClassTable::WriteToMemory(uint8_t* ptr) const {
   ClassSet combined;
   // Combine all the class sets in case there are multiple, also adjusts load factor back to
   // default in case classes were pruned.
-  for (const ClassSet& class_set : classes_) {
-    for (const TableSlot& root : class_set) {
+  for (const std::unique_ptr<ClassSet>& class_set : classes_) {
+    for (const TableSlot& root : *class_set) {
       combined.insert(root);
     }
   }
@@ -289,7 +368,8 @@ size_t ClassTable::ReadFromMemory(uint8_t* ptr) {
 
 void ClassTable::AddClassSet(ClassSet&& set) {
   WriterMutexLock mu(Thread::Current(), lock_);
-  classes_.insert(classes_.begin(), std::move(set));
+  classes_.insert(classes_.begin(), std::make_unique<ClassSet>(std::move(set)));
+  PublishClassSets();
 }
 
 void ClassTable::ClearStrongRoots() {
@@ -17,6 +17,7 @@
 #ifndef ART_RUNTIME_CLASS_TABLE_H_
 #define ART_RUNTIME_CLASS_TABLE_H_
 
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -60,7 +61,8 @@ class ClassTable {
     TableSlot(ObjPtr<mirror::Class> klass, uint32_t descriptor_hash);
 
     TableSlot& operator=(const TableSlot& copy) {
-      data_.store(copy.data_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+      // Release, so that lock-free lookups observing the new slot see the initialized class.
+      data_.store(copy.data_.load(std::memory_order_relaxed), std::memory_order_release);
       return *this;
     }
 
@@ -151,6 +153,19 @@ class ClassTable {
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Free the class sets and lists retired before the previous call. Called once per GC by
+  // ClassLinker::CleanupClassLoaders(). Each GC takes the mutator lock exclusively between two
+  // calls, so no lock-free lookup that could read them is still running.
+  void ReclaimRetiredClassSets()
+      REQUIRES(!lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Returns the number of class sets and lists kept for lock-free lookups that may still read
+  // them. For testing.
+  size_t NumRetiredClassSets() const
+      REQUIRES(!lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   // Returns the number of classes in previous snapshots defined by `defining_loader`.
   size_t NumZygoteClasses(ObjPtr<mirror::ClassLoader> defining_loader) const
       REQUIRES(!lock_)
@@ -200,11 +215,13 @@ class ClassTable {
       REQUIRES_SHARED(Locks::mutator_lock_);
 
   // Return the first class that matches the descriptor. Returns null if there are none.
+  // Does not take `lock_` unless it races with Remove().
   mirror::Class* Lookup(const char* descriptor, size_t hash)
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
   // Return the first class that matches the descriptor of klass. Returns null if there are none.
+  // Does not take `lock_` unless it races with Remove().
   mirror::Class* LookupByDescriptor(ObjPtr<mirror::Class> klass)
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
@@ -269,6 +286,29 @@ class ClassTable {
   }
 
  private:
+  // The class sets searched by lock-free lookups, in lookup order. A published list is never
+  // modified, nor are the bucket arrays of the sets it refers to reallocated. Writers holding
+  // `lock_` may still store into the slots of these sets.
+  using ClassSetList = std::vector<const ClassSet*>;
+
+  template <typename Key>
+  static mirror::Class* LookupInSets(const ClassSetList& sets, const Key& key, size_t hash)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  template <typename Key>
+  mirror::Class* LookupLockFree(const Key& key, size_t hash)
+      REQUIRES(!lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Publish the current `classes_` for lock-free lookups.
+  void PublishClassSets() REQUIRES(lock_);
+
+  // Return the latest class set, replacing it with a larger copy if inserting one more class
+  // would make it rehash in place under the feet of lock-free lookups.
+  ClassSet& PrepareInsert()
+      REQUIRES(lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   // Only copies classes.
   void CopyWithoutLocks(const ClassTable& source_table) NO_THREAD_SAFETY_ANALYSIS;
   void InsertWithoutLocks(ObjPtr<mirror::Class> klass) NO_THREAD_SAFETY_ANALYSIS;
@@ -286,7 +326,23 @@ class ClassTable {
   // Lock to guard inserting and removing.
   mutable ReaderWriterMutex lock_;
   // We have a vector to help prevent dirty pages after the zygote forks by calling FreezeSnapshot.
-  std::vector<ClassSet> classes_ GUARDED_BY(lock_);
+  std::vector<std::unique_ptr<ClassSet>> classes_ GUARDED_BY(lock_);
+  // The list of `classes_` currently used by lock-free lookups.
+  Atomic<const ClassSetList*> published_classes_;
+  // Every published list, the current one last, and every class set replaced by a larger copy,
+  // oldest first. Lock-free lookups may still be reading the replaced ones, so they are only
+  // freed by the second ReclaimRetiredClassSets() after they were replaced. Since the current
+  // class set grows geometrically, the sets replaced within two GCs take at most as much memory
+  // as the current one.
+  std::vector<std::unique_ptr<ClassSetList>> class_set_lists_ GUARDED_BY(lock_);
+  std::vector<std::unique_ptr<ClassSet>> retired_classes_ GUARDED_BY(lock_);
+  // How many of the oldest entries above were already replaced at the last
+  // ReclaimRetiredClassSets(), and can be freed by the next one.
+  size_t num_reclaimable_class_set_lists_ GUARDED_BY(lock_);
+  size_t num_reclaimable_retired_classes_ GUARDED_BY(lock_);
+  // Odd while Remove() shuffles entries of a published set, which can make a concurrent lock-free
+  // lookup miss a class. Such lookups retry with `lock_` held.
+  Atomic<uint32_t> remove_sequence_;
   // Extra strong roots that can be either dex files or dex caches. Dex files used by the class
   // loader which may not be owned by the class loader must be held strongly live. Also dex caches
   // are held live to prevent them being unloading once they have classes in them.
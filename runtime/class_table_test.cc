@@ -16,6 +16,10 @@
 
 #include "class_table-inl.h"
 
+#include <set>
+#include <string>
+#include <vector>
+
 #include "art_field-inl.h"
 #include "art_method-inl.h"
 #include "class_linker-inl.h"
@@ -27,6 +31,7 @@
 #include "mirror/class-inl.h"
 #include "obj_ptr.h"
 #include "scoped_thread_state_change-inl.h"
+#include "thread_pool.h"
 
 namespace art {
 namespace mirror {
@@ -159,5 +164,131 @@ TEST_F(ClassTableTest, ClassTable) {
   // TODO: Add tests for UpdateClass, InsertOatFile.
 }
 
+class CollectClassesVisitor : public ClassVisitor {
+ public:
+  bool operator()(ObjPtr<mirror::Class> klass) override REQUIRES_SHARED(Locks::mutator_lock_) {
+    std::string temp;
+    std::string descriptor = klass->GetDescriptor(&temp);
+    if (seen_.insert(descriptor).second) {
+      classes_.push_back(klass.Ptr());
+      descriptors_.push_back(descriptor);
+    }
+    return true;
+  }
+
+  std::set<std::string> seen_;
+  std::vector<mirror::Class*> classes_;
+  std::vector<std::string> descriptors_;
+};
+
+struct ConcurrentLookupState {
+  ClassTable table;
+  std::vector<mirror::Class*> classes;
+  std::vector<std::string> descriptors;
+  Atomic<size_t> num_inserted;
+  Atomic<bool> done;
+  Atomic<size_t> num_failures;
+};
+
+class ConcurrentLookupTask : public Task {
+ public:
+  explicit ConcurrentLookupTask(ConcurrentLookupState* state) : state_(state) {}
+
+  void Run(Thread* self) override {
+    ScopedObjectAccess soa(self);
+    size_t step = 0u;
+    while (!state_->done.load(std::memory_order_acquire)) {
+      size_t num_inserted = state_->num_inserted.load(std::memory_order_acquire);
+      if (num_inserted == 0u) {
+        continue;
+      }
+      // Walk over the inserted classes in a scattered order.
+      size_t index = (step++ * 7919u) % num_inserted;
+      const char* descriptor = state_->descriptors[index].c_str();
+      if (state_->table.Lookup(descriptor, ComputeModifiedUtf8Hash(descriptor)) !=
+              state_->classes[index]) {
+        state_->num_failures.fetch_add(1u, std::memory_order_relaxed);
+      }
+    }
+  }
+
+ private:
+  ConcurrentLookupState* const state_;
+};
+
+// Lock-free lookups racing with insertions that grow the latest class set must find every class
+// inserted before they started.
+TEST_F(ClassTableTest, ConcurrentLookupDuringInsert) {
+  static constexpr size_t kNumReaders = 4u;
+  static constexpr size_t kNumRounds = 4u;
+  Thread* self = Thread::Current();
+  ConcurrentLookupState state;
+  {
+    ScopedObjectAccess soa(self);
+    CollectClassesVisitor visitor;
+    class_linker_->VisitClasses(&visitor);
+    state.classes = std::move(visitor.classes_);
+    state.descriptors = std::move(visitor.descriptors_);
+  }
+  ASSERT_FALSE(state.classes.empty());
+
+  ThreadPool thread_pool("Class table test thread pool", kNumReaders);
+  std::vector<std::unique_ptr<ConcurrentLookupTask>> tasks;
+  for (size_t i = 0; i != kNumReaders; ++i) {
+    tasks.emplace_back(new ConcurrentLookupTask(&state));
+    thread_pool.AddTask(self, tasks.back().get());
+  }
+  thread_pool.StartWorkers(self);
+  {
+    ScopedObjectAccess soa(self);
+    // Insert the classes several times to make the set grow a few times while readers look.
+    for (size_t round = 0; round != kNumRounds; ++round) {
+      for (size_t i = 0; i != state.classes.size(); ++i) {
+        state.table.Insert(state.classes[i]);
+        if (round == 0u) {
+          state.num_inserted.store(i + 1u, std::memory_order_release);
+        }
+      }
+    }
+  }
+  state.done.store(true, std::memory_order_release);
+  thread_pool.Wait(self, /* do_work */ false, /* may_hold_locks */ false);
+  EXPECT_EQ(0u, state.num_failures.load(std::memory_order_relaxed));
+  EXPECT_EQ(state.table.NumReferencedNonZygoteClasses(), kNumRounds * state.classes.size());
+}
+
+// Class sets replaced by a larger copy are kept for lock-free lookups until the second
+// ReclaimRetiredClassSets() after the replacement.
+TEST_F(ClassTableTest, ReclaimRetiredClassSets) {
+  ScopedObjectAccess soa(Thread::Current());
+  CollectClassesVisitor visitor;
+  class_linker_->VisitClasses(&visitor);
+  ASSERT_FALSE(visitor.classes_.empty());
+  ClassTable table;
+  for (mirror::Class* klass : visitor.classes_) {
+    table.Insert(klass);
+  }
+  const size_t num_retired = table.NumRetiredClassSets();
+  EXPECT_NE(0u, num_retired);
+
+  // Lookups which started before the first call may still read the retired sets.
+  table.ReclaimRetiredClassSets();
+  EXPECT_EQ(num_retired, table.NumRetiredClassSets());
+  table.ReclaimRetiredClassSets();
+  EXPECT_EQ(0u, table.NumRetiredClassSets());
+
+  // Sets retired in between are only freed by the call after next.
+  table.FreezeSnapshot();
+  table.ReclaimRetiredClassSets();
+  EXPECT_EQ(1u, table.NumRetiredClassSets());
+  table.ReclaimRetiredClassSets();
+  EXPECT_EQ(0u, table.NumRetiredClassSets());
+
+  for (size_t i = 0; i != visitor.classes_.size(); ++i) {
+    const char* descriptor = visitor.descriptors_[i].c_str();
+    EXPECT_EQ(visitor.classes_[i], table.Lookup(descriptor, ComputeModifiedUtf8Hash(descriptor)));
+  }
+}
+
 }  // namespace mirror
 }  // namespace art
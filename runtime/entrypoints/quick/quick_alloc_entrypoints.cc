@@ -212,6 +212,12 @@ void SetQuickAllocEntryPointsInstrumented(bool instrumented) {
   entry_points_instrumented = instrumented;
 }
 
+bool CanInlineQuickAllocFastPath() {
+  return !entry_points_instrumented &&
+      (entry_points_allocator == gc::kAllocatorTypeTLAB ||
+       entry_points_allocator == gc::kAllocatorTypeRegionTLAB);
+}
+
 void ResetQuickAllocEntryPoints(QuickEntryPoints* qpoints, bool is_marking) {
 #if !defined(__APPLE__) || !defined(__LP64__)
   switch (entry_points_allocator) {
@@ -38,6 +38,10 @@ void SetQuickAllocEntryPointsAllocator(gc::AllocatorType allocator)
 void SetQuickAllocEntryPointsInstrumented(bool instrumented)
     REQUIRES(Locks::mutator_lock_, Locks::runtime_shutdown_lock_);
 
+// Returns whether compiled code may bump-allocate from the TLAB without calling the allocation
+// entrypoints, i.e. the entrypoints are not instrumented and use a TLAB allocator.
+bool CanInlineQuickAllocFastPath();
+
 }  // namespace art
 
 #endif  // ART_RUNTIME_ENTRYPOINTS_QUICK_QUICK_ALLOC_ENTRYPOINTS_H_
@@ -19,12 +19,16 @@
 
 #include "card_table.h"
 
+#include <algorithm>
+
 #include <android-base/logging.h>
 
 #include "base/atomic.h"
 #include "base/bit_utils.h"
 #include "base/mem_map.h"
 #include "space_bitmap.h"
+#include "thread-current-inl.h"
+#include "thread_pool.h"
 
 namespace art {
 namespace gc {
@@ -227,6 +231,60 @@ inline uint8_t* CardTable::CardFromAddr(const void *addr) const {
   return card_addr;
 }
 
+template <typename Visitor>
+class CardRangeTask : public Task {
+ public:
+  CardRangeTask(const Visitor& visitor, size_t chunk_index, uint8_t* begin, uint8_t* end)
+      : visitor_(visitor), chunk_index_(chunk_index), begin_(begin), end_(end) {}
+
+  // Runs on behalf of the thread that started the parallel visit and holds its locks.
+  void Run(Thread* self ATTRIBUTE_UNUSED) override NO_THREAD_SAFETY_ANALYSIS {
+    visitor_(chunk_index_, begin_, end_);
+  }
+
+  void Finalize() override {
+    delete this;
+  }
+
+ private:
+  const Visitor& visitor_;
+  const size_t chunk_index_;
+  uint8_t* const begin_;
+  uint8_t* const end_;
+};
+
+template <typename Visitor>
+inline void CardTable::VisitRangeInParallel(ThreadPool* thread_pool,
+                                            size_t thread_count,
+                                            uint8_t* begin,
+                                            uint8_t* end,
+                                            const Visitor& visitor) {
+  DCHECK_ALIGNED(begin, kCardSize);
+  DCHECK_LE(begin, end);
+  const size_t range = end - begin;
+  const size_t chunk_count = std::min(thread_count, range / kMinParallelChunkSize);
+  if (thread_pool == nullptr || chunk_count <= 1) {
+    visitor(0u, begin, end);
+    return;
+  }
+  DCHECK_LE(chunk_count, thread_pool->GetThreadCount() + 1);
+  const size_t chunk_size = RoundUp((range + chunk_count - 1) / chunk_count,
+                                    kParallelChunkAlignment);
+  Thread* const self = Thread::Current();
+  size_t chunk_index = 0;
+  for (uint8_t* chunk_begin = begin; chunk_begin < end; chunk_begin += chunk_size) {
+    uint8_t* chunk_end = (end - chunk_begin > chunk_size) ? chunk_begin + chunk_size : end;
+    thread_pool->AddTask(self,
+                         new CardRangeTask<Visitor>(visitor, chunk_index, chunk_begin, chunk_end));
+    ++chunk_index;
+  }
+  DCHECK_LE(chunk_index, chunk_count);
+  thread_pool->SetMaxActiveWorkers(chunk_index - 1);
+  thread_pool->StartWorkers(self);
+  thread_pool->Wait(self, /* do_work */ true, /* may_hold_locks */ true);
+  thread_pool->StopWorkers(self);
+}
+
 inline bool CardTable::IsValidCard(const uint8_t* card_addr) const {
   uint8_t* begin = mem_map_.Begin() + offset_;
   uint8_t* end = mem_map_.End();
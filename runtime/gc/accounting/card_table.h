@@ -25,6 +25,8 @@
 
 namespace art {
 
+class ThreadPool;
+
 namespace mirror {
 class Object;
 }  // namespace mirror
@@ -52,6 +54,12 @@ class CardTable {
   static constexpr uint8_t kCardDirty = 0x70;
   static constexpr uint8_t kCardAged = kCardDirty - 1;
 
+  // Parallel card processing never splits a range into chunks smaller than this.
+  static constexpr size_t kMinParallelChunkSize = 1 * MB;
+  // Chunk boundaries are aligned so that chunks never share a word of a bitmap with one bit per
+  // card, such as the mod-union card bitmap. This allows non-atomic bitmap updates per chunk.
+  static constexpr size_t kParallelChunkAlignment = kCardSize * kBitsPerIntPtrT;
+
   static CardTable* Create(const uint8_t* heap_begin, size_t heap_capacity);
   ~CardTable();
 
@@ -119,6 +127,19 @@ class CardTable {
       REQUIRES(Locks::heap_bitmap_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Split [begin, end) into at most `thread_count` chunks and call
+  // visitor(chunk_index, chunk_begin, chunk_end) for each of them on `thread_pool`, with the
+  // calling thread taking part. Chunk indices are smaller than `thread_count` so that callers can
+  // keep per-chunk results without locking and merge them afterwards. Falls back to visiting the
+  // whole range on the calling thread if there is no thread pool or the range is small. `begin`
+  // must be card aligned and relative to the start of any per-card bitmap the visitor updates.
+  template <typename Visitor>
+  static void VisitRangeInParallel(ThreadPool* thread_pool,
+                                   size_t thread_count,
+                                   uint8_t* begin,
+                                   uint8_t* end,
+                                   const Visitor& visitor);
+
   // Assertion used to check the given address is covered by the card table
   void CheckAddrIsInCardTable(const uint8_t* addr) const;
 
@@ -16,7 +16,10 @@
 
 #include "card_table-inl.h"
 
+#include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "base/atomic.h"
 #include "base/utils.h"
@@ -144,6 +147,57 @@ TEST_F(CardTableTest, TestModifyCardsAtomic) {
   }
 }
 
+TEST_F(CardTableTest, TestVisitRangeInParallel) {
+  CommonSetup();
+  for (uint8_t* addr = HeapBegin(); addr < HeapLimit(); addr += 3 * CardTable::kCardSize) {
+    card_table_->MarkCard(addr);
+  }
+  static constexpr size_t kThreadCount = 4;
+  ThreadPool thread_pool("Card table test thread pool", kThreadCount - 1);
+  std::vector<std::vector<uint8_t*>> chunk_cards(kThreadCount);
+  std::vector<std::pair<uint8_t*, uint8_t*>> chunk_ranges(kThreadCount);
+  CardTable::VisitRangeInParallel(
+      &thread_pool,
+      kThreadCount,
+      HeapBegin(),
+      HeapLimit(),
+      [&](size_t chunk_index, uint8_t* begin, uint8_t* end) {
+        ASSERT_LT(chunk_index, kThreadCount);
+        chunk_ranges[chunk_index] = std::make_pair(begin, end);
+        std::vector<uint8_t*>* cards = &chunk_cards[chunk_index];
+        card_table_->ModifyCardsAtomic(
+            begin,
+            end,
+            AgeCardVisitor(),
+            [cards](uint8_t* card, uint8_t expected_value, uint8_t new_value ATTRIBUTE_UNUSED) {
+              if (expected_value == CardTable::kCardDirty) {
+                cards->push_back(card);
+              }
+            });
+      });
+  // The range is split into more than one chunk, all of them aligned.
+  EXPECT_TRUE(chunk_ranges[1].first != nullptr);
+  for (const auto& range : chunk_ranges) {
+    if (range.first != nullptr) {
+      EXPECT_EQ(static_cast<size_t>(range.first - HeapBegin()) %
+                    CardTable::kParallelChunkAlignment,
+                0u);
+    }
+  }
+  std::set<uint8_t*> visited;
+  for (const std::vector<uint8_t*>& cards : chunk_cards) {
+    for (uint8_t* card : cards) {
+      EXPECT_TRUE(visited.insert(card).second);
+    }
+  }
+  for (uint8_t* addr = HeapBegin(); addr < HeapLimit(); addr += CardTable::kCardSize) {
+    uint8_t* card = card_table_->CardFromAddr(addr);
+    bool was_dirty = (addr - HeapBegin()) % (3 * CardTable::kCardSize) == 0;
+    EXPECT_EQ(was_dirty, visited.find(card) != visited.end());
+    EXPECT_EQ(was_dirty ? CardTable::kCardAged : CardTable::kCardClean, *card);
+  }
+}
+
 // TODO: Add test for CardTable::Scan.
 }  // namespace accounting
 }  // namespace gc
@@ -17,6 +17,7 @@
 #include "mod_union_table.h"
 
 #include <memory>
+#include <vector>
 
 #include "base/logging.h"  // For VLOG
 #include "base/stl_util.h"
@@ -36,23 +37,6 @@ namespace art {
 namespace gc {
 namespace accounting {
 
-class ModUnionAddToCardSetVisitor {
- public:
-  explicit ModUnionAddToCardSetVisitor(ModUnionTable::CardSet* const cleared_cards)
-      : cleared_cards_(cleared_cards) {}
-
-  inline void operator()(uint8_t* card,
-                         uint8_t expected_value,
-                         uint8_t new_value ATTRIBUTE_UNUSED) const {
-    if (expected_value == CardTable::kCardDirty) {
-      cleared_cards_->insert(card);
-    }
-  }
-
- private:
-  ModUnionTable::CardSet* const cleared_cards_;
-};
-
 class ModUnionAddToCardBitmapVisitor {
  public:
   ModUnionAddToCardBitmapVisitor(ModUnionTable::CardBitmap* bitmap, CardTable* card_table)
@@ -173,9 +157,22 @@ class ModUnionScanImageRootVisitor {
 
 void ModUnionTableReferenceCache::ProcessCards() {
   CardTable* card_table = GetHeap()->GetCardTable();
-  ModUnionAddToCardSetVisitor visitor(&cleared_cards_);
+  const size_t thread_count = heap_->GetCardProcessingThreadCount();
+  // Each chunk collects the cards it cleared separately, they are merged once all chunks are done.
+  std::vector<std::vector<uint8_t*>> chunk_cleared_cards(thread_count);
   // Clear dirty cards in the this space and update the corresponding mod-union bits.
-  card_table->ModifyCardsAtomic(space_->Begin(), space_->End(), AgeCardVisitor(), visitor);
+  CardTable::VisitRangeInParallel(
+      heap_->GetThreadPool(),
+      thread_count,
+      space_->Begin(),
+      space_->End(),
+      [card_table, &chunk_cleared_cards](size_t chunk_index, uint8_t* begin, uint8_t* end) {
+        ModUnionAddToCardVectorVisitor visitor(&chunk_cleared_cards[chunk_index]);
+        card_table->ModifyCardsAtomic(begin, end, AgeCardVisitor(), visitor);
+      });
+  for (const std::vector<uint8_t*>& cards : chunk_cleared_cards) {
+    cleared_cards_.insert(cards.begin(), cards.end());
+  }
 }
 
 void ModUnionTableReferenceCache::ClearTable() {
@@ -386,24 +383,34 @@ void ModUnionTableReferenceCache::Dump(std::ostream& os) {
 }
 
 void ModUnionTableReferenceCache::VisitObjects(ObjectCallback callback, void* arg) {
+  VisitObjectsInRange(callback, arg, space_->Begin(), space_->End());
+}
+
+void ModUnionTableReferenceCache::VisitObjectsInRange(ObjectCallback callback,
+                                                      void* arg,
+                                                      uint8_t* begin,
+                                                      uint8_t* end) {
   CardTable* const card_table = heap_->GetCardTable();
   ContinuousSpaceBitmap* live_bitmap = space_->GetLiveBitmap();
-  for (uint8_t* card : cleared_cards_) {
-    uintptr_t start = reinterpret_cast<uintptr_t>(card_table->AddrFromCard(card));
-    uintptr_t end = start + CardTable::kCardSize;
+  uint8_t* const card_begin = card_table->CardFromAddr(begin);
+  uint8_t* const card_end = card_table->CardFromAddr(AlignUp(end, CardTable::kCardSize));
+  for (auto it = cleared_cards_.lower_bound(card_begin);
+       it != cleared_cards_.end() && *it < card_end;
+       ++it) {
+    uintptr_t start = reinterpret_cast<uintptr_t>(card_table->AddrFromCard(*it));
     live_bitmap->VisitMarkedRange(start,
-                                  end,
+                                  start + CardTable::kCardSize,
                                   [callback, arg](mirror::Object* obj) {
       callback(obj, arg);
     });
   }
   // This may visit the same card twice, TODO avoid this.
-  for (const auto& pair : references_) {
-    const uint8_t* card = pair.first;
-    uintptr_t start = reinterpret_cast<uintptr_t>(card_table->AddrFromCard(card));
-    uintptr_t end = start + CardTable::kCardSize;
+  for (auto it = references_.lower_bound(card_begin);
+       it != references_.end() && it->first < card_end;
+       ++it) {
+    uintptr_t start = reinterpret_cast<uintptr_t>(card_table->AddrFromCard(it->first));
     live_bitmap->VisitMarkedRange(start,
-                                  end,
+                                  start + CardTable::kCardSize,
                                   [callback, arg](mirror::Object* obj) {
       callback(obj, arg);
     });
@@ -531,8 +538,16 @@ class CardBitVisitor {
 void ModUnionTableCardCache::ProcessCards() {
   CardTable* const card_table = GetHeap()->GetCardTable();
   ModUnionAddToCardBitmapVisitor visitor(card_bitmap_.get(), card_table);
-  // Clear dirty cards in the this space and update the corresponding mod-union bits.
-  card_table->ModifyCardsAtomic(space_->Begin(), space_->End(), AgeCardVisitor(), visitor);
+  // Clear dirty cards in the this space and update the corresponding mod-union bits. The bitmap
+  // starts at the space begin, so chunks never share a bitmap word and can set bits non-atomically.
+  CardTable::VisitRangeInParallel(
+      heap_->GetThreadPool(),
+      heap_->GetCardProcessingThreadCount(),
+      space_->Begin(),
+      space_->End(),
+      [card_table, &visitor](size_t chunk_index ATTRIBUTE_UNUSED, uint8_t* begin, uint8_t* end) {
+        card_table->ModifyCardsAtomic(begin, end, AgeCardVisitor(), visitor);
+      });
 }
 
 void ModUnionTableCardCache::ClearTable() {
@@ -553,9 +568,18 @@ void ModUnionTableCardCache::UpdateAndMarkReferences(MarkObjectVisitor* visitor)
 }
 
 void ModUnionTableCardCache::VisitObjects(ObjectCallback callback, void* arg) {
+  VisitObjectsInRange(callback, arg, space_->Begin(), space_->End());
+}
+
+void ModUnionTableCardCache::VisitObjectsInRange(ObjectCallback callback,
+                                                 void* arg,
+                                                 uint8_t* begin,
+                                                 uint8_t* end) {
+  DCHECK_ALIGNED(begin, CardTable::kCardSize);
   card_bitmap_->VisitSetBits(
-      0,
-      RoundUp(space_->Size(), CardTable::kCardSize) / CardTable::kCardSize,
+      static_cast<size_t>(begin - space_->Begin()) / CardTable::kCardSize,
+      RoundUp(static_cast<size_t>(end - space_->Begin()), CardTable::kCardSize) /
+          CardTable::kCardSize,
       [this, callback, arg](size_t bit_index) {
         const uintptr_t start = card_bitmap_->AddrFromBitIndex(bit_index);
         DCHECK(space_->HasAddress(reinterpret_cast<mirror::Object*>(start)))
@@ -82,6 +82,14 @@ class ModUnionTable {
   // Visit all of the objects that may contain references to other spaces.
   virtual void VisitObjects(ObjectCallback callback, void* arg) = 0;
 
+  // Visit the objects that may contain references to other spaces and that start within the card
+  // aligned range [begin, end). Visits of disjoint ranges may run in parallel if the callback
+  // allows it.
+  virtual void VisitObjectsInRange(ObjectCallback callback,
+                                   void* arg,
+                                   uint8_t* begin,
+                                   uint8_t* end) = 0;
+
   // Verification, sanity checks that we don't have clean cards which conflict with out cached data
   // for said cards. Exclusive lock is required since verify sometimes uses
   // SpaceBitmap::VisitMarkedRange and VisitMarkedRange can't know if the callback will modify the
@@ -136,6 +144,11 @@ class ModUnionTableReferenceCache : public ModUnionTable {
       REQUIRES(Locks::heap_bitmap_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  void VisitObjectsInRange(ObjectCallback callback, void* arg, uint8_t* begin, uint8_t* end)
+      override
+      REQUIRES(Locks::heap_bitmap_lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   // Exclusive lock is required since verify uses SpaceBitmap::VisitMarkedRange and
   // VisitMarkedRange can't know if the callback will modify the bitmap or not.
   void Verify() override
@@ -183,6 +196,11 @@ class ModUnionTableCardCache : public ModUnionTable {
       REQUIRES(Locks::heap_bitmap_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  void VisitObjectsInRange(ObjectCallback callback, void* arg, uint8_t* begin, uint8_t* end)
+      override
+      REQUIRES(Locks::heap_bitmap_lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   // Nothing to verify.
   void Verify() override {}
 
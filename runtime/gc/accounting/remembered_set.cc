@@ -17,6 +17,7 @@
 #include "remembered_set.h"
 
 #include <memory>
+#include <vector>
 
 #include "base/stl_util.h"
 #include "card_table-inl.h"
@@ -39,24 +40,37 @@ namespace accounting {
 
 class RememberedSetCardVisitor {
  public:
-  explicit RememberedSetCardVisitor(RememberedSet::CardSet* const dirty_cards)
+  explicit RememberedSetCardVisitor(std::vector<uint8_t*>* const dirty_cards)
       : dirty_cards_(dirty_cards) {}
 
   void operator()(uint8_t* card, uint8_t expected_value, uint8_t new_value ATTRIBUTE_UNUSED) const {
     if (expected_value == CardTable::kCardDirty) {
-      dirty_cards_->insert(card);
+      dirty_cards_->push_back(card);
     }
   }
 
  private:
-  RememberedSet::CardSet* const dirty_cards_;
+  std::vector<uint8_t*>* const dirty_cards_;
 };
 
 void RememberedSet::ClearCards() {
   CardTable* card_table = GetHeap()->GetCardTable();
-  RememberedSetCardVisitor card_visitor(&dirty_cards_);
+  const size_t thread_count = heap_->GetCardProcessingThreadCount();
+  // Each chunk collects the cards it cleared separately, they are merged once all chunks are done.
+  std::vector<std::vector<uint8_t*>> chunk_dirty_cards(thread_count);
   // Clear dirty cards in the space and insert them into the dirty card set.
-  card_table->ModifyCardsAtomic(space_->Begin(), space_->End(), AgeCardVisitor(), card_visitor);
+  CardTable::VisitRangeInParallel(
+      heap_->GetThreadPool(),
+      thread_count,
+      space_->Begin(),
+      space_->End(),
+      [card_table, &chunk_dirty_cards](size_t chunk_index, uint8_t* begin, uint8_t* end) {
+        RememberedSetCardVisitor card_visitor(&chunk_dirty_cards[chunk_index]);
+        card_table->ModifyCardsAtomic(begin, end, AgeCardVisitor(), card_visitor);
+      });
+  for (const std::vector<uint8_t*>& cards : chunk_dirty_cards) {
+    dirty_cards_.insert(cards.begin(), cards.end());
+  }
 }
 
 class RememberedSetReferenceVisitor {
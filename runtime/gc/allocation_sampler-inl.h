@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_GC_ALLOCATION_SAMPLER_INL_H_
+#define ART_RUNTIME_GC_ALLOCATION_SAMPLER_INL_H_
+
+#include "allocation_sampler.h"
+
+#include "thread.h"
+
+namespace art {
+namespace gc {
+
+inline void AllocationSampler::ReportTlabRefill(Thread* self, size_t bytes) {
+  DCHECK(IsEnabled());
+  size_t bytes_left = self->GetAllocSampleBytesLeft();
+  if (UNLIKELY(bytes_left == 0u)) {
+    // First refill since sampling started.
+    self->SetAllocSampleBytesLeft(NextSampleInterval(self));
+    return;
+  }
+  if (LIKELY(bytes_left > bytes)) {
+    self->SetAllocSampleBytesLeft(bytes_left - bytes);
+    return;
+  }
+  // The countdown ran out in this TLAB. Sample the allocation that triggered the refill and charge
+  // the overshoot to the next interval so that large TLABs are not undercounted.
+  self->SetAllocSamplePending(true);
+  size_t overshoot = bytes - bytes_left;
+  size_t next_interval = NextSampleInterval(self);
+  self->SetAllocSampleBytesLeft(next_interval > overshoot ? next_interval - overshoot : 1u);
+}
+
+}  // namespace gc
+}  // namespace art
+
+#endif  // ART_RUNTIME_GC_ALLOCATION_SAMPLER_INL_H_
@@ -0,0 +1,289 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "allocation_sampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+#include "art_method-inl.h"
+#include "base/enums.h"
+#include "base/logging.h"  // For VLOG
+#include "base/os.h"
+#include "base/time_utils.h"
+#include "base/unix_file/fd_file.h"
+#include "base/utils.h"
+#include "handle_scope-inl.h"
+#include "mirror/class-inl.h"
+#include "mirror/object-inl.h"
+#include "obj_ptr-inl.h"
+#include "runtime.h"
+#include "stack.h"
+#include "thread-current-inl.h"
+#include "thread_list.h"
+
+namespace art {
+namespace gc {
+
+class AllocationSampleStackVisitor : public StackVisitor {
+ public:
+  AllocationSampleStackVisitor(Thread* thread, AllocationSample* sample)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      : StackVisitor(thread, nullptr, StackVisitor::StackWalkKind::kIncludeInlinedFrames),
+        sample_(sample) {
+    sample_->depth = 0u;
+  }
+
+  bool VisitFrame() override REQUIRES_SHARED(Locks::mutator_lock_) {
+    if (sample_->depth == AllocationSample::kMaxDepth) {
+      return false;
+    }
+    ArtMethod* m = GetMethod();
+    // m may be null if we have inlined methods of unresolved classes. b/27858645
+    if (m != nullptr && !m->IsRuntimeMethod()) {
+      m = m->GetInterfaceMethodIfProxy(kRuntimePointerSize);
+      sample_->frames[sample_->depth++] = AllocRecordStackTraceElement(m, GetDexPc());
+    }
+    return true;
+  }
+
+ private:
+  AllocationSample* const sample_;
+};
+
+void AllocationSampleBuffer::VisitRoots(RootVisitor* visitor) {
+  BufferedRootVisitor<kDefaultBufferedRootCount> buffered_visitor(visitor, RootInfo(kRootDebugger));
+  size_t head = head_.load(std::memory_order_acquire);
+  for (size_t i = tail_.load(std::memory_order_acquire); i != head; ++i) {
+    AllocationSample& sample = samples_[i & (kCapacity - 1)];
+    buffered_visitor.VisitRootIfNonNull(sample.klass);
+    // Keep the methods of the pending stack traces from getting unloaded.
+    for (size_t j = 0; j < sample.depth; ++j) {
+      sample.frames[j].GetMethod()->VisitRoots(buffered_visitor, kRuntimePointerSize);
+    }
+  }
+}
+
+AllocationSampler::AllocationSampler()
+    : enabled_(false),
+      sample_interval_(kDefaultSampleInterval),
+      lock_("allocation sampler lock"),
+      total_samples_(0u) {}
+
+AllocationSampler::~AllocationSampler() {}
+
+void AllocationSampler::Start(size_t sample_interval, const std::string& profile_path) {
+  DCHECK_NE(sample_interval, 0u);
+  MutexLock mu(Thread::Current(), lock_);
+  sample_interval_ = sample_interval;
+  profile_path_ = profile_path;
+  enabled_.store(true, std::memory_order_relaxed);
+  VLOG(heap) << "Sampling allocations every " << PrettySize(sample_interval) << " on average";
+}
+
+void AllocationSampler::Stop() {
+  // Threads that already have a pending sample drop it in RecordSample().
+  enabled_.store(false, std::memory_order_relaxed);
+}
+
+size_t AllocationSampler::NextSampleInterval(Thread* self) const {
+  uint32_t state = self->GetAllocSampleRngState();
+  if (UNLIKELY(state == 0u)) {
+    state = (static_cast<uint32_t>(NanoTime()) ^ (static_cast<uint32_t>(self->GetTid()) *
+                                                  0x9e3779b9u)) | 1u;
+  }
+  // Xorshift, good enough to keep samples from aliasing with periodic allocation patterns.
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  self->SetAllocSampleRngState(state);
+  // Exponentially distributed intervals make every allocated byte equally likely to be sampled.
+  double uniform = (static_cast<double>(state) + 0.5) / 4294967296.0;
+  double interval = -std::log(uniform) * static_cast<double>(sample_interval_);
+  return std::max(static_cast<size_t>(interval), static_cast<size_t>(1u));
+}
+
+void AllocationSampler::RecordSample(Thread* self,
+                                     ObjPtr<mirror::Object>* obj,
+                                     size_t byte_count) {
+  self->SetAllocSamplePending(false);
+  if (!IsEnabled()) {
+    return;
+  }
+  AllocationSampleBuffer* buffer = self->GetAllocSampleBuffer();
+  if (UNLIKELY(buffer == nullptr)) {
+    buffer = new AllocationSampleBuffer();
+    self->SetAllocSampleBuffer(buffer);
+  }
+  AllocationSample* sample = buffer->BeginPush();
+  if (UNLIKELY(sample == nullptr)) {
+    // Nobody drained our samples for a while. Aggregate them ourselves, this is the only place the
+    // producer takes the sampler lock.
+    DrainThread(self);
+    sample = buffer->BeginPush();
+    DCHECK(sample != nullptr);
+  }
+  sample->klass = GcRoot<mirror::Class>((*obj)->GetClass());
+  sample->byte_count = byte_count;
+  AllocationSampleStackVisitor visitor(self, sample);
+  {
+    StackHandleScope<1> hs(self);
+    auto obj_wrapper = hs.NewHandleWrapper(obj);
+    visitor.WalkStack();
+  }
+  buffer->EndPush();
+}
+
+static std::string SymbolizeFrame(const AllocRecordStackTraceElement& frame)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  ArtMethod* method = frame.GetMethod();
+  std::string result = method->PrettyMethod(/* with_signature */ false);
+  const char* source_file = method->GetDeclaringClassSourceFile();
+  if (source_file != nullptr) {
+    result += " (";
+    result += source_file;
+    result += ":";
+    result += std::to_string(frame.ComputeLineNumber());
+    result += ")";
+  }
+  return result;
+}
+
+void AllocationSampler::DrainBufferLocked(AllocationSampleBuffer* buffer) {
+  for (const AllocationSample* sample = buffer->Peek();
+       sample != nullptr;
+       sample = buffer->Peek()) {
+    std::vector<std::string> key;
+    key.reserve(sample->depth + 1u);
+    // The allocated class is the leaf of the profile so that pprof attributes bytes per type.
+    key.push_back(sample->klass.IsNull() ? "null" : sample->klass.Read()->PrettyDescriptor());
+    for (size_t i = 0; i < sample->depth; ++i) {
+      key.push_back(SymbolizeFrame(sample->frames[i]));
+    }
+    auto it = samples_.find(key);
+    if (it == samples_.end() && samples_.size() < kMaxStacks) {
+      it = samples_.emplace(std::move(key), AggregatedSample()).first;
+    }
+    AggregatedSample& aggregated = (it != samples_.end()) ? it->second : other_stacks_;
+    ++aggregated.count;
+    aggregated.bytes += sample->byte_count;
+    ++total_samples_;
+    buffer->Pop();
+  }
+}
+
+void AllocationSampler::DrainThread(Thread* thread) {
+  MutexLock mu(Thread::Current(), lock_);
+  AllocationSampleBuffer* buffer = thread->GetAllocSampleBuffer();
+  if (buffer != nullptr) {
+    DrainBufferLocked(buffer);
+  }
+}
+
+void AllocationSampler::DrainAllThreads(Thread* self) {
+  // Holding the thread list lock keeps threads from exiting and deleting their buffers.
+  MutexLock mu(self, *Locks::thread_list_lock_);
+  MutexLock mu2(self, lock_);
+  for (Thread* thread : Runtime::Current()->GetThreadList()->GetList()) {
+    AllocationSampleBuffer* buffer = thread->GetAllocSampleBuffer();
+    if (buffer != nullptr) {
+      DrainBufferLocked(buffer);
+    }
+  }
+}
+
+void AllocationSampler::DumpProfile(std::ostream& os) {
+  Thread* self = Thread::Current();
+  DrainAllThreads(self);
+  MutexLock mu(self, lock_);
+  // Legacy Java heapz text format understood by pprof: a header with attributes, one line per
+  // unique stack with "<count> <bytes> @ <location ids>" and a table mapping ids to frames.
+  uint64_t total_bytes = other_stacks_.bytes;
+  for (const auto& entry : samples_) {
+    total_bytes += entry.second.bytes;
+  }
+  os << "--- heapz 1 ---\n"
+     << "format = java\n"
+     << "resolution = bytes\n"
+     << "sampling period = " << sample_interval_ << "\n"
+     << "total = " << total_bytes << "\n"
+     << "---\n";
+  std::map<std::string, size_t> location_ids;
+  auto dump_sample = [&](const std::vector<std::string>& stack, const AggregatedSample& sample) {
+    os << sample.count << " " << sample.bytes << " @";
+    for (const std::string& frame : stack) {
+      auto it = location_ids.emplace(frame, location_ids.size() + 1u).first;
+      os << " 0x" << std::hex << it->second << std::dec;
+    }
+    os << "\n";
+  };
+  for (const auto& entry : samples_) {
+    dump_sample(entry.first, entry.second);
+  }
+  if (other_stacks_.count != 0u) {
+    dump_sample({"(other stacks)"}, other_stacks_);
+  }
+  os << "---\n";
+  std::vector<const std::string*> frames(location_ids.size());
+  for (const auto& location : location_ids) {
+    frames[location.second - 1u] = &location.first;
+  }
+  for (size_t i = 0; i < frames.size(); ++i) {
+    os << "0x" << std::hex << (i + 1u) << std::dec << " " << *frames[i] << "\n";
+  }
+}
+
+void AllocationSampler::WriteProfile() {
+  std::string profile_path;
+  {
+    MutexLock mu(Thread::Current(), lock_);
+    profile_path = profile_path_;
+  }
+  if (profile_path.empty()) {
+    return;
+  }
+  std::ostringstream oss;
+  DumpProfile(oss);
+  std::string profile = oss.str();
+  std::unique_ptr<File> file(OS::CreateEmptyFileWriteOnly(profile_path.c_str()));
+  if (file == nullptr) {
+    PLOG(ERROR) << "Unable to open allocation profile '" << profile_path << "'";
+    return;
+  }
+  if (!file->WriteFully(profile.data(), profile.size())) {
+    PLOG(ERROR) << "Failed to write allocation profile '" << profile_path << "'";
+    file->Erase();
+    return;
+  }
+  if (file->FlushCloseOrErase() != 0) {
+    PLOG(ERROR) << "Failed to flush allocation profile '" << profile_path << "'";
+  }
+}
+
+void AllocationSampler::DumpForSigQuit(std::ostream& os) {
+  if (!IsEnabled()) {
+    return;
+  }
+  MutexLock mu(Thread::Current(), lock_);
+  os << "Allocation sampler: interval=" << PrettySize(sample_interval_)
+     << " drained samples=" << total_samples_
+     << " unique stacks=" << samples_.size()
+     << " other stack samples=" << other_stacks_.count << "\n";
+}
+
+}  // namespace gc
+}  // namespace art
@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_GC_ALLOCATION_SAMPLER_H_
+#define ART_RUNTIME_GC_ALLOCATION_SAMPLER_H_
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "base/atomic.h"
+#include "base/bit_utils.h"
+#include "base/globals.h"
+#include "base/macros.h"
+#include "base/mutex.h"
+#include "gc/allocation_record.h"
+#include "gc_root.h"
+#include "obj_ptr.h"
+
+namespace art {
+
+class RootVisitor;
+class Thread;
+
+namespace mirror {
+class Class;
+class Object;
+}  // namespace mirror
+
+namespace gc {
+
+// A single sampled allocation: the allocated class, its size and the allocating stack.
+struct AllocationSample {
+  static constexpr size_t kMaxDepth = 32;
+
+  GcRoot<mirror::Class> klass;
+  size_t byte_count = 0u;
+  size_t depth = 0u;
+  AllocRecordStackTraceElement frames[kMaxDepth];
+};
+
+// Single-producer single-consumer ring of samples owned by one thread. The owning thread is the
+// only producer and never takes a lock to publish a sample. Consumers are serialized by the
+// AllocationSampler lock.
+class AllocationSampleBuffer {
+ public:
+  static constexpr size_t kCapacity = 64;
+  static_assert(IsPowerOfTwo(kCapacity), "Ring buffer capacity must be a power of two");
+
+  AllocationSampleBuffer() : head_(0u), tail_(0u) {}
+
+  // Producer side. Returns the slot to fill, or null if the ring is full.
+  AllocationSample* BeginPush() {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) == kCapacity) {
+      return nullptr;
+    }
+    return &samples_[head & (kCapacity - 1)];
+  }
+
+  // Producer side. Publishes the slot returned by the last BeginPush().
+  void EndPush() {
+    head_.store(head_.load(std::memory_order_relaxed) + 1u, std::memory_order_release);
+  }
+
+  // Consumer side. Returns the oldest published sample or null if the ring is empty.
+  const AllocationSample* Peek() const {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_.load(std::memory_order_acquire)) {
+      return nullptr;
+    }
+    return &samples_[tail & (kCapacity - 1)];
+  }
+
+  // Consumer side. Releases the slot returned by the last Peek() back to the producer.
+  void Pop() {
+    tail_.store(tail_.load(std::memory_order_relaxed) + 1u, std::memory_order_release);
+  }
+
+  // Visit the classes of pending samples and the declaring classes of their frames so that
+  // nothing a pending sample refers to gets moved or unloaded before it is drained. Called with
+  // the owning thread suspended or by the owning thread itself.
+  void VisitRoots(RootVisitor* visitor) REQUIRES_SHARED(Locks::mutator_lock_);
+
+ private:
+  // Index of the next slot to publish, only written by the owning thread.
+  Atomic<size_t> head_;
+  // Index of the oldest unconsumed slot, only written by consumers.
+  Atomic<size_t> tail_;
+  AllocationSample samples_[kCapacity];
+
+  DISALLOW_COPY_AND_ASSIGN(AllocationSampleBuffer);
+};
+
+// Low overhead sampling allocation profiler. Instead of recording every allocation like
+// AllocRecordObjectMap, each thread counts down the bytes it obtains through TLAB refills and
+// records one stack trace roughly every sample_interval_ bytes. Samples are queued in lock-free
+// per-thread ring buffers and aggregated lazily into a pprof-compatible (legacy Java heapz)
+// profile of at most kMaxStacks unique stacks.
+class AllocationSampler {
+ public:
+  // Matches the default heapz sampling period.
+  static constexpr size_t kDefaultSampleInterval = 512 * KB;
+  // Samples with new stacks once the profile has this many are only counted as other stacks.
+  static constexpr size_t kMaxStacks = 4 * KB;
+
+  AllocationSampler();
+  ~AllocationSampler();
+
+  bool IsEnabled() const {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  size_t GetSampleInterval() const {
+    return sample_interval_;
+  }
+
+  // Start sampling roughly every `sample_interval` bytes. If `profile_path` is not empty the
+  // aggregated profile is written there by WriteProfile(), on SIGUSR1.
+  void Start(size_t sample_interval, const std::string& profile_path) REQUIRES(!lock_);
+  void Stop() REQUIRES(!lock_);
+
+  // Called from the TLAB refill slow path with the number of bytes the thread just obtained.
+  // Marks the thread's next allocation for sampling when its countdown runs out.
+  ALWAYS_INLINE void ReportTlabRefill(Thread* self, size_t bytes);
+
+  // Record the allocation of `obj` if the thread has a pending sample.
+  void RecordSample(Thread* self, ObjPtr<mirror::Object>* obj, size_t byte_count)
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!lock_);
+
+  // Move the pending samples of `thread` into the aggregated profile. `thread` must be the current
+  // thread or must be prevented from exiting by the caller.
+  void DrainThread(Thread* thread) REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!lock_);
+
+  // Drain the samples of every thread and dump the aggregated profile in pprof's Java heapz text
+  // format.
+  void DumpProfile(std::ostream& os)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!lock_, !Locks::thread_list_lock_);
+
+  // Write the aggregated profile to the configured profile path, if any.
+  void WriteProfile()
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!lock_, !Locks::thread_list_lock_);
+
+  void DumpForSigQuit(std::ostream& os) REQUIRES(!lock_);
+
+ private:
+  struct AggregatedSample {
+    uint64_t count = 0u;
+    uint64_t bytes = 0u;
+  };
+
+  // Draws from the thread's own random state, the refill path never takes the lock.
+  size_t NextSampleInterval(Thread* self) const;
+  void DrainBufferLocked(AllocationSampleBuffer* buffer)
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(lock_);
+  void DrainAllThreads(Thread* self)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!lock_, !Locks::thread_list_lock_);
+
+  Atomic<bool> enabled_;
+  size_t sample_interval_;
+  Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  std::string profile_path_ GUARDED_BY(lock_);
+  // Aggregated samples keyed by their symbolized stack, leaf (allocated class) first.
+  std::map<std::vector<std::string>, AggregatedSample> samples_ GUARDED_BY(lock_);
+  // Samples whose stack did not fit in samples_.
+  AggregatedSample other_stacks_ GUARDED_BY(lock_);
+  uint64_t total_samples_ GUARDED_BY(lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(AllocationSampler);
+};
+
+}  // namespace gc
+}  // namespace art
+
+#endif  // ART_RUNTIME_GC_ALLOCATION_SAMPLER_H_
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "allocation_sampler-inl.h"
+
+#include <sstream>
+
+#include "common_runtime_test.h"
+#include "gc/heap.h"
+#include "mirror/array-inl.h"
+#include "scoped_thread_state_change-inl.h"
+#include "thread-current-inl.h"
+
+namespace art {
+namespace gc {
+
+class AllocationSamplerTest : public CommonRuntimeTest {};
+
+TEST_F(AllocationSamplerTest, RingBuffer) {
+  std::unique_ptr<AllocationSampleBuffer> buffer(new AllocationSampleBuffer());
+  EXPECT_TRUE(buffer->Peek() == nullptr);
+  for (size_t i = 0; i < AllocationSampleBuffer::kCapacity; ++i) {
+    AllocationSample* sample = buffer->BeginPush();
+    ASSERT_TRUE(sample != nullptr);
+    sample->byte_count = i;
+    buffer->EndPush();
+  }
+  // The ring is full until the consumer releases a slot.
+  EXPECT_TRUE(buffer->BeginPush() == nullptr);
+  const AllocationSample* oldest = buffer->Peek();
+  ASSERT_TRUE(oldest != nullptr);
+  EXPECT_EQ(oldest->byte_count, 0u);
+  buffer->Pop();
+  EXPECT_TRUE(buffer->BeginPush() != nullptr);
+  for (size_t i = 1; i < AllocationSampleBuffer::kCapacity; ++i) {
+    const AllocationSample* sample = buffer->Peek();
+    ASSERT_TRUE(sample != nullptr);
+    EXPECT_EQ(sample->byte_count, i);
+    buffer->Pop();
+  }
+  EXPECT_TRUE(buffer->Peek() == nullptr);
+}
+
+TEST_F(AllocationSamplerTest, TlabRefillCountdown) {
+  Thread* self = Thread::Current();
+  AllocationSampler sampler;
+  sampler.Start(/* sample_interval */ 64 * KB, /* profile_path */ "");
+  self->SetAllocSamplePending(false);
+  self->SetAllocSampleBytesLeft(0u);
+  // The first refill only arms the countdown.
+  sampler.ReportTlabRefill(self, 4 * KB);
+  EXPECT_FALSE(self->IsAllocSamplePending());
+  EXPECT_NE(self->GetAllocSampleBytesLeft(), 0u);
+  self->SetAllocSampleBytesLeft(16 * KB);
+  sampler.ReportTlabRefill(self, 8 * KB);
+  EXPECT_FALSE(self->IsAllocSamplePending());
+  EXPECT_EQ(self->GetAllocSampleBytesLeft(), 8 * KB);
+  sampler.ReportTlabRefill(self, 8 * KB);
+  EXPECT_TRUE(self->IsAllocSamplePending());
+  EXPECT_NE(self->GetAllocSampleBytesLeft(), 0u);
+  self->SetAllocSamplePending(false);
+  sampler.Stop();
+}
+
+TEST_F(AllocationSamplerTest, SampleIntervals) {
+  static constexpr size_t kSampleInterval = 64 * KB;
+  static constexpr size_t kNumIntervals = 10000u;
+  Thread* self = Thread::Current();
+  AllocationSampler sampler;
+  sampler.Start(kSampleInterval, /* profile_path */ "");
+  uint64_t total = 0u;
+  for (size_t i = 0; i < kNumIntervals; ++i) {
+    self->SetAllocSampleBytesLeft(0u);
+    sampler.ReportTlabRefill(self, 1u);
+    ASSERT_NE(self->GetAllocSampleBytesLeft(), 0u);
+    total += self->GetAllocSampleBytesLeft();
+  }
+  sampler.Stop();
+  // The intervals are exponentially distributed around the sample interval.
+  EXPECT_GT(total / kNumIntervals, kSampleInterval * 9 / 10);
+  EXPECT_LT(total / kNumIntervals, kSampleInterval * 11 / 10);
+}
+
+TEST_F(AllocationSamplerTest, SampleArrays) {
+  Heap* heap = Runtime::Current()->GetHeap();
+  if (!IsTLABAllocator(heap->GetCurrentAllocator())) {
+    // Samples are only taken on TLAB refills.
+    return;
+  }
+  ScopedObjectAccess soa(Thread::Current());
+  AllocationSampler* sampler = heap->GetAllocationSampler();
+  sampler->Start(/* sample_interval */ 4 * KB, /* profile_path */ "");
+  for (size_t i = 0; i < 4 * KB; ++i) {
+    ASSERT_TRUE(mirror::ByteArray::Alloc(soa.Self(), 1 * KB) != nullptr);
+  }
+  std::ostringstream oss;
+  sampler->DumpProfile(oss);
+  sampler->Stop();
+  std::string profile = oss.str();
+  EXPECT_EQ(profile.find("--- heapz 1 ---\n"), 0u) << profile;
+  EXPECT_NE(profile.find("sampling period = 4096\n"), std::string::npos) << profile;
+  EXPECT_NE(profile.find(" byte[]\n"), std::string::npos) << profile;
+}
+
+}  // namespace gc
+}  // namespace art
@@ -26,6 +26,7 @@
 #include "class_root.h"
 #include "debugger.h"
 #include "gc/accounting/atomic_stack.h"
+#include "gc/accounting/card_table-inl.h"
 #include "gc/accounting/heap_bitmap-inl.h"
 #include "gc/accounting/mod_union_table-inl.h"
 #include "gc/accounting/read_barrier_table.h"
@@ -738,6 +739,29 @@ class ConcurrentCopying::GrayImmuneObjectVisitor {
   Thread* const self_;
 };
 
+template <typename Visitor>
+void ConcurrentCopying::ScanImmuneSpaceCardsInParallel(space::ContinuousSpace* space,
+                                                       const Visitor& visitor,
+                                                       uint8_t minimum_age) {
+  accounting::CardTable* const card_table = heap_->GetCardTable();
+  // Card ranges are disjoint, so every object is visited by exactly one chunk.
+  accounting::CardTable::VisitRangeInParallel(
+      heap_->GetThreadPool(),
+      heap_->GetCardProcessingThreadCount(),
+      space->Begin(),
+      space->End(),
+      [card_table, space, &visitor, minimum_age](size_t chunk_index ATTRIBUTE_UNUSED,
+                                                 uint8_t* begin,
+                                                 uint8_t* end)
+          REQUIRES(Locks::heap_bitmap_lock_) REQUIRES_SHARED(Locks::mutator_lock_) {
+        card_table->Scan</* kClearCard */ false>(space->GetMarkBitmap(),
+                                                 begin,
+                                                 end,
+                                                 visitor,
+                                                 minimum_age);
+      });
+}
+
 void ConcurrentCopying::GrayAllDirtyImmuneObjects() {
   TimingLogger::ScopedTiming split("GrayAllDirtyImmuneObjects", GetTimings());
   accounting::CardTable* const card_table = heap_->GetCardTable();
@@ -754,7 +778,16 @@ void ConcurrentCopying::GrayAllDirtyImmuneObjects() {
     // spaces.
     if (table != nullptr) {
       table->ProcessCards();
-      table->VisitObjects(&VisitorType::Callback, &visitor);
+      // Graying is atomic, split the space across the heap thread pool.
+      accounting::CardTable::VisitRangeInParallel(
+          heap_->GetThreadPool(),
+          heap_->GetCardProcessingThreadCount(),
+          space->Begin(),
+          space->End(),
+          [table, &visitor](size_t chunk_index ATTRIBUTE_UNUSED, uint8_t* begin, uint8_t* end)
+              REQUIRES(Locks::heap_bitmap_lock_) REQUIRES_SHARED(Locks::mutator_lock_) {
+            table->VisitObjectsInRange(&VisitorType::Callback, &visitor, begin, end);
+          });
       // Don't clear cards here since we need to rescan in the pause. If we cleared the cards here,
       // there would be races with the mutator marking new cards.
     } else {
@@ -769,11 +802,7 @@ void ConcurrentCopying::GrayAllDirtyImmuneObjects() {
                 : card;
           },
           /* card modified visitor */ VoidFunctor());
-      card_table->Scan</* kClearCard */ false>(space->GetMarkBitmap(),
-                                               space->Begin(),
-                                               space->End(),
-                                               visitor,
-                                               gc::accounting::CardTable::kCardAged);
+      ScanImmuneSpaceCardsInParallel(space, visitor, gc::accounting::CardTable::kCardAged);
     }
   }
 }
@@ -791,11 +820,7 @@ void ConcurrentCopying::GrayAllNewlyDirtyImmuneObjects() {
 
     // Don't need to scan aged cards since we did these before the pause. Note that scanning cards
     // also handles the mod-union table cards.
-    card_table->Scan</* kClearCard */ false>(space->GetMarkBitmap(),
-                                             space->Begin(),
-                                             space->End(),
-                                             visitor,
-                                             gc::accounting::CardTable::kCardDirty);
+    ScanImmuneSpaceCardsInParallel(space, visitor, gc::accounting::CardTable::kCardDirty);
     if (table != nullptr) {
       // Add the cards to the mod-union table so that we can clear cards to save RAM.
       table->ProcessCards();
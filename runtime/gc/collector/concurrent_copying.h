@@ -48,6 +48,7 @@ class ReadBarrierTable;
 }  // namespace accounting
 
 namespace space {
+class ContinuousSpace;
 class RegionSpace;
 }  // namespace space
 
@@ -192,6 +193,14 @@ class ConcurrentCopying : public GarbageCollector {
   void GrayAllNewlyDirtyImmuneObjects()
       REQUIRES(Locks::mutator_lock_)
       REQUIRES(!mark_stack_lock_);
+  // Scan the cards of at least `minimum_age` in an immune space, splitting the space across the
+  // heap thread pool. `visitor` must be safe to call concurrently on different objects.
+  template <typename Visitor>
+  void ScanImmuneSpaceCardsInParallel(space::ContinuousSpace* space,
+                                      const Visitor& visitor,
+                                      uint8_t minimum_age)
+      REQUIRES(Locks::heap_bitmap_lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
   void VerifyGrayImmuneObjects()
       REQUIRES(Locks::mutator_lock_)
       REQUIRES(!mark_stack_lock_);
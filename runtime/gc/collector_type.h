@@ -61,6 +61,10 @@ enum CollectorType {
   kCollectorTypeGetObjectsAllocated,
   // Fake collector type for ScopedGCCriticalSection
   kCollectorTypeCriticalSection,
+  // Fake collector type for incremental heap verification.
+  kCollectorTypeVerification,
+  // Fake collector type for background monitor deflation.
+  kCollectorTypeMonitorDeflation,
 };
 std::ostream& operator<<(std::ostream& os, const CollectorType& collector_type);
 
@@ -46,6 +46,8 @@ const char* PrettyCause(GcCause cause) {
     case kGcCauseHprof: return "Hprof";
     case kGcCauseGetObjectsAllocated: return "ObjectsAllocated";
     case kGcCauseProfileSaver: return "ProfileSaver";
+    case kGcCauseVerification: return "Verification";
+    case kGcCauseMonitorDeflation: return "MonitorDeflation";
   }
   LOG(FATAL) << "Unreachable";
   UNREACHABLE();
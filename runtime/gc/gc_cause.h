@@ -62,6 +62,10 @@ enum GcCause {
   kGcCauseGetObjectsAllocated,
   // GC cause for the profile saver.
   kGcCauseProfileSaver,
+  // Not a real GC cause, used to prevent incremental heap verification running in the middle of GC.
+  kGcCauseVerification,
+  // Not a real GC cause, used to deflate monitors without racing with the GC on the lock words.
+  kGcCauseMonitorDeflation,
 };
 
 const char* PrettyCause(GcCause cause);
@@ -20,6 +20,7 @@
 #include "heap.h"
 
 #include "allocation_listener.h"
+#include "allocation_sampler.h"
 #include "base/quasi_atomic.h"
 #include "base/time_utils.h"
 #include "base/utils.h"
@@ -157,6 +158,10 @@ inline mirror::Object* Heap::AllocObjectWithAllocator(Thread* self,
     }
     pre_fence_visitor(obj, usable_size);
     QuasiAtomic::ThreadFenceForConstructor();
+    if (UNLIKELY(self->IsAllocSamplePending())) {
+      // Set by the TLAB refill in TryToAllocate, so only checked on the slow path.
+      allocation_sampler_->RecordSample(self, &obj, bytes_allocated);
+    }
     if (bytes_tl_bulk_allocated > 0) {
       size_t num_bytes_allocated_before =
           num_bytes_allocated_.fetch_add(bytes_tl_bulk_allocated, std::memory_order_relaxed);
@@ -108,8 +108,18 @@ inline void Heap::VisitObjectsInternal(Visitor&& visitor) {
     // Visit objects in bump pointer space.
     bump_pointer_space_->Walk(visitor);
   }
-  // TODO: Switch to standard begin and end to use ranged a based loop.
-  for (auto* it = allocation_stack_->Begin(), *end = allocation_stack_->End(); it < end; ++it) {
+  VisitAllocationStackRange(allocation_stack_->Begin(), allocation_stack_->End(), visitor);
+  {
+    ReaderMutexLock mu(Thread::Current(), *Locks::heap_bitmap_lock_);
+    GetLiveBitmap()->Visit<Visitor>(visitor);
+  }
+}
+
+template <typename Visitor>
+inline void Heap::VisitAllocationStackRange(StackReference<mirror::Object>* begin,
+                                            StackReference<mirror::Object>* end,
+                                            Visitor&& visitor) {
+  for (StackReference<mirror::Object>* it = begin; it < end; ++it) {
     mirror::Object* const obj = it->AsMirrorPtr();
 
     mirror::Class* kls = nullptr;
@@ -157,9 +167,50 @@ inline void Heap::VisitObjectsInternal(Visitor&& visitor) {
       visitor(obj);
     }
   }
-  {
-    ReaderMutexLock mu(Thread::Current(), *Locks::heap_bitmap_lock_);
-    GetLiveBitmap()->Visit<Visitor>(visitor);
+}
+
+template <typename Visitor>
+inline void Heap::VisitVerificationWindows(size_t first_window,
+                                           size_t last_window,
+                                           Visitor&& visitor) {
+  DCHECK_LE(first_window, last_window);
+  // Index of the first window of the current space.
+  size_t space_window = 0u;
+  for (space::ContinuousSpace* space : continuous_spaces_) {
+    size_t num_windows;
+    if (space == region_space_) {
+      num_windows = region_space_->GetNumRegions();
+    } else if (space->GetLiveBitmap() != nullptr) {
+      num_windows = RoundUp(space->Size(), kVerificationWindowSize) / kVerificationWindowSize;
+    } else {
+      // The bump pointer spaces are verified separately.
+      continue;
+    }
+    size_t begin = std::max(first_window, space_window) - space_window;
+    size_t end = std::min(last_window, space_window + num_windows) - space_window;
+    if (begin < end) {
+      if (space == region_space_) {
+        region_space_->WalkRegions(begin, end, visitor);
+      } else {
+        uintptr_t space_begin = reinterpret_cast<uintptr_t>(space->Begin());
+        space->GetLiveBitmap()->VisitMarkedRange(
+            space_begin + begin * kVerificationWindowSize,
+            std::min(space_begin + end * kVerificationWindowSize,
+                     reinterpret_cast<uintptr_t>(space->End())),
+            visitor);
+      }
+    }
+    space_window += num_windows;
+    if (space_window >= last_window) {
+      return;
+    }
+  }
+  // Each large object space is a single window, its objects are sparse.
+  for (accounting::LargeObjectBitmap* bitmap : live_bitmap_->large_object_bitmaps_) {
+    if (first_window <= space_window && space_window < last_window) {
+      bitmap->VisitMarkedRange(bitmap->HeapBegin(), bitmap->HeapLimit(), visitor);
+    }
+    ++space_window;
   }
 }
 
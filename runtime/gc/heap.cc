@@ -23,6 +23,7 @@
 #include "android-base/stringprintf.h"
 
 #include "allocation_listener.h"
+#include "allocation_sampler-inl.h"
 #include "art_field-inl.h"
 #include "backtrace_helper.h"
 #include "base/allocator.h"
@@ -79,6 +80,8 @@
 #include "mirror/object-refvisitor-inl.h"
 #include "mirror/object_array-inl.h"
 #include "mirror/reference-inl.h"
+#include "monitor.h"
+#include "monitor_pool.h"
 #include "nativehelper/scoped_local_ref.h"
 #include "obj_ptr-inl.h"
 #include "reflection.h"
@@ -288,7 +291,10 @@ Heap::Heap(size_t initial_size,
       backtrace_lock_(nullptr),
       seen_backtrace_count_(0u),
       unique_backtrace_count_(0u),
-      gc_disabled_for_shutdown_(false) {
+      gc_disabled_for_shutdown_(false),
+      incremental_verification_regions_(0u),
+      incremental_verification_cursor_(0u),
+      monitors_after_last_deflation_(0u) {
   if (VLOG_IS_ON(heap) || VLOG_IS_ON(startup)) {
     LOG(INFO) << "Heap() entering";
   }
@@ -297,6 +303,7 @@ Heap::Heap(size_t initial_size,
     CHECK_EQ(background_collector_type_, kCollectorTypeCCBackground);
   }
   verification_.reset(new Verification(this));
+  allocation_sampler_.reset(new AllocationSampler());
   CHECK_GE(large_object_threshold, kMinLargeObjectThreshold);
   ScopedTrace trace(__FUNCTION__);
   Runtime* const runtime = Runtime::Current();
@@ -847,6 +854,18 @@ void Heap::DecrementDisableMovingGC(Thread* self) {
   --disable_moving_gc_count_;
 }
 
+void Heap::PinObject(ObjPtr<mirror::Object> obj) {
+  CHECK(kUseReadBarrier);
+  DCHECK(region_space_ != nullptr && region_space_->HasAddress(obj.Ptr())) << obj;
+  region_space_->PinObject(obj.Ptr());
+}
+
+void Heap::UnpinObject(ObjPtr<mirror::Object> obj) {
+  CHECK(kUseReadBarrier);
+  DCHECK(region_space_ != nullptr && region_space_->HasAddress(obj.Ptr())) << obj;
+  region_space_->UnpinObject(obj.Ptr());
+}
+
 void Heap::IncrementDisableThreadFlip(Thread* self) {
   // Supposed to be called by mutators. If thread_flip_running_ is true, block. Otherwise, go ahead.
   CHECK(kUseReadBarrier);
@@ -969,6 +988,15 @@ void Heap::CreateThreadPool() {
   }
 }
 
+size_t Heap::GetCardProcessingThreadCount() const {
+  if (thread_pool_ == nullptr || !Runtime::Current()->InJankPerceptibleProcessState()) {
+    return 1;
+  }
+  // Card processing happens both during pauses and concurrently, use the larger of the two counts
+  // since the pool always has that many workers.
+  return std::max(parallel_gc_threads_, conc_gc_threads_) + 1;
+}
+
 void Heap::MarkAllocStackAsLive(accounting::ObjectStack* stack) {
   space::ContinuousSpace* space1 = main_space_ != nullptr ? main_space_ : non_moving_space_;
   space::ContinuousSpace* space2 = non_moving_space_;
@@ -1337,14 +1365,7 @@ void Heap::Trim(Thread* self) {
   if (!CareAboutPauseTimes()) {
     // Deflate the monitors, this can cause a pause but shouldn't matter since we don't care
     // about pauses.
-    ScopedTrace trace("Deflating monitors");
-    // Avoid race conditions on the lock word for CC.
-    ScopedGCCriticalSection gcs(self, kGcCauseTrim, kCollectorTypeHeapTrim);
-    ScopedSuspendAll ssa(__FUNCTION__);
-    uint64_t start_time = NanoTime();
-    size_t count = runtime->GetMonitorList()->DeflateMonitors();
-    VLOG(heap) << "Deflating " << count << " monitors took "
-        << PrettyDuration(NanoTime() - start_time);
+    DeflateMonitors(self);
   }
   TrimIndirectReferenceTables(self);
   TrimSpaces(self);
@@ -2686,6 +2707,8 @@ collector::GcType Heap::CollectGarbageInternal(collector::GcType gc_type,
   total_objects_freed_ever_ += GetCurrentGcIteration()->GetFreedObjects();
   total_bytes_freed_ever_ += GetCurrentGcIteration()->GetFreedBytes();
   RequestTrim(self);
+  RequestIncrementalVerification(self);
+  RequestMonitorDeflation(self);
   // Enqueue cleared references.
   reference_processor_->EnqueueClearedReferences(self);
   // Grow the heap so that we know when to perform the next GC.
@@ -2819,9 +2842,17 @@ class ScanVisitor {
 // Verify a reference from an object.
 class VerifyReferenceVisitor : public SingleRootVisitor {
  public:
-  VerifyReferenceVisitor(Thread* self, Heap* heap, size_t* fail_count, bool verify_referent)
+  VerifyReferenceVisitor(Thread* self,
+                         Heap* heap,
+                         size_t* fail_count,
+                         bool verify_referent,
+                         bool log_failures)
       REQUIRES_SHARED(Locks::mutator_lock_)
-      : self_(self), heap_(heap), fail_count_(fail_count), verify_referent_(verify_referent) {
+      : self_(self),
+        heap_(heap),
+        fail_count_(fail_count),
+        verify_referent_(verify_referent),
+        log_failures_(log_failures) {
     CHECK_EQ(self_, Thread::Current());
   }
 
@@ -2859,7 +2890,7 @@ class VerifyReferenceVisitor : public SingleRootVisitor {
       REQUIRES_SHARED(Locks::mutator_lock_) {
     if (root == nullptr) {
       LOG(ERROR) << "Root is null with info " << root_info.GetType();
-    } else if (!VerifyReference(nullptr, root, MemberOffset(0))) {
+    } else if (!VerifyReference(nullptr, root, MemberOffset(0)) && log_failures_) {
       LOG(ERROR) << "Root " << root << " is dead with type " << mirror::Object::PrettyTypeOf(root)
           << " thread_id= " << root_info.GetThreadId() << " root_type= " << root_info.GetType();
     }
@@ -2876,6 +2907,9 @@ class VerifyReferenceVisitor : public SingleRootVisitor {
     }
     CHECK_EQ(self_, Thread::Current());  // fail_count_ is private to the calling thread.
     *fail_count_ += 1;
+    if (!log_failures_) {
+      return false;
+    }
     if (*fail_count_ == 1) {
       // Only print message for the first failure to prevent spam.
       LOG(ERROR) << "!!!!!!!!!!!!!!Heap corruption detected!!!!!!!!!!!!!!!!!!!";
@@ -2967,25 +3001,36 @@ class VerifyReferenceVisitor : public SingleRootVisitor {
   Heap* const heap_;
   size_t* const fail_count_;
   const bool verify_referent_;
+  // Whether to investigate and log failures. Counting them is all that is safe to do on heap
+  // thread pool workers, which do not hold the mutator lock.
+  const bool log_failures_;
 };
 
 // Verify all references within an object, for use with HeapBitmap::Visit.
 class VerifyObjectVisitor {
  public:
-  VerifyObjectVisitor(Thread* self, Heap* heap, size_t* fail_count, bool verify_referent)
-      : self_(self), heap_(heap), fail_count_(fail_count), verify_referent_(verify_referent) {}
+  VerifyObjectVisitor(Thread* self,
+                      Heap* heap,
+                      size_t* fail_count,
+                      bool verify_referent,
+                      bool log_failures = true)
+      : self_(self),
+        heap_(heap),
+        fail_count_(fail_count),
+        verify_referent_(verify_referent),
+        log_failures_(log_failures) {}
 
   void operator()(mirror::Object* obj) REQUIRES_SHARED(Locks::mutator_lock_) {
     // Note: we are verifying the references in obj but not obj itself, this is because obj must
     // be live or else how did we find it in the live bitmap?
-    VerifyReferenceVisitor visitor(self_, heap_, fail_count_, verify_referent_);
+    VerifyReferenceVisitor visitor(self_, heap_, fail_count_, verify_referent_, log_failures_);
     // The class doesn't count as a reference but we should verify it anyways.
     obj->VisitReferences(visitor, visitor);
   }
 
   void VerifyRoots() REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!Locks::heap_bitmap_lock_) {
     ReaderMutexLock mu(Thread::Current(), *Locks::heap_bitmap_lock_);
-    VerifyReferenceVisitor visitor(self_, heap_, fail_count_, verify_referent_);
+    VerifyReferenceVisitor visitor(self_, heap_, fail_count_, verify_referent_, log_failures_);
     Runtime::Current()->VisitRoots(&visitor);
   }
 
@@ -2999,6 +3044,7 @@ class VerifyObjectVisitor {
   Heap* const heap_;
   size_t* const fail_count_;
   const bool verify_referent_;
+  const bool log_failures_;
 };
 
 void Heap::PushOnAllocationStackWithInternalGC(Thread* self, ObjPtr<mirror::Object>* obj) {
@@ -3039,6 +3085,115 @@ void Heap::PushOnThreadLocalAllocationStackWithInternalGC(Thread* self,
   CHECK(self->PushOnThreadLocalAllocationStack(obj->Ptr()));  // Must succeed.
 }
 
+// Verifies the objects of a range of verification windows and of the allocation stack on a heap
+// thread pool worker.
+class Heap::VerifyHeapReferencesTask : public Task {
+ public:
+  VerifyHeapReferencesTask(Heap* heap,
+                           bool verify_referents,
+                           size_t first_window,
+                           size_t last_window,
+                           StackReference<mirror::Object>* stack_begin,
+                           StackReference<mirror::Object>* stack_end)
+      : heap_(heap),
+        verify_referents_(verify_referents),
+        first_window_(first_window),
+        last_window_(last_window),
+        stack_begin_(stack_begin),
+        stack_end_(stack_end),
+        fail_count_(0u) {}
+
+  // The thread running the verification keeps the mutators suspended.
+  void Run(Thread* self) override NO_THREAD_SAFETY_ANALYSIS {
+    VerifyObjectVisitor visitor(self, heap_, &fail_count_, verify_referents_, false);
+    heap_->VisitVerificationWindows(first_window_, last_window_, visitor);
+    heap_->VisitAllocationStackRange(stack_begin_, stack_end_, visitor);
+  }
+
+  size_t GetFailureCount() const {
+    return fail_count_;
+  }
+
+ private:
+  Heap* const heap_;
+  const bool verify_referents_;
+  const size_t first_window_;
+  const size_t last_window_;
+  StackReference<mirror::Object>* const stack_begin_;
+  StackReference<mirror::Object>* const stack_end_;
+  size_t fail_count_;
+};
+
+size_t Heap::GetNumVerificationWindows() const {
+  static_assert(kVerificationWindowSize == space::RegionSpace::kRegionSize,
+                "Verification windows should match regions");
+  size_t num_windows = 0u;
+  for (space::ContinuousSpace* space : continuous_spaces_) {
+    if (space == region_space_) {
+      num_windows += region_space_->GetNumRegions();
+    } else if (space->GetLiveBitmap() != nullptr) {
+      num_windows += RoundUp(space->Size(), kVerificationWindowSize) / kVerificationWindowSize;
+    }
+  }
+  return num_windows + live_bitmap_->large_object_bitmaps_.size();
+}
+
+size_t Heap::VerifyHeapReferencesInParallel(Thread* self,
+                                            bool verify_referents,
+                                            size_t thread_count) {
+  // More tasks than threads so that a few dense windows do not keep a single worker busy.
+  static constexpr size_t kTasksPerThread = 4u;
+  std::vector<std::unique_ptr<VerifyHeapReferencesTask>> tasks;
+  const size_t num_windows = GetNumVerificationWindows();
+  const size_t windows_per_task =
+      std::max<size_t>(1u, (num_windows + thread_count * kTasksPerThread - 1) /
+                               (thread_count * kTasksPerThread));
+  for (size_t first = 0u; first < num_windows; first += windows_per_task) {
+    tasks.emplace_back(new VerifyHeapReferencesTask(this,
+                                                    verify_referents,
+                                                    first,
+                                                    std::min(first + windows_per_task, num_windows),
+                                                    nullptr,
+                                                    nullptr));
+  }
+  StackReference<mirror::Object>* stack_begin = allocation_stack_->Begin();
+  StackReference<mirror::Object>* stack_end = allocation_stack_->End();
+  const size_t stack_chunk_size =
+      std::max<size_t>(1u, (stack_end - stack_begin + thread_count - 1) / thread_count);
+  for (StackReference<mirror::Object>* it = stack_begin; it < stack_end; it += stack_chunk_size) {
+    tasks.emplace_back(new VerifyHeapReferencesTask(this,
+                                                    verify_referents,
+                                                    0u,
+                                                    0u,
+                                                    it,
+                                                    std::min(it + stack_chunk_size, stack_end)));
+  }
+  {
+    // The workers visit the live bitmaps on our behalf.
+    ReaderMutexLock mu(self, *Locks::heap_bitmap_lock_);
+    ThreadPool* pool = GetThreadPool();
+    for (const std::unique_ptr<VerifyHeapReferencesTask>& task : tasks) {
+      pool->AddTask(self, task.get());
+    }
+    pool->SetMaxActiveWorkers(thread_count - 1);
+    pool->StartWorkers(self);
+    pool->Wait(self, /* do_work */ true, /* may_hold_locks */ true);
+    pool->StopWorkers(self);
+  }
+  size_t fail_count = 0u;
+  for (const std::unique_ptr<VerifyHeapReferencesTask>& task : tasks) {
+    fail_count += task->GetFailureCount();
+  }
+  // The bump pointer spaces are small or only used by non-concurrent collectors, and the roots
+  // need the mutator lock to be visited.
+  VerifyObjectVisitor visitor(self, this, &fail_count, verify_referents, false);
+  if (bump_pointer_space_ != nullptr) {
+    bump_pointer_space_->Walk(visitor);
+  }
+  visitor.VerifyRoots();
+  return fail_count;
+}
+
 // Must do this with mutators suspended since we are directly accessing the allocation stacks.
 size_t Heap::VerifyHeapReferences(bool verify_referents) {
   Thread* self = Thread::Current();
@@ -3049,6 +3204,13 @@ size_t Heap::VerifyHeapReferences(bool verify_referents) {
   // Since we sorted the allocation stack content, need to revoke all
   // thread-local allocation stacks.
   RevokeAllThreadLocalAllocationStacks(self);
+  const size_t thread_count = GetCardProcessingThreadCount();
+  if (thread_count > 1u) {
+    if (VerifyHeapReferencesInParallel(self, verify_referents, thread_count) == 0u) {
+      return 0u;
+    }
+    // Verify again on this thread to investigate and report the failures.
+  }
   size_t fail_count = 0;
   VerifyObjectVisitor visitor(self, this, &fail_count, verify_referents);
   // Verify objects in the allocation stack since these will be objects which were:
@@ -3280,8 +3442,14 @@ void Heap::ProcessCards(TimingLogger* timings,
         // The races are we either end up with: Aged card, unaged card. Since we have the
         // checkpoint roots and then we scan / update mod union tables after. We will always
         // scan either card. If we end up with the non aged card, we scan it it in the pause.
-        card_table_->ModifyCardsAtomic(space->Begin(), space->End(), AgeCardVisitor(),
-                                       VoidFunctor());
+        accounting::CardTable::VisitRangeInParallel(
+            thread_pool_.get(),
+            GetCardProcessingThreadCount(),
+            space->Begin(),
+            space->End(),
+            [this](size_t chunk_index ATTRIBUTE_UNUSED, uint8_t* begin, uint8_t* end) {
+              card_table_->ModifyCardsAtomic(begin, end, AgeCardVisitor(), VoidFunctor());
+            });
       }
     }
   }
@@ -3465,6 +3633,7 @@ void Heap::DumpForSigQuit(std::ostream& os) {
   os << "Heap: " << GetPercentFree() << "% free, " << PrettySize(GetBytesAllocated()) << "/"
      << PrettySize(GetTotalMemory()) << "; " << GetObjectsAllocated() << " objects\n";
   DumpGcPerformanceInfo(os);
+  allocation_sampler_->DumpForSigQuit(os);
 }
 
 size_t Heap::GetPercentFree() {
@@ -3774,6 +3943,48 @@ void Heap::ClearPendingTrim(Thread* self) {
   pending_heap_trim_ = nullptr;
 }
 
+void Heap::DeflateMonitors(Thread* self) {
+  ScopedTrace trace("Deflating monitors");
+  MonitorList* const monitor_list = Runtime::Current()->GetMonitorList();
+  {
+    // Avoid race conditions on the lock word for CC.
+    ScopedGCCriticalSection gcs(self, kGcCauseMonitorDeflation, kCollectorTypeMonitorDeflation);
+    ScopedSuspendAll ssa(__FUNCTION__);
+    uint64_t start_time = NanoTime();
+    size_t count = monitor_list->DeflateMonitors();
+    VLOG(heap) << "Deflating " << count << " monitors took "
+        << PrettyDuration(NanoTime() - start_time);
+  }
+  monitors_after_last_deflation_.store(monitor_list->Size(), std::memory_order_relaxed);
+  // The mutators may run again, they do not reference the monitors we freed.
+  size_t released_chunks = MonitorPool::ReleaseUnusedChunks(self);
+  VLOG(heap) << "Released " << released_chunks << " monitor pool chunks";
+}
+
+class Heap::MonitorDeflationTask : public HeapTask {
+ public:
+  explicit MonitorDeflationTask(uint64_t target_time) : HeapTask(target_time) {}
+  void Run(Thread* self) override {
+    gc::Heap* heap = Runtime::Current()->GetHeap();
+    heap->monitor_deflation_pending_.store(false, std::memory_order_relaxed);
+    heap->DeflateMonitors(self);
+  }
+};
+
+void Heap::RequestMonitorDeflation(Thread* self) {
+  // The deflation pause is proportional to the number of monitors. Only pay for it once they
+  // doubled since the last deflation so that its cost is amortized over the inflations.
+  size_t num_monitors = Runtime::Current()->GetMonitorList()->Size();
+  if (num_monitors < kMinMonitorsForBackgroundDeflation ||
+      num_monitors < 2 * monitors_after_last_deflation_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  if (CanAddHeapTask(self) &&
+      monitor_deflation_pending_.CompareAndSetStrongSequentiallyConsistent(false, true)) {
+    task_processor_->AddTask(self, new MonitorDeflationTask(NanoTime() + kMonitorDeflationWait));
+  }
+}
+
 void Heap::RequestTrim(Thread* self) {
   if (!CanAddHeapTask(self)) {
     return;
@@ -3803,6 +4014,54 @@ void Heap::RequestTrim(Thread* self) {
   task_processor_->AddTask(self, added_task);
 }
 
+class Heap::IncrementalVerificationTask : public HeapTask {
+ public:
+  explicit IncrementalVerificationTask(uint64_t target_time) : HeapTask(target_time) {}
+  void Run(Thread* self) override {
+    gc::Heap* heap = Runtime::Current()->GetHeap();
+    heap->incremental_verification_pending_.store(false, std::memory_order_relaxed);
+    size_t failures = heap->VerifyHeapReferencesIncrementally(self);
+    if (failures > 0) {
+      LOG(FATAL) << "Incremental heap verification failed with " << failures << " failures";
+    }
+  }
+};
+
+void Heap::RequestIncrementalVerification(Thread* self) {
+  if (incremental_verification_regions_ != 0u &&
+      CanAddHeapTask(self) &&
+      incremental_verification_pending_.CompareAndSetStrongSequentiallyConsistent(false, true)) {
+    task_processor_->AddTask(self, new IncrementalVerificationTask(NanoTime()));
+  }
+}
+
+size_t Heap::VerifyHeapReferencesIncrementally(Thread* self) {
+  ScopedTrace trace(__FUNCTION__);
+  // Keep collections from moving objects or swapping the allocation stacks under us.
+  ScopedGCCriticalSection gcs(self, kGcCauseVerification, kCollectorTypeVerification);
+  // The pause only covers the windows checked this time, not the whole heap.
+  ScopedSuspendAll ssa(__FUNCTION__);
+  uint64_t start_time = NanoTime();
+  allocation_stack_->Sort();
+  live_stack_->Sort();
+  RevokeAllThreadLocalAllocationStacks(self);
+  const size_t num_windows = GetNumVerificationWindows();
+  size_t first_window = incremental_verification_cursor_ < num_windows
+      ? incremental_verification_cursor_
+      : 0u;
+  size_t last_window = std::min(first_window + incremental_verification_regions_, num_windows);
+  incremental_verification_cursor_ = last_window;
+  size_t fail_count = 0u;
+  {
+    ReaderMutexLock mu(self, *Locks::heap_bitmap_lock_);
+    VerifyObjectVisitor visitor(self, this, &fail_count, /* verify_referent */ true);
+    VisitVerificationWindows(first_window, last_window, visitor);
+  }
+  VLOG(heap) << "Incrementally verified heap windows [" << first_window << ", " << last_window
+             << ") of " << num_windows << " in " << PrettyDuration(NanoTime() - start_time);
+  return fail_count;
+}
+
 void Heap::IncrementNumberOfBytesFreedRevoke(size_t freed_bytes_revoke) {
   size_t previous_num_bytes_freed_revoke =
       num_bytes_freed_revoke_.fetch_add(freed_bytes_revoke, std::memory_order_relaxed);
@@ -4185,6 +4444,9 @@ mirror::Object* Heap::AllocWithNewTLAB(Thread* self,
       return nullptr;
     }
   }
+  if (UNLIKELY(allocation_sampler_->IsEnabled())) {
+    allocation_sampler_->ReportTlabRefill(self, *bytes_tl_bulk_allocated);
+  }
   // Refilled TLAB, return.
   mirror::Object* ret = self->AllocTlab(alloc_size);
   DCHECK(ret != nullptr);
@@ -4197,6 +4459,10 @@ const Verification* Heap::GetVerification() const {
   return verification_.get();
 }
 
+AllocationSampler* Heap::GetAllocationSampler() const {
+  return allocation_sampler_.get();
+}
+
 void Heap::VlogHeapGrowth(size_t max_allowed_footprint, size_t new_footprint, size_t alloc_size) {
   VLOG(heap) << "Growing heap from " << PrettySize(max_allowed_footprint) << " to "
              << PrettySize(new_footprint) << " for a " << PrettySize(alloc_size) << " allocation";
@@ -52,6 +52,7 @@ class IsMarkedVisitor;
 class Mutex;
 class RootVisitor;
 class StackVisitor;
+template<class MirrorType> class StackReference;
 class Thread;
 class ThreadPool;
 class TimingLogger;
@@ -65,6 +66,7 @@ class Object;
 namespace gc {
 
 class AllocationListener;
+class AllocationSampler;
 class AllocRecordObjectMap;
 class GcPauseListener;
 class ReferenceProcessor;
@@ -162,6 +164,14 @@ class Heap {
   // Whether the transition-wait applies or not. Zero wait will stress the
   // transition code and collector, but increases jank probability.
   DECLARE_RUNTIME_DEBUG_FLAG(kStressCollectorTransition);
+  // How long we wait after a GC before deflating monitors in the background (nanoseconds).
+  static constexpr uint64_t kMonitorDeflationWait = MsToNs(1000);
+  // Don't bother deflating monitors in the background below this many inflated monitors.
+  static constexpr size_t kMinMonitorsForBackgroundDeflation = 4096;
+
+  // Granularity of parallel and incremental heap verification, the size of a region of the region
+  // space.
+  static constexpr size_t kVerificationWindowSize = 256 * KB;
 
   // Create a heap with the requested sizes. The possible empty
   // image_file_names names specify Spaces to load based on
@@ -289,9 +299,22 @@ class Heap {
 
   // Check sanity of all live references.
   void VerifyHeap() REQUIRES(!Locks::heap_bitmap_lock_);
-  // Returns how many failures occured.
+  // Returns how many failures occured. Uses the heap thread pool if there is one.
   size_t VerifyHeapReferences(bool verify_referents = true)
       REQUIRES(Locks::mutator_lock_, !*gc_complete_lock_);
+  // Only counts the failures, VerifyHeapReferences reruns serially to report them. Expects the
+  // allocation stacks to be sorted, as done by VerifyHeapReferences.
+  size_t VerifyHeapReferencesInParallel(Thread* self, bool verify_referents, size_t thread_count)
+      REQUIRES(Locks::mutator_lock_, !Locks::heap_bitmap_lock_);
+  // Verify the references of the objects in the next few regions of the heap, wrapping around, so
+  // that the whole heap gets checked over a number of GC cycles without long pauses. Returns how
+  // many failures occured.
+  size_t VerifyHeapReferencesIncrementally(Thread* self)
+      REQUIRES(!Locks::mutator_lock_, !*gc_complete_lock_);
+  // Verify this many regions in the background after each GC, 0 disables incremental verification.
+  void SetIncrementalVerificationRegions(size_t regions) {
+    incremental_verification_regions_ = regions;
+  }
   bool VerifyMissingCardMarks()
       REQUIRES(Locks::heap_bitmap_lock_, Locks::mutator_lock_);
 
@@ -320,6 +343,11 @@ class Heap {
   void IncrementDisableMovingGC(Thread* self) REQUIRES(!*gc_complete_lock_);
   void DecrementDisableMovingGC(Thread* self) REQUIRES(!*gc_complete_lock_);
 
+  // Keep a movable object in place for a JNI critical call with the concurrent copying
+  // collector. Only the region holding `obj` is kept from being evacuated, the GC is not blocked.
+  void PinObject(ObjPtr<mirror::Object> obj) REQUIRES_SHARED(Locks::mutator_lock_);
+  void UnpinObject(ObjPtr<mirror::Object> obj) REQUIRES_SHARED(Locks::mutator_lock_);
+
   // Temporarily disable thread flip for JNI critical calls.
   void IncrementDisableThreadFlip(Thread* self) REQUIRES(!*thread_flip_lock_);
   void DecrementDisableThreadFlip(Thread* self) REQUIRES(!*thread_flip_lock_);
@@ -562,6 +590,9 @@ class Heap {
   // Deflate monitors, ... and trim the spaces.
   void Trim(Thread* self) REQUIRES(!*gc_complete_lock_);
 
+  // Deflate the unused inflated monitors in a pause and return the monitor pool chunks they free.
+  void DeflateMonitors(Thread* self) REQUIRES(!*gc_complete_lock_);
+
   void RevokeThreadLocalBuffers(Thread* thread);
   void RevokeRosAllocThreadLocalBuffers(Thread* thread);
   void RevokeAllThreadLocalBuffers();
@@ -651,6 +682,10 @@ class Heap {
     return large_object_space_;
   }
 
+  space::RegionSpace* GetRegionSpace() const {
+    return region_space_;
+  }
+
   // Returns the free list space that may contain movable objects (the
   // one that's not the non-moving space), either rosalloc_space_ or
   // dlmalloc_space_.
@@ -686,6 +721,10 @@ class Heap {
   size_t GetConcGCThreadCount() const {
     return conc_gc_threads_;
   }
+  // Number of threads, including the calling GC thread, to split card table and mod-union table
+  // processing across. Returns 1 if there is no thread pool or in the background, where we want to
+  // leave CPU time to the foreground apps.
+  size_t GetCardProcessingThreadCount() const;
   accounting::ModUnionTable* FindModUnionTableFromSpace(space::Space* space);
   void AddModUnionTable(accounting::ModUnionTable* mod_union_table);
 
@@ -823,12 +862,18 @@ class Heap {
 
   const Verification* GetVerification() const;
 
+  // The sampling allocation profiler, enabled with -XX:AllocSampleInterval.
+  AllocationSampler* GetAllocationSampler() const;
+
   void PostForkChildAction(Thread* self);
 
  private:
   class ConcurrentGCTask;
   class CollectorTransitionTask;
   class HeapTrimTask;
+  class IncrementalVerificationTask;
+  class MonitorDeflationTask;
+  class VerifyHeapReferencesTask;
   class TriggerPostForkCCGcTask;
 
   // Compact source space to target space. Returns the collector used.
@@ -1059,6 +1104,25 @@ class Heap {
   template <typename Visitor>
   ALWAYS_INLINE void VisitObjectsInternalRegionSpace(Visitor&& visitor)
       REQUIRES(Locks::mutator_lock_, !Locks::heap_bitmap_lock_, !*gc_complete_lock_);
+  template <typename Visitor>
+  ALWAYS_INLINE void VisitAllocationStackRange(StackReference<mirror::Object>* begin,
+                                               StackReference<mirror::Object>* end,
+                                               Visitor&& visitor)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Heap verification splits the spaces with a live bitmap into windows of at most
+  // kVerificationWindowSize bytes, the regions of the region space, and one window per large
+  // object space. This lets it spread them over the heap thread pool or check a few at a time.
+  size_t GetNumVerificationWindows() const REQUIRES(Locks::mutator_lock_);
+  // Visit the live objects of the windows [first_window, last_window). The mutators must be
+  // suspended, possibly by another thread.
+  template <typename Visitor>
+  ALWAYS_INLINE void VisitVerificationWindows(size_t first_window,
+                                              size_t last_window,
+                                              Visitor&& visitor) NO_THREAD_SAFETY_ANALYSIS;
+  void RequestIncrementalVerification(Thread* self);
+  // Request a background monitor deflation if many monitors got inflated since the last one.
+  void RequestMonitorDeflation(Thread* self);
 
   void UpdateGcCountRateHistograms() REQUIRES(gc_complete_lock_);
 
@@ -1423,6 +1487,19 @@ class Heap {
   // allocating.
   bool gc_disabled_for_shutdown_ GUARDED_BY(gc_complete_lock_);
 
+  // Number of verification windows checked in the background after each GC, 0 if incremental heap
+  // verification is disabled.
+  size_t incremental_verification_regions_;
+  // The first window the next incremental verification checks.
+  size_t incremental_verification_cursor_;
+  // Whether or not an incremental verification task is pending.
+  Atomic<bool> incremental_verification_pending_;
+
+  // Number of inflated monitors left by the last deflation.
+  Atomic<size_t> monitors_after_last_deflation_;
+  // Whether or not a monitor deflation task is pending.
+  Atomic<bool> monitor_deflation_pending_;
+
   // Boot image spaces.
   std::vector<space::ImageSpace*> boot_image_spaces_;
 
@@ -1433,6 +1510,8 @@ class Heap {
 
   std::unique_ptr<Verification> verification_;
 
+  std::unique_ptr<AllocationSampler> allocation_sampler_;
+
   friend class CollectorTransitionTask;
   friend class collector::GarbageCollector;
   friend class collector::ConcurrentCopying;
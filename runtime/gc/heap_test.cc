@@ -23,6 +23,7 @@
 #include "mirror/object-inl.h"
 #include "mirror/object_array-inl.h"
 #include "scoped_thread_state_change-inl.h"
+#include "thread_list.h"
 
 namespace art {
 namespace gc {
@@ -95,6 +96,79 @@ TEST_F(HeapTest, DumpGCPerformanceOnShutdown) {
   Runtime::Current()->SetDumpGCPerformanceOnShutdown(true);
 }
 
+TEST_F(HeapTest, VerifyHeapReferences) {
+  Heap* heap = Runtime::Current()->GetHeap();
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    StackHandleScope<2> hs(soa.Self());
+    Handle<mirror::Class> c(
+        hs.NewHandle(class_linker_->FindSystemClass(soa.Self(), "[Ljava/lang/Object;")));
+    Handle<mirror::ObjectArray<mirror::Object>> array(hs.NewHandle(
+        mirror::ObjectArray<mirror::Object>::Alloc(soa.Self(), c.Get(), 1024)));
+    ASSERT_TRUE(array != nullptr);
+    for (size_t i = 0; i < 1024; ++i) {
+      array->Set<false>(i, mirror::String::AllocFromModifiedUtf8(soa.Self(), "hello, world!"));
+    }
+  }
+  {
+    ScopedSuspendAll ssa(__FUNCTION__);
+    EXPECT_EQ(heap->VerifyHeapReferences(), 0u);
+  }
+  // Enough slices to wrap around the whole heap at least once.
+  heap->SetIncrementalVerificationRegions(64u);
+  for (size_t i = 0; i < 64u; ++i) {
+    EXPECT_EQ(heap->VerifyHeapReferencesIncrementally(Thread::Current()), 0u);
+  }
+  heap->SetIncrementalVerificationRegions(0u);
+}
+
+class ParallelVerificationHeapTest : public HeapTest {
+  void SetUpRuntimeOptions(RuntimeOptions* options) override {
+    HeapTest::SetUpRuntimeOptions(options);
+    options->push_back(std::make_pair("-XX:ParallelGCThreads=3", nullptr));
+  }
+};
+
+TEST_F(ParallelVerificationHeapTest, ReportsBadReference) {
+  Thread* self = Thread::Current();
+  Heap* heap = Runtime::Current()->GetHeap();
+  ASSERT_GT(heap->GetCardProcessingThreadCount(), 1u);
+  ScopedObjectAccess soa(self);
+  StackHandleScope<3> hs(soa.Self());
+  Handle<mirror::Class> c(
+      hs.NewHandle(class_linker_->FindSystemClass(soa.Self(), "[Ljava/lang/Object;")));
+  Handle<mirror::ObjectArray<mirror::Object>> array(hs.NewHandle(
+      mirror::ObjectArray<mirror::Object>::Alloc(soa.Self(), c.Get(), 1024)));
+  ASSERT_TRUE(array != nullptr);
+  Handle<mirror::String> string(
+      hs.NewHandle(mirror::String::AllocFromModifiedUtf8(soa.Self(), "hello, world!")));
+  ASSERT_TRUE(string != nullptr);
+  for (size_t i = 0; i < 1024; ++i) {
+    array->Set<false>(i, string.Get());
+  }
+  // Point to memory that is not part of the heap.
+  std::string error_msg;
+  MemMap outside_heap = MemMap::MapAnonymous("OutsideHeap",
+                                             /* addr */ nullptr,
+                                             kPageSize,
+                                             PROT_READ,
+                                             /*low_4gb*/ true,
+                                             &error_msg);
+  ASSERT_TRUE(outside_heap.IsValid()) << error_msg;
+  mirror::Object* bad_ref = reinterpret_cast<mirror::Object*>(outside_heap.Begin());
+  ScopedThreadSuspension sts(self, kSuspended);
+  ScopedSuspendAll ssa(__FUNCTION__);
+  array->SetWithoutChecksAndWriteBarrier<false>(512, bad_ref);
+  // VerifyHeapReferences only rechecks serially if the workers counted a failure.
+  EXPECT_GT(heap->VerifyHeapReferences(), 0u);
+  EXPECT_EQ(heap->VerifyHeapReferencesInParallel(self,
+                                                 /* verify_referents */ true,
+                                                 heap->GetCardProcessingThreadCount()),
+            1u);
+  array->SetWithoutChecksAndWriteBarrier<false>(512, string.Get());
+  EXPECT_EQ(heap->VerifyHeapReferences(), 0u);
+}
+
 class ZygoteHeapTest : public CommonRuntimeTest {
   void SetUpRuntimeOptions(RuntimeOptions* options) override {
     CommonRuntimeTest::SetUpRuntimeOptions(options);
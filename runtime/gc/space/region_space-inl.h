@@ -195,7 +195,21 @@ inline void RegionSpace::WalkInternal(Visitor&& visitor) {
   // issues (the classloader classes lock and the monitor lock). We
   // call this with threads suspended.
   Locks::mutator_lock_->AssertExclusiveHeld(Thread::Current());
-  for (size_t i = 0; i < num_regions_; ++i) {
+  WalkRegionsInternal<kToSpaceOnly>(0u, num_regions_, visitor);
+}
+
+template <typename Visitor>
+inline void RegionSpace::WalkRegions(size_t first_region, size_t last_region, Visitor&& visitor) {
+  WalkRegionsInternal</* kToSpaceOnly */ false>(first_region, last_region, visitor);
+}
+
+template<bool kToSpaceOnly, typename Visitor>
+inline void RegionSpace::WalkRegionsInternal(size_t first_region,
+                                             size_t last_region,
+                                             Visitor&& visitor) {
+  DCHECK_LE(first_region, last_region);
+  DCHECK_LE(last_region, num_regions_);
+  for (size_t i = first_region; i < last_region; ++i) {
     Region* r = &regions_[i];
     if (r->IsFree() || (kToSpaceOnly && !r->IsInToSpace())) {
       continue;
@@ -180,10 +180,14 @@ inline bool RegionSpace::Region::ShouldBeEvacuated(EvacMode evac_mode) {
   // Evacuation mode `kEvacModeNewlyAllocated` is only used during sticky-bit CC collections.
   DCHECK(kEnableGenerationalConcurrentCopyingCollection || (evac_mode != kEvacModeNewlyAllocated));
   DCHECK((IsAllocated() || IsLarge()) && IsInToSpace());
-  // The region should be evacuated if:
+  // The region should be evacuated if it is not pinned and:
   // - the evacuation is forced (`evac_mode == kEvacModeForceAll`); or
   // - the region was allocated after the start of the previous GC (newly allocated region); or
   // - the live ratio is below threshold (`kEvacuateLivePercentThreshold`).
+  if (UNLIKELY(IsPinned())) {
+    // Native code has direct access to an object in this region (JNI critical section).
+    return false;
+  }
   if (UNLIKELY(evac_mode == kEvacModeForceAll)) {
     return true;
   }
@@ -807,6 +811,7 @@ void RegionSpace::Region::Dump(std::ostream& os) const {
      << " objects_allocated=" << objects_allocated_
      << " alloc_time=" << alloc_time_
      << " live_bytes=" << live_bytes_
+     << " pin_count=" << pin_count_.load(std::memory_order_relaxed)
      << " is_newly_allocated=" << std::boolalpha << is_newly_allocated_ << std::noboolalpha
      << " is_a_tlab=" << std::boolalpha << is_a_tlab_ << std::noboolalpha
      << " thread=" << thread_ << '\n';
@@ -827,6 +832,7 @@ size_t RegionSpace::AllocationSizeNonvirtual(mirror::Object* obj, size_t* usable
 }
 
 void RegionSpace::Region::Clear(bool zero_and_release_pages) {
+  DCHECK(!IsPinned()) << "Clearing region " << idx_ << " held by a JNI critical section";
   top_.store(begin_, std::memory_order_relaxed);
   state_ = RegionState::kRegionStateFree;
   type_ = RegionType::kRegionTypeNone;
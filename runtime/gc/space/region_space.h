@@ -213,6 +213,11 @@ class RegionSpace final : public ContinuousMemMapAllocSpace {
       REQUIRES(Locks::mutator_lock_) {
     WalkInternal<true /* kToSpaceOnly */>(visitor);
   }
+  // Visit the objects of the regions [first_region, last_region). The mutators must be suspended
+  // but, unlike Walk, not necessarily by the calling thread, e.g. for heap thread pool workers.
+  template <typename Visitor>
+  ALWAYS_INLINE void WalkRegions(size_t first_region, size_t last_region, Visitor&& visitor)
+      NO_THREAD_SAFETY_ANALYSIS;
 
   accounting::ContinuousSpaceBitmap::SweepCallback* GetSweepCallback() override {
     return nullptr;
@@ -282,6 +287,21 @@ class RegionSpace final : public ContinuousMemMapAllocSpace {
     return r->Type();
   }
 
+  // Pin the region holding `obj` so that it is not evacuated until the matching UnpinObject().
+  // Used by JNI critical sections, which hand out raw pointers to object data, instead of
+  // blocking the thread flip for the whole collection. Pins nest.
+  void PinObject(mirror::Object* obj) REQUIRES_SHARED(Locks::mutator_lock_) {
+    RefToRegionUnlocked(obj)->Pin();
+  }
+
+  void UnpinObject(mirror::Object* obj) REQUIRES_SHARED(Locks::mutator_lock_) {
+    RefToRegionUnlocked(obj)->Unpin();
+  }
+
+  bool IsPinned(mirror::Object* obj) REQUIRES_SHARED(Locks::mutator_lock_) {
+    return RefToRegionUnlocked(obj)->IsPinned();
+  }
+
   // Zero live bytes for a large object, used by young gen CC for marking newly allocated large
   // objects.
   void ZeroLiveBytesForLargeObject(mirror::Object* obj) REQUIRES_SHARED(Locks::mutator_lock_);
@@ -327,6 +347,10 @@ class RegionSpace final : public ContinuousMemMapAllocSpace {
 
   template<bool kToSpaceOnly, typename Visitor>
   ALWAYS_INLINE void WalkInternal(Visitor&& visitor) NO_THREAD_SAFETY_ANALYSIS;
+  template<bool kToSpaceOnly, typename Visitor>
+  ALWAYS_INLINE void WalkRegionsInternal(size_t first_region,
+                                         size_t last_region,
+                                         Visitor&& visitor) NO_THREAD_SAFETY_ANALYSIS;
 
   class Region {
    public:
@@ -339,6 +363,7 @@ class RegionSpace final : public ContinuousMemMapAllocSpace {
           end_(nullptr),
           objects_allocated_(0),
           alloc_time_(0),
+          pin_count_(0),
           is_newly_allocated_(false),
           is_a_tlab_(false),
           state_(RegionState::kRegionStateAllocated),
@@ -354,6 +379,7 @@ class RegionSpace final : public ContinuousMemMapAllocSpace {
       objects_allocated_.store(0, std::memory_order_relaxed);
       alloc_time_ = 0;
       live_bytes_ = static_cast<size_t>(-1);
+      pin_count_.store(0, std::memory_order_relaxed);
       is_newly_allocated_ = false;
       is_a_tlab_ = false;
       thread_ = nullptr;
@@ -456,6 +482,21 @@ class RegionSpace final : public ContinuousMemMapAllocSpace {
       return type_ == RegionType::kRegionTypeNone;
     }
 
+    // Pins are taken and released by runnable mutators while the evacuation decision is made in
+    // the flip pause, so the suspension provides the ordering and relaxed accesses are enough.
+    void Pin() {
+      pin_count_.fetch_add(1u, std::memory_order_relaxed);
+    }
+
+    void Unpin() {
+      uint32_t old_pin_count = pin_count_.fetch_sub(1u, std::memory_order_relaxed);
+      DCHECK_NE(old_pin_count, 0u);
+    }
+
+    bool IsPinned() const {
+      return pin_count_.load(std::memory_order_relaxed) != 0u;
+    }
+
     // Set this region as evacuated from-space. At the end of the
     // collection, RegionSpace::ClearFromSpace will clear and reclaim
     // the space used by this region, and tag it as unallocated/free.
@@ -488,10 +529,10 @@ class RegionSpace final : public ContinuousMemMapAllocSpace {
       type_ = RegionType::kRegionTypeUnevacFromSpace;
       if (IsNewlyAllocated()) {
         // A newly allocated region set as unevac from-space must be
-        // a large or large tail region.
-        DCHECK(IsLarge() || IsLargeTail()) << static_cast<uint>(state_);
-        // Always clear the live bytes of a newly allocated (large or
-        // large tail) region.
+        // a large or large tail region, or pinned.
+        DCHECK(IsLarge() || IsLargeTail() || IsPinned()) << static_cast<uint>(state_);
+        // Always clear the live bytes of a newly allocated (large,
+        // large tail or pinned) region.
         clear_live_bytes = true;
         // Clear the "newly allocated" status here, as we do not want the
         // GC to see it when encountering (and processing) references in the
@@ -586,6 +627,7 @@ class RegionSpace final : public ContinuousMemMapAllocSpace {
     // are concurrent updates.
     Atomic<size_t> objects_allocated_;  // The number of objects allocated.
     uint32_t alloc_time_;               // The allocation time of the region.
+    Atomic<uint32_t> pin_count_;        // Number of JNI critical sections holding the region.
     // Note that newly allocated and evacuated regions use -1 as
     // special value for `live_bytes_`.
     bool is_newly_allocated_;           // True if it's allocated after the last collection.
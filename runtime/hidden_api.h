@@ -19,11 +19,13 @@
 
 #include "art_field-inl.h"
 #include "art_method-inl.h"
+#include "base/bit_utils.h"
 #include "base/mutex.h"
 #include "dex/hidden_api_access_flags.h"
 #include "mirror/class-inl.h"
 #include "reflection.h"
 #include "runtime.h"
+#include "thread-current-inl.h"
 
 namespace art {
 namespace hiddenapi {
@@ -111,6 +113,61 @@ class ScopedHiddenApiEnforcementPolicySetting {
   DISALLOW_COPY_AND_ASSIGN(ScopedHiddenApiEnforcementPolicySetting);
 };
 
+// Caches the actions for hidden members accessed by untrusted callers. The action for an untrusted
+// caller only depends on the member and the runtime's hidden API settings, so entries are tagged
+// with Runtime::GetHiddenApiSettingsGeneration() and dropped once the settings change. Each thread
+// has its own cache, see Thread::GetHiddenApiMemberActionCache(), so it needs no locking.
+class MemberActionCache {
+ public:
+  MemberActionCache() {}
+
+  // Returns true and sets `action` if there is an entry for `key` in `generation`.
+  bool Lookup(uintptr_t key, uint32_t generation, /*out*/ Action* action) const {
+    const Entry& entry = entries_[IndexFor(key)];
+    if (entry.key != key || entry.generation != generation) {
+      return false;
+    }
+    *action = entry.action;
+    return true;
+  }
+
+  // Records `action` for `key`, replacing whatever entry `key` collides with.
+  void Insert(uintptr_t key, uint32_t generation, Action action) {
+    Entry& entry = entries_[IndexFor(key)];
+    entry.key = key;
+    entry.generation = generation;
+    entry.action = action;
+  }
+
+  // Returns the cache key for accessing `member` with `access_method`. Internal checks that do
+  // not warn are kept apart from actual accesses, which warn the first time.
+  template<typename T>
+  static uintptr_t KeyFor(T* member, AccessMethod access_method) {
+    static_assert(alignof(T) >= 2u, "Need a free bit in member pointers");
+    return reinterpret_cast<uintptr_t>(member) | (access_method == kNone ? 1u : 0u);
+  }
+
+ private:
+  // Direct-mapped, a scan of all hidden members simply keeps replacing entries.
+  static constexpr size_t kNumEntries = 256u;
+  static_assert(IsPowerOfTwo(kNumEntries), "kNumEntries must be a power of two");
+
+  struct Entry {
+    uintptr_t key = 0u;  // Never a valid key, members are not null.
+    uint32_t generation = 0u;
+    Action action = kAllow;
+  };
+
+  static size_t IndexFor(uintptr_t key) {
+    // Members are at least 4-byte aligned, keep the kNone bit and mix in higher bits.
+    return (key ^ (key >> 9)) & (kNumEntries - 1u);
+  }
+
+  Entry entries_[kNumEntries];
+
+  DISALLOW_COPY_AND_ASSIGN(MemberActionCache);
+};
+
 // Implementation details. DO NOT ACCESS DIRECTLY.
 namespace detail {
 
@@ -216,15 +273,36 @@ inline Action GetMemberAction(T* member,
     return action;
   }
 
-  // Member is hidden. Invoke `fn_caller_in_platform` and find the origin of the access.
-  // This can be *very* expensive. Save it for last.
+  // Member is hidden. Look for an earlier decision before finding the origin of the access. An
+  // exempted member is allowed for every caller, so a cached kAllow needs no caller at all.
+  MemberActionCache* cache = Thread::Current()->GetHiddenApiMemberActionCache();
+  const uintptr_t key = MemberActionCache::KeyFor(member, access_method);
+  const uint32_t generation = Runtime::Current()->GetHiddenApiSettingsGeneration();
+  Action cached_action;
+  const bool is_cached = cache->Lookup(key, generation, &cached_action);
+  if (is_cached && cached_action == kAllow) {
+    return kAllow;
+  }
+
+  // Invoke `fn_caller_is_trusted` and find the origin of the access. This can be *very*
+  // expensive. Save it for last.
   if (fn_caller_is_trusted(self)) {
     // Caller is trusted. Exit.
     return kAllow;
   }
 
   // Member is hidden and caller is not in the platform.
-  return detail::GetMemberActionImpl(member, api_list, action, access_method);
+  if (is_cached) {
+    return cached_action;
+  }
+
+  action = detail::GetMemberActionImpl(member, api_list, action, access_method);
+  // Only remember decisions that have no side effects to repeat. Actual accesses that are not
+  // allowed outright warn and are sampled into the event log every time.
+  if (action == kAllow || access_method == kNone) {
+    cache->Insert(key, generation, action);
+  }
+  return action;
 }
 
 inline bool IsCallerTrusted(ObjPtr<mirror::Class> caller) REQUIRES_SHARED(Locks::mutator_lock_) {
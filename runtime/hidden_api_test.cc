@@ -24,6 +24,7 @@ namespace art {
 
 using hiddenapi::detail::MemberSignature;
 using hiddenapi::GetActionFromAccessFlags;
+using hiddenapi::MemberActionCache;
 
 class HiddenApiTest : public CommonRuntimeTest {
  protected:
@@ -125,6 +126,51 @@ TEST_F(HiddenApiTest, CheckGetActionFromRuntimeFlags) {
             hiddenapi::kDeny);
 }
 
+TEST_F(HiddenApiTest, CheckMemberActionCache) {
+  MemberActionCache cache;
+  hiddenapi::Action action;
+  const uintptr_t method_key = MemberActionCache::KeyFor(class1_method1_, hiddenapi::kReflection);
+  const uintptr_t field_key = MemberActionCache::KeyFor(class1_field1_, hiddenapi::kJNI);
+  ASSERT_NE(method_key, MemberActionCache::KeyFor(class1_method1_, hiddenapi::kNone));
+
+  ASSERT_FALSE(cache.Lookup(method_key, 1u, &action));
+  cache.Insert(method_key, 1u, hiddenapi::kDeny);
+  ASSERT_TRUE(cache.Lookup(method_key, 1u, &action));
+  ASSERT_EQ(action, hiddenapi::kDeny);
+
+  // Entries of older generations are not found.
+  ASSERT_FALSE(cache.Lookup(method_key, 2u, &action));
+  cache.Insert(field_key, 2u, hiddenapi::kAllow);
+  ASSERT_TRUE(cache.Lookup(field_key, 2u, &action));
+  ASSERT_EQ(action, hiddenapi::kAllow);
+  ASSERT_FALSE(cache.Lookup(method_key, 2u, &action));
+
+  // Decisions taken with stale settings are never found with the current ones.
+  cache.Insert(method_key, 1u, hiddenapi::kDeny);
+  ASSERT_FALSE(cache.Lookup(method_key, 2u, &action));
+
+  // Internal checks do not share entries with actual accesses of the same member.
+  const uintptr_t internal_key = MemberActionCache::KeyFor(class1_method1_, hiddenapi::kNone);
+  cache.Insert(internal_key, 2u, hiddenapi::kDeny);
+  ASSERT_TRUE(cache.Lookup(internal_key, 2u, &action));
+  ASSERT_EQ(action, hiddenapi::kDeny);
+  ASSERT_FALSE(cache.Lookup(method_key, 2u, &action));
+}
+
+TEST_F(HiddenApiTest, CheckSettingsInvalidateDecisions) {
+  uint32_t generation = runtime_->GetHiddenApiSettingsGeneration();
+  runtime_->SetHiddenApiEnforcementPolicy(hiddenapi::EnforcementPolicy::kBlacklistOnly);
+  ASSERT_NE(generation, runtime_->GetHiddenApiSettingsGeneration());
+
+  generation = runtime_->GetHiddenApiSettingsGeneration();
+  runtime_->SetHiddenApiExemptions({"Lmypackage/packagea/Class1;"});
+  ASSERT_NE(generation, runtime_->GetHiddenApiSettingsGeneration());
+
+  generation = runtime_->GetHiddenApiSettingsGeneration();
+  runtime_->SetDedupeHiddenApiWarnings(false);
+  ASSERT_NE(generation, runtime_->GetHiddenApiSettingsGeneration());
+}
+
 TEST_F(HiddenApiTest, CheckMembersRead) {
   ASSERT_NE(nullptr, class1_field1_);
   ASSERT_NE(nullptr, class1_field12_);
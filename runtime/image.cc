@@ -26,7 +26,7 @@
 namespace art {
 
 const uint8_t ImageHeader::kImageMagic[] = { 'a', 'r', 't', '\n' };
-const uint8_t ImageHeader::kImageVersion[] = { '0', '6', '4', '\0' };  // Remove PIC flags.
+const uint8_t ImageHeader::kImageVersion[] = { '0', '6', '6', '\0' };  // Box class roots.
 
 ImageHeader::ImageHeader(uint32_t image_begin,
                          uint32_t image_size,
@@ -56,7 +56,7 @@ inline bool IndirectReferenceTable::GetChecked(IndirectRef iref) const {
     AbortIfNoCheckJNI(msg);
     return false;
   }
-  if (UNLIKELY(table_[idx].GetReference()->IsNull())) {
+  if (UNLIKELY(GetEntry(idx)->GetReference()->IsNull())) {
     AbortIfNoCheckJNI(android::base::StringPrintf("JNI ERROR (app bug): accessed deleted %s %p",
                                                   GetIndirectRefKindString(kind_),
                                                   iref));
@@ -92,7 +92,7 @@ inline ObjPtr<mirror::Object> IndirectReferenceTable::Get(IndirectRef iref) cons
     return nullptr;
   }
   uint32_t idx = ExtractIndex(iref);
-  ObjPtr<mirror::Object> obj = table_[idx].GetReference()->Read<kReadBarrierOption>();
+  ObjPtr<mirror::Object> obj = GetEntry(idx)->GetReference()->Read<kReadBarrierOption>();
   VerifyObject(obj);
   return obj;
 }
@@ -103,20 +103,16 @@ inline void IndirectReferenceTable::Update(IndirectRef iref, ObjPtr<mirror::Obje
     return;
   }
   uint32_t idx = ExtractIndex(iref);
-  table_[idx].SetReference(obj);
+  GetEntry(idx)->SetReference(obj);
 }
 
 inline void IrtEntry::Add(ObjPtr<mirror::Object> obj) {
-  ++serial_;
-  if (serial_ == kIRTPrevCount) {
-    serial_ = 0;
-  }
-  references_[serial_] = GcRoot<mirror::Object>(obj);
+  serial_ = (serial_ + 1u) & (kIRTSerialCount - 1u);
+  reference_ = GcRoot<mirror::Object>(obj);
 }
 
 inline void IrtEntry::SetReference(ObjPtr<mirror::Object> obj) {
-  DCHECK_LT(serial_, kIRTPrevCount);
-  references_[serial_] = GcRoot<mirror::Object>(obj);
+  reference_ = GcRoot<mirror::Object>(obj);
 }
 
 }  // namespace art
@@ -37,6 +37,7 @@ static constexpr bool kDebugIRT = false;
 
 // Maximum table size we allow.
 static constexpr size_t kMaxTableSizeInBytes = 128 * MB;
+static constexpr size_t kMaxEntries = kMaxTableSizeInBytes / sizeof(IrtEntry);
 
 const char* GetIndirectRefKindString(const IndirectRefKind& kind) {
   switch (kind) {
@@ -68,31 +69,42 @@ IndirectReferenceTable::IndirectReferenceTable(size_t max_count,
                                                ResizableCapacity resizable,
                                                std::string* error_msg)
     : segment_state_(kIRTFirstSegment),
+      chunks_(),
+      first_chunk_entries_(0u),
+      first_chunk_shift_(0u),
       kind_(desired_kind),
-      max_entries_(max_count),
+      max_entries_(0u),
       current_num_holes_(0),
       resizable_(resizable) {
   CHECK(error_msg != nullptr);
   CHECK_NE(desired_kind, kHandleScopeOrInvalid);
 
   // Overflow and maximum check.
-  CHECK_LE(max_count, kMaxTableSizeInBytes / sizeof(IrtEntry));
-
-  const size_t table_bytes = max_count * sizeof(IrtEntry);
-  table_mem_map_ = MemMap::MapAnonymous("indirect ref table",
-                                        /* addr */ nullptr,
-                                        table_bytes,
-                                        PROT_READ | PROT_WRITE,
-                                        /* low_4gb */ false,
-                                        error_msg);
-  if (!table_mem_map_.IsValid() && error_msg->empty()) {
+  CHECK_LE(max_count, kMaxEntries);
+
+  // Later chunks are indexed by the position of the most significant bit of the table index.
+  size_t first_chunk_entries = max_count;
+  if (resizable == ResizableCapacity::kYes) {
+    first_chunk_entries = RoundUpToPowerOfTwo(std::max<size_t>(max_count, 1u));
+    first_chunk_shift_ = WhichPowerOf2(first_chunk_entries);
+  }
+
+  const size_t table_bytes = first_chunk_entries * sizeof(IrtEntry);
+  MemMap map = MemMap::MapAnonymous("indirect ref table",
+                                    /* addr */ nullptr,
+                                    table_bytes,
+                                    PROT_READ | PROT_WRITE,
+                                    /* low_4gb */ false,
+                                    error_msg);
+  if (!map.IsValid() && error_msg->empty()) {
     *error_msg = "Unable to map memory for indirect ref table";
   }
 
-  if (table_mem_map_.IsValid()) {
-    table_ = reinterpret_cast<IrtEntry*>(table_mem_map_.Begin());
-  } else {
-    table_ = nullptr;
+  if (map.IsValid()) {
+    chunks_[0] = reinterpret_cast<IrtEntry*>(map.Begin());
+    chunk_maps_.push_back(std::move(map));
+    first_chunk_entries_ = first_chunk_entries;
+    max_entries_ = first_chunk_entries;
   }
   segment_state_ = kIRTFirstSegment;
   last_known_previous_state_ = kIRTFirstSegment;
@@ -130,7 +142,7 @@ void IndirectReferenceTable::ConstexprChecks() {
 }
 
 bool IndirectReferenceTable::IsValid() const {
-  return table_mem_map_.IsValid();
+  return !chunk_maps_.empty();
 }
 
 // Holes:
@@ -168,10 +180,10 @@ bool IndirectReferenceTable::IsValid() const {
 // equal to the current previous state, and smaller than the current state (top index). The
 // condition is conservative as it adds O(1) overhead to operations on an empty segment.
 
-static size_t CountNullEntries(const IrtEntry* table, size_t from, size_t to) {
+size_t IndirectReferenceTable::CountNullEntries(size_t from, size_t to) const {
   size_t count = 0;
   for (size_t index = from; index != to; ++index) {
-    if (table[index].GetReference()->IsNull()) {
+    if (GetEntry(index)->GetReference()->IsNull()) {
       count++;
     }
   }
@@ -182,7 +194,7 @@ void IndirectReferenceTable::RecoverHoles(IRTSegmentState prev_state) {
   if (last_known_previous_state_.top_index >= segment_state_.top_index ||
       last_known_previous_state_.top_index < prev_state.top_index) {
     const size_t top_index = segment_state_.top_index;
-    size_t count = CountNullEntries(table_, prev_state.top_index, top_index);
+    size_t count = CountNullEntries(prev_state.top_index, top_index);
 
     if (kDebugIRT) {
       LOG(INFO) << "+++ Recovered holes: "
@@ -200,42 +212,45 @@ void IndirectReferenceTable::RecoverHoles(IRTSegmentState prev_state) {
 }
 
 ALWAYS_INLINE
-static inline void CheckHoleCount(IrtEntry* table,
-                                  size_t exp_num_holes,
-                                  IRTSegmentState prev_state,
-                                  IRTSegmentState cur_state) {
+inline void IndirectReferenceTable::CheckHoleCount(IRTSegmentState prev_state) const {
   if (kIsDebugBuild) {
-    size_t count = CountNullEntries(table, prev_state.top_index, cur_state.top_index);
-    CHECK_EQ(exp_num_holes, count) << "prevState=" << prev_state.top_index
-                                   << " topIndex=" << cur_state.top_index;
+    size_t count = CountNullEntries(prev_state.top_index, segment_state_.top_index);
+    CHECK_EQ(current_num_holes_, count) << "prevState=" << prev_state.top_index
+                                        << " topIndex=" << segment_state_.top_index;
   }
 }
 
 bool IndirectReferenceTable::Resize(size_t new_size, std::string* error_msg) {
   CHECK_GT(new_size, max_entries_);
+  DCHECK(resizable_ == ResizableCapacity::kYes);
 
-  constexpr size_t kMaxEntries = kMaxTableSizeInBytes / sizeof(IrtEntry);
   if (new_size > kMaxEntries) {
     *error_msg = android::base::StringPrintf("Requested size exceeds maximum: %zu", new_size);
     return false;
   }
-  // Note: the above check also ensures that there is no overflow below.
-
-  const size_t table_bytes = new_size * sizeof(IrtEntry);
-  MemMap new_map = MemMap::MapAnonymous("indirect ref table",
-                                        /* addr */ nullptr,
-                                        table_bytes,
-                                        PROT_READ | PROT_WRITE,
-                                        /* is_low_4gb */ false,
-                                        error_msg);
-  if (!new_map.IsValid()) {
-    return false;
-  }
 
-  memcpy(new_map.Begin(), table_mem_map_.Begin(), table_mem_map_.Size());
-  table_mem_map_ = std::move(new_map);
-  table_ = reinterpret_cast<IrtEntry*>(table_mem_map_.Begin());
-  max_entries_ = new_size;
+  // Each new chunk doubles the capacity. The existing entries stay where they are, so unlike
+  // reallocating the whole table this does not copy them and touches no more memory than used.
+  while (max_entries_ < new_size) {
+    size_t chunk = chunk_maps_.size();
+    DCHECK_LT(chunk, kMaxChunks);
+    const size_t chunk_entries = ChunkEntries(chunk);
+    DCHECK_EQ(chunk_entries, max_entries_);
+    // The last chunk may exceed the maximum that was requested.
+    const size_t chunk_bytes = chunk_entries * sizeof(IrtEntry);
+    MemMap new_map = MemMap::MapAnonymous("indirect ref table",
+                                          /* addr */ nullptr,
+                                          chunk_bytes,
+                                          PROT_READ | PROT_WRITE,
+                                          /* is_low_4gb */ false,
+                                          error_msg);
+    if (!new_map.IsValid()) {
+      return false;
+    }
+    chunks_[chunk] = reinterpret_cast<IrtEntry*>(new_map.Begin());
+    chunk_maps_.push_back(std::move(new_map));
+    max_entries_ += chunk_entries;
+  }
 
   return true;
 }
@@ -254,7 +269,7 @@ IndirectRef IndirectReferenceTable::Add(IRTSegmentState previous_state,
 
   CHECK(obj != nullptr);
   VerifyObject(obj);
-  DCHECK(table_ != nullptr);
+  DCHECK(IsValid());
 
   if (top_index == max_entries_) {
     if (resizable_ == ResizableCapacity::kNo) {
@@ -290,7 +305,7 @@ IndirectRef IndirectReferenceTable::Add(IRTSegmentState previous_state,
   }
 
   RecoverHoles(previous_state);
-  CheckHoleCount(table_, current_num_holes_, previous_state, segment_state_);
+  CheckHoleCount(previous_state);
 
   // We know there's enough room in the table.  Now we just need to find
   // the right spot.  If there's a hole, find it and fill it; otherwise,
@@ -300,21 +315,20 @@ IndirectRef IndirectReferenceTable::Add(IRTSegmentState previous_state,
   if (current_num_holes_ > 0) {
     DCHECK_GT(top_index, 1U);
     // Find the first hole; likely to be near the end of the list.
-    IrtEntry* p_scan = &table_[top_index - 1];
-    DCHECK(!p_scan->GetReference()->IsNull());
-    --p_scan;
-    while (!p_scan->GetReference()->IsNull()) {
-      DCHECK_GE(p_scan, table_ + previous_state.top_index);
-      --p_scan;
+    index = top_index - 1;
+    DCHECK(!GetEntry(index)->GetReference()->IsNull());
+    --index;
+    while (!GetEntry(index)->GetReference()->IsNull()) {
+      DCHECK_GT(index, previous_state.top_index);
+      --index;
     }
-    index = p_scan - table_;
     current_num_holes_--;
   } else {
     // Add to the end.
     index = top_index++;
     segment_state_.top_index = top_index;
   }
-  table_[index].Add(obj);
+  GetEntry(index)->Add(obj);
   result = ToIndirectRef(index);
   if (kDebugIRT) {
     LOG(INFO) << "+++ added at " << ExtractIndex(result) << " top=" << segment_state_.top_index
@@ -327,7 +341,7 @@ IndirectRef IndirectReferenceTable::Add(IRTSegmentState previous_state,
 
 void IndirectReferenceTable::AssertEmpty() {
   for (size_t i = 0; i < Capacity(); ++i) {
-    if (!table_[i].GetReference()->IsNull()) {
+    if (!GetEntry(i)->GetReference()->IsNull()) {
       LOG(FATAL) << "Internal Error: non-empty local reference table\n"
                  << MutatorLockedDumpable<IndirectReferenceTable>(*this);
       UNREACHABLE();
@@ -354,7 +368,7 @@ bool IndirectReferenceTable::Remove(IRTSegmentState previous_state, IndirectRef
   const uint32_t top_index = segment_state_.top_index;
   const uint32_t bottom_index = previous_state.top_index;
 
-  DCHECK(table_ != nullptr);
+  DCHECK(IsValid());
 
   if (GetIndirectRefKind(iref) == kHandleScopeOrInvalid) {
     auto* self = Thread::Current();
@@ -386,7 +400,7 @@ bool IndirectReferenceTable::Remove(IRTSegmentState previous_state, IndirectRef
   }
 
   RecoverHoles(previous_state);
-  CheckHoleCount(table_, current_num_holes_, previous_state, segment_state_);
+  CheckHoleCount(previous_state);
 
   if (idx == top_index - 1) {
     // Top-most entry.  Scan up and consume holes.
@@ -395,7 +409,7 @@ bool IndirectReferenceTable::Remove(IRTSegmentState previous_state, IndirectRef
       return false;
     }
 
-    *table_[idx].GetReference() = GcRoot<mirror::Object>(nullptr);
+    *GetEntry(idx)->GetReference() = GcRoot<mirror::Object>(nullptr);
     if (current_num_holes_ != 0) {
       uint32_t collapse_top_index = top_index;
       while (--collapse_top_index > bottom_index && current_num_holes_ != 0) {
@@ -403,9 +417,10 @@ bool IndirectReferenceTable::Remove(IRTSegmentState previous_state, IndirectRef
           ScopedObjectAccess soa(Thread::Current());
           LOG(INFO) << "+++ checking for hole at " << collapse_top_index - 1
                     << " (previous_state=" << bottom_index << ") val="
-                    << table_[collapse_top_index - 1].GetReference()->Read<kWithoutReadBarrier>();
+                    << GetEntry(collapse_top_index - 1)->GetReference()
+                           ->Read<kWithoutReadBarrier>();
         }
-        if (!table_[collapse_top_index - 1].GetReference()->IsNull()) {
+        if (!GetEntry(collapse_top_index - 1)->GetReference()->IsNull()) {
           break;
         }
         if (kDebugIRT) {
@@ -415,7 +430,7 @@ bool IndirectReferenceTable::Remove(IRTSegmentState previous_state, IndirectRef
       }
       segment_state_.top_index = collapse_top_index;
 
-      CheckHoleCount(table_, current_num_holes_, previous_state, segment_state_);
+      CheckHoleCount(previous_state);
     } else {
       segment_state_.top_index = top_index - 1;
       if (kDebugIRT) {
@@ -425,7 +440,7 @@ bool IndirectReferenceTable::Remove(IRTSegmentState previous_state, IndirectRef
   } else {
     // Not the top-most entry.  This creates a hole.  We null out the entry to prevent somebody
     // from deleting it twice and screwing up the hole count.
-    if (table_[idx].GetReference()->IsNull()) {
+    if (GetEntry(idx)->GetReference()->IsNull()) {
       LOG(INFO) << "--- WEIRD: removing null entry " << idx;
       return false;
     }
@@ -433,9 +448,9 @@ bool IndirectReferenceTable::Remove(IRTSegmentState previous_state, IndirectRef
       return false;
     }
 
-    *table_[idx].GetReference() = GcRoot<mirror::Object>(nullptr);
+    *GetEntry(idx)->GetReference() = GcRoot<mirror::Object>(nullptr);
     current_num_holes_++;
-    CheckHoleCount(table_, current_num_holes_, previous_state, segment_state_);
+    CheckHoleCount(previous_state);
     if (kDebugIRT) {
       LOG(INFO) << "+++ left hole at " << idx << ", holes=" << current_num_holes_;
     }
@@ -447,9 +462,22 @@ bool IndirectReferenceTable::Remove(IRTSegmentState previous_state, IndirectRef
 void IndirectReferenceTable::Trim() {
   ScopedTrace trace(__PRETTY_FUNCTION__);
   const size_t top_index = Capacity();
-  auto* release_start = AlignUp(reinterpret_cast<uint8_t*>(&table_[top_index]), kPageSize);
-  uint8_t* release_end = table_mem_map_.End();
-  madvise(release_start, release_end - release_start, MADV_DONTNEED);
+  size_t chunk_begin_index = 0u;
+  for (size_t chunk = 0; chunk != chunk_maps_.size(); ++chunk) {
+    const size_t chunk_entries = ChunkEntries(chunk);
+    if (top_index < chunk_begin_index + chunk_entries) {
+      uint8_t* release_start = chunk_maps_[chunk].Begin();
+      if (top_index > chunk_begin_index) {
+        release_start = AlignUp(
+            reinterpret_cast<uint8_t*>(&chunks_[chunk][top_index - chunk_begin_index]), kPageSize);
+      }
+      uint8_t* release_end = chunk_maps_[chunk].End();
+      if (release_start < release_end) {
+        madvise(release_start, release_end - release_start, MADV_DONTNEED);
+      }
+    }
+    chunk_begin_index += chunk_entries;
+  }
 }
 
 void IndirectReferenceTable::VisitRoots(RootVisitor* visitor, const RootInfo& root_info) {
@@ -466,9 +494,9 @@ void IndirectReferenceTable::Dump(std::ostream& os) const {
   os << kind_ << " table dump:\n";
   ReferenceTable::Table entries;
   for (size_t i = 0; i < Capacity(); ++i) {
-    ObjPtr<mirror::Object> obj = table_[i].GetReference()->Read<kWithoutReadBarrier>();
+    ObjPtr<mirror::Object> obj = GetEntry(i)->GetReference()->Read<kWithoutReadBarrier>();
     if (obj != nullptr) {
-      obj = table_[i].GetReference()->Read();
+      obj = GetEntry(i)->GetReference()->Read();
       entries.push_back(GcRoot<mirror::Object>(obj));
     }
   }
@@ -22,6 +22,7 @@
 #include <iosfwd>
 #include <limits>
 #include <string>
+#include <vector>
 
 #include <android-base/logging.h>
 
@@ -149,23 +150,22 @@ struct IRTSegmentState {
 // Use as initial value for "cookie", and when table has only one segment.
 static constexpr IRTSegmentState kIRTFirstSegment = { 0 };
 
-// Try to choose kIRTPrevCount so that sizeof(IrtEntry) is a power of 2.
-// Contains multiple entries but only one active one, this helps us detect use after free errors
-// since the serial stored in the indirect ref wont match.
-static constexpr size_t kIRTPrevCount = kIsDebugBuild ? 7 : 3;
+// Number of serial numbers an entry cycles through. Each reuse of an entry bumps its serial, which
+// is also encoded in the indirect reference, so stale references to a reused entry are detected
+// unless the entry was reused a multiple of kIRTSerialCount times in between.
+static constexpr size_t kIRTSerialCount = kIsDebugBuild ? 8 : 4;
+static_assert(IsPowerOfTwo(kIRTSerialCount), "Unexpected kIRTSerialCount");
 
 class IrtEntry {
  public:
   void Add(ObjPtr<mirror::Object> obj) REQUIRES_SHARED(Locks::mutator_lock_);
 
   GcRoot<mirror::Object>* GetReference() {
-    DCHECK_LT(serial_, kIRTPrevCount);
-    return &references_[serial_];
+    return &reference_;
   }
 
   const GcRoot<mirror::Object>* GetReference() const {
-    DCHECK_LT(serial_, kIRTPrevCount);
-    return &references_[serial_];
+    return &reference_;
   }
 
   uint32_t GetSerial() const {
@@ -176,15 +176,17 @@ class IrtEntry {
 
  private:
   uint32_t serial_;
-  GcRoot<mirror::Object> references_[kIRTPrevCount];
+  GcRoot<mirror::Object> reference_;
 };
-static_assert(sizeof(IrtEntry) == (1 + kIRTPrevCount) * sizeof(uint32_t),
-              "Unexpected sizeof(IrtEntry)");
+static_assert(sizeof(IrtEntry) == 2 * sizeof(uint32_t), "Unexpected sizeof(IrtEntry)");
 static_assert(IsPowerOfTwo(sizeof(IrtEntry)), "Unexpected sizeof(IrtEntry)");
 
+class IndirectReferenceTable;
+
 class IrtIterator {
  public:
-  IrtIterator(IrtEntry* table, size_t i, size_t capacity) REQUIRES_SHARED(Locks::mutator_lock_)
+  IrtIterator(const IndirectReferenceTable* table, size_t i, size_t capacity)
+      REQUIRES_SHARED(Locks::mutator_lock_)
       : table_(table), i_(i), capacity_(capacity) {
     // capacity_ is used in some target; has warning with unused attribute.
     UNUSED(capacity_);
@@ -195,17 +197,15 @@ class IrtIterator {
     return *this;
   }
 
-  GcRoot<mirror::Object>* operator*() REQUIRES_SHARED(Locks::mutator_lock_) {
-    // This does not have a read barrier as this is used to visit roots.
-    return table_[i_].GetReference();
-  }
+  // This does not have a read barrier as this is used to visit roots.
+  GcRoot<mirror::Object>* operator*() REQUIRES_SHARED(Locks::mutator_lock_);
 
   bool equals(const IrtIterator& rhs) const {
     return (i_ == rhs.i_ && table_ == rhs.table_);
   }
 
  private:
-  IrtEntry* const table_;
+  const IndirectReferenceTable* const table_;
   size_t i_;
   const size_t capacity_;
 };
@@ -300,11 +300,11 @@ class IndirectReferenceTable {
 
   // Note IrtIterator does not have a read barrier as it's used to visit roots.
   IrtIterator begin() {
-    return IrtIterator(table_, 0, Capacity());
+    return IrtIterator(this, 0, Capacity());
   }
 
   IrtIterator end() {
-    return IrtIterator(table_, Capacity(), Capacity());
+    return IrtIterator(this, Capacity(), Capacity());
   }
 
   void VisitRoots(RootVisitor* visitor, const RootInfo& root_info)
@@ -332,7 +332,7 @@ class IndirectReferenceTable {
   }
 
  private:
-  static constexpr size_t kSerialBits = MinimumBitsToStore(kIRTPrevCount);
+  static constexpr size_t kSerialBits = WhichPowerOf2(kIRTSerialCount);
   static constexpr uint32_t kShiftedSerialMask = (1u << kSerialBits) - 1;
 
   static constexpr size_t kKindBits = MinimumBitsToStore(
@@ -377,15 +377,34 @@ class IndirectReferenceTable {
 
   IndirectRef ToIndirectRef(uint32_t table_index) const {
     DCHECK_LT(table_index, max_entries_);
-    uint32_t serial = table_[table_index].GetSerial();
+    uint32_t serial = GetEntry(table_index)->GetSerial();
     return reinterpret_cast<IndirectRef>(EncodeIndirectRef(table_index, serial));
   }
 
-  // Resize the backing table. Currently must be larger than the current size.
+  // The entries live in chunks so that growing the table never moves them. The first chunk holds
+  // the initial capacity. For resizable tables that is a power of two and chunk k > 0 holds the
+  // entries [2^(shift + k - 1), 2^(shift + k)), doubling the capacity each time.
+  ALWAYS_INLINE IrtEntry* GetEntry(uint32_t table_index) const {
+    DCHECK_LT(table_index, max_entries_);
+    if (LIKELY(table_index < first_chunk_entries_)) {
+      return &chunks_[0][table_index];
+    }
+    size_t msb = MostSignificantBit(table_index);
+    return &chunks_[msb - first_chunk_shift_ + 1u][table_index - (1u << msb)];
+  }
+
+  size_t ChunkEntries(size_t chunk) const {
+    return (chunk == 0u) ? first_chunk_entries_ : (first_chunk_entries_ << (chunk - 1u));
+  }
+
+  // Add chunks until the table holds at least `new_size` entries.
   bool Resize(size_t new_size, std::string* error_msg);
 
   void RecoverHoles(IRTSegmentState from);
 
+  size_t CountNullEntries(size_t from, size_t to) const;
+  void CheckHoleCount(IRTSegmentState prev_state) const;
+
   // Abort if check_jni is not enabled. Otherwise, just log as an error.
   static void AbortIfNoCheckJNI(const std::string& msg);
 
@@ -396,11 +415,17 @@ class IndirectReferenceTable {
   /// semi-public - read/write by jni down calls.
   IRTSegmentState segment_state_;
 
-  // Mem map where we store the indirect refs.
-  MemMap table_mem_map_;
-  // bottom of the stack. Do not directly access the object references
-  // in this as they are roots. Use Get() that has a read barrier.
-  IrtEntry* table_;
+  // Enough chunks to reach the maximum table size from a single-entry first chunk.
+  static constexpr size_t kMaxChunks = BitSizeOf<uint32_t>();
+
+  // Mem maps where we store the indirect refs, one per chunk.
+  std::vector<MemMap> chunk_maps_;
+  // Beginnings of the chunks. Do not directly access the object references
+  // in these as they are roots. Use Get() that has a read barrier.
+  IrtEntry* chunks_[kMaxChunks];
+  size_t first_chunk_entries_;
+  // log2(first_chunk_entries_) for resizable tables.
+  size_t first_chunk_shift_;
   // bit mask, ORed into all irefs.
   const IndirectRefKind kind_;
 
@@ -416,8 +441,14 @@ class IndirectReferenceTable {
   // Whether the table's capacity may be resized. As there are no locks used, it is the caller's
   // responsibility to ensure thread-safety.
   ResizableCapacity resizable_;
+
+  friend class IrtIterator;
 };
 
+inline GcRoot<mirror::Object>* IrtIterator::operator*() {
+  return table_->GetEntry(i_)->GetReference();
+}
+
 }  // namespace art
 
 #endif  // ART_RUNTIME_INDIRECT_REFERENCE_TABLE_H_
@@ -513,4 +513,57 @@ TEST_F(IndirectReferenceTableTest, Resize) {
   EXPECT_EQ(irt.Capacity(), kTableMax + 1);
 }
 
+TEST_F(IndirectReferenceTableTest, ResizeKeepsReferences) {
+  ScopedObjectAccess soa(Thread::Current());
+  static const size_t kTableInitial = 100;
+  static const size_t kNumRefs = 8 * kTableInitial + 1;
+
+  StackHandleScope<2> hs(soa.Self());
+  Handle<mirror::Class> c = hs.NewHandle(
+      class_linker_->FindSystemClass(soa.Self(), "Ljava/lang/Object;"));
+  ASSERT_TRUE(c != nullptr);
+  Handle<mirror::Object> obj0 = hs.NewHandle(c->AllocObject(soa.Self()));
+  ASSERT_TRUE(obj0 != nullptr);
+
+  std::string error_msg;
+  IndirectReferenceTable irt(kTableInitial,
+                             kLocal,
+                             IndirectReferenceTable::ResizableCapacity::kYes,
+                             &error_msg);
+  ASSERT_TRUE(irt.IsValid()) << error_msg;
+  const IRTSegmentState cookie = kIRTFirstSegment;
+
+  // Grow through several chunks; references added before growing must stay valid.
+  std::vector<IndirectRef> refs;
+  for (size_t i = 0; i != kNumRefs; ++i) {
+    IndirectRef ref = irt.Add(cookie, obj0.Get(), &error_msg);
+    ASSERT_TRUE(ref != nullptr) << error_msg;
+    refs.push_back(ref);
+    EXPECT_OBJ_PTR_EQ(obj0.Get(), irt.Get(refs[0]));
+  }
+  EXPECT_EQ(kNumRefs, irt.Capacity());
+  for (IndirectRef ref : refs) {
+    EXPECT_OBJ_PTR_EQ(obj0.Get(), irt.Get(ref));
+  }
+  size_t visited = 0u;
+  for (GcRoot<mirror::Object>* root : irt) {
+    EXPECT_OBJ_PTR_EQ(obj0.Get(), root->Read());
+    ++visited;
+  }
+  EXPECT_EQ(kNumRefs, visited);
+
+  // Holes in later chunks get filled.
+  ASSERT_TRUE(irt.Remove(cookie, refs[kNumRefs / 2]));
+  IndirectRef ref = irt.Add(cookie, obj0.Get(), &error_msg);
+  ASSERT_TRUE(ref != nullptr) << error_msg;
+  EXPECT_EQ(kNumRefs, irt.Capacity());
+
+  irt.Trim();
+  for (size_t i = kNumRefs; i != 0u; --i) {
+    ASSERT_TRUE(irt.Remove(cookie, (i - 1u == kNumRefs / 2) ? ref : refs[i - 1u]));
+  }
+  EXPECT_EQ(0u, irt.Capacity());
+  EXPECT_TRUE(irt.EnsureFreeCapacity(kNumRefs, &error_msg)) << error_msg;
+}
+
 }  // namespace art
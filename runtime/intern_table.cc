@@ -35,24 +35,45 @@
 namespace art {
 
 InternTable::InternTable()
-    : log_new_roots_(false),
-      weak_intern_condition_("New intern condition", *Locks::intern_table_lock_),
+    : weak_intern_condition_("New intern condition", *Locks::intern_table_lock_),
       weak_root_state_(gc::kWeakRootStateNormal) {
 }
 
+InternTable::Shard::Shard()
+    : lock_("InternTable shard lock", kInternTableShardLock),
+      log_new_roots_(false) {
+}
+
+InternTable::Shard& InternTable::GetShard(ObjPtr<mirror::String> s) {
+  return GetShard(s->GetHashCode());
+}
+
 size_t InternTable::Size() const {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  return strong_interns_.Size() + weak_interns_.Size();
+  return StrongSize() + WeakSize();
 }
 
 size_t InternTable::StrongSize() const {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  return strong_interns_.Size();
+  Thread* const self = Thread::Current();
+  size_t size;
+  {
+    MutexLock mu(self, *Locks::intern_table_lock_);
+    size = image_strong_interns_.Size();
+  }
+  for (const Shard& shard : shards_) {
+    MutexLock mu(self, shard.lock_);
+    size += shard.strong_interns_.Size();
+  }
+  return size;
 }
 
 size_t InternTable::WeakSize() const {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  return weak_interns_.Size();
+  Thread* const self = Thread::Current();
+  size_t size = 0u;
+  for (const Shard& shard : shards_) {
+    MutexLock mu(self, shard.lock_);
+    size += shard.weak_interns_.Size();
+  }
+  return size;
 }
 
 void InternTable::DumpForSigQuit(std::ostream& os) const {
@@ -60,42 +81,59 @@ void InternTable::DumpForSigQuit(std::ostream& os) const {
 }
 
 void InternTable::VisitRoots(RootVisitor* visitor, VisitRootFlags flags) {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
+  Thread* const self = Thread::Current();
   if ((flags & kVisitRootFlagAllRoots) != 0) {
-    strong_interns_.VisitRoots(visitor);
-  } else if ((flags & kVisitRootFlagNewRoots) != 0) {
-    for (auto& root : new_strong_intern_roots_) {
-      ObjPtr<mirror::String> old_ref = root.Read<kWithoutReadBarrier>();
-      root.VisitRoot(visitor, RootInfo(kRootInternedString));
-      ObjPtr<mirror::String> new_ref = root.Read<kWithoutReadBarrier>();
-      if (new_ref != old_ref) {
-        // The GC moved a root in the log. Need to search the strong interns and update the
-        // corresponding object. This is slow, but luckily for us, this may only happen with a
-        // concurrent moving GC.
-        strong_interns_.Remove(old_ref);
-        strong_interns_.Insert(new_ref);
+    MutexLock mu(self, *Locks::intern_table_lock_);
+    image_strong_interns_.VisitRoots(visitor);
+  }
+  for (Shard& shard : shards_) {
+    MutexLock mu(self, shard.lock_);
+    if ((flags & kVisitRootFlagAllRoots) != 0) {
+      shard.strong_interns_.VisitRoots(visitor);
+    } else if ((flags & kVisitRootFlagNewRoots) != 0) {
+      for (auto& root : shard.new_strong_intern_roots_) {
+        ObjPtr<mirror::String> old_ref = root.Read<kWithoutReadBarrier>();
+        root.VisitRoot(visitor, RootInfo(kRootInternedString));
+        ObjPtr<mirror::String> new_ref = root.Read<kWithoutReadBarrier>();
+        if (new_ref != old_ref) {
+          // The GC moved a root in the log. Need to search the strong interns and update the
+          // corresponding object. This is slow, but luckily for us, this may only happen with a
+          // concurrent moving GC. The moved string has the same hash, so it stays in this shard.
+          shard.strong_interns_.Remove(old_ref);
+          shard.strong_interns_.Insert(new_ref);
+        }
       }
     }
-  }
-  if ((flags & kVisitRootFlagClearRootLog) != 0) {
-    new_strong_intern_roots_.clear();
-  }
-  if ((flags & kVisitRootFlagStartLoggingNewRoots) != 0) {
-    log_new_roots_ = true;
-  } else if ((flags & kVisitRootFlagStopLoggingNewRoots) != 0) {
-    log_new_roots_ = false;
+    if ((flags & kVisitRootFlagClearRootLog) != 0) {
+      shard.new_strong_intern_roots_.clear();
+    }
+    if ((flags & kVisitRootFlagStartLoggingNewRoots) != 0) {
+      shard.log_new_roots_ = true;
+    } else if ((flags & kVisitRootFlagStopLoggingNewRoots) != 0) {
+      shard.log_new_roots_ = false;
+    }
   }
   // Note: we deliberately don't visit the weak_interns_ table and the immutable image roots.
 }
 
 ObjPtr<mirror::String> InternTable::LookupWeak(Thread* self, ObjPtr<mirror::String> s) {
-  MutexLock mu(self, *Locks::intern_table_lock_);
-  return LookupWeakLocked(s);
+  Shard& shard = GetShard(s);
+  MutexLock mu(self, shard.lock_);
+  return shard.weak_interns_.Find(s);
+}
+
+ObjPtr<mirror::String> InternTable::LookupImage(ObjPtr<mirror::String> s) {
+  return image_strong_interns_.Find(s);
 }
 
 ObjPtr<mirror::String> InternTable::LookupStrong(Thread* self, ObjPtr<mirror::String> s) {
-  MutexLock mu(self, *Locks::intern_table_lock_);
-  return LookupStrongLocked(s);
+  ObjPtr<mirror::String> image_string = LookupImage(s);
+  if (image_string != nullptr) {
+    return image_string;
+  }
+  Shard& shard = GetShard(s);
+  MutexLock mu(self, shard.lock_);
+  return shard.strong_interns_.Find(s);
 }
 
 ObjPtr<mirror::String> InternTable::LookupStrong(Thread* self,
@@ -105,76 +143,84 @@ ObjPtr<mirror::String> InternTable::LookupStrong(Thread* self,
   Utf8String string(utf16_length,
                     utf8_data,
                     ComputeUtf16HashFromModifiedUtf8(utf8_data, utf16_length));
-  MutexLock mu(self, *Locks::intern_table_lock_);
-  return strong_interns_.Find(string);
-}
-
-ObjPtr<mirror::String> InternTable::LookupWeakLocked(ObjPtr<mirror::String> s) {
-  return weak_interns_.Find(s);
-}
-
-ObjPtr<mirror::String> InternTable::LookupStrongLocked(ObjPtr<mirror::String> s) {
-  return strong_interns_.Find(s);
+  ObjPtr<mirror::String> image_string = image_strong_interns_.Find(string);
+  if (image_string != nullptr) {
+    return image_string;
+  }
+  Shard& shard = GetShard(string.GetHash());
+  MutexLock mu(self, shard.lock_);
+  return shard.strong_interns_.Find(string);
 }
 
 void InternTable::AddNewTable() {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  weak_interns_.AddNewTable();
-  strong_interns_.AddNewTable();
+  Thread* const self = Thread::Current();
+  for (Shard& shard : shards_) {
+    MutexLock mu(self, shard.lock_);
+    shard.weak_interns_.AddNewTable();
+    shard.strong_interns_.AddNewTable();
+  }
 }
 
-ObjPtr<mirror::String> InternTable::InsertStrong(ObjPtr<mirror::String> s) {
+ObjPtr<mirror::String> InternTable::InsertStrong(Shard* shard, ObjPtr<mirror::String> s) {
   Runtime* runtime = Runtime::Current();
   if (runtime->IsActiveTransaction()) {
     runtime->RecordStrongStringInsertion(s);
   }
-  if (log_new_roots_) {
-    new_strong_intern_roots_.push_back(GcRoot<mirror::String>(s));
+  if (shard->log_new_roots_) {
+    shard->new_strong_intern_roots_.push_back(GcRoot<mirror::String>(s));
   }
-  strong_interns_.Insert(s);
+  shard->strong_interns_.Insert(s);
   return s;
 }
 
-ObjPtr<mirror::String> InternTable::InsertWeak(ObjPtr<mirror::String> s) {
+ObjPtr<mirror::String> InternTable::InsertWeak(Shard* shard, ObjPtr<mirror::String> s) {
   Runtime* runtime = Runtime::Current();
   if (runtime->IsActiveTransaction()) {
     runtime->RecordWeakStringInsertion(s);
   }
-  weak_interns_.Insert(s);
+  shard->weak_interns_.Insert(s);
   return s;
 }
 
-void InternTable::RemoveStrong(ObjPtr<mirror::String> s) {
-  strong_interns_.Remove(s);
+void InternTable::RemoveStrong(Shard* shard, ObjPtr<mirror::String> s) {
+  shard->strong_interns_.Remove(s);
 }
 
-void InternTable::RemoveWeak(ObjPtr<mirror::String> s) {
+void InternTable::RemoveWeak(Shard* shard, ObjPtr<mirror::String> s) {
   Runtime* runtime = Runtime::Current();
   if (runtime->IsActiveTransaction()) {
     runtime->RecordWeakStringRemoval(s);
   }
-  weak_interns_.Remove(s);
+  shard->weak_interns_.Remove(s);
 }
 
 // Insert/remove methods used to undo changes made during an aborted transaction.
 ObjPtr<mirror::String> InternTable::InsertStrongFromTransaction(ObjPtr<mirror::String> s) {
   DCHECK(!Runtime::Current()->IsActiveTransaction());
-  return InsertStrong(s);
+  Shard& shard = GetShard(s);
+  MutexLock mu(Thread::Current(), shard.lock_);
+  return InsertStrong(&shard, s);
 }
 
 ObjPtr<mirror::String> InternTable::InsertWeakFromTransaction(ObjPtr<mirror::String> s) {
   DCHECK(!Runtime::Current()->IsActiveTransaction());
-  return InsertWeak(s);
+  Shard& shard = GetShard(s);
+  MutexLock mu(Thread::Current(), shard.lock_);
+  return InsertWeak(&shard, s);
 }
 
 void InternTable::RemoveStrongFromTransaction(ObjPtr<mirror::String> s) {
   DCHECK(!Runtime::Current()->IsActiveTransaction());
-  RemoveStrong(s);
+  Shard& shard = GetShard(s);
+  MutexLock mu(Thread::Current(), shard.lock_);
+  RemoveStrong(&shard, s);
 }
 
 void InternTable::RemoveWeakFromTransaction(ObjPtr<mirror::String> s) {
   DCHECK(!Runtime::Current()->IsActiveTransaction());
-  RemoveWeak(s);
+  Shard& shard = GetShard(s);
+  MutexLock mu(Thread::Current(), shard.lock_);
+  RemoveWeak(&shard, s);
 }
 
 void InternTable::AddImagesStringsToTable(const std::vector<gc::space::ImageSpace*>& image_spaces) {
@@ -195,17 +241,19 @@ void InternTable::BroadcastForNewInterns() {
   weak_intern_condition_.Broadcast(self);
 }
 
-void InternTable::WaitUntilAccessible(Thread* self) {
-  Locks::intern_table_lock_->ExclusiveUnlock(self);
+void InternTable::WaitUntilAccessible(Thread* self, Shard* shard) {
+  shard->lock_.ExclusiveUnlock(self);
   {
     ScopedThreadSuspension sts(self, kWaitingWeakGcRootRead);
     MutexLock mu(self, *Locks::intern_table_lock_);
-    while ((!kUseReadBarrier && weak_root_state_ == gc::kWeakRootStateNoReadsOrWrites) ||
+    while ((!kUseReadBarrier &&
+            weak_root_state_.load(std::memory_order_relaxed) ==
+                gc::kWeakRootStateNoReadsOrWrites) ||
            (kUseReadBarrier && !self->GetWeakRefAccessEnabled())) {
       weak_intern_condition_.Wait(self);
     }
   }
-  Locks::intern_table_lock_->ExclusiveLock(self);
+  shard->lock_.ExclusiveLock(self);
 }
 
 ObjPtr<mirror::String> InternTable::Insert(ObjPtr<mirror::String> s,
@@ -215,7 +263,13 @@ ObjPtr<mirror::String> InternTable::Insert(ObjPtr<mirror::String> s,
     return nullptr;
   }
   Thread* const self = Thread::Current();
-  MutexLock mu(self, *Locks::intern_table_lock_);
+  // The image interns never change, check them before taking any lock.
+  ObjPtr<mirror::String> image_string = LookupImage(s);
+  if (image_string != nullptr) {
+    return image_string;
+  }
+  Shard& shard = GetShard(s);
+  MutexLock mu(self, shard.lock_);
   if (kDebugLocking && !holding_locks) {
     Locks::mutator_lock_->AssertSharedHeld(self);
     CHECK_EQ(2u, self->NumberOfHeldMutexes()) << "may only safely hold the mutator lock";
@@ -223,17 +277,18 @@ ObjPtr<mirror::String> InternTable::Insert(ObjPtr<mirror::String> s,
   while (true) {
     if (holding_locks) {
       if (!kUseReadBarrier) {
-        CHECK_EQ(weak_root_state_, gc::kWeakRootStateNormal);
+        CHECK_EQ(weak_root_state_.load(std::memory_order_relaxed), gc::kWeakRootStateNormal);
       } else {
         CHECK(self->GetWeakRefAccessEnabled());
       }
     }
     // Check the strong table for a match.
-    ObjPtr<mirror::String> strong = LookupStrongLocked(s);
+    ObjPtr<mirror::String> strong = shard.strong_interns_.Find(s);
     if (strong != nullptr) {
       return strong;
     }
-    if ((!kUseReadBarrier && weak_root_state_ != gc::kWeakRootStateNoReadsOrWrites) ||
+    if ((!kUseReadBarrier &&
+         weak_root_state_.load(std::memory_order_relaxed) != gc::kWeakRootStateNoReadsOrWrites) ||
         (kUseReadBarrier && self->GetWeakRefAccessEnabled())) {
       break;
     }
@@ -243,25 +298,25 @@ ObjPtr<mirror::String> InternTable::Insert(ObjPtr<mirror::String> s,
     CHECK(!holding_locks);
     StackHandleScope<1> hs(self);
     auto h = hs.NewHandleWrapper(&s);
-    WaitUntilAccessible(self);
+    WaitUntilAccessible(self, &shard);
   }
   if (!kUseReadBarrier) {
-    CHECK_EQ(weak_root_state_, gc::kWeakRootStateNormal);
+    CHECK_EQ(weak_root_state_.load(std::memory_order_relaxed), gc::kWeakRootStateNormal);
   } else {
     CHECK(self->GetWeakRefAccessEnabled());
   }
   // There is no match in the strong table, check the weak table.
-  ObjPtr<mirror::String> weak = LookupWeakLocked(s);
+  ObjPtr<mirror::String> weak = shard.weak_interns_.Find(s);
   if (weak != nullptr) {
     if (is_strong) {
       // A match was found in the weak table. Promote to the strong table.
-      RemoveWeak(weak);
-      return InsertStrong(weak);
+      RemoveWeak(&shard, weak);
+      return InsertStrong(&shard, weak);
     }
     return weak;
   }
   // No match in the strong table or the weak table. Insert into the strong / weak table.
-  return is_strong ? InsertStrong(s) : InsertWeak(s);
+  return is_strong ? InsertStrong(&shard, s) : InsertWeak(&shard, s);
 }
 
 ObjPtr<mirror::String> InternTable::InternStrong(int32_t utf16_length, const char* utf8_data) {
@@ -299,8 +354,11 @@ bool InternTable::ContainsWeak(ObjPtr<mirror::String> s) {
 }
 
 void InternTable::SweepInternTableWeaks(IsMarkedVisitor* visitor) {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  weak_interns_.SweepWeaks(visitor);
+  Thread* const self = Thread::Current();
+  for (Shard& shard : shards_) {
+    MutexLock mu(self, shard.lock_);
+    shard.weak_interns_.SweepWeaks(visitor);
+  }
 }
 
 size_t InternTable::AddTableFromMemory(const uint8_t* ptr) {
@@ -309,12 +367,21 @@ size_t InternTable::AddTableFromMemory(const uint8_t* ptr) {
 }
 
 size_t InternTable::AddTableFromMemoryLocked(const uint8_t* ptr) {
-  return strong_interns_.AddTableFromMemory(ptr);
+  return image_strong_interns_.AddTableFromMemory(ptr);
 }
 
 size_t InternTable::WriteToMemory(uint8_t* ptr) {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  return strong_interns_.WriteToMemory(ptr);
+  Thread* const self = Thread::Current();
+  MutexLock mu(self, *Locks::intern_table_lock_);
+  // Combine the interns of all shards into a single table. The order of insertion only depends on
+  // the contents of the shards, so sizing with a null ptr and writing produce the same layout.
+  Table combined;
+  image_strong_interns_.AddAllTo(&combined);
+  for (Shard& shard : shards_) {
+    MutexLock mu2(self, shard.lock_);
+    shard.strong_interns_.AddAllTo(&combined);
+  }
+  return combined.WriteToMemory(ptr);
 }
 
 std::size_t InternTable::StringHashEquals::operator()(const GcRoot<mirror::String>& root) const {
@@ -413,7 +480,6 @@ void InternTable::Table::Remove(ObjPtr<mirror::String> s) {
 }
 
 ObjPtr<mirror::String> InternTable::Table::Find(ObjPtr<mirror::String> s) {
-  Locks::intern_table_lock_->AssertHeld(Thread::Current());
   for (UnorderedSet& table : tables_) {
     auto it = table.find(GcRoot<mirror::String>(s));
     if (it != table.end()) {
@@ -424,7 +490,6 @@ ObjPtr<mirror::String> InternTable::Table::Find(ObjPtr<mirror::String> s) {
 }
 
 ObjPtr<mirror::String> InternTable::Table::Find(const Utf8String& string) {
-  Locks::intern_table_lock_->AssertHeld(Thread::Current());
   for (UnorderedSet& table : tables_) {
     auto it = table.find(string);
     if (it != table.end()) {
@@ -434,6 +499,14 @@ ObjPtr<mirror::String> InternTable::Table::Find(const Utf8String& string) {
   return nullptr;
 }
 
+void InternTable::Table::AddAllTo(Table* combined) {
+  for (UnorderedSet& table : tables_) {
+    for (GcRoot<mirror::String>& string : table) {
+      combined->tables_.back().insert(string);
+    }
+  }
+}
+
 void InternTable::Table::AddNewTable() {
   tables_.push_back(UnorderedSet());
 }
@@ -491,7 +564,7 @@ void InternTable::ChangeWeakRootState(gc::WeakRootState new_state) {
 
 void InternTable::ChangeWeakRootStateLocked(gc::WeakRootState new_state) {
   CHECK(!kUseReadBarrier);
-  weak_root_state_ = new_state;
+  weak_root_state_.store(new_state, std::memory_order_relaxed);
   if (new_state != gc::kWeakRootStateNoReadsOrWrites) {
     weak_intern_condition_.Broadcast(Thread::Current());
   }
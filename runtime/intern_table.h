@@ -56,6 +56,9 @@ class Transaction;
  * String.intern. Some code (XML parsers being a prime example) relies on being able to intern
  * arbitrarily many strings for the duration of a parse without permanently increasing the memory
  * footprint.
+ *
+ * Both tables are split into shards by string hash, each with its own lock, so that threads
+ * interning different strings do not contend with each other.
  */
 class InternTable {
  public:
@@ -192,38 +195,32 @@ class InternTable {
                                TrackingAllocator<GcRoot<mirror::String>, kAllocatorTagInternTable>>;
 
   // Table which holds pre zygote and post zygote interned strings. There is one instance for
-  // weak interns and strong interns.
+  // weak interns and strong interns in each shard, and one for the strong interns of the images.
   class Table {
    public:
     Table();
-    ObjPtr<mirror::String> Find(ObjPtr<mirror::String> s) REQUIRES_SHARED(Locks::mutator_lock_)
-        REQUIRES(Locks::intern_table_lock_);
-    ObjPtr<mirror::String> Find(const Utf8String& string) REQUIRES_SHARED(Locks::mutator_lock_)
-        REQUIRES(Locks::intern_table_lock_);
-    void Insert(ObjPtr<mirror::String> s) REQUIRES_SHARED(Locks::mutator_lock_)
-        REQUIRES(Locks::intern_table_lock_);
-    void Remove(ObjPtr<mirror::String> s)
-        REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
-    void VisitRoots(RootVisitor* visitor)
-        REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
-    void SweepWeaks(IsMarkedVisitor* visitor)
-        REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
+    ObjPtr<mirror::String> Find(ObjPtr<mirror::String> s) REQUIRES_SHARED(Locks::mutator_lock_);
+    ObjPtr<mirror::String> Find(const Utf8String& string) REQUIRES_SHARED(Locks::mutator_lock_);
+    void Insert(ObjPtr<mirror::String> s) REQUIRES_SHARED(Locks::mutator_lock_);
+    void Remove(ObjPtr<mirror::String> s) REQUIRES_SHARED(Locks::mutator_lock_);
+    void VisitRoots(RootVisitor* visitor) REQUIRES_SHARED(Locks::mutator_lock_);
+    void SweepWeaks(IsMarkedVisitor* visitor) REQUIRES_SHARED(Locks::mutator_lock_);
     // Add a new intern table that will only be inserted into from now on.
-    void AddNewTable() REQUIRES(Locks::intern_table_lock_);
-    size_t Size() const REQUIRES(Locks::intern_table_lock_);
+    void AddNewTable();
+    size_t Size() const;
+    // Insert all of the interns of this table into the last table of 'combined'.
+    void AddAllTo(Table* combined) REQUIRES_SHARED(Locks::mutator_lock_);
     // Read and add an intern table from ptr.
     // Tables read are inserted at the front of the table array. Only checks for conflicts in
     // debug builds. Returns how many bytes were read.
-    size_t AddTableFromMemory(const uint8_t* ptr)
-        REQUIRES(Locks::intern_table_lock_) REQUIRES_SHARED(Locks::mutator_lock_);
+    size_t AddTableFromMemory(const uint8_t* ptr) REQUIRES_SHARED(Locks::mutator_lock_);
     // Write the intern tables to ptr, if there are multiple tables they are combined into a single
     // one. Returns how many bytes were written.
-    size_t WriteToMemory(uint8_t* ptr)
-        REQUIRES(Locks::intern_table_lock_) REQUIRES_SHARED(Locks::mutator_lock_);
+    size_t WriteToMemory(uint8_t* ptr) REQUIRES_SHARED(Locks::mutator_lock_);
 
    private:
     void SweepWeaks(UnorderedSet* set, IsMarkedVisitor* visitor)
-        REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
+        REQUIRES_SHARED(Locks::mutator_lock_);
 
     // We call AddNewTable when we create the zygote to reduce private dirty pages caused by
     // modifying the zygote intern table. The back of table is modified when strings are interned.
@@ -233,34 +230,61 @@ class InternTable {
     ART_FRIEND_TEST(InternTableTest, CrossHash);
   };
 
+  // The interns of a string are always in the shard selected by its hash, so that a single lock
+  // guards both looking it up and moving it from the weak to the strong table.
+  struct Shard {
+    Shard();
+
+    mutable Mutex lock_;
+    // Since this contains (strong) roots, they need a read barrier to
+    // enable concurrent intern table (strong) root scan. Do not
+    // directly access the strings in it. Use functions that contain
+    // read barriers.
+    Table strong_interns_ GUARDED_BY(lock_);
+    std::vector<GcRoot<mirror::String>> new_strong_intern_roots_ GUARDED_BY(lock_);
+    bool log_new_roots_ GUARDED_BY(lock_);
+    // Since this contains (weak) roots, they need a read barrier. Do
+    // not directly access the strings in it. Use functions that contain
+    // read barriers.
+    Table weak_interns_ GUARDED_BY(lock_);
+  };
+
+  static constexpr size_t kShardBits = 4u;
+  static constexpr size_t kNumShards = 1u << kShardBits;
+
+  Shard& GetShard(int32_t hash) {
+    // Use the high bits of a multiplicative hash, the sets of a shard already use the string hash
+    // to pick buckets.
+    return shards_[(static_cast<uint32_t>(hash) * 0x9e3779b9u) >> (32u - kShardBits)];
+  }
+  Shard& GetShard(ObjPtr<mirror::String> s) REQUIRES_SHARED(Locks::mutator_lock_);
+
   // Insert if non null, otherwise return null. Must be called holding the mutator lock.
   // If holding_locks is true, then we may also hold other locks. If holding_locks is true, then we
   // require GC is not running since it is not safe to wait while holding locks.
   ObjPtr<mirror::String> Insert(ObjPtr<mirror::String> s, bool is_strong, bool holding_locks)
       REQUIRES(!Locks::intern_table_lock_) REQUIRES_SHARED(Locks::mutator_lock_);
 
-  ObjPtr<mirror::String> LookupStrongLocked(ObjPtr<mirror::String> s)
-      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
-  ObjPtr<mirror::String> LookupWeakLocked(ObjPtr<mirror::String> s)
-      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
-  ObjPtr<mirror::String> InsertStrong(ObjPtr<mirror::String> s)
-      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
-  ObjPtr<mirror::String> InsertWeak(ObjPtr<mirror::String> s)
-      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
-  void RemoveStrong(ObjPtr<mirror::String> s)
-      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
-  void RemoveWeak(ObjPtr<mirror::String> s)
-      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
+  ObjPtr<mirror::String> LookupImage(ObjPtr<mirror::String> s)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+  ObjPtr<mirror::String> InsertStrong(Shard* shard, ObjPtr<mirror::String> s)
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(shard->lock_);
+  ObjPtr<mirror::String> InsertWeak(Shard* shard, ObjPtr<mirror::String> s)
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(shard->lock_);
+  void RemoveStrong(Shard* shard, ObjPtr<mirror::String> s)
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(shard->lock_);
+  void RemoveWeak(Shard* shard, ObjPtr<mirror::String> s)
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(shard->lock_);
 
   // Transaction rollback access.
   ObjPtr<mirror::String> InsertStrongFromTransaction(ObjPtr<mirror::String> s)
-      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
+      REQUIRES_SHARED(Locks::mutator_lock_);
   ObjPtr<mirror::String> InsertWeakFromTransaction(ObjPtr<mirror::String> s)
-      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
+      REQUIRES_SHARED(Locks::mutator_lock_);
   void RemoveStrongFromTransaction(ObjPtr<mirror::String> s)
-      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
+      REQUIRES_SHARED(Locks::mutator_lock_);
   void RemoveWeakFromTransaction(ObjPtr<mirror::String> s)
-      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
+      REQUIRES_SHARED(Locks::mutator_lock_);
 
   size_t AddTableFromMemoryLocked(const uint8_t* ptr)
       REQUIRES(Locks::intern_table_lock_) REQUIRES_SHARED(Locks::mutator_lock_);
@@ -269,25 +293,21 @@ class InternTable {
   void ChangeWeakRootStateLocked(gc::WeakRootState new_state)
       REQUIRES(Locks::intern_table_lock_);
 
-  // Wait until we can read weak roots.
-  void WaitUntilAccessible(Thread* self)
-      REQUIRES(Locks::intern_table_lock_) REQUIRES_SHARED(Locks::mutator_lock_);
+  // Wait until we can read weak roots. Releases the shard lock while waiting.
+  void WaitUntilAccessible(Thread* self, Shard* shard)
+      REQUIRES(shard->lock_) REQUIRES(!Locks::intern_table_lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
 
-  bool log_new_roots_ GUARDED_BY(Locks::intern_table_lock_);
+  // Signalled when weak interns become accessible again.
   ConditionVariable weak_intern_condition_ GUARDED_BY(Locks::intern_table_lock_);
-  // Since this contains (strong) roots, they need a read barrier to
-  // enable concurrent intern table (strong) root scan. Do not
-  // directly access the strings in it. Use functions that contain
-  // read barriers.
-  Table strong_interns_ GUARDED_BY(Locks::intern_table_lock_);
-  std::vector<GcRoot<mirror::String>> new_strong_intern_roots_
-      GUARDED_BY(Locks::intern_table_lock_);
-  // Since this contains (weak) roots, they need a read barrier. Do
-  // not directly access the strings in it. Use functions that contain
-  // read barriers.
-  Table weak_interns_ GUARDED_BY(Locks::intern_table_lock_);
-  // Weak root state, used for concurrent system weak processing and more.
-  gc::WeakRootState weak_root_state_ GUARDED_BY(Locks::intern_table_lock_);
+  // Strong interns of the boot images. They are only added before the table is used by other
+  // threads and never modified afterwards, so they are read without holding any lock.
+  Table image_strong_interns_;
+  Shard shards_[kNumShards];
+  // Weak root state, used for concurrent system weak processing and more. Only written while
+  // holding Locks::intern_table_lock_ but read without it when interning. The switch to
+  // gc::kWeakRootStateNoReadsOrWrites happens in a pause, so no intern can be in progress then.
+  Atomic<gc::WeakRootState> weak_root_state_;
 
   friend class gc::space::ImageSpace;
   friend class linker::ImageWriter;
@@ -24,6 +24,7 @@
 #include "mirror/object.h"
 #include "mirror/string.h"
 #include "scoped_thread_state_change-inl.h"
+#include "thread_pool.h"
 
 namespace art {
 
@@ -77,8 +78,9 @@ TEST_F(InternTableTest, CrossHash) {
   // A string that has a negative hash value.
   GcRoot<mirror::String> str(mirror::String::AllocFromModifiedUtf8(soa.Self(), "00000000"));
 
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  for (InternTable::UnorderedSet& table : t.strong_interns_.tables_) {
+  InternTable::Shard& shard = t.GetShard(str.Read());
+  MutexLock mu(Thread::Current(), shard.lock_);
+  for (InternTable::UnorderedSet& table : shard.strong_interns_.tables_) {
     // The negative hash value shall be 32-bit wide on every host.
     ASSERT_TRUE(IsUint<32>(table.hashfn_(str)));
   }
@@ -234,4 +236,31 @@ TEST_F(InternTableTest, LookupStrong) {
   EXPECT_TRUE(lookup_foobbS == nullptr);
 }
 
+TEST_F(InternTableTest, ConcurrentInternStrong) {
+  static constexpr size_t kNumThreads = 4u;
+  static constexpr size_t kNumStrings = 1000u;
+  static constexpr size_t kNumRounds = 4u;
+  InternTable intern_table;
+  Thread* self = Thread::Current();
+  ThreadPool thread_pool("Intern table test thread pool", kNumThreads - 1u);
+  Atomic<size_t> num_mismatches(0u);
+  // Every thread interns every string, so that the same strings race for the same shards.
+  thread_pool.ParallelFor(self, 0u, kNumThreads * kNumRounds, /* grain */ 1u, kNumThreads,
+                          [&](size_t) {
+    Thread* current = Thread::Current();
+    ScopedObjectAccess soa(current);
+    for (size_t i = 0; i != kNumStrings; ++i) {
+      std::string utf8 = "string" + std::to_string(i);
+      ObjPtr<mirror::String> interned = intern_table.InternStrong(utf8.length(), utf8.c_str());
+      if (interned == nullptr ||
+          interned != intern_table.LookupStrong(current, utf8.length(), utf8.c_str())) {
+        num_mismatches.fetch_add(1u, std::memory_order_relaxed);
+      }
+    }
+  });
+  EXPECT_EQ(0u, num_mismatches.load(std::memory_order_relaxed));
+  EXPECT_EQ(kNumStrings, intern_table.StrongSize());
+  EXPECT_EQ(0u, intern_table.WeakSize());
+}
+
 }  // namespace art
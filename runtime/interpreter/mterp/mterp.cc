@@ -654,6 +654,8 @@ extern "C" void MterpLogSuspendFallback(Thread* self, ShadowFrame* shadow_frame,
     LOG(INFO) << "Suspend fallback: " << inst->Opcode(inst_data);
   } else if (flags & kEmptyCheckpointRequest) {
     LOG(INFO) << "Empty checkpoint fallback: " << inst->Opcode(inst_data);
+  } else if (flags & kHandshakeRequest) {
+    LOG(INFO) << "Handshake fallback: " << inst->Opcode(inst_data);
   }
 }
 
@@ -710,7 +710,10 @@ void Jit::AddSamples(Thread* self, ArtMethod* method, uint16_t count, bool with_
       DCHECK(!method->IsNative());  // No back edges reported for native methods.
       if ((new_count >= OSRMethodThreshold()) &&  !code_cache_->IsOsrCompiled(method)) {
         DCHECK(thread_pool_ != nullptr);
-        thread_pool_->AddTask(self, new JitCompileTask(method, JitCompileTask::kCompileOsr));
+        // The method is stuck in a hot loop, compile it before queued regular compilations.
+        thread_pool_->AddTask(self,
+                              new JitCompileTask(method, JitCompileTask::kCompileOsr),
+                              TaskPriority::kHigh);
       }
     }
   }
@@ -39,6 +39,9 @@
 #include "fault_handler.h"
 #include "hidden_api.h"
 #include "gc/accounting/card_table-inl.h"
+#include "gc/space/image_space.h"
+#include "gc/space/malloc_space.h"
+#include "gc/space/region_space.h"
 #include "gc_root.h"
 #include "indirect_reference_table-inl.h"
 #include "interpreter/interpreter.h"
@@ -1811,9 +1814,7 @@ class JNI {
     } else {
       CHECK_NON_NULL_MEMCPY_ARGUMENT(length, buf);
       if (s->IsCompressed()) {
-        for (int i = 0; i < length; ++i) {
-          buf[i] = static_cast<jchar>(s->CharAt(start+i));
-        }
+        ConvertAsciiToUtf16(buf, s->GetValueCompressed() + start, length);
       } else {
         const jchar* chars = static_cast<jchar*>(s->GetValue());
         memcpy(buf, chars + start, length * sizeof(jchar));
@@ -1831,9 +1832,7 @@ class JNI {
     } else {
       CHECK_NON_NULL_MEMCPY_ARGUMENT(length, buf);
       if (s->IsCompressed()) {
-        for (int i = 0; i < length; ++i) {
-          buf[i] = s->CharAt(start+i);
-        }
+        memcpy(buf, s->GetValueCompressed() + start, length);
       } else {
         const jchar* chars = s->GetValue();
         size_t bytes = CountUtf8Bytes(chars + start, length);
@@ -1850,10 +1849,7 @@ class JNI {
     if (heap->IsMovableObject(s) || s->IsCompressed()) {
       jchar* chars = new jchar[s->GetLength()];
       if (s->IsCompressed()) {
-        int32_t length = s->GetLength();
-        for (int i = 0; i < length; ++i) {
-          chars[i] = s->CharAt(i);
-        }
+        ConvertAsciiToUtf16(chars, s->GetValueCompressed(), s->GetLength());
       } else {
         memcpy(chars, s->GetValue(), sizeof(jchar) * s->GetLength());
       }
@@ -1882,15 +1878,16 @@ class JNI {
     ScopedObjectAccess soa(env);
     ObjPtr<mirror::String> s = soa.Decode<mirror::String>(java_string);
     gc::Heap* heap = Runtime::Current()->GetHeap();
-    if (heap->IsMovableObject(s)) {
-      StackHandleScope<1> hs(soa.Self());
-      HandleWrapperObjPtr<mirror::String> h(hs.NewHandleWrapper(&s));
+    // Compressed strings are returned as a copy and don't need to stay in place.
+    if (!s->IsCompressed() && heap->IsMovableObject(s)) {
       if (!kUseReadBarrier) {
+        StackHandleScope<1> hs(soa.Self());
+        HandleWrapperObjPtr<mirror::String> h(hs.NewHandleWrapper(&s));
         heap->IncrementDisableMovingGC(soa.Self());
       } else {
-        // For the CC collector, we only need to wait for the thread flip rather than the whole GC
-        // to occur thanks to the to-space invariant.
-        heap->IncrementDisableThreadFlip(soa.Self());
+        // For the CC collector, we only need to keep the region holding the string from being
+        // evacuated. The decoded reference is a to-space one thanks to the to-space invariant.
+        heap->PinObject(s);
       }
     }
     if (s->IsCompressed()) {
@@ -1899,9 +1896,7 @@ class JNI {
       }
       int32_t length = s->GetLength();
       jchar* chars = new jchar[length];
-      for (int i = 0; i < length; ++i) {
-        chars[i] = s->CharAt(i);
-      }
+      ConvertAsciiToUtf16(chars, s->GetValueCompressed(), length);
       return chars;
     } else {
       if (is_copy != nullptr) {
@@ -1918,11 +1913,11 @@ class JNI {
     ScopedObjectAccess soa(env);
     gc::Heap* heap = Runtime::Current()->GetHeap();
     ObjPtr<mirror::String> s = soa.Decode<mirror::String>(java_string);
-    if (heap->IsMovableObject(s)) {
+    if (!s->IsCompressed() && heap->IsMovableObject(s)) {
       if (!kUseReadBarrier) {
         heap->DecrementDisableMovingGC(soa.Self());
       } else {
-        heap->DecrementDisableThreadFlip(soa.Self());
+        heap->UnpinObject(s);
       }
     }
     if (s->IsCompressed() || (s->IsCompressed() == false && s->GetValue() != chars)) {
@@ -1930,22 +1925,63 @@ class JNI {
     }
   }
 
+  // Compressed string data handed out in place by GetStringUTFChars() comes from a pinned
+  // region of the region space, from the boot image or, with the CC collector, from the
+  // non-moving space. The bounds of these spaces are fixed for the lifetime of the heap, so
+  // ReleaseStringUTFChars() can tell in-place data from a copy by its address alone. Other
+  // collectors may turn the main space into the non-moving space, so strings are copied there.
+  static bool IsPinnableStringData(gc::Heap* heap, const void* data) {
+    gc::space::RegionSpace* region_space = heap->GetRegionSpace();
+    return kUseReadBarrier &&
+        region_space != nullptr &&
+        region_space->HasAddress(reinterpret_cast<const mirror::Object*>(data));
+  }
+
+  static bool IsImmovableStringData(gc::Heap* heap, const void* data) {
+    const mirror::Object* obj = reinterpret_cast<const mirror::Object*>(data);
+    for (gc::space::ImageSpace* space : heap->GetBootImageSpaces()) {
+      if (space->HasAddress(obj)) {
+        return true;
+      }
+    }
+    gc::space::MallocSpace* non_moving_space = heap->GetNonMovingSpace();
+    return kUseReadBarrier && non_moving_space != nullptr && non_moving_space->HasAddress(obj);
+  }
+
   static const char* GetStringUTFChars(JNIEnv* env, jstring java_string, jboolean* is_copy) {
     if (java_string == nullptr) {
       return nullptr;
     }
+    ScopedObjectAccess soa(env);
+    ObjPtr<mirror::String> s = soa.Decode<mirror::String>(java_string);
+    gc::Heap* heap = Runtime::Current()->GetHeap();
+    if (s->IsCompressed()) {
+      // Compressed strings are zero-terminated ASCII, which is already modified UTF-8, so the
+      // string data can be handed out directly if it stays in place until the release. With the
+      // CC collector, pin the region holding the string rather than copying it.
+      bool in_place = false;
+      if (IsPinnableStringData(heap, s.Ptr())) {
+        heap->PinObject(s);
+        in_place = true;
+      } else if (!heap->IsMovableObject(s) && IsImmovableStringData(heap, s.Ptr())) {
+        in_place = true;
+      }
+      if (in_place) {
+        if (is_copy != nullptr) {
+          *is_copy = JNI_FALSE;
+        }
+        DCHECK_EQ(s->GetValueCompressed()[s->GetLength()], 0u);
+        return reinterpret_cast<const char*>(s->GetValueCompressed());
+      }
+    }
     if (is_copy != nullptr) {
       *is_copy = JNI_TRUE;
     }
-    ScopedObjectAccess soa(env);
-    ObjPtr<mirror::String> s = soa.Decode<mirror::String>(java_string);
     size_t byte_count = s->GetUtfLength();
     char* bytes = new char[byte_count + 1];
     CHECK(bytes != nullptr);  // bionic aborts anyway.
     if (s->IsCompressed()) {
-      for (size_t i = 0; i < byte_count; ++i) {
-        bytes[i] = s->CharAt(i);
-      }
+      memcpy(bytes, s->GetValueCompressed(), byte_count);
     } else {
       const uint16_t* chars = s->GetValue();
       ConvertUtf16ToModifiedUtf8(bytes, byte_count, chars, s->GetLength());
@@ -1954,7 +1990,18 @@ class JNI {
     return bytes;
   }
 
-  static void ReleaseStringUTFChars(JNIEnv*, jstring, const char* chars) {
+  static void ReleaseStringUTFChars(JNIEnv* env, jstring java_string, const char* chars) {
+    // Copies are released without a thread state change or decoding the string.
+    gc::Heap* heap = Runtime::Current()->GetHeap();
+    if (java_string != nullptr && IsPinnableStringData(heap, chars)) {
+      ScopedObjectAccess soa(env);
+      const char* obj = chars - mirror::String::ValueOffset().Uint32Value();
+      heap->UnpinObject(reinterpret_cast<mirror::Object*>(const_cast<char*>(obj)));
+      return;
+    }
+    if (java_string != nullptr && IsImmovableStringData(heap, chars)) {
+      return;
+    }
     delete[] chars;
   }
 
@@ -2082,13 +2129,13 @@ class JNI {
     if (heap->IsMovableObject(array)) {
       if (!kUseReadBarrier) {
         heap->IncrementDisableMovingGC(soa.Self());
+        // Re-decode in case the object moved since IncrementDisableGC waits for GC to complete.
+        array = soa.Decode<mirror::Array>(java_array);
       } else {
-        // For the CC collector, we only need to wait for the thread flip rather than the whole GC
-        // to occur thanks to the to-space invariant.
-        heap->IncrementDisableThreadFlip(soa.Self());
+        // For the CC collector, we only need to keep the region holding the array from being
+        // evacuated. The decoded reference is a to-space one thanks to the to-space invariant.
+        heap->PinObject(array);
       }
-      // Re-decode in case the object moved since IncrementDisableGC waits for GC to complete.
-      array = soa.Decode<mirror::Array>(java_array);
     }
     if (is_copy != nullptr) {
       *is_copy = JNI_FALSE;
@@ -2644,11 +2691,12 @@ class JNI {
       if (is_copy) {
         delete[] reinterpret_cast<uint64_t*>(elements);
       } else if (heap->IsMovableObject(array)) {
-        // Non copy to a movable object must means that we had disabled the moving GC.
+        // Non copy to a movable object must means that we had disabled the moving GC or pinned
+        // the object.
         if (!kUseReadBarrier) {
           heap->DecrementDisableMovingGC(soa.Self());
         } else {
-          heap->DecrementDisableThreadFlip(soa.Self());
+          heap->UnpinObject(array);
         }
       }
     }
@@ -1270,6 +1270,28 @@ TEST_F(JniInternalTest, GetReleasePrimitiveArrayCriticalOfWrongType) {
   GetReleasePrimitiveArrayCriticalOfWrongType(true);
 }
 
+TEST_F(JniInternalTest, PrimitiveArrayCriticalPinsRegion) {
+  if (!kUseReadBarrier) {
+    // Other collectors disable moving GC for the critical section, a GC would block.
+    return;
+  }
+  jbyteArray array = env_->NewByteArray(16);
+  ASSERT_NE(array, nullptr);
+  jboolean is_copy = JNI_TRUE;
+  jbyte* elements = static_cast<jbyte*>(env_->GetPrimitiveArrayCritical(array, &is_copy));
+  ASSERT_NE(elements, nullptr);
+  EXPECT_EQ(JNI_FALSE, is_copy);
+  elements[0] = 42;
+  // An explicit GC evacuates every region that is not pinned. It must not wait for the critical
+  // section to end and must not move the array.
+  Runtime::Current()->GetHeap()->CollectGarbage(/* clear_soft_references */ true);
+  jbyte* elements_after_gc = static_cast<jbyte*>(env_->GetPrimitiveArrayCritical(array, nullptr));
+  EXPECT_EQ(elements, elements_after_gc);
+  EXPECT_EQ(42, elements_after_gc[0]);
+  env_->ReleasePrimitiveArrayCritical(array, elements_after_gc, 0);
+  env_->ReleasePrimitiveArrayCritical(array, elements, 0);
+}
+
 TEST_F(JniInternalTest, GetPrimitiveArrayRegionElementsOfWrongType) {
   GetPrimitiveArrayRegionElementsOfWrongType(false);
   GetPrimitiveArrayRegionElementsOfWrongType(true);
@@ -1674,11 +1696,48 @@ TEST_F(JniInternalTest, GetStringUTFChars_ReleaseStringUTFChars) {
   EXPECT_STREQ("hello", utf);
   env_->ReleaseStringUTFChars(s, utf);
 
+  bool movable;
+  {
+    ScopedObjectAccess soa(env_);
+    movable = Runtime::Current()->GetHeap()->IsMovableObject(soa.Decode<mirror::String>(s));
+  }
   jboolean is_copy = JNI_FALSE;
   utf = env_->GetStringUTFChars(s, &is_copy);
-  EXPECT_EQ(JNI_TRUE, is_copy);
+  if (mirror::kUseStringCompression && kUseReadBarrier) {
+    // "hello" is all-ASCII, the compressed data is handed out directly and the region holding
+    // a movable string is pinned until the release.
+    EXPECT_EQ(JNI_FALSE, is_copy);
+    if (kUseReadBarrier && movable) {
+      ScopedObjectAccess soa(env_);
+      EXPECT_TRUE(Runtime::Current()->GetHeap()->GetRegionSpace()->IsPinned(
+          soa.Decode<mirror::String>(s).Ptr()));
+    }
+  } else {
+    EXPECT_EQ(JNI_TRUE, is_copy);
+  }
   EXPECT_STREQ("hello", utf);
   env_->ReleaseStringUTFChars(s, utf);
+  if (kUseReadBarrier && movable) {
+    ScopedObjectAccess soa(env_);
+    EXPECT_FALSE(Runtime::Current()->GetHeap()->GetRegionSpace()->IsPinned(
+        soa.Decode<mirror::String>(s).Ptr()));
+  }
+
+  // The compressed data is zero-terminated even when it fills the object up to its alignment.
+  jstring s_8 = env_->NewStringUTF("01234567");
+  ASSERT_TRUE(s_8 != nullptr);
+  utf = env_->GetStringUTFChars(s_8, nullptr);
+  EXPECT_STREQ("01234567", utf);
+  env_->ReleaseStringUTFChars(s_8, utf);
+
+  // Incompressible strings are always copied.
+  jstring s_16 = env_->NewStringUTF("caf\xc3\xa9");
+  ASSERT_TRUE(s_16 != nullptr);
+  is_copy = JNI_FALSE;
+  utf = env_->GetStringUTFChars(s_16, &is_copy);
+  EXPECT_EQ(JNI_TRUE, is_copy);
+  EXPECT_STREQ("caf\xc3\xa9", utf);
+  env_->ReleaseStringUTFChars(s_16, utf);
 }
 
 TEST_F(JniInternalTest, GetStringChars_ReleaseStringChars) {
@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "native_optimization_list.h"
+
+#include <zlib.h>
+
+#include <sstream>
+
+#include <android-base/file.h>
+#include <android-base/stringprintf.h>
+#include <android-base/strings.h>
+
+#include "dex/dex_file-inl.h"
+#include "dex/dex_file_annotations.h"
+#include "dex/modifiers.h"
+#include "java_vm_ext.h"
+#include "runtime.h"
+
+namespace art {
+
+using android::base::StringPrintf;
+
+std::unique_ptr<NativeOptimizationList> NativeOptimizationList::Create(const std::string& filename,
+                                                                       std::string* error_msg) {
+  std::string contents;
+  if (!android::base::ReadFileToString(filename, &contents)) {
+    *error_msg = StringPrintf("Failed to read native optimization list %s", filename.c_str());
+    return nullptr;
+  }
+  std::unique_ptr<NativeOptimizationList> list = CreateFromString(contents, error_msg);
+  if (list == nullptr) {
+    *error_msg = filename + ": " + *error_msg;
+  }
+  return list;
+}
+
+std::unique_ptr<NativeOptimizationList> NativeOptimizationList::CreateFromString(
+    const std::string& contents,
+    std::string* error_msg) {
+  std::unique_ptr<NativeOptimizationList> list(new NativeOptimizationList());
+  std::istringstream stream(contents);
+  std::string line;
+  for (size_t line_number = 1u; std::getline(stream, line); ++line_number) {
+    line = android::base::Trim(line);
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    size_t comma = line.rfind(',');
+    if (comma == std::string::npos || line.find("->") == std::string::npos) {
+      *error_msg = StringPrintf("Line %zu: expected <method>,fast or <method>,critical",
+                                line_number);
+      return nullptr;
+    }
+    std::string method = line.substr(0u, comma);
+    std::string optimization = line.substr(comma + 1u);
+    uint32_t flags;
+    if (optimization == "fast") {
+      flags = kAccFastNative;
+    } else if (optimization == "critical") {
+      flags = kAccCriticalNative;
+    } else {
+      *error_msg = StringPrintf("Line %zu: unknown optimization '%s'",
+                                line_number,
+                                optimization.c_str());
+      return nullptr;
+    }
+    auto it = list->entries_.emplace(method, flags).first;
+    if (it->second != flags) {
+      *error_msg = StringPrintf("Line %zu: conflicting optimizations for %s",
+                                line_number,
+                                method.c_str());
+      return nullptr;
+    }
+  }
+  uint32_t checksum = adler32(0L, Z_NULL, 0);
+  checksum = adler32(checksum, reinterpret_cast<const Bytef*>(contents.data()), contents.size());
+  list->checksum_ = StringPrintf("%08x", checksum);
+  return list;
+}
+
+uint32_t NativeOptimizationList::GetAccessFlags(const DexFile& dex_file,
+                                                uint32_t method_index,
+                                                uint32_t access_flags,
+                                                std::string* error_msg) const {
+  DCHECK_NE(access_flags & kAccNative, 0u);
+  const DexFile::MethodId& method_id = dex_file.GetMethodId(method_index);
+  std::string method = dex_file.GetMethodDeclaringClassDescriptor(method_id);
+  method += "->";
+  method += dex_file.GetMethodName(method_id);
+  method += dex_file.GetMethodSignature(method_id).ToString();
+  auto it = entries_.find(method);
+  if (it == entries_.end()) {
+    return 0u;
+  }
+  // Same restrictions as for the annotations, see the JNI compiler.
+  if ((access_flags & kAccSynchronized) != 0u) {
+    *error_msg = method + " is synchronized and cannot be @FastNative or @CriticalNative";
+    return 0u;
+  }
+  if (it->second == kAccCriticalNative) {
+    if ((access_flags & kAccStatic) == 0u) {
+      *error_msg = method + " is not static and cannot be @CriticalNative";
+      return 0u;
+    }
+    const char* shorty = dex_file.GetMethodShorty(method_id);
+    if (strchr(shorty, 'L') != nullptr) {
+      *error_msg = method + " takes or returns a reference and cannot be @CriticalNative";
+      return 0u;
+    }
+  }
+  return it->second;
+}
+
+uint32_t NativeOptimizationList::GetNativeMethodAccessFlags(const DexFile& dex_file,
+                                                            const DexFile::ClassDef& class_def,
+                                                            uint32_t method_index,
+                                                            uint32_t access_flags) {
+  uint32_t flags =
+      annotations::GetNativeMethodAnnotationAccessFlags(dex_file, class_def, method_index);
+  Runtime* runtime = Runtime::Current();
+  if (flags != 0u || runtime == nullptr || runtime->GetNativeOptimizationList() == nullptr) {
+    return flags;
+  }
+  std::string error_msg;
+  flags = runtime->GetNativeOptimizationList()->GetAccessFlags(
+      dex_file, method_index, access_flags, &error_msg);
+  if (UNLIKELY(!error_msg.empty())) {
+    if (runtime->GetJavaVM()->IsCheckJniEnabled()) {
+      LOG(FATAL) << "Invalid native optimization list entry: " << error_msg;
+    }
+    LOG(WARNING) << "Ignoring native optimization list entry: " << error_msg;
+  }
+  return flags;
+}
+
+}  // namespace art
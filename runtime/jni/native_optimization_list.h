@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_JNI_NATIVE_OPTIMIZATION_LIST_H_
+#define ART_RUNTIME_JNI_NATIVE_OPTIMIZATION_LIST_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "base/macros.h"
+#include "dex/dex_file.h"
+
+namespace art {
+
+// Marks native methods as @FastNative or @CriticalNative without annotating their sources. The
+// list has one method per line, followed by the optimization to apply:
+//
+//   Lcom/example/Codec;->crc32([BII)I,fast
+//   Lcom/example/Math;->mix(JJ)J,critical
+//
+// Empty lines and lines starting with '#' are ignored. The usual restrictions of the annotations
+// apply and the native implementations must be written for them. In particular @CriticalNative
+// functions take neither a JNIEnv* nor a jclass and must be registered with RegisterNatives.
+//
+// The list is given to the runtime with -Xnative-optimization-list. Give the same list to
+// dex2oat with --runtime-arg so that the compiled JNI stubs match. Compiled stubs of listed
+// methods are ignored in oat files compiled with a different list.
+class NativeOptimizationList {
+ public:
+  // Returns null and sets `error_msg` if the file cannot be read or parsed.
+  static std::unique_ptr<NativeOptimizationList> Create(const std::string& filename,
+                                                        std::string* error_msg);
+
+  static std::unique_ptr<NativeOptimizationList> CreateFromString(const std::string& contents,
+                                                                  std::string* error_msg);
+
+  // Returns kAccFastNative or kAccCriticalNative if the native method `method_index` of
+  // `dex_file` is listed, 0 otherwise. `access_flags` are the method's flags from the dex file.
+  // If the listed optimization is not allowed for the method, returns 0 and sets `error_msg`.
+  uint32_t GetAccessFlags(const DexFile& dex_file,
+                          uint32_t method_index,
+                          uint32_t access_flags,
+                          std::string* error_msg) const;
+
+  // Returns kAccFastNative or kAccCriticalNative for the native method `method_index` if it is
+  // annotated with @FastNative or @CriticalNative, or else listed in the runtime's list. An
+  // invalid list entry is fatal with CheckJNI and ignored with a warning otherwise.
+  static uint32_t GetNativeMethodAccessFlags(const DexFile& dex_file,
+                                             const DexFile::ClassDef& class_def,
+                                             uint32_t method_index,
+                                             uint32_t access_flags);
+
+  // Identifies the contents of the list, recorded in oat files compiled with it.
+  const std::string& GetChecksum() const {
+    return checksum_;
+  }
+
+  size_t Size() const {
+    return entries_.size();
+  }
+
+ private:
+  NativeOptimizationList() {}
+
+  // Method signature, e.g. "Lcom/example/Math;->mix(JJ)J", to kAccFastNative or
+  // kAccCriticalNative.
+  std::unordered_map<std::string, uint32_t> entries_;
+  std::string checksum_;
+
+  DISALLOW_COPY_AND_ASSIGN(NativeOptimizationList);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_JNI_NATIVE_OPTIMIZATION_LIST_H_
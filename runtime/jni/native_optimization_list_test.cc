@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "native_optimization_list.h"
+
+#include "common_runtime_test.h"
+#include "dex/class_accessor-inl.h"
+#include "dex/modifiers.h"
+
+namespace art {
+
+class NativeOptimizationListTest : public CommonRuntimeTest {
+ protected:
+  void SetUp() override {
+    CommonRuntimeTest::SetUp();
+    dex_file_ = OpenTestDexFile("MyClassNatives");
+    ASSERT_TRUE(dex_file_ != nullptr);
+  }
+
+  // Returns the flags the list gives to the native method `name` of MyClassNatives.
+  uint32_t GetAccessFlags(const NativeOptimizationList& list,
+                          const char* name,
+                          std::string* error_msg) {
+    const DexFile::TypeId* type_id = dex_file_->FindTypeId("LMyClassNatives;");
+    CHECK(type_id != nullptr);
+    const DexFile::ClassDef* class_def =
+        dex_file_->FindClassDef(dex_file_->GetIndexForTypeId(*type_id));
+    CHECK(class_def != nullptr);
+    for (const ClassAccessor::Method& method : ClassAccessor(*dex_file_, *class_def).GetMethods()) {
+      const DexFile::MethodId& method_id = dex_file_->GetMethodId(method.GetIndex());
+      if (strcmp(dex_file_->GetMethodName(method_id), name) == 0) {
+        CHECK_NE(method.GetAccessFlags() & kAccNative, 0u);
+        return list.GetAccessFlags(
+            *dex_file_, method.GetIndex(), method.GetAccessFlags(), error_msg);
+      }
+    }
+    LOG(FATAL) << "Method not found: " << name;
+    UNREACHABLE();
+  }
+
+  std::unique_ptr<const DexFile> dex_file_;
+};
+
+TEST_F(NativeOptimizationListTest, Parse) {
+  std::string error_msg;
+  std::unique_ptr<NativeOptimizationList> list = NativeOptimizationList::CreateFromString(
+      "# Comment\n"
+      "\n"
+      "LMyClassNatives;->sbar(I)I,critical\n"
+      "  LMyClassNatives;->fooI(I)I,fast  \n",
+      &error_msg);
+  ASSERT_TRUE(list != nullptr) << error_msg;
+  EXPECT_EQ(2u, list->Size());
+  EXPECT_EQ(8u, list->GetChecksum().size());
+
+  EXPECT_TRUE(NativeOptimizationList::CreateFromString("LMyClassNatives;->sbar(I)I\n", &error_msg)
+                  == nullptr);
+  EXPECT_TRUE(NativeOptimizationList::CreateFromString("LMyClassNatives;->sbar(I)I,slow\n",
+                                                       &error_msg) == nullptr);
+  EXPECT_TRUE(NativeOptimizationList::CreateFromString(
+      "LMyClassNatives;->sbar(I)I,fast\nLMyClassNatives;->sbar(I)I,critical\n",
+      &error_msg) == nullptr);
+
+  std::unique_ptr<NativeOptimizationList> other = NativeOptimizationList::CreateFromString(
+      "LMyClassNatives;->sbar(I)I,fast\n", &error_msg);
+  ASSERT_TRUE(other != nullptr) << error_msg;
+  EXPECT_NE(list->GetChecksum(), other->GetChecksum());
+}
+
+TEST_F(NativeOptimizationListTest, GetAccessFlags) {
+  std::string error_msg;
+  std::unique_ptr<NativeOptimizationList> list = NativeOptimizationList::CreateFromString(
+      "LMyClassNatives;->sbar(I)I,critical\n"
+      "LMyClassNatives;->fooI(I)I,fast\n"
+      "LMyClassNatives;->fooSIOO(ILjava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;,fast\n",
+      &error_msg);
+  ASSERT_TRUE(list != nullptr) << error_msg;
+
+  EXPECT_EQ(kAccCriticalNative, GetAccessFlags(*list, "sbar", &error_msg));
+  EXPECT_EQ(kAccFastNative, GetAccessFlags(*list, "fooI", &error_msg));
+  EXPECT_EQ(kAccFastNative, GetAccessFlags(*list, "fooSIOO", &error_msg));
+  EXPECT_TRUE(error_msg.empty()) << error_msg;
+  // Not listed.
+  EXPECT_EQ(0u, GetAccessFlags(*list, "fooSII", &error_msg));
+  EXPECT_TRUE(error_msg.empty()) << error_msg;
+}
+
+TEST_F(NativeOptimizationListTest, InvalidEntries) {
+  std::string error_msg;
+  std::unique_ptr<NativeOptimizationList> list = NativeOptimizationList::CreateFromString(
+      "LMyClassNatives;->fooI(I)I,critical\n"
+      "LMyClassNatives;->fooJJ_synchronized(JJ)J,fast\n"
+      "LMyClassNatives;->fooSIOO(ILjava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;,"
+      "critical\n",
+      &error_msg);
+  ASSERT_TRUE(list != nullptr) << error_msg;
+
+  // @CriticalNative methods must be static.
+  EXPECT_EQ(0u, GetAccessFlags(*list, "fooI", &error_msg));
+  EXPECT_FALSE(error_msg.empty());
+  // @FastNative and @CriticalNative methods cannot be synchronized.
+  error_msg.clear();
+  EXPECT_EQ(0u, GetAccessFlags(*list, "fooJJ_synchronized", &error_msg));
+  EXPECT_FALSE(error_msg.empty());
+  // @CriticalNative methods cannot take or return references.
+  error_msg.clear();
+  EXPECT_EQ(0u, GetAccessFlags(*list, "fooSIOO", &error_msg));
+  EXPECT_FALSE(error_msg.empty());
+}
+
+}  // namespace art
@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lock_contention_profiler.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "art_method-inl.h"
+#include "barrier.h"
+#include "base/enums.h"
+#include "base/time_utils.h"
+#include "scoped_thread_state_change-inl.h"
+#include "thread-current-inl.h"
+#include "thread_list.h"
+
+namespace art {
+
+void LockContentionBuffer::VisitRoots(RootVisitor* visitor) {
+  BufferedRootVisitor<kDefaultBufferedRootCount> buffered_visitor(visitor,
+                                                                  RootInfo(kRootVMInternal));
+  for (const auto& entry : sites_) {
+    if (entry.first.owner_method != nullptr) {
+      entry.first.owner_method->VisitRoots(buffered_visitor, kRuntimePointerSize);
+    }
+    if (entry.first.waiter_method != nullptr) {
+      entry.first.waiter_method->VisitRoots(buffered_visitor, kRuntimePointerSize);
+    }
+  }
+}
+
+LockContentionProfiler::LockContentionProfiler()
+    : enabled_(true), lock_("lock contention profiler lock") {}
+
+LockContentionProfiler::~LockContentionProfiler() {}
+
+void LockContentionProfiler::RecordContention(Thread* self,
+                                              const LockContentionSite& site,
+                                              uint64_t wait_ns) {
+  LockContentionBuffer* buffer = self->GetLockContentionBuffer();
+  if (UNLIKELY(buffer == nullptr)) {
+    buffer = new LockContentionBuffer();
+    self->SetLockContentionBuffer(buffer);
+  }
+  buffer->Record(site, wait_ns);
+}
+
+static std::string SymbolizeSite(ArtMethod* method, uint32_t dex_pc)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  if (method == nullptr) {
+    return "<unknown>";
+  }
+  std::string result = method->PrettyMethod(/* with_signature */ false);
+  const char* source_file = method->GetDeclaringClassSourceFile();
+  if (source_file != nullptr) {
+    result += " (";
+    result += source_file;
+    result += ":";
+    result += std::to_string(method->GetLineNumFromDexPC(dex_pc));
+    result += ")";
+  }
+  return result;
+}
+
+void LockContentionProfiler::MergeThread(Thread* thread) {
+  LockContentionBuffer* buffer = thread->GetLockContentionBuffer();
+  if (buffer == nullptr || buffer->sites_.empty()) {
+    return;
+  }
+  MutexLock mu(Thread::Current(), lock_);
+  for (const auto& entry : buffer->sites_) {
+    std::string key = SymbolizeSite(entry.first.waiter_method, entry.first.waiter_dex_pc);
+    key += ";";
+    key += SymbolizeSite(entry.first.owner_method, entry.first.owner_dex_pc);
+    LockContentionStats& stats = profile_[key];
+    stats.count += entry.second.count;
+    stats.wait_ns += entry.second.wait_ns;
+  }
+  buffer->sites_.clear();
+}
+
+class MergeLockContentionClosure : public Closure {
+ public:
+  MergeLockContentionClosure(LockContentionProfiler* profiler, Barrier* barrier)
+      : profiler_(profiler), barrier_(barrier) {}
+
+  void Run(Thread* thread) override {
+    {
+      // We may run on behalf of a suspended thread, make sure its methods cannot get unloaded
+      // while we symbolize them.
+      ScopedObjectAccess soa(Thread::Current());
+      profiler_->MergeThread(thread);
+    }
+    barrier_->Pass(Thread::Current());
+  }
+
+ private:
+  LockContentionProfiler* const profiler_;
+  Barrier* const barrier_;
+};
+
+void LockContentionProfiler::MergeAllThreads(Thread* self) {
+  Barrier barrier(0);
+  MergeLockContentionClosure closure(this, &barrier);
+  ScopedThreadStateChange tsc(self, kWaitingForCheckPointsToRun);
+  size_t barrier_count = Runtime::Current()->GetThreadList()->RunCheckpoint(&closure);
+  if (barrier_count != 0) {
+    barrier.Increment(self, barrier_count);
+  }
+}
+
+void LockContentionProfiler::DumpProfile(std::ostream& os, size_t max_sites) {
+  MutexLock mu(Thread::Current(), lock_);
+  std::vector<const std::pair<const std::string, LockContentionStats>*> sites;
+  sites.reserve(profile_.size());
+  for (const auto& entry : profile_) {
+    sites.push_back(&entry);
+  }
+  auto by_wait_time = [](const std::pair<const std::string, LockContentionStats>* lhs,
+                         const std::pair<const std::string, LockContentionStats>* rhs) {
+    return lhs->second.wait_ns > rhs->second.wait_ns;
+  };
+  if (sites.size() > max_sites) {
+    std::partial_sort(sites.begin(), sites.begin() + max_sites, sites.end(), by_wait_time);
+    sites.resize(max_sites);
+  } else {
+    std::sort(sites.begin(), sites.end(), by_wait_time);
+  }
+  for (const auto* site : sites) {
+    os << site->first << " " << NsToUs(site->second.wait_ns) << "\n";
+  }
+}
+
+void LockContentionProfiler::DumpForSigQuit(std::ostream& os) {
+  if (!IsEnabled()) {
+    return;
+  }
+  MergeAllThreads(Thread::Current());
+  size_t num_sites;
+  uint64_t total_count = 0u;
+  uint64_t total_wait_ns = 0u;
+  {
+    MutexLock mu(Thread::Current(), lock_);
+    num_sites = profile_.size();
+    for (const auto& entry : profile_) {
+      total_count += entry.second.count;
+      total_wait_ns += entry.second.wait_ns;
+    }
+  }
+  os << "Monitor contention: sites=" << num_sites
+     << " contended enters=" << total_count
+     << " blocked=" << PrettyDuration(total_wait_ns) << "\n";
+  if (num_sites != 0u) {
+    os << "Top contended monitor sites (waiter;owner microseconds):\n";
+    DumpProfile(os, kMaxSitesForSigQuit);
+  }
+  os << "\n";
+}
+
+}  // namespace art
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_LOCK_CONTENTION_PROFILER_H_
+#define ART_RUNTIME_LOCK_CONTENTION_PROFILER_H_
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+#include "base/atomic.h"
+#include "base/macros.h"
+#include "base/mutex.h"
+
+namespace art {
+
+class ArtMethod;
+class RootVisitor;
+class Thread;
+
+// A contended monitor enter: where the waiter blocked and where the owner held the monitor.
+struct LockContentionSite {
+  ArtMethod* owner_method;
+  uint32_t owner_dex_pc;
+  ArtMethod* waiter_method;
+  uint32_t waiter_dex_pc;
+
+  bool operator==(const LockContentionSite& other) const {
+    return owner_method == other.owner_method &&
+        owner_dex_pc == other.owner_dex_pc &&
+        waiter_method == other.waiter_method &&
+        waiter_dex_pc == other.waiter_dex_pc;
+  }
+};
+
+struct LockContentionSiteHash {
+  size_t operator()(const LockContentionSite& site) const {
+    size_t hash = reinterpret_cast<uintptr_t>(site.owner_method);
+    hash = hash * 31u + site.owner_dex_pc;
+    hash = hash * 31u + reinterpret_cast<uintptr_t>(site.waiter_method);
+    return hash * 31u + site.waiter_dex_pc;
+  }
+};
+
+struct LockContentionStats {
+  uint64_t count = 0u;
+  uint64_t wait_ns = 0u;
+};
+
+// Contention recorded by one thread and not yet merged into the LockContentionProfiler. Only
+// accessed by the owning thread, or on its behalf while it is suspended.
+class LockContentionBuffer {
+ public:
+  LockContentionBuffer() {}
+
+  void Record(const LockContentionSite& site, uint64_t wait_ns) {
+    LockContentionStats& stats = sites_[site];
+    ++stats.count;
+    stats.wait_ns += wait_ns;
+  }
+
+  // Keep the classes of the recorded methods from being unloaded before they are merged.
+  void VisitRoots(RootVisitor* visitor) REQUIRES_SHARED(Locks::mutator_lock_);
+
+ private:
+  std::unordered_map<LockContentionSite, LockContentionStats, LockContentionSiteHash> sites_;
+
+  friend class LockContentionProfiler;
+  DISALLOW_COPY_AND_ASSIGN(LockContentionBuffer);
+};
+
+// Profiler of the time threads spend blocked on contended monitors, off unless the runtime is
+// started with -XX:LockContentionProfiler=true. Contention is only recorded on the already slow
+// path where a thread blocks on an inflated monitor, and is aggregated per thread by (owner
+// method, owner dex pc, waiter method, waiter dex pc). The per-thread buffers are merged on demand
+// into a profile keyed by symbolized site, which is dumped in the folded stack format understood
+// by flamegraph.pl.
+class LockContentionProfiler {
+ public:
+  LockContentionProfiler();
+  ~LockContentionProfiler();
+
+  bool IsEnabled() const {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  void SetEnabled(bool enabled) {
+    enabled_.store(enabled, std::memory_order_relaxed);
+  }
+
+  // Record that `self` was blocked for `wait_ns` entering a monitor at the given site.
+  void RecordContention(Thread* self, const LockContentionSite& site, uint64_t wait_ns)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Merge the contention recorded by `thread` into the profile. `thread` must be the current
+  // thread or be suspended.
+  void MergeThread(Thread* thread) REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!lock_);
+
+  // Merge the contention recorded by every thread into the profile, by running a checkpoint.
+  void MergeAllThreads(Thread* self) REQUIRES(!Locks::mutator_lock_, !lock_);
+
+  // Dump one "<waiter site>;<owner site> <microseconds blocked>" line per site, the format
+  // expected by flamegraph.pl. Dumps at most `max_sites` sites, the ones with the most wait time.
+  void DumpProfile(std::ostream& os, size_t max_sites = SIZE_MAX) REQUIRES(!lock_);
+
+  void DumpForSigQuit(std::ostream& os) REQUIRES(!Locks::mutator_lock_, !lock_);
+
+ private:
+  // Sites dumped on SIGQUIT.
+  static constexpr size_t kMaxSitesForSigQuit = 20;
+
+  Atomic<bool> enabled_;
+  Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  // Merged contention keyed by "<waiter site>;<owner site>".
+  std::map<std::string, LockContentionStats> profile_ GUARDED_BY(lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(LockContentionProfiler);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_LOCK_CONTENTION_PROFILER_H_
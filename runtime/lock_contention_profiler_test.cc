@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lock_contention_profiler.h"
+
+#include <sstream>
+
+#include "art_method-inl.h"
+#include "base/enums.h"
+#include "class_linker-inl.h"
+#include "common_runtime_test.h"
+#include "mirror/class-inl.h"
+#include "scoped_thread_state_change-inl.h"
+#include "thread-current-inl.h"
+
+namespace art {
+
+class LockContentionProfilerTest : public CommonRuntimeTest {};
+
+TEST_F(LockContentionProfilerTest, MergeAndDump) {
+  LockContentionProfiler profiler;
+  Thread* self = Thread::Current();
+  {
+    ScopedObjectAccess soa(self);
+    ObjPtr<mirror::Class> klass = class_linker_->FindSystemClass(self, "Ljava/lang/Object;");
+    ASSERT_TRUE(klass != nullptr);
+    ArtMethod* method =
+        klass->FindClassMethod("toString", "()Ljava/lang/String;", kRuntimePointerSize);
+    ASSERT_TRUE(method != nullptr);
+    LockContentionSite unknown_site = { nullptr, 0u, nullptr, 0u };
+    LockContentionSite method_site = { method, 0u, method, 0u };
+    profiler.RecordContention(self, unknown_site, 3000u);
+    profiler.RecordContention(self, method_site, 5000u);
+    profiler.RecordContention(self, unknown_site, 4000u);
+    profiler.MergeThread(self);
+    // Merging empties the thread's buffer.
+    profiler.MergeThread(self);
+  }
+  std::ostringstream oss;
+  profiler.DumpProfile(oss);
+  std::string profile = oss.str();
+  // Sites are sorted by wait time and report it in microseconds.
+  EXPECT_EQ(profile.find("<unknown>;<unknown> 7\n"), 0u) << profile;
+  EXPECT_NE(profile.find("java.lang.Object.toString"), std::string::npos) << profile;
+  EXPECT_NE(profile.find(" 5\n"), std::string::npos) << profile;
+
+  std::ostringstream top;
+  profiler.DumpProfile(top, /* max_sites */ 1u);
+  EXPECT_EQ(top.str(), "<unknown>;<unknown> 7\n");
+}
+
+TEST_F(LockContentionProfilerTest, MergeAllThreads) {
+  LockContentionProfiler profiler;
+  Thread* self = Thread::Current();
+  {
+    ScopedObjectAccess soa(self);
+    LockContentionSite site = { nullptr, 0u, nullptr, 0u };
+    profiler.RecordContention(self, site, 2000u);
+  }
+  profiler.MergeAllThreads(self);
+  std::ostringstream oss;
+  profiler.DumpProfile(oss);
+  EXPECT_EQ(oss.str(), "<unknown>;<unknown> 2\n");
+}
+
+}  // namespace art
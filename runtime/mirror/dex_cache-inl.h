@@ -57,14 +57,19 @@ inline uint32_t DexCache::ClassSize(PointerSize pointer_size) {
 
 inline uint32_t DexCache::StringSlotIndex(dex::StringIndex string_idx) {
   DCHECK_LT(string_idx.index_, GetDexFile()->NumStringIds());
-  const uint32_t slot_idx = string_idx.index_ % kDexCacheStringCacheSize;
+  const uint32_t slot_idx = SlotIndexForSize(string_idx.index_, NumStrings());
   DCHECK_LT(slot_idx, NumStrings());
   return slot_idx;
 }
 
 inline String* DexCache::GetResolvedString(dex::StringIndex string_idx) {
-  return GetStrings()[StringSlotIndex(string_idx)].load(
-      std::memory_order_relaxed).GetObjectForIndex(string_idx.index_);
+  StringDexCachePair pair =
+      GetStrings()[StringSlotIndex(string_idx)].load(std::memory_order_relaxed);
+  String* string = pair.GetObjectForIndex(string_idx.index_);
+  if (UNLIKELY(string == nullptr)) {
+    RecordMiss(CacheKind::kStrings, !pair.object.IsNull());
+  }
+  return string;
 }
 
 inline void DexCache::SetResolvedString(dex::StringIndex string_idx, ObjPtr<String> resolved) {
@@ -93,7 +98,7 @@ inline void DexCache::ClearString(dex::StringIndex string_idx) {
 
 inline uint32_t DexCache::TypeSlotIndex(dex::TypeIndex type_idx) {
   DCHECK_LT(type_idx.index_, GetDexFile()->NumTypeIds());
-  const uint32_t slot_idx = type_idx.index_ % kDexCacheTypeCacheSize;
+  const uint32_t slot_idx = SlotIndexForSize(type_idx.index_, NumResolvedTypes());
   DCHECK_LT(slot_idx, NumResolvedTypes());
   return slot_idx;
 }
@@ -101,8 +106,13 @@ inline uint32_t DexCache::TypeSlotIndex(dex::TypeIndex type_idx) {
 inline Class* DexCache::GetResolvedType(dex::TypeIndex type_idx) {
   // It is theorized that a load acquire is not required since obtaining the resolved class will
   // always have an address dependency or a lock.
-  return GetResolvedTypes()[TypeSlotIndex(type_idx)].load(
-      std::memory_order_relaxed).GetObjectForIndex(type_idx.index_);
+  TypeDexCachePair pair =
+      GetResolvedTypes()[TypeSlotIndex(type_idx)].load(std::memory_order_relaxed);
+  Class* type = pair.GetObjectForIndex(type_idx.index_);
+  if (UNLIKELY(type == nullptr)) {
+    RecordMiss(CacheKind::kTypes, !pair.object.IsNull());
+  }
+  return type;
 }
 
 inline void DexCache::SetResolvedType(dex::TypeIndex type_idx, ObjPtr<Class> resolved) {
@@ -131,14 +141,19 @@ inline void DexCache::ClearResolvedType(dex::TypeIndex type_idx) {
 inline uint32_t DexCache::MethodTypeSlotIndex(dex::ProtoIndex proto_idx) {
   DCHECK(Runtime::Current()->IsMethodHandlesEnabled());
   DCHECK_LT(proto_idx.index_, GetDexFile()->NumProtoIds());
-  const uint32_t slot_idx = proto_idx.index_ % kDexCacheMethodTypeCacheSize;
+  const uint32_t slot_idx = SlotIndexForSize(proto_idx.index_, NumResolvedMethodTypes());
   DCHECK_LT(slot_idx, NumResolvedMethodTypes());
   return slot_idx;
 }
 
 inline MethodType* DexCache::GetResolvedMethodType(dex::ProtoIndex proto_idx) {
-  return GetResolvedMethodTypes()[MethodTypeSlotIndex(proto_idx)].load(
-      std::memory_order_relaxed).GetObjectForIndex(proto_idx.index_);
+  MethodTypeDexCachePair pair =
+      GetResolvedMethodTypes()[MethodTypeSlotIndex(proto_idx)].load(std::memory_order_relaxed);
+  MethodType* method_type = pair.GetObjectForIndex(proto_idx.index_);
+  if (UNLIKELY(method_type == nullptr)) {
+    RecordMiss(CacheKind::kMethodTypes, !pair.object.IsNull());
+  }
+  return method_type;
 }
 
 inline void DexCache::SetResolvedMethodType(dex::ProtoIndex proto_idx, MethodType* resolved) {
@@ -181,7 +196,7 @@ inline ObjPtr<CallSite> DexCache::SetResolvedCallSite(uint32_t call_site_idx,
 
 inline uint32_t DexCache::FieldSlotIndex(uint32_t field_idx) {
   DCHECK_LT(field_idx, GetDexFile()->NumFieldIds());
-  const uint32_t slot_idx = field_idx % kDexCacheFieldCacheSize;
+  const uint32_t slot_idx = SlotIndexForSize(field_idx, NumResolvedFields());
   DCHECK_LT(slot_idx, NumResolvedFields());
   return slot_idx;
 }
@@ -189,7 +204,11 @@ inline uint32_t DexCache::FieldSlotIndex(uint32_t field_idx) {
 inline ArtField* DexCache::GetResolvedField(uint32_t field_idx, PointerSize ptr_size) {
   DCHECK_EQ(Runtime::Current()->GetClassLinker()->GetImagePointerSize(), ptr_size);
   auto pair = GetNativePairPtrSize(GetResolvedFields(), FieldSlotIndex(field_idx), ptr_size);
-  return pair.GetObjectForIndex(field_idx);
+  ArtField* field = pair.GetObjectForIndex(field_idx);
+  if (UNLIKELY(field == nullptr)) {
+    RecordMiss(CacheKind::kFields, pair.object != nullptr);
+  }
+  return field;
 }
 
 inline void DexCache::SetResolvedField(uint32_t field_idx, ArtField* field, PointerSize ptr_size) {
@@ -213,7 +232,7 @@ inline void DexCache::ClearResolvedField(uint32_t field_idx, PointerSize ptr_siz
 
 inline uint32_t DexCache::MethodSlotIndex(uint32_t method_idx) {
   DCHECK_LT(method_idx, GetDexFile()->NumMethodIds());
-  const uint32_t slot_idx = method_idx % kDexCacheMethodCacheSize;
+  const uint32_t slot_idx = SlotIndexForSize(method_idx, NumResolvedMethods());
   DCHECK_LT(slot_idx, NumResolvedMethods());
   return slot_idx;
 }
@@ -221,7 +240,11 @@ inline uint32_t DexCache::MethodSlotIndex(uint32_t method_idx) {
 inline ArtMethod* DexCache::GetResolvedMethod(uint32_t method_idx, PointerSize ptr_size) {
   DCHECK_EQ(Runtime::Current()->GetClassLinker()->GetImagePointerSize(), ptr_size);
   auto pair = GetNativePairPtrSize(GetResolvedMethods(), MethodSlotIndex(method_idx), ptr_size);
-  return pair.GetObjectForIndex(method_idx);
+  ArtMethod* method = pair.GetObjectForIndex(method_idx);
+  if (UNLIKELY(method == nullptr)) {
+    RecordMiss(CacheKind::kMethods, pair.object != nullptr);
+  }
+  return method;
 }
 
 inline void DexCache::SetResolvedMethod(uint32_t method_idx,
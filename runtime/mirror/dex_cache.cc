@@ -66,22 +66,10 @@ void DexCache::InitializeDexCache(Thread* self,
   FieldDexCacheType* fields = (dex_file->NumFieldIds() == 0u) ? nullptr :
       reinterpret_cast<FieldDexCacheType*>(raw_arrays + layout.FieldsOffset());
 
-  size_t num_strings = kDexCacheStringCacheSize;
-  if (dex_file->NumStringIds() < num_strings) {
-    num_strings = dex_file->NumStringIds();
-  }
-  size_t num_types = kDexCacheTypeCacheSize;
-  if (dex_file->NumTypeIds() < num_types) {
-    num_types = dex_file->NumTypeIds();
-  }
-  size_t num_fields = kDexCacheFieldCacheSize;
-  if (dex_file->NumFieldIds() < num_fields) {
-    num_fields = dex_file->NumFieldIds();
-  }
-  size_t num_methods = kDexCacheMethodCacheSize;
-  if (dex_file->NumMethodIds() < num_methods) {
-    num_methods = dex_file->NumMethodIds();
-  }
+  size_t num_strings = layout.NumStrings();
+  size_t num_types = layout.NumTypes();
+  size_t num_fields = layout.NumFields();
+  size_t num_methods = layout.NumMethods();
 
   // Note that we allocate the method type dex caches regardless of this flag,
   // and we make sure here that they're not used by the runtime. This is in the
@@ -90,13 +78,7 @@ void DexCache::InitializeDexCache(Thread* self,
   // If this needs to be mitigated in a production system running this code,
   // DexCache::kDexCacheMethodTypeCacheSize can be set to zero.
   MethodTypeDexCacheType* method_types = nullptr;
-  size_t num_method_types = 0;
-
-  if (dex_file->NumProtoIds() < kDexCacheMethodTypeCacheSize) {
-    num_method_types = dex_file->NumProtoIds();
-  } else {
-    num_method_types = kDexCacheMethodTypeCacheSize;
-  }
+  size_t num_method_types = layout.NumMethodTypes();
 
   if (num_method_types > 0) {
     method_types = reinterpret_cast<MethodTypeDexCacheType*>(
@@ -211,6 +193,44 @@ void DexCache::Init(const DexFile* dex_file,
   SetField32<false>(NumResolvedCallSitesOffset(), num_resolved_call_sites);
 }
 
+static constexpr size_t kNumCacheKinds = static_cast<size_t>(DexCache::CacheKind::kLast) + 1u;
+static std::atomic<uint64_t> dex_cache_misses[kNumCacheKinds];
+static std::atomic<uint64_t> dex_cache_conflicts[kNumCacheKinds];
+
+bool DexCache::record_misses_ = false;
+
+void DexCache::CountMiss(CacheKind kind, bool conflict) {
+  size_t index = static_cast<size_t>(kind);
+  dex_cache_misses[index].fetch_add(1u, std::memory_order_relaxed);
+  if (conflict) {
+    dex_cache_conflicts[index].fetch_add(1u, std::memory_order_relaxed);
+  }
+}
+
+uint64_t DexCache::GetMissCount(CacheKind kind) {
+  return dex_cache_misses[static_cast<size_t>(kind)].load(std::memory_order_relaxed);
+}
+
+uint64_t DexCache::GetConflictCount(CacheKind kind) {
+  return dex_cache_conflicts[static_cast<size_t>(kind)].load(std::memory_order_relaxed);
+}
+
+void DexCache::DumpStats(std::ostream& os) {
+  if (!record_misses_) {
+    return;
+  }
+  static constexpr const char* kKindNames[kNumCacheKinds] = {
+      "types", "strings", "fields", "methods", "method types"
+  };
+  os << "Dex cache misses (conflicts):";
+  for (size_t i = 0; i != kNumCacheKinds; ++i) {
+    CacheKind kind = static_cast<CacheKind>(i);
+    os << (i != 0u ? ", " : " ") << kKindNames[i] << "=" << GetMissCount(kind)
+       << " (" << GetConflictCount(kind) << ")";
+  }
+  os << "\n";
+}
+
 void DexCache::SetLocation(ObjPtr<mirror::String> location) {
   SetFieldObject<false>(OFFSET_OF_OBJECT_MEMBER(DexCache, location_), location);
 }
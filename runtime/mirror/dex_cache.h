@@ -82,7 +82,7 @@ template <typename T> struct PACKED(8) DexCachePair {
   }
 
   static uint32_t InvalidIndexForSlot(uint32_t slot) {
-    // Since the cache size is a power of two, 0 will always map to slot 0.
+    // Index 0 always maps to slot 0, see DexCache::SlotIndexForSize().
     // Use 1 for slot 0 and 0 for all other slots.
     return (slot == 0) ? 1u : 0u;
   }
@@ -111,7 +111,7 @@ template <typename T> struct PACKED(2 * __SIZEOF_POINTER__) NativeDexCachePair {
   static void Initialize(std::atomic<NativeDexCachePair<T>>* dex_cache, PointerSize pointer_size);
 
   static uint32_t InvalidIndexForSlot(uint32_t slot) {
-    // Since the cache size is a power of two, 0 will always map to slot 0.
+    // Index 0 always maps to slot 0, see DexCache::SlotIndexForSize().
     // Use 1 for slot 0 and 0 for all other slots.
     return (slot == 0) ? 1u : 0u;
   }
@@ -192,6 +192,49 @@ class MANAGED DexCache final : public Object {
     return kDexCacheMethodTypeCacheSize;
   }
 
+  // Maps `idx` to a slot of a hashed array with `cache_size` entries. The arrays are sized by
+  // DexCacheArraysLayout::CacheSize(), so they either hold every index or have a power of two
+  // size. The former makes the common small dex file case a plain array lookup.
+  ALWAYS_INLINE static uint32_t SlotIndexForSize(uint32_t idx, uint32_t cache_size) {
+    DCHECK_NE(cache_size, 0u);
+    if (LIKELY(idx < cache_size)) {
+      return idx;
+    }
+    DCHECK(IsPowerOfTwo(cache_size)) << cache_size;
+    return idx & (cache_size - 1u);
+  }
+
+  // Kinds of hashed dex cache arrays, for the lookup statistics.
+  enum class CacheKind : uint8_t {
+    kTypes,
+    kStrings,
+    kFields,
+    kMethods,
+    kMethodTypes,
+    kLast = kMethodTypes,
+  };
+
+  // Records a lookup that missed in a dex cache array of the given kind. A conflict is a miss
+  // on a slot that holds the entry for another index; these are the misses that a larger array
+  // would have avoided. Misses are only counted with -Xadaptive-dex-caches:true, so that the
+  // default configuration does not contend on the shared counters.
+  ALWAYS_INLINE static void RecordMiss(CacheKind kind, bool conflict) {
+    if (UNLIKELY(record_misses_)) {
+      CountMiss(kind, conflict);
+    }
+  }
+
+  static void SetRecordMisses(bool record_misses) {
+    record_misses_ = record_misses;
+  }
+
+  // Dumps the counts recorded by RecordMiss(), for SIGQUIT.
+  static void DumpStats(std::ostream& os);
+
+  // Returns the number of misses and conflicts recorded for the given kind.
+  static uint64_t GetMissCount(CacheKind kind);
+  static uint64_t GetConflictCount(CacheKind kind);
+
   // Size of an instance of java.lang.DexCache not including referenced values.
   static constexpr uint32_t InstanceSize() {
     return sizeof(DexCache);
@@ -551,6 +594,11 @@ class MANAGED DexCache final : public Object {
   uint32_t num_resolved_types_;         // Number of elements in the resolved_types_ array.
   uint32_t num_strings_;                // Number of elements in the strings_ array.
 
+  // Whether RecordMiss() counts misses, set once at runtime startup.
+  static bool record_misses_;
+
+  static void CountMiss(CacheKind kind, bool conflict);
+
   friend struct art::DexCacheOffsets;  // for verifying offset information
   friend class linker::ImageWriter;
   friend class Object;  // For VisitReferences
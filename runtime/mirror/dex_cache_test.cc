@@ -26,6 +26,7 @@
 #include "mirror/class_loader-inl.h"
 #include "mirror/dex_cache-inl.h"
 #include "scoped_thread_state_change-inl.h"
+#include "utils/dex_cache_arrays_layout-inl.h"
 
 namespace art {
 namespace mirror {
@@ -39,6 +40,14 @@ class DexCacheMethodHandlesTest : public DexCacheTest {
   }
 };
 
+class DexCacheAdaptiveTest : public DexCacheTest {
+ protected:
+  void SetUpRuntimeOptions(RuntimeOptions* options) override {
+    CommonRuntimeTest::SetUpRuntimeOptions(options);
+    options->push_back(std::make_pair("-Xadaptive-dex-caches:true", nullptr));
+  }
+};
+
 TEST_F(DexCacheTest, Open) {
   ScopedObjectAccess soa(Thread::Current());
   StackHandleScope<1> hs(soa.Self());
@@ -76,6 +85,88 @@ TEST_F(DexCacheMethodHandlesTest, Open) {
       || java_lang_dex_file_->NumProtoIds() == dex_cache->NumResolvedMethodTypes());
 }
 
+TEST_F(DexCacheTest, CacheSize) {
+  constexpr uint32_t kFixedSize = 1024u;
+  EXPECT_EQ(100u, DexCacheArraysLayout::CacheSize(100u, kFixedSize, DexCacheSizing::kFixed));
+  EXPECT_EQ(1024u, DexCacheArraysLayout::CacheSize(5000u, kFixedSize, DexCacheSizing::kFixed));
+  EXPECT_EQ(100u, DexCacheArraysLayout::CacheSize(100u, kFixedSize, DexCacheSizing::kAdaptive));
+  EXPECT_EQ(1024u, DexCacheArraysLayout::CacheSize(3000u, kFixedSize, DexCacheSizing::kAdaptive));
+  EXPECT_EQ(2048u, DexCacheArraysLayout::CacheSize(5000u, kFixedSize, DexCacheSizing::kAdaptive));
+  EXPECT_EQ(DexCacheArraysLayout::kMaxAdaptiveCacheSize,
+            DexCacheArraysLayout::CacheSize(65535u, kFixedSize, DexCacheSizing::kAdaptive));
+  EXPECT_EQ(5000u, DexCacheArraysLayout::CacheSize(5000u, kFixedSize, DexCacheSizing::kFull));
+  EXPECT_EQ(0u, DexCacheArraysLayout::CacheSize(0u, kFixedSize, DexCacheSizing::kFull));
+}
+
+TEST_F(DexCacheTest, ConflictStats) {
+  ScopedObjectAccess soa(Thread::Current());
+  StackHandleScope<2> hs(soa.Self());
+  Handle<DexCache> dex_cache(
+      hs.NewHandle(class_linker_->AllocAndInitializeDexCache(
+          soa.Self(),
+          *java_lang_dex_file_,
+          Runtime::Current()->GetLinearAlloc())));
+  ASSERT_TRUE(dex_cache != nullptr);
+  const uint32_t num_strings = dex_cache->NumStrings();
+  ASSERT_GT(java_lang_dex_file_->NumStringIds(), num_strings);
+  Handle<String> string = hs.NewHandle(String::AllocFromModifiedUtf8(soa.Self(), "conflict"));
+  ASSERT_TRUE(string != nullptr);
+  DexCache::SetRecordMisses(true);
+
+  // A cold slot is a miss but not a conflict.
+  const uint64_t misses = DexCache::GetMissCount(DexCache::CacheKind::kStrings);
+  const uint64_t conflicts = DexCache::GetConflictCount(DexCache::CacheKind::kStrings);
+  EXPECT_TRUE(dex_cache->GetResolvedString(dex::StringIndex(1u)) == nullptr);
+  EXPECT_GE(DexCache::GetMissCount(DexCache::CacheKind::kStrings), misses + 1u);
+
+  // Index 1 + num_strings shares the slot of index 1.
+  dex_cache->SetResolvedString(dex::StringIndex(1u), string.Get());
+  EXPECT_EQ(string.Get(), dex_cache->GetResolvedString(dex::StringIndex(1u)));
+  EXPECT_TRUE(dex_cache->GetResolvedString(dex::StringIndex(1u + num_strings)) == nullptr);
+  EXPECT_GE(DexCache::GetConflictCount(DexCache::CacheKind::kStrings), conflicts + 1u);
+  EXPECT_GE(DexCache::GetMissCount(DexCache::CacheKind::kStrings), misses + 2u);
+
+  // Nothing is counted unless enabled.
+  DexCache::SetRecordMisses(false);
+  const uint64_t disabled_misses = DexCache::GetMissCount(DexCache::CacheKind::kStrings);
+  EXPECT_TRUE(dex_cache->GetResolvedString(dex::StringIndex(2u)) == nullptr);
+  EXPECT_EQ(disabled_misses, DexCache::GetMissCount(DexCache::CacheKind::kStrings));
+}
+
+TEST_F(DexCacheAdaptiveTest, Open) {
+  ScopedObjectAccess soa(Thread::Current());
+  StackHandleScope<2> hs(soa.Self());
+  Handle<DexCache> dex_cache(
+      hs.NewHandle(class_linker_->AllocAndInitializeDexCache(
+          soa.Self(),
+          *java_lang_dex_file_,
+          Runtime::Current()->GetLinearAlloc())));
+  ASSERT_TRUE(dex_cache != nullptr);
+
+  const DexFile& dex_file = *java_lang_dex_file_;
+  EXPECT_EQ(DexCacheArraysLayout::CacheSize(
+                dex_file.NumStringIds(), DexCache::StaticStringSize(), DexCacheSizing::kAdaptive),
+            dex_cache->NumStrings());
+  EXPECT_EQ(DexCacheArraysLayout::CacheSize(
+                dex_file.NumTypeIds(), DexCache::StaticTypeSize(), DexCacheSizing::kAdaptive),
+            dex_cache->NumResolvedTypes());
+  EXPECT_EQ(DexCacheArraysLayout::CacheSize(
+                dex_file.NumMethodIds(), DexCache::StaticMethodSize(), DexCacheSizing::kAdaptive),
+            dex_cache->NumResolvedMethods());
+  EXPECT_EQ(DexCacheArraysLayout::CacheSize(
+                dex_file.NumFieldIds(), DexCache::StaticArtFieldSize(), DexCacheSizing::kAdaptive),
+            dex_cache->NumResolvedFields());
+  EXPECT_GT(dex_cache->NumStrings(), DexCache::StaticStringSize());
+
+  // Every string index maps into the larger array and round-trips through its slot.
+  Handle<String> string = hs.NewHandle(String::AllocFromModifiedUtf8(soa.Self(), "adaptive"));
+  ASSERT_TRUE(string != nullptr);
+  const dex::StringIndex last_idx(dex_file.NumStringIds() - 1u);
+  EXPECT_LT(dex_cache->StringSlotIndex(last_idx), dex_cache->NumStrings());
+  dex_cache->SetResolvedString(last_idx, string.Get());
+  EXPECT_EQ(string.Get(), dex_cache->GetResolvedString(last_idx));
+}
+
 TEST_F(DexCacheTest, LinearAlloc) {
   ScopedObjectAccess soa(Thread::Current());
   jobject jclass_loader(LoadDex("Main"));
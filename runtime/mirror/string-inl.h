@@ -119,9 +119,7 @@ class SetStringCountAndValueVisitorFromCharArray {
     const uint16_t* const src = src_array_->GetData() + offset_;
     const int32_t length = String::GetLengthFromCount(count_);
     if (kUseStringCompression && String::IsCompressed(count_)) {
-      for (int i = 0; i < length; ++i) {
-        string->GetValueCompressed()[i] = static_cast<uint8_t>(src[i]);
-      }
+      ConvertUtf16ToAscii(string->GetValueCompressed(), src, length);
     } else {
       memcpy(string->GetValue(), src, length * sizeof(uint16_t));
     }
@@ -155,9 +153,7 @@ class SetStringCountAndValueVisitorFromString {
     } else {
       const uint16_t* const src = src_string_->GetValue() + offset_;
       if (compressible) {
-        for (int i = 0; i < length; ++i) {
-          string->GetValueCompressed()[i] = static_cast<uint8_t>(src[i]);
-        }
+        ConvertUtf16ToAscii(string->GetValueCompressed(), src, length);
       } else {
         memcpy(string->GetValue(), src, length * sizeof(uint16_t));
       }
@@ -205,7 +201,7 @@ inline String* String::Alloc(Thread* self, int32_t utf16_length_with_flag,
   size_t length = String::GetLengthFromCount(utf16_length_with_flag);
   static_assert(sizeof(length) <= sizeof(size_t),
                 "static_cast<size_t>(utf16_length) must not lose bits.");
-  size_t data_size = block_size * length;
+  size_t data_size = block_size * length + (compressible ? kCompressedTerminatorSize : 0u);
   size_t size = header_size + data_size;
   // String.equals() intrinsics assume zero-padding up to kObjectAlignment,
   // so make sure the allocator clears the padding as well.
@@ -302,12 +298,8 @@ inline int32_t String::GetHashCode() {
 template<typename MemoryType>
 inline bool String::AllASCII(const MemoryType* chars, const int length) {
   static_assert(std::is_unsigned<MemoryType>::value, "Expecting unsigned MemoryType");
-  for (int i = 0; i < length; ++i) {
-    if (!IsASCII(chars[i])) {
-      return false;
-    }
-  }
-  return true;
+  DCHECK_GE(length, 0);
+  return CountLeadingAsciiChars(chars, length) == static_cast<size_t>(length);
 }
 
 inline bool String::DexFileStringAllASCII(const char* chars, const int length) {
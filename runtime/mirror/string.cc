@@ -139,16 +139,12 @@ String* String::AllocFromStrings(Thread* self, Handle<String> string, Handle<Str
   } else {
     uint16_t* new_value = new_string->GetValue();
     if (string->IsCompressed()) {
-      for (int i = 0; i < length; ++i) {
-        new_value[i] = string->CharAt(i);
-      }
+      ConvertAsciiToUtf16(new_value, string->GetValueCompressed(), length);
     } else {
       memcpy(new_value, string->GetValue(), length * sizeof(uint16_t));
     }
     if (string2->IsCompressed()) {
-      for (int i = 0; i < length2; ++i) {
-        new_value[i+length] = string2->CharAt(i);
-      }
+      ConvertAsciiToUtf16(new_value + length, string2->GetValueCompressed(), length2);
     } else {
       memcpy(new_value + length, string2->GetValue(), length2 * sizeof(uint16_t));
     }
@@ -168,9 +164,7 @@ String* String::AllocFromUtf16(Thread* self, int32_t utf16_length, const uint16_
     return nullptr;
   }
   if (compressible) {
-    for (int i = 0; i < utf16_length; ++i) {
-      string->GetValueCompressed()[i] = static_cast<uint8_t>(utf16_data_in[i]);
-    }
+    ConvertUtf16ToAscii(string->GetValueCompressed(), utf16_data_in, utf16_length);
   } else {
     uint16_t* array = string->GetValue();
     memcpy(array, utf16_data_in, utf16_length * sizeof(uint16_t));
@@ -303,9 +297,7 @@ std::string String::ToModifiedUtf8() {
   size_t byte_count = GetUtfLength();
   std::string result(byte_count, static_cast<char>(0));
   if (IsCompressed()) {
-    for (size_t i = 0; i < byte_count; ++i) {
-      result[i] = static_cast<char>(CharAt(i));
-    }
+    memcpy(&result[0], GetValueCompressed(), byte_count);
   } else {
     const uint16_t* chars = GetValue();
     ConvertUtf16ToModifiedUtf8(&result[0], byte_count, chars, GetLength());
@@ -362,10 +354,7 @@ CharArray* String::ToCharArray(Thread* self) {
   ObjPtr<CharArray> result = CharArray::Alloc(self, GetLength());
   if (result != nullptr) {
     if (string->IsCompressed()) {
-      int32_t length = string->GetLength();
-      for (int i = 0; i < length; ++i) {
-        result->GetData()[i] = string->CharAt(i);
-      }
+      ConvertAsciiToUtf16(result->GetData(), string->GetValueCompressed(), string->GetLength());
     } else {
       memcpy(result->GetData(), string->GetValue(), string->GetLength() * sizeof(uint16_t));
     }
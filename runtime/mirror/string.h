@@ -34,6 +34,10 @@ namespace mirror {
 
 // String Compression
 static constexpr bool kUseStringCompression = true;
+
+// Size of the zero byte following the data of compressed strings.
+static constexpr size_t kCompressedTerminatorSize = 1u;
+
 enum class StringCompressionFlag : uint32_t {
     kCompressed = 0u,
     kUncompressed = 1u
@@ -70,7 +74,7 @@ class MANAGED String final : public Object {
   size_t SizeOf() REQUIRES_SHARED(Locks::mutator_lock_) {
     size_t size = sizeof(String);
     if (IsCompressed()) {
-      size += (sizeof(uint8_t) * GetLength<kVerifyFlags>());
+      size += (sizeof(uint8_t) * GetLength<kVerifyFlags>()) + kCompressedTerminatorSize;
     } else {
       size += (sizeof(uint16_t) * GetLength<kVerifyFlags>());
     }
@@ -265,7 +269,9 @@ class MANAGED String final : public Object {
 
   uint32_t hash_code_;
 
-  // Compression of all-ASCII into 8-bit memory leads to usage one of these fields
+  // Compression of all-ASCII into 8-bit memory leads to usage one of these fields.
+  // Compressed data is always followed by a zero byte, so that it is also a valid
+  // NUL-terminated modified UTF-8 string that JNI can hand out without copying.
   union {
     uint16_t value_[0];
     uint8_t value_compressed_[0];
@@ -16,6 +16,7 @@
 
 #include "monitor.h"
 
+#include <algorithm>
 #include <vector>
 
 #include "android-base/stringprintf.h"
@@ -31,6 +32,7 @@
 #include "dex/dex_file-inl.h"
 #include "dex/dex_file_types.h"
 #include "dex/dex_instruction-inl.h"
+#include "lock_contention_profiler.h"
 #include "lock_word-inl.h"
 #include "mirror/class-inl.h"
 #include "mirror/object-inl.h"
@@ -49,6 +51,15 @@ using android::base::StringPrintf;
 static constexpr uint64_t kDebugThresholdFudgeFactor = kIsDebugBuild ? 10 : 1;
 static constexpr uint64_t kLongWaitMs = 100 * kDebugThresholdFudgeFactor;
 
+// Hint to the CPU that we are busy-waiting.
+static inline void SpinPause() {
+#if defined(__i386__) || defined(__x86_64__)
+  __builtin_ia32_pause();
+#elif defined(__arm__) || defined(__aarch64__)
+  __asm__ __volatile__("yield" ::: "memory");
+#endif
+}
+
 /*
  * Every Object has a monitor associated with it, but not every Object is actually locked.  Even
  * the ones that are locked do not need a full-fledged monitor until a) there is actual contention
@@ -95,11 +106,14 @@ Monitor::Monitor(Thread* self, Thread* owner, mirror::Object* obj, int32_t hash_
       num_waiters_(0),
       owner_(owner),
       lock_count_(0),
+      spin_limit_(kInitialMonitorSpinLimit),
       obj_(GcRoot<mirror::Object>(obj)),
       wait_set_(nullptr),
       hash_code_(hash_code),
       locking_method_(nullptr),
       locking_dex_pc_(0),
+      contended_owner_method_(nullptr),
+      contended_owner_dex_pc_(0),
       monitor_id_(MonitorPool::ComputeMonitorId(this, self)) {
 #ifdef __LP64__
   DCHECK(false) << "Should not be reached in 64b";
@@ -118,11 +132,14 @@ Monitor::Monitor(Thread* self, Thread* owner, mirror::Object* obj, int32_t hash_
       num_waiters_(0),
       owner_(owner),
       lock_count_(0),
+      spin_limit_(kInitialMonitorSpinLimit),
       obj_(GcRoot<mirror::Object>(obj)),
       wait_set_(nullptr),
       hash_code_(hash_code),
       locking_method_(nullptr),
       locking_dex_pc_(0),
+      contended_owner_method_(nullptr),
+      contended_owner_dex_pc_(0),
       monitor_id_(id) {
 #ifdef __LP64__
   next_free_ = nullptr;
@@ -394,6 +411,37 @@ bool Monitor::TryLock(Thread* self) {
   return TryLockLocked(self);
 }
 
+bool Monitor::TrySpinLock(Thread* self) {
+  const uint32_t spin_limit = spin_limit_;
+  monitor_lock_.Unlock(self);
+  uint32_t spins = 0u;
+  bool owner_released = false;
+  for (; spins != spin_limit; ++spins) {
+    if (GetOwner() == nullptr) {
+      owner_released = true;
+      break;
+    }
+    if (UNLIKELY(self->TestAllFlags())) {
+      // Do not delay suspension or checkpoints, block and let them run instead.
+      break;
+    }
+    SpinPause();
+  }
+  monitor_lock_.Lock(self);
+  const bool acquired = owner_released && TryLockLocked(self);
+  if (acquired) {
+    // Allow for twice the spin that just succeeded, averaged with the current limit so that a
+    // single short hold time does not stop us from spinning through the next long one.
+    uint32_t target = std::min(2u * (spins + 1u), kMaxMonitorSpinLimit);
+    spin_limit_ = std::max((spin_limit_ + target) / 2u, kMinMonitorSpinLimit);
+  } else if (!owner_released) {
+    // The owner held on for the whole spin, most likely it is not running or holds the lock for a
+    // long time. Back off, but keep a minimum so that we notice when hold times get short again.
+    spin_limit_ = std::max(spin_limit_ / 2u, kMinMonitorSpinLimit);
+  }
+  return acquired;
+}
+
 // Asserts that a mutex isn't held when the class comes into and out of scope.
 class ScopedAssertNotHeld {
  public:
@@ -416,15 +464,32 @@ void Monitor::Lock(Thread* self) {
   ScopedAssertNotHeld sanh(self, monitor_lock_);
   bool called_monitors_callback = false;
   monitor_lock_.Lock(self);
+  bool spun = false;
+  // Where we blocked on the monitor, if we did and the lock contention profiler is enabled.
+  ArtMethod* waiter_method = nullptr;
+  uint32_t waiter_dex_pc = 0u;
   while (true) {
     if (TryLockLocked(self)) {
       break;
     }
-    // Contended.
+    // Contended. Spin once before blocking, in case the owner is about to release the monitor.
+    if (!spun) {
+      spun = true;
+      if (TrySpinLock(self)) {
+        break;
+      }
+      continue;
+    }
     const bool log_contention = (lock_profiling_threshold_ != 0);
     uint64_t wait_start_ms = log_contention ? MilliTime() : 0;
     ArtMethod* owners_method = locking_method_;
     uint32_t owners_dex_pc = locking_dex_pc_;
+    // Without lock profiling, the owner's site is only known if it acquired the monitor after
+    // blocking on it.
+    ArtMethod* const profiled_owner_method =
+        (owners_method != nullptr) ? owners_method : contended_owner_method_;
+    const uint32_t profiled_owner_dex_pc =
+        (owners_method != nullptr) ? owners_dex_pc : contended_owner_dex_pc_;
     // Do this before releasing the lock so that we don't get deflated.
     size_t num_waiters = num_waiters_;
     ++num_waiters_;
@@ -464,6 +529,10 @@ void Monitor::Lock(Thread* self) {
       Runtime::Current()->GetRuntimeCallbacks()->MonitorContendedLocking(this);
     }
     self->SetMonitorEnterObject(GetObject());
+    LockContentionProfiler* const profiler = Runtime::Current()->GetLockContentionProfiler();
+    const bool profile_contention = profiler->IsEnabled();
+    const uint64_t block_start_ns = profile_contention ? NanoTime() : 0u;
+    bool blocked = false;
     {
       ScopedThreadSuspension tsc(self, kBlocked);  // Change to blocked and give up mutator_lock_.
       uint32_t original_owner_thread_id = 0u;
@@ -475,6 +544,7 @@ void Monitor::Lock(Thread* self) {
           monitor_contenders_.Wait(self);  // Still contended so wait.
         }
       }
+      blocked = (original_owner_thread_id != 0u);
       if (original_owner_thread_id != 0u) {
         // Woken from contention.
         if (log_contention) {
@@ -585,8 +655,27 @@ void Monitor::Lock(Thread* self) {
       ATRACE_END();
     }
     self->SetMonitorEnterObject(nullptr);
+    uint64_t block_ns = 0u;
+    if (profile_contention && blocked) {
+      block_ns = NanoTime() - block_start_ns;
+      waiter_method = self->GetCurrentMethod(&waiter_dex_pc);
+    }
     monitor_lock_.Lock(self);  // Reacquire locks in order.
     --num_waiters_;
+    if (profile_contention && blocked) {
+      LockContentionSite site;
+      site.owner_method = profiled_owner_method;
+      site.owner_dex_pc = profiled_owner_dex_pc;
+      site.waiter_method = waiter_method;
+      site.waiter_dex_pc = waiter_dex_pc;
+      profiler->RecordContention(self, site, block_ns);
+    }
+  }
+  if (lock_count_ == 0) {
+    // Let the threads we block attribute their contention to where we blocked, if we did. The
+    // blocked path already walked our stack, so this costs nothing while we own the monitor.
+    contended_owner_method_ = waiter_method;
+    contended_owner_dex_pc_ = waiter_dex_pc;
   }
   monitor_lock_.Unlock(self);
   // We need to pair this with a single contended locking call. NB we match the RI behavior and call
@@ -712,6 +801,8 @@ bool Monitor::Unlock(Thread* self) {
         owner_ = nullptr;
         locking_method_ = nullptr;
         locking_dex_pc_ = 0;
+        contended_owner_method_ = nullptr;
+        contended_owner_dex_pc_ = 0;
         // Wake a contender.
         monitor_contenders_.Signal(self);
       } else {
@@ -773,6 +864,8 @@ void Monitor::Wait(Thread* self, int64_t ms, int32_t ns,
   locking_method_ = nullptr;
   uintptr_t saved_dex_pc = locking_dex_pc_;
   locking_dex_pc_ = 0;
+  contended_owner_method_ = nullptr;
+  contended_owner_dex_pc_ = 0;
 
   AtraceMonitorUnlock();  // For the implict Unlock() just above. This will only end the deepest
                           // nesting, but that is enough for the visualization, and corresponds to
@@ -1023,6 +1116,24 @@ static mirror::Object* FakeUnlock(mirror::Object* obj)
   return obj;
 }
 
+// Busy-waits until obj is no longer thin locked by owner_thread_id. Returns false if the lock
+// word did not change within kThinLockSpinIterations or a suspension is pending.
+static bool SpinOnThinLock(Thread* self, Handle<mirror::Object> obj, uint32_t owner_thread_id)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  for (size_t i = 0; i != Monitor::kThinLockSpinIterations; ++i) {
+    LockWord lock_word = obj->GetLockWord(false);
+    if (lock_word.GetState() != LockWord::kThinLocked ||
+        lock_word.ThinLockOwner() != owner_thread_id) {
+      return true;
+    }
+    if (UNLIKELY(self->TestAllFlags())) {
+      return false;
+    }
+    SpinPause();
+  }
+  return false;
+}
+
 mirror::Object* Monitor::MonitorEnter(Thread* self, mirror::Object* obj, bool trylock) {
   DCHECK(self != nullptr);
   DCHECK(obj != nullptr);
@@ -1086,14 +1197,16 @@ mirror::Object* Monitor::MonitorEnter(Thread* self, mirror::Object* obj, bool tr
           contention_count++;
           Runtime* runtime = Runtime::Current();
           if (contention_count <= runtime->GetMaxSpinsBeforeThinLockInflation()) {
+            // Spin first, without sched_yield. Sched_yield either does nothing (at significant
+            // expense), or guarantees that we wait at least microseconds, while the median thin
+            // lock hold time of a running owner is hundreds of nanoseconds or less.
+            if (SpinOnThinLock(self, h_obj, owner_thread_id)) {
+              continue;  // The lock word changed, start from the beginning.
+            }
             // TODO: Consider switching the thread state to kWaitingForLockInflation when we are
             // yielding.  Use sched_yield instead of NanoSleep since NanoSleep can wait much longer
             // than the parameter you pass in. This can cause thread suspension to take excessively
             // long and make long pauses. See b/16307460.
-            // TODO: We should literally spin first, without sched_yield. Sched_yield either does
-            // nothing (at significant expense), or guarantees that we wait at least microseconds.
-            // If the owner is running, I would expect the median lock hold time to be hundreds
-            // of nanoseconds or less.
             sched_yield();
           } else {
             contention_count = 0;
@@ -1499,7 +1612,8 @@ uint32_t Monitor::GetOwnerThreadId() {
 
 MonitorList::MonitorList()
     : allow_new_monitors_(true), monitor_list_lock_("MonitorList lock", kMonitorListLock),
-      monitor_add_condition_("MonitorList disallow condition", monitor_list_lock_) {
+      monitor_add_condition_("MonitorList disallow condition", monitor_list_lock_),
+      total_inflated_(0u), total_deflated_(0u) {
 }
 
 MonitorList::~MonitorList() {
@@ -1544,6 +1658,7 @@ void MonitorList::Add(Monitor* m) {
     monitor_add_condition_.WaitHoldingLocks(self);
   }
   list_.push_front(m);
+  ++total_inflated_;
 }
 
 void MonitorList::SweepMonitorList(IsMarkedVisitor* visitor) {
@@ -1596,9 +1711,23 @@ size_t MonitorList::DeflateMonitors() {
   MonitorDeflateVisitor visitor;
   Locks::mutator_lock_->AssertExclusiveHeld(visitor.self_);
   SweepMonitorList(&visitor);
+  {
+    MutexLock mu(visitor.self_, monitor_list_lock_);
+    total_deflated_ += visitor.deflate_count_;
+  }
   return visitor.deflate_count_;
 }
 
+void MonitorList::DumpForSigQuit(std::ostream& os) {
+  {
+    MutexLock mu(Thread::Current(), monitor_list_lock_);
+    os << "Monitors: inflated=" << list_.size()
+       << " total inflated=" << total_inflated_
+       << " total deflated=" << total_deflated_ << "\n";
+  }
+  MonitorPool::DumpForSigQuit(os);
+}
+
 MonitorInfo::MonitorInfo(mirror::Object* obj) : owner_(nullptr), entry_count_(0) {
   DCHECK(obj != nullptr);
   LockWord lock_word = obj->GetLockWord(true);
@@ -59,6 +59,15 @@ class Monitor {
   // a lock word. See Runtime::max_spins_before_thin_lock_inflation_.
   constexpr static size_t kDefaultMaxSpinsBeforeThinLockInflation = 50;
 
+  // Bounds for the adaptive spinning of contenders of an inflated monitor. Spinning threads are
+  // runnable, so the upper bound also caps how much spinning can delay a suspend all.
+  constexpr static uint32_t kMinMonitorSpinLimit = 16;
+  constexpr static uint32_t kInitialMonitorSpinLimit = 128;
+  constexpr static uint32_t kMaxMonitorSpinLimit = 2048;
+
+  // Iterations spent busy-waiting on a thin lock before each sched_yield().
+  constexpr static size_t kThinLockSpinIterations = 64;
+
   ~Monitor();
 
   static void Init(uint32_t lock_profiling_threshold, uint32_t stack_dump_lock_profiling_threshold);
@@ -212,6 +221,11 @@ class Monitor {
   bool TryLockLocked(Thread* self)
       REQUIRES(monitor_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
+  // Briefly releases the monitor lock and busy-waits for the owner to give up the monitor before
+  // retrying to acquire it. Returns true if we acquired the monitor. Adjusts spin_limit_.
+  bool TrySpinLock(Thread* self)
+      REQUIRES(monitor_lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
 
   template<LockReason reason = LockReason::kForLock>
   void Lock(Thread* self)
@@ -298,6 +312,10 @@ class Monitor {
   // Owner's recursive lock depth.
   int lock_count_ GUARDED_BY(monitor_lock_);
 
+  // How many iterations contenders spin waiting for the owner before blocking. Learned from the
+  // number of iterations recent successful spins took, which tracks how long the lock is held.
+  uint32_t spin_limit_ GUARDED_BY(monitor_lock_);
+
   // What object are we part of. This is a weak root. Do not access
   // this directly, use GetObject() to read it so it will be guarded
   // by a read barrier.
@@ -315,6 +333,11 @@ class Monitor {
   ArtMethod* locking_method_ GUARDED_BY(monitor_lock_);
   uint32_t locking_dex_pc_ GUARDED_BY(monitor_lock_);
 
+  // Method and dex pc where the owner acquired the monitor after blocking on it, recorded for the
+  // lock contention profiler. Null if the owner did not block or the profiler is disabled.
+  ArtMethod* contended_owner_method_ GUARDED_BY(monitor_lock_);
+  uint32_t contended_owner_dex_pc_ GUARDED_BY(monitor_lock_);
+
   // The denser encoded version of this monitor as stored in the lock word.
   MonitorId monitor_id_;
 
@@ -345,6 +368,7 @@ class MonitorList {
   // Returns how many monitors were deflated.
   size_t DeflateMonitors() REQUIRES(!monitor_list_lock_) REQUIRES(Locks::mutator_lock_);
   size_t Size() REQUIRES(!monitor_list_lock_);
+  void DumpForSigQuit(std::ostream& os) REQUIRES(!monitor_list_lock_);
 
   typedef std::list<Monitor*, TrackingAllocator<Monitor*, kAllocatorTagMonitorList>> Monitors;
 
@@ -357,6 +381,9 @@ class MonitorList {
   Mutex monitor_list_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
   ConditionVariable monitor_add_condition_ GUARDED_BY(monitor_list_lock_);
   Monitors list_ GUARDED_BY(monitor_list_lock_);
+  // Number of monitors ever added to the list and deflated, for the SIGQUIT dump.
+  uint64_t total_inflated_ GUARDED_BY(monitor_list_lock_);
+  uint64_t total_deflated_ GUARDED_BY(monitor_list_lock_);
 
   friend class Monitor;
   DISALLOW_COPY_AND_ASSIGN(MonitorList);
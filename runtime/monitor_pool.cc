@@ -16,8 +16,12 @@
 
 #include "monitor_pool.h"
 
+#include <map>
+#include <set>
+
 #include "base/logging.h"  // For VLOG.
 #include "base/mutex-inl.h"
+#include "base/utils.h"
 #include "monitor.h"
 #include "thread-current-inl.h"
 
@@ -29,7 +33,7 @@ class Object;
 
 MonitorPool::MonitorPool()
     : current_chunk_list_index_(0), num_chunks_(0), current_chunk_list_capacity_(0),
-    first_free_(nullptr) {
+    first_free_(nullptr), num_free_monitors_(0), num_live_chunks_(0), total_released_chunks_(0) {
   for (size_t i = 0; i < kMaxChunkLists; ++i) {
     monitor_chunks_[i] = nullptr;  // Not absolutely required, but ...
   }
@@ -41,6 +45,20 @@ MonitorPool::MonitorPool()
 void MonitorPool::AllocateChunk() {
   DCHECK(first_free_ == nullptr);
 
+  if (!released_chunk_indexes_.empty()) {
+    // Reuse the slot of a released chunk.
+    size_t chunk_index = released_chunk_indexes_.back();
+    released_chunk_indexes_.pop_back();
+    void* chunk = allocator_.allocate(kChunkSize);
+    CHECK_NE(reinterpret_cast<uintptr_t>(nullptr), reinterpret_cast<uintptr_t>(chunk));
+    CHECK_EQ(0U, reinterpret_cast<uintptr_t>(chunk) % kMonitorAlignment);
+    uintptr_t& slot = monitor_chunks_[chunk_index / kMaxListSize][chunk_index % kMaxListSize];
+    DCHECK_EQ(slot, 0U);
+    slot = reinterpret_cast<uintptr_t>(chunk);
+    AddChunkToFreeList(slot, chunk_index);
+    return;
+  }
+
   // Do we need to allocate another chunk list?
   if (num_chunks_ == current_chunk_list_capacity_) {
     if (current_chunk_list_capacity_ != 0U) {
@@ -67,13 +85,17 @@ void MonitorPool::AllocateChunk() {
   monitor_chunks_[current_chunk_list_index_][num_chunks_] = reinterpret_cast<uintptr_t>(chunk);
   num_chunks_++;
 
+  AddChunkToFreeList(reinterpret_cast<uintptr_t>(chunk),
+                     current_chunk_list_index_ * kMaxListSize + num_chunks_ - 1);
+}
+
+void MonitorPool::AddChunkToFreeList(uintptr_t chunk, size_t chunk_index) {
   // Set up the free list
-  Monitor* last = reinterpret_cast<Monitor*>(reinterpret_cast<uintptr_t>(chunk) +
-                                             (kChunkCapacity - 1) * kAlignedMonitorSize);
-  last->next_free_ = nullptr;
+  Monitor* last = reinterpret_cast<Monitor*>(chunk + (kChunkCapacity - 1) * kAlignedMonitorSize);
+  last->next_free_ = first_free_;
   // Eagerly compute id.
-  last->monitor_id_ = OffsetToMonitorId(current_chunk_list_index_* (kMaxListSize * kChunkSize)
-      + (num_chunks_ - 1) * kChunkSize + (kChunkCapacity - 1) * kAlignedMonitorSize);
+  last->monitor_id_ = OffsetToMonitorId(chunk_index * kChunkSize
+      + (kChunkCapacity - 1) * kAlignedMonitorSize);
   for (size_t i = 0; i < kChunkCapacity - 1; ++i) {
     Monitor* before = reinterpret_cast<Monitor*>(reinterpret_cast<uintptr_t>(last) -
                                                  kAlignedMonitorSize);
@@ -86,6 +108,8 @@ void MonitorPool::AllocateChunk() {
   }
   DCHECK(last == reinterpret_cast<Monitor*>(chunk));
   first_free_ = last;
+  num_free_monitors_ += kChunkCapacity;
+  ++num_live_chunks_;
 }
 
 void MonitorPool::FreeInternal() {
@@ -95,8 +119,10 @@ void MonitorPool::FreeInternal() {
     DCHECK_NE(monitor_chunks_[i], static_cast<uintptr_t*>(nullptr));
     for (size_t j = 0; j < ChunkListCapacity(i); ++j) {
       if (i < current_chunk_list_index_ || j < num_chunks_) {
-        DCHECK_NE(monitor_chunks_[i][j], 0U);
-        allocator_.deallocate(reinterpret_cast<uint8_t*>(monitor_chunks_[i][j]), kChunkSize);
+        // Released chunks leave an empty slot.
+        if (monitor_chunks_[i][j] != 0U) {
+          allocator_.deallocate(reinterpret_cast<uint8_t*>(monitor_chunks_[i][j]), kChunkSize);
+        }
       } else {
         DCHECK_EQ(monitor_chunks_[i][j], 0U);
       }
@@ -119,6 +145,7 @@ Monitor* MonitorPool::CreateMonitorInPool(Thread* self, Thread* owner, mirror::O
 
   Monitor* mon_uninitialized = first_free_;
   first_free_ = first_free_->next_free_;
+  --num_free_monitors_;
 
   // Pull out the id which was preinitialized.
   MonitorId id = mon_uninitialized->monitor_id_;
@@ -143,6 +170,7 @@ void MonitorPool::ReleaseMonitorToPool(Thread* self, Monitor* monitor) {
   // Add to the head of the free list.
   monitor->next_free_ = first_free_;
   first_free_ = monitor;
+  ++num_free_monitors_;
 
   // Rewrite monitor id.
   monitor->monitor_id_ = id;
@@ -154,4 +182,55 @@ void MonitorPool::ReleaseMonitorsToPool(Thread* self, MonitorList::Monitors* mon
   }
 }
 
+size_t MonitorPool::ReleaseUnusedChunksInPool(Thread* self) {
+  MutexLock mu(self, *Locks::allocated_monitor_ids_lock_);
+  // Count the free monitors of each chunk.
+  std::map<size_t, size_t> free_counts;
+  for (Monitor* mon = first_free_; mon != nullptr; mon = mon->next_free_) {
+    ++free_counts[MonitorIdToChunkIndex(mon->monitor_id_)];
+  }
+  std::set<size_t> unused_chunks;
+  for (const auto& entry : free_counts) {
+    DCHECK_LE(entry.second, kChunkCapacity);
+    if (entry.second == kChunkCapacity) {
+      unused_chunks.insert(entry.first);
+    }
+  }
+  if (!unused_chunks.empty()) {
+    // Keep one unused chunk around so that the next inflations do not reallocate right away.
+    unused_chunks.erase(unused_chunks.begin());
+  }
+  if (unused_chunks.empty()) {
+    return 0u;
+  }
+  // Unlink the monitors of the unused chunks from the free list.
+  Monitor** link = &first_free_;
+  while (*link != nullptr) {
+    Monitor* mon = *link;
+    if (unused_chunks.find(MonitorIdToChunkIndex(mon->monitor_id_)) != unused_chunks.end()) {
+      *link = mon->next_free_;
+    } else {
+      link = &mon->next_free_;
+    }
+  }
+  for (size_t chunk_index : unused_chunks) {
+    uintptr_t& slot = monitor_chunks_[chunk_index / kMaxListSize][chunk_index % kMaxListSize];
+    allocator_.deallocate(reinterpret_cast<uint8_t*>(slot), kChunkSize);
+    slot = 0U;
+    released_chunk_indexes_.push_back(chunk_index);
+  }
+  num_free_monitors_ -= unused_chunks.size() * kChunkCapacity;
+  num_live_chunks_ -= unused_chunks.size();
+  total_released_chunks_ += unused_chunks.size();
+  return unused_chunks.size();
+}
+
+void MonitorPool::DumpForSigQuitInPool(std::ostream& os) {
+  MutexLock mu(Thread::Current(), *Locks::allocated_monitor_ids_lock_);
+  os << "Monitor pool: chunks=" << num_live_chunks_
+     << " (" << PrettySize(num_live_chunks_ * kChunkSize) << ")"
+     << " free monitors=" << num_free_monitors_
+     << " released chunks=" << total_released_chunks_ << "\n";
+}
+
 }  // namespace art
@@ -19,9 +19,12 @@
 
 #include "monitor.h"
 
+#include <ostream>
+
 #include "base/allocator.h"
 #ifdef __LP64__
 #include <stdint.h>
+#include <vector>
 #include "base/atomic.h"
 #include "runtime.h"
 #else
@@ -96,6 +99,25 @@ class MonitorPool {
 #endif
   }
 
+  // Return the chunks that only hold free monitors to the allocator. Returns how many chunks were
+  // released.
+  static size_t ReleaseUnusedChunks(Thread* self) {
+#ifndef __LP64__
+    UNUSED(self);
+    return 0u;
+#else
+    return GetMonitorPool()->ReleaseUnusedChunksInPool(self);
+#endif
+  }
+
+  static void DumpForSigQuit(std::ostream& os) {
+#ifndef __LP64__
+    UNUSED(os);
+#else
+    GetMonitorPool()->DumpForSigQuitInPool(os);
+#endif
+  }
+
   static MonitorPool* GetMonitorPool() {
 #ifndef __LP64__
     return nullptr;
@@ -128,6 +150,13 @@ class MonitorPool {
   void ReleaseMonitorToPool(Thread* self, Monitor* monitor);
   void ReleaseMonitorsToPool(Thread* self, MonitorList::Monitors* monitors);
 
+  size_t ReleaseUnusedChunksInPool(Thread* self) REQUIRES(!Locks::allocated_monitor_ids_lock_);
+  void DumpForSigQuitInPool(std::ostream& os) REQUIRES(!Locks::allocated_monitor_ids_lock_);
+
+  // Thread the monitors of the chunk with the given index onto the free list.
+  void AddChunkToFreeList(uintptr_t chunk, size_t chunk_index)
+      REQUIRES(Locks::allocated_monitor_ids_lock_);
+
   // Note: This is safe as we do not ever move chunks.  All needed entries in the monitor_chunks_
   // data structure are read-only once we get here.  Updates happen-before this call because
   // the lock word was stored with release semantics and we read it with acquire semantics to
@@ -174,6 +203,12 @@ class MonitorPool {
     return static_cast<MonitorId>(offset >> 3);
   }
 
+  // Index of the chunk holding the monitor with the given id, counting kMaxListSize chunks for
+  // each chunk list.
+  static constexpr size_t MonitorIdToChunkIndex(MonitorId id) {
+    return MonitorIdToOffset(id) / kChunkSize;
+  }
+
   static constexpr size_t ChunkListCapacity(size_t index) {
     return kInitialChunkStorage << index;
   }
@@ -236,6 +271,15 @@ class MonitorPool {
   // Start of free list of monitors.
   // Note: these point to the right memory regions, but do *not* denote initialized objects.
   Monitor* first_free_ GUARDED_BY(Locks::allocated_monitor_ids_lock_);
+
+  // Indexes of the chunk slots whose chunk was released, reused before growing the chunk lists.
+  // Nothing refers to the ids of a released chunk, so readers never see its slot change.
+  std::vector<size_t> released_chunk_indexes_ GUARDED_BY(Locks::allocated_monitor_ids_lock_);
+
+  // Statistics for the SIGQUIT dump.
+  size_t num_free_monitors_ GUARDED_BY(Locks::allocated_monitor_ids_lock_);
+  size_t num_live_chunks_ GUARDED_BY(Locks::allocated_monitor_ids_lock_);
+  size_t total_released_chunks_ GUARDED_BY(Locks::allocated_monitor_ids_lock_);
 #endif
 };
 
@@ -16,6 +16,7 @@
 
 #include "monitor_pool.h"
 
+#include "base/enums.h"
 #include "common_runtime_test.h"
 #include "scoped_thread_state_change-inl.h"
 #include "thread-current-inl.h"
@@ -124,4 +125,30 @@ TEST_F(MonitorPoolTest, MonitorPoolTest) {
   }
 }
 
+TEST_F(MonitorPoolTest, ReleaseUnusedChunks) {
+  // Enough monitors to fill several chunks.
+  const size_t kNumMonitors = 1000;
+  Thread* self = Thread::Current();
+  ScopedObjectAccess soa(self);
+
+  for (size_t i = 0; i < 3; ++i) {
+    std::vector<Monitor*> monitors;
+    for (size_t j = 0; j < kNumMonitors; ++j) {
+      Monitor* mon = MonitorPool::CreateMonitor(self, self, nullptr, static_cast<int32_t>(j));
+      monitors.push_back(mon);
+      VerifyMonitor(mon, self);
+    }
+    for (Monitor* mon : monitors) {
+      MonitorPool::ReleaseMonitor(self, mon);
+    }
+    size_t released = MonitorPool::ReleaseUnusedChunks(self);
+    if (kRuntimePointerSize == PointerSize::k64) {
+      // Only one unused chunk is kept, the following iterations reuse the released slots.
+      EXPECT_GT(released, 0u);
+    } else {
+      EXPECT_EQ(released, 0u);
+    }
+  }
+}
+
 }  // namespace art
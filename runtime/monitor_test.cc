@@ -374,5 +374,52 @@ TEST_F(MonitorTest, TestTryLock) {
   thread_pool.StopWorkers(self);
 }
 
+class ContendedIncrementTask : public Task {
+ public:
+  ContendedIncrementTask(Handle<mirror::Object> obj, size_t* counter)
+      : obj_(obj), counter_(counter) {}
+
+  void Run(Thread* self) override {
+    ScopedObjectAccess soa(self);
+    for (size_t i = 0; i < kIncrements; ++i) {
+      ObjectLock<mirror::Object> lock(self, obj_);
+      ++*counter_;
+    }
+  }
+
+  void Finalize() override {
+    delete this;
+  }
+
+  static constexpr size_t kIncrements = 10000;
+
+ private:
+  Handle<mirror::Object> obj_;
+  size_t* const counter_;
+};
+
+// Test that spinning contenders, on both the thin lock and the inflated monitor, keep mutual
+// exclusion.
+TEST_F(MonitorTest, TestContendedSpinning) {
+  static constexpr size_t kNumThreads = 4;
+  Thread* const self = Thread::Current();
+  ThreadPool thread_pool("the pool", kNumThreads);
+  ScopedObjectAccess soa(self);
+  StackHandleScope<1> hs(self);
+  Handle<mirror::Object> obj(
+      hs.NewHandle<mirror::Object>(mirror::String::AllocFromModifiedUtf8(self, "hello, world!")));
+  size_t counter = 0u;
+  for (size_t i = 0; i < kNumThreads; ++i) {
+    thread_pool.AddTask(self, new ContendedIncrementTask(obj, &counter));
+  }
+  {
+    ScopedThreadSuspension sts(self, kSuspended);
+    thread_pool.StartWorkers(self);
+    thread_pool.Wait(self, /*do_work*/false, /*may_hold_locks*/false);
+  }
+  thread_pool.StopWorkers(self);
+  ObjectLock<mirror::Object> lock(self, obj);
+  EXPECT_EQ(counter, kNumThreads * ContendedIncrementTask::kIncrements);
+}
 
 }  // namespace art
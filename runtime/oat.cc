@@ -449,6 +449,10 @@ bool OatHeader::IsConcurrentCopying() const {
   return IsKeyEnabled(OatHeader::kConcurrentCopying);
 }
 
+bool OatHeader::HasImplicitSuspendChecks() const {
+  return IsKeyEnabled(OatHeader::kImplicitSuspendChecksKey);
+}
+
 bool OatHeader::IsNativeDebuggable() const {
   return IsKeyEnabled(OatHeader::kNativeDebuggableKey);
 }
@@ -32,8 +32,8 @@ class InstructionSetFeatures;
 class PACKED(4) OatHeader {
  public:
   static constexpr uint8_t kOatMagic[] = { 'o', 'a', 't', '\n' };
-  // Last oat version changed reason: Remove PIC option from oat files.
-  static constexpr uint8_t kOatVersion[] = { '1', '6', '2', '\0' };
+  // Last oat version changed reason: Zero-terminate compressed string data.
+  static constexpr uint8_t kOatVersion[] = { '1', '6', '3', '\0' };
 
   static constexpr const char* kImageLocationKey = "image-location";
   static constexpr const char* kDex2OatCmdLineKey = "dex2oat-cmdline";
@@ -44,7 +44,9 @@ class PACKED(4) OatHeader {
   static constexpr const char* kClassPathKey = "classpath";
   static constexpr const char* kBootClassPathKey = "bootclasspath";
   static constexpr const char* kConcurrentCopying = "concurrent-copying";
+  static constexpr const char* kImplicitSuspendChecksKey = "implicit-suspend-checks";
   static constexpr const char* kCompilationReasonKey = "compilation-reason";
+  static constexpr const char* kNativeOptimizationListKey = "native-optimization-list";
 
   static constexpr const char kTrueValue[] = "true";
   static constexpr const char kFalseValue[] = "false";
@@ -110,6 +112,7 @@ class PACKED(4) OatHeader {
   bool IsNativeDebuggable() const;
   CompilerFilter::Filter GetCompilerFilter() const;
   bool IsConcurrentCopying() const;
+  bool HasImplicitSuspendChecks() const;
 
  private:
   bool KeyHasValue(const char* key, const char* value, size_t value_size) const;
@@ -209,6 +209,11 @@ class OatFile {
       return type_;
     }
 
+    // Returns null for an invalid OatClass.
+    const OatFile* GetOatFile() const {
+      return oat_file_;
+    }
+
     // Get the OatMethod entry based on its index into the class
     // defintion. Direct methods come first, followed by virtual
     // methods. Note that runtime created methods such as miranda
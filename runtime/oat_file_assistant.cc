@@ -391,6 +391,13 @@ OatFileAssistant::OatStatus OatFileAssistant::GivenOatFileStatus(const OatFile&
     return kOatCannotOpen;
   }
 
+  // Code polling the suspend trigger faults when a suspension is requested, so it can only run
+  // with the SuspensionHandler installed. Code without polls runs everywhere.
+  if (file.GetOatHeader().HasImplicitSuspendChecks() &&
+      !Runtime::Current()->ImplicitSuspendChecks()) {
+    return kOatCannotOpen;
+  }
+
   // Verify the dex checksum.
   std::string error_msg;
   VdexFile* vdex = file.GetVdexFile();
@@ -289,6 +289,22 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
       .Define("-XX:NativeBridge=_")
           .WithType<std::string>()
           .IntoKey(M::NativeBridge)
+      .Define("-Xnative-optimization-list:_")
+          .WithType<std::string>()
+          .IntoKey(M::NativeOptimizationList)
+      .Define("-Xpreload-classes-profile:_")
+          .WithType<std::string>()
+          .IntoKey(M::PreloadClassesProfile)
+      .Define("-Xpreload-classes-threads:_")
+          .WithType<unsigned int>()
+          .IntoKey(M::PreloadClassesThreads)
+      .Define("-Xadaptive-dex-caches:_")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::AdaptiveDexCaches)
+      .Define("-Xdex-cache-hotness-profile:_")
+          .WithType<std::string>()
+          .IntoKey(M::DexCacheHotnessProfile)
       .Define("-Xzygote-max-boot-retry=_")
           .WithType<unsigned int>()
           .IntoKey(M::ZygoteMaxFailedBoots)
@@ -317,6 +333,19 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
       .Define("-XX:GlobalRefAllocStackTraceLimit=_")  // Number of free slots to enable tracing.
           .WithType<unsigned int>()
           .IntoKey(M::GlobalRefAllocStackTraceLimit)
+      .Define("-XX:AllocSampleInterval=_")  // Average bytes between allocation samples.
+          .WithType<Memory<1>>()
+          .IntoKey(M::AllocSampleInterval)
+      .Define("-XX:AllocSampleProfile=_")
+          .WithType<std::string>()
+          .IntoKey(M::AllocSampleProfile)
+      .Define("-XX:IncrementalHeapVerificationRegions=_")  // Regions verified after each GC.
+          .WithType<unsigned int>()
+          .IntoKey(M::IncrementalHeapVerificationRegions)
+      .Define("-XX:LockContentionProfiler=_")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::LockContentionProfiler)
       .Define("-XX:SlowDebug=_")
           .WithType<bool>()
           .WithValueMap({{"false", false}, {"true", true}})
@@ -737,6 +766,10 @@ void ParsedOptions::Usage(const char* fmt, ...) {
   UsageMessage(stream, "  -XX:DumpNativeStackOnSigQuit=booleanvalue\n");
   UsageMessage(stream, "  -XX:MadviseRandomAccess:booleanvalue\n");
   UsageMessage(stream, "  -XX:SlowDebug={false,true}\n");
+  UsageMessage(stream, "  -XX:AllocSampleInterval=N\n");
+  UsageMessage(stream, "  -XX:AllocSampleProfile=filename\n");
+  UsageMessage(stream, "  -XX:IncrementalHeapVerificationRegions=N\n");
+  UsageMessage(stream, "  -XX:LockContentionProfiler=(true|false)\n");
   UsageMessage(stream, "  -Xmethod-trace\n");
   UsageMessage(stream, "  -Xmethod-trace-file:filename");
   UsageMessage(stream, "  -Xmethod-trace-file-size:integervalue\n");
@@ -761,6 +794,10 @@ void ParsedOptions::Usage(const char* fmt, ...) {
   UsageMessage(stream, "  -X[no]relocate\n");
   UsageMessage(stream, "  -X[no]dex2oat (Whether to invoke dex2oat on the application)\n");
   UsageMessage(stream, "  -X[no]image-dex2oat (Whether to create and use a boot image)\n");
+  UsageMessage(stream, "  -Xpreload-classes-profile:filename\n");
+  UsageMessage(stream, "  -Xpreload-classes-threads:integervalue\n");
+  UsageMessage(stream, "  -Xadaptive-dex-caches:booleanvalue\n");
+  UsageMessage(stream, "  -Xdex-cache-hotness-profile:filename\n");
   UsageMessage(stream, "  -Xno-dex-file-fallback "
                        "(Don't fall back to dex files without oat files)\n");
   UsageMessage(stream, "  -Xplugin:<library.so> "
@@ -20,6 +20,7 @@
 #include "art_method-inl.h"
 #include "base/enums.h"
 #include "class_linker.h"
+#include "class_root.h"
 #include "common_throws.h"
 #include "dex/dex_file-inl.h"
 #include "indirect_reference_table-inl.h"
@@ -40,6 +41,32 @@ namespace {
 
 using android::base::StringPrintf;
 
+// Reads the value held by a boxed primitive into |value| and returns its primitive type, or
+// returns kPrimNot if |o| is not an instance of one of the java.lang box classes. The box classes
+// are final, so they are matched by identity against their class roots instead of by comparing
+// descriptors.
+Primitive::Type GetBoxedValue(ObjPtr<mirror::Object> o, JValue* value)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  ObjPtr<mirror::Class> klass = o->GetClass();
+  ObjPtr<mirror::ObjectArray<mirror::Class>> class_roots =
+      Runtime::Current()->GetClassLinker()->GetClassRoots();
+#define BOXED_VALUE(java_name, get_fn, set_fn, type)                                       \
+  if (klass == GetClassRoot(ClassRoot::kJavaLang ## java_name, class_roots)) {             \
+    value->set_fn(klass->GetIFieldsPtr()->At(0).get_fn(o));                                 \
+    return type;                                                                            \
+  }
+  BOXED_VALUE(Integer, GetInt, SetI, Primitive::kPrimInt)
+  BOXED_VALUE(Long, GetLong, SetJ, Primitive::kPrimLong)
+  BOXED_VALUE(Boolean, GetBoolean, SetZ, Primitive::kPrimBoolean)
+  BOXED_VALUE(Double, GetDouble, SetD, Primitive::kPrimDouble)
+  BOXED_VALUE(Float, GetFloat, SetF, Primitive::kPrimFloat)
+  BOXED_VALUE(Character, GetChar, SetC, Primitive::kPrimChar)
+  BOXED_VALUE(Byte, GetByte, SetB, Primitive::kPrimByte)
+  BOXED_VALUE(Short, GetShort, SetS, Primitive::kPrimShort)
+#undef BOXED_VALUE
+  return Primitive::kPrimNot;
+}
+
 class ArgArray {
  public:
   ArgArray(const char* shorty, uint32_t shorty_len)
@@ -213,14 +240,6 @@ class ArgArray {
     }
   }
 
-  static void ThrowIllegalPrimitiveArgumentException(const char* expected,
-                                                     const char* found_descriptor)
-      REQUIRES_SHARED(Locks::mutator_lock_) {
-    ThrowIllegalArgumentException(
-        StringPrintf("Invalid primitive conversion from %s to %s", expected,
-                     PrettyDescriptor(found_descriptor).c_str()).c_str());
-  }
-
   bool BuildArgArrayFromObjectArray(ObjPtr<mirror::Object> receiver,
                                     ObjPtr<mirror::ObjectArray<mirror::Object>> raw_args,
                                     ArtMethod* m,
@@ -258,99 +277,42 @@ class ArgArray {
         }
       }
 
-#define DO_FIRST_ARG(match_descriptor, get_fn, append) { \
-          if (LIKELY(arg != nullptr && \
-              arg->GetClass()->DescriptorEquals(match_descriptor))) { \
-            ArtField* primitive_field = arg->GetClass()->GetInstanceField(0); \
-            append(primitive_field-> get_fn(arg.Get()));
-
-#define DO_ARG(match_descriptor, get_fn, append) \
-          } else if (LIKELY(arg != nullptr && \
-                            arg->GetClass<>()->DescriptorEquals(match_descriptor))) { \
-            ArtField* primitive_field = arg->GetClass()->GetInstanceField(0); \
-            append(primitive_field-> get_fn(arg.Get()));
-
-#define DO_FAIL(expected) \
-          } else { \
-            if (arg->GetClass<>()->IsPrimitive()) { \
-              std::string temp; \
-              ThrowIllegalPrimitiveArgumentException(expected, \
-                                                     arg->GetClass<>()->GetDescriptor(&temp)); \
-            } else { \
-              ThrowIllegalArgumentException(\
-                  StringPrintf("method %s argument %zd has type %s, got %s", \
-                      ArtMethod::PrettyMethod(m, false).c_str(), \
-                      args_offset + 1, \
-                      expected, \
-                      mirror::Object::PrettyTypeOf(arg.Get()).c_str()).c_str()); \
-            } \
-            return false; \
-          } }
+      if (shorty_[i] == 'L') {
+        Append(arg.Get());
+        continue;
+      }
 
-      switch (shorty_[i]) {
-        case 'L':
-          Append(arg.Get());
-          break;
-        case 'Z':
-          DO_FIRST_ARG("Ljava/lang/Boolean;", GetBoolean, Append)
-          DO_FAIL("boolean")
-          break;
-        case 'B':
-          DO_FIRST_ARG("Ljava/lang/Byte;", GetByte, Append)
-          DO_FAIL("byte")
-          break;
-        case 'C':
-          DO_FIRST_ARG("Ljava/lang/Character;", GetChar, Append)
-          DO_FAIL("char")
-          break;
-        case 'S':
-          DO_FIRST_ARG("Ljava/lang/Short;", GetShort, Append)
-          DO_ARG("Ljava/lang/Byte;", GetByte, Append)
-          DO_FAIL("short")
-          break;
-        case 'I':
-          DO_FIRST_ARG("Ljava/lang/Integer;", GetInt, Append)
-          DO_ARG("Ljava/lang/Character;", GetChar, Append)
-          DO_ARG("Ljava/lang/Short;", GetShort, Append)
-          DO_ARG("Ljava/lang/Byte;", GetByte, Append)
-          DO_FAIL("int")
-          break;
-        case 'J':
-          DO_FIRST_ARG("Ljava/lang/Long;", GetLong, AppendWide)
-          DO_ARG("Ljava/lang/Integer;", GetInt, AppendWide)
-          DO_ARG("Ljava/lang/Character;", GetChar, AppendWide)
-          DO_ARG("Ljava/lang/Short;", GetShort, AppendWide)
-          DO_ARG("Ljava/lang/Byte;", GetByte, AppendWide)
-          DO_FAIL("long")
+      // Unbox the argument and widen it to the parameter type. The null case has been
+      // rejected above, so |arg| is known to be non-null here.
+      Primitive::Type dst_type = Primitive::GetType(shorty_[i]);
+      JValue boxed_value;
+      JValue value;
+      Primitive::Type src_type = GetBoxedValue(arg.Get(), &boxed_value);
+      if (UNLIKELY(src_type == Primitive::kPrimNot ||
+                   !ConvertPrimitiveValueNoThrow(src_type, dst_type, boxed_value, &value))) {
+        ThrowIllegalArgumentException(
+            StringPrintf("method %s argument %zd has type %s, got %s",
+                ArtMethod::PrettyMethod(m, false).c_str(),
+                args_offset + 1,
+                PrettyDescriptor(dst_type).c_str(),
+                mirror::Object::PrettyTypeOf(arg.Get()).c_str()).c_str());
+        return false;
+      }
+      switch (dst_type) {
+        case Primitive::kPrimLong:
+          AppendWide(value.GetJ());
           break;
-        case 'F':
-          DO_FIRST_ARG("Ljava/lang/Float;", GetFloat, AppendFloat)
-          DO_ARG("Ljava/lang/Long;", GetLong, AppendFloat)
-          DO_ARG("Ljava/lang/Integer;", GetInt, AppendFloat)
-          DO_ARG("Ljava/lang/Character;", GetChar, AppendFloat)
-          DO_ARG("Ljava/lang/Short;", GetShort, AppendFloat)
-          DO_ARG("Ljava/lang/Byte;", GetByte, AppendFloat)
-          DO_FAIL("float")
+        case Primitive::kPrimFloat:
+          AppendFloat(value.GetF());
           break;
-        case 'D':
-          DO_FIRST_ARG("Ljava/lang/Double;", GetDouble, AppendDouble)
-          DO_ARG("Ljava/lang/Float;", GetFloat, AppendDouble)
-          DO_ARG("Ljava/lang/Long;", GetLong, AppendDouble)
-          DO_ARG("Ljava/lang/Integer;", GetInt, AppendDouble)
-          DO_ARG("Ljava/lang/Character;", GetChar, AppendDouble)
-          DO_ARG("Ljava/lang/Short;", GetShort, AppendDouble)
-          DO_ARG("Ljava/lang/Byte;", GetByte, AppendDouble)
-          DO_FAIL("double")
+        case Primitive::kPrimDouble:
+          AppendDouble(value.GetD());
           break;
-#ifndef NDEBUG
         default:
-          LOG(FATAL) << "Unexpected shorty character: " << shorty_[i];
-          UNREACHABLE();
-#endif
+          // The JValue setters sign- or zero-extend sub-word values as their type requires.
+          Append(value.GetI());
+          break;
       }
-#undef DO_FIRST_ARG
-#undef DO_ARG
-#undef DO_FAIL
     }
     return true;
   }
@@ -773,6 +735,30 @@ ObjPtr<mirror::Object> BoxPrimitive(Primitive::Type src_class, const JValue& val
     return nullptr;
   }
 
+  // Double.valueOf() and Float.valueOf() always return a new box, allocate it here rather than
+  // calling into managed code. The other valueOf() methods may return cached boxes.
+  if ((src_class == Primitive::kPrimDouble || src_class == Primitive::kPrimFloat) &&
+      !Runtime::Current()->IsActiveTransaction()) {
+    Thread* self = Thread::Current();
+    ObjPtr<mirror::Class> klass = GetClassRoot(src_class == Primitive::kPrimDouble
+                                                   ? ClassRoot::kJavaLangDouble
+                                                   : ClassRoot::kJavaLangFloat);
+    if (LIKELY(klass->IsInitialized())) {
+      ObjPtr<mirror::Object> box = klass->AllocObject(self);
+      if (UNLIKELY(box == nullptr)) {
+        self->AssertPendingOOMException();
+        return nullptr;
+      }
+      ArtField* value_field = &klass->GetIFieldsPtr()->At(0);
+      if (src_class == Primitive::kPrimDouble) {
+        value_field->SetDouble</* kTransactionActive */ false>(box, value.GetD());
+      } else {
+        value_field->SetFloat</* kTransactionActive */ false>(box, value.GetF());
+      }
+      return box;
+    }
+  }
+
   jmethodID m = nullptr;
   const char* shorty;
   switch (src_class) {
@@ -885,35 +871,8 @@ static bool UnboxPrimitive(ObjPtr<mirror::Object> o,
   }
 
   JValue boxed_value;
-  ObjPtr<mirror::Class> klass = o->GetClass();
-  ObjPtr<mirror::Class> src_class = nullptr;
-  ClassLinker* const class_linker = Runtime::Current()->GetClassLinker();
-  ArtField* primitive_field = &klass->GetIFieldsPtr()->At(0);
-  if (klass->DescriptorEquals("Ljava/lang/Boolean;")) {
-    src_class = class_linker->FindPrimitiveClass('Z');
-    boxed_value.SetZ(primitive_field->GetBoolean(o));
-  } else if (klass->DescriptorEquals("Ljava/lang/Byte;")) {
-    src_class = class_linker->FindPrimitiveClass('B');
-    boxed_value.SetB(primitive_field->GetByte(o));
-  } else if (klass->DescriptorEquals("Ljava/lang/Character;")) {
-    src_class = class_linker->FindPrimitiveClass('C');
-    boxed_value.SetC(primitive_field->GetChar(o));
-  } else if (klass->DescriptorEquals("Ljava/lang/Float;")) {
-    src_class = class_linker->FindPrimitiveClass('F');
-    boxed_value.SetF(primitive_field->GetFloat(o));
-  } else if (klass->DescriptorEquals("Ljava/lang/Double;")) {
-    src_class = class_linker->FindPrimitiveClass('D');
-    boxed_value.SetD(primitive_field->GetDouble(o));
-  } else if (klass->DescriptorEquals("Ljava/lang/Integer;")) {
-    src_class = class_linker->FindPrimitiveClass('I');
-    boxed_value.SetI(primitive_field->GetInt(o));
-  } else if (klass->DescriptorEquals("Ljava/lang/Long;")) {
-    src_class = class_linker->FindPrimitiveClass('J');
-    boxed_value.SetJ(primitive_field->GetLong(o));
-  } else if (klass->DescriptorEquals("Ljava/lang/Short;")) {
-    src_class = class_linker->FindPrimitiveClass('S');
-    boxed_value.SetS(primitive_field->GetShort(o));
-  } else {
+  Primitive::Type src_type = GetBoxedValue(o, &boxed_value);
+  if (UNLIKELY(src_type == Primitive::kPrimNot)) {
     std::string temp;
     ThrowIllegalArgumentException(
         StringPrintf("%s has type %s, got %s", UnboxingFailureKind(f).c_str(),
@@ -923,7 +882,7 @@ static bool UnboxPrimitive(ObjPtr<mirror::Object> o,
   }
 
   return ConvertPrimitiveValue(unbox_for_result,
-                               src_class->GetPrimitiveType(), dst_class->GetPrimitiveType(),
+                               src_type, dst_class->GetPrimitiveType(),
                                boxed_value, unboxed_value);
 }
 
@@ -21,10 +21,13 @@
 
 #include "art_method-inl.h"
 #include "base/enums.h"
+#include "class_root.h"
 #include "common_compiler_test.h"
 #include "dex/descriptors_names.h"
 #include "jni/java_vm_ext.h"
 #include "jni/jni_internal.h"
+#include "mirror/method.h"
+#include "mirror/object_array-inl.h"
 #include "nativehelper/scoped_local_ref.h"
 #include "scoped_thread_state_change-inl.h"
 
@@ -413,6 +416,68 @@ class ReflectionTest : public CommonCompilerTest {
     EXPECT_DOUBLE_EQ(INFINITY, result.GetD());
   }
 
+  // Invokes sum(DD)D through the java.lang.reflect.Method path, which has to unbox and widen
+  // its arguments.
+  void InvokeSumDoubleDoubleMethodWithBoxedArgs(bool is_static) {
+    ScopedObjectAccess soa(env_);
+    ArtMethod* method;
+    ObjPtr<mirror::Object> receiver;
+    ReflectionTestMakeExecutable(&method, &receiver, is_static, "sum", "(DD)D");
+    ScopedLocalRef<jobject> receiver_ref(soa.Env(), soa.AddLocalReference<jobject>(receiver));
+
+    StackHandleScope<2> hs(soa.Self());
+    Handle<mirror::Method> method_obj = hs.NewHandle(
+        mirror::Method::CreateFromArtMethod<kRuntimePointerSize, false>(soa.Self(), method));
+    ASSERT_TRUE(method_obj != nullptr);
+    // The test methods are package-private; skip the caller access check.
+    method_obj->SetFieldBoolean<false>(mirror::AccessibleObject::FlagOffset(), 1u);
+    ScopedLocalRef<jobject> method_ref(soa.Env(), soa.AddLocalReference<jobject>(method_obj.Get()));
+    Handle<mirror::ObjectArray<mirror::Object>> args = hs.NewHandle(
+        mirror::ObjectArray<mirror::Object>::Alloc(
+            soa.Self(), GetClassRoot<mirror::ObjectArray<mirror::Object>>(), 2));
+    ASSERT_TRUE(args != nullptr);
+    ScopedLocalRef<jobject> args_ref(soa.Env(), soa.AddLocalReference<jobject>(args.Get()));
+
+    JValue value;
+    value.SetI(1);
+    args->Set<false>(0, BoxPrimitive(Primitive::kPrimInt, value));
+    value.SetF(2.5f);
+    args->Set<false>(1, BoxPrimitive(Primitive::kPrimFloat, value));
+    ScopedLocalRef<jobject> result(soa.Env(), InvokeMethod(soa,
+                                                           method_ref.get(),
+                                                           receiver_ref.get(),
+                                                           args_ref.get()));
+    ASSERT_FALSE(soa.Self()->IsExceptionPending());
+    JValue unboxed;
+    ASSERT_TRUE(UnboxPrimitiveForResult(soa.Decode<mirror::Object>(result.get()),
+                                        class_linker_->FindPrimitiveClass('D'),
+                                        &unboxed));
+    EXPECT_DOUBLE_EQ(3.5, unboxed.GetD());
+
+    // Sub-word values must be sign-extended when widened.
+    value.SetB(-1);
+    args->Set<false>(0, BoxPrimitive(Primitive::kPrimByte, value));
+    value.SetJ(2);
+    args->Set<false>(1, BoxPrimitive(Primitive::kPrimLong, value));
+    result.reset(InvokeMethod(soa, method_ref.get(), receiver_ref.get(), args_ref.get()));
+    ASSERT_FALSE(soa.Self()->IsExceptionPending());
+    ASSERT_TRUE(UnboxPrimitiveForResult(soa.Decode<mirror::Object>(result.get()),
+                                        class_linker_->FindPrimitiveClass('D'),
+                                        &unboxed));
+    EXPECT_DOUBLE_EQ(1.0, unboxed.GetD());
+
+    // There is no widening conversion from boolean, and a non-box is never unboxed.
+    value.SetZ(1);
+    args->Set<false>(0, BoxPrimitive(Primitive::kPrimBoolean, value));
+    EXPECT_EQ(nullptr, InvokeMethod(soa, method_ref.get(), receiver_ref.get(), args_ref.get()));
+    EXPECT_TRUE(soa.Self()->IsExceptionPending());
+    soa.Self()->ClearException();
+    args->Set<false>(0, args.Get());
+    EXPECT_EQ(nullptr, InvokeMethod(soa, method_ref.get(), receiver_ref.get(), args_ref.get()));
+    EXPECT_TRUE(soa.Self()->IsExceptionPending());
+    soa.Self()->ClearException();
+  }
+
   void InvokeSumDoubleDoubleDoubleMethod(bool is_static) {
     ScopedObjectAccess soa(env_);
     ArtMethod* method;
@@ -633,4 +698,12 @@ TEST_F(ReflectionTest, NonStaticSumDoubleDoubleDoubleDoubleDoubleMethod) {
   InvokeSumDoubleDoubleDoubleDoubleDoubleMethod(false);
 }
 
+TEST_F(ReflectionTest, StaticSumDoubleDoubleMethodWithBoxedArgs) {
+  InvokeSumDoubleDoubleMethodWithBoxedArgs(true);
+}
+
+TEST_F(ReflectionTest, NonStaticSumDoubleDoubleMethodWithBoxedArgs) {
+  InvokeSumDoubleDoubleMethodWithBoxedArgs(false);
+}
+
 }  // namespace art
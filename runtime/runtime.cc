@@ -34,6 +34,8 @@
 #include <cstdio>
 #include <cstdlib>
 #include <limits>
+#include <set>
+#include <thread>
 #include <vector>
 
 #include "android-base/strings.h"
@@ -77,6 +79,7 @@
 #include "experimental_flags.h"
 #include "fault_handler.h"
 #include "gc/accounting/card_table-inl.h"
+#include "gc/allocation_sampler.h"
 #include "gc/heap.h"
 #include "gc/scoped_gc_critical_section.h"
 #include "gc/space/image_space.h"
@@ -93,12 +96,15 @@
 #include "jit/profile_saver.h"
 #include "jni/java_vm_ext.h"
 #include "jni/jni_internal.h"
+#include "jni/native_optimization_list.h"
 #include "linear_alloc.h"
+#include "lock_contention_profiler.h"
 #include "memory_representation.h"
 #include "mirror/array.h"
 #include "mirror/class-inl.h"
 #include "mirror/class_ext.h"
 #include "mirror/class_loader.h"
+#include "mirror/dex_cache.h"
 #include "mirror/emulated_stack_frame.h"
 #include "mirror/field.h"
 #include "mirror/method.h"
@@ -144,6 +150,7 @@
 #include "oat_file_manager.h"
 #include "object_callbacks.h"
 #include "parsed_options.h"
+#include "profile/profile_compilation_info.h"
 #include "quick/quick_method_frame_info.h"
 #include "reflection.h"
 #include "runtime_callbacks.h"
@@ -158,6 +165,7 @@
 #include "ti/agent.h"
 #include "trace.h"
 #include "transaction.h"
+#include "utils/dex_cache_arrays_layout.h"
 #include "vdex_file.h"
 #include "verifier/method_verifier.h"
 #include "well_known_classes.h"
@@ -222,6 +230,8 @@ Runtime::Runtime()
       max_spins_before_thin_lock_inflation_(Monitor::kDefaultMaxSpinsBeforeThinLockInflation),
       monitor_list_(nullptr),
       monitor_pool_(nullptr),
+      preload_classes_threads_(0u),
+      adaptive_dex_caches_(false),
       thread_list_(nullptr),
       intern_table_(nullptr),
       class_linker_(nullptr),
@@ -268,6 +278,7 @@ Runtime::Runtime()
       dedupe_hidden_api_warnings_(true),
       always_set_hidden_api_warning_flag_(false),
       hidden_api_access_event_log_rate_(0),
+      hidden_api_settings_generation_(0u),
       dump_native_stack_on_sig_quit_(true),
       pruned_dalvik_cache_(false),
       // Initially assume we perceive jank in case the process state is never updated.
@@ -825,6 +836,15 @@ bool Runtime::Start() {
 
   StartDaemonThreads();
 
+  if (!preload_classes_profile_.empty() && system_class_loader_ != nullptr) {
+    unsigned int num_threads = preload_classes_threads_;
+    if (num_threads == 0u) {
+      num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    GetClassLinker()->PreloadProfileClasses(
+        self, system_class_loader_, preload_classes_profile_, num_threads);
+  }
+
   {
     ScopedObjectAccess soa(self);
     self->GetJniEnv()->AssertLocalsEmpty();
@@ -1209,12 +1229,37 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
 
   monitor_list_ = new MonitorList;
   monitor_pool_ = MonitorPool::Create();
+  lock_contention_profiler_.reset(new LockContentionProfiler());
+  lock_contention_profiler_->SetEnabled(runtime_options.GetOrDefault(Opt::LockContentionProfiler));
   thread_list_ = new ThreadList(runtime_options.GetOrDefault(Opt::ThreadSuspendTimeout));
   intern_table_ = new InternTable;
 
   verify_ = runtime_options.GetOrDefault(Opt::Verify);
   allow_dex_file_fallback_ = !runtime_options.Exists(Opt::NoDexFileFallback);
 
+  if (runtime_options.Exists(Opt::NativeOptimizationList)) {
+    std::string error_msg;
+    native_optimization_list_ = NativeOptimizationList::Create(
+        runtime_options.GetOrDefault(Opt::NativeOptimizationList), &error_msg);
+    if (native_optimization_list_ == nullptr) {
+      LOG(WARNING) << "Ignoring native optimization list: " << error_msg;
+    }
+  }
+  preload_classes_profile_ = runtime_options.ReleaseOrDefault(Opt::PreloadClassesProfile);
+  preload_classes_threads_ = runtime_options.GetOrDefault(Opt::PreloadClassesThreads);
+  adaptive_dex_caches_ = runtime_options.GetOrDefault(Opt::AdaptiveDexCaches);
+  mirror::DexCache::SetRecordMisses(adaptive_dex_caches_);
+  if (adaptive_dex_caches_ && runtime_options.Exists(Opt::DexCacheHotnessProfile)) {
+    std::string profile_file = runtime_options.GetOrDefault(Opt::DexCacheHotnessProfile);
+    std::unique_ptr<ProfileCompilationInfo> profile(new ProfileCompilationInfo());
+    std::unique_ptr<File> file(OS::OpenFileForReading(profile_file.c_str()));
+    if (file != nullptr && profile->Load(file->Fd())) {
+      dex_cache_hotness_profile_ = std::move(profile);
+    } else {
+      LOG(WARNING) << "Could not load dex cache hotness profile " << profile_file;
+    }
+  }
+
   target_sdk_version_ = runtime_options.GetOrDefault(Opt::TargetSdkVersion);
 
   // Check whether to enforce hidden API access checks. The checks are disabled
@@ -1304,6 +1349,14 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
 
   dump_gc_performance_on_shutdown_ = runtime_options.Exists(Opt::DumpGCPerformanceOnShutdown);
 
+  const size_t alloc_sample_interval = runtime_options.GetOrDefault(Opt::AllocSampleInterval);
+  if (alloc_sample_interval != 0u) {
+    heap_->GetAllocationSampler()->Start(alloc_sample_interval,
+                                         runtime_options.GetOrDefault(Opt::AllocSampleProfile));
+  }
+  heap_->SetIncrementalVerificationRegions(
+      runtime_options.GetOrDefault(Opt::IncrementalHeapVerificationRegions));
+
   jdwp_options_ = runtime_options.GetOrDefault(Opt::JdwpOptions);
   jdwp_provider_ = CanonicalizeJdwpProvider(runtime_options.GetOrDefault(Opt::JdwpProvider),
                                             IsJavaDebuggable());
@@ -1397,6 +1450,26 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
       // Keep the defaults.
       break;
   }
+  // Code compiled with --implicit-suspend-checks polls the suspend trigger, which faults
+  // whenever a suspend or checkpoint is requested. Only the arm64 code generator emits such polls.
+  // Install the handler if the boot image was compiled that way, or if the runtime is given the
+  // option with -Xcompiler-option, which also makes the JIT and the compilations started by the
+  // runtime use it. Other oat files with polls are rejected without the handler, see
+  // OatFileAssistant::GivenOatFileStatus().
+  if (kRuntimeISA == InstructionSet::kArm64) {
+    for (StringPiece option : compiler_options_) {
+      if (option == "--implicit-suspend-checks") {
+        implicit_suspend_checks_ = true;
+        break;
+      }
+    }
+    for (gc::space::ImageSpace* image_space : heap_->GetBootImageSpaces()) {
+      if (image_space->GetOatFile()->GetOatHeader().HasImplicitSuspendChecks()) {
+        implicit_suspend_checks_ = true;
+        break;
+      }
+    }
+  }
 
   if (!no_sig_chain_) {
     // Dex2Oat's Runtime does not need the signal chain or the fault handler.
@@ -1874,6 +1947,7 @@ void Runtime::DumpForSigQuit(std::ostream& os) {
   GetInternTable()->DumpForSigQuit(os);
   GetJavaVM()->DumpForSigQuit(os);
   GetHeap()->DumpForSigQuit(os);
+  GetMonitorList()->DumpForSigQuit(os);
   oat_file_manager_->DumpForSigQuit(os);
   if (GetJit() != nullptr) {
     GetJit()->DumpForSigQuit(os);
@@ -1886,6 +1960,8 @@ void Runtime::DumpForSigQuit(std::ostream& os) {
 
   thread_list_->DumpForSigQuit(os);
   BaseMutex::DumpAll(os);
+  // Merging the profile runs a checkpoint, do it after dumping the threads in case it hangs.
+  lock_contention_profiler_->DumpForSigQuit(os);
 
   // Inform anyone else who is interested in SigQuit.
   {
@@ -2536,6 +2612,27 @@ bool Runtime::IsVerificationSoftFail() const {
   return verify_ == verifier::VerifyMode::kSoftFail;
 }
 
+DexCacheSizing Runtime::GetDexCacheSizing(const DexFile& dex_file) const {
+  if (!adaptive_dex_caches_) {
+    return DexCacheSizing::kFixed;
+  }
+  if (dex_cache_hotness_profile_ != nullptr) {
+    // A dex file is hot if at least this fraction of its methods were hot in the profile.
+    static constexpr size_t kHotMethodsFraction = 16u;
+    std::set<dex::TypeIndex> classes;
+    std::set<uint16_t> hot_methods;
+    std::set<uint16_t> startup_methods;
+    std::set<uint16_t> post_startup_methods;
+    if (dex_cache_hotness_profile_->GetClassesAndMethods(
+            dex_file, &classes, &hot_methods, &startup_methods, &post_startup_methods) &&
+        !hot_methods.empty() &&
+        hot_methods.size() * kHotMethodsFraction >= dex_file.NumMethodIds()) {
+      return DexCacheSizing::kFull;
+    }
+  }
+  return DexCacheSizing::kAdaptive;
+}
+
 bool Runtime::IsAsyncDeoptimizeable(uintptr_t code) const {
   // We only support async deopt (ie the compiled code is not explicitly asking for
   // deopt, but something else like the debugger) in debuggable JIT code.
@@ -2645,6 +2742,8 @@ class UpdateEntryPointsClassVisitor : public ClassVisitor {
 
 void Runtime::SetJavaDebuggable(bool value) {
   is_java_debuggable_ = value;
+  // Debuggable apps get warnings for more hidden API accesses.
+  InvalidateHiddenApiDecisions();
   // Do not call DeoptimizeBootImage just yet, the runtime may still be starting up.
 }
 
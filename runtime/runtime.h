@@ -83,15 +83,19 @@ enum class CalleeSaveType: uint32_t;
 class ClassLinker;
 class CompilerCallbacks;
 class DexFile;
+enum class DexCacheSizing : uint8_t;
 class InternTable;
 class IsMarkedVisitor;
 class JavaVMExt;
 class LinearAlloc;
+class LockContentionProfiler;
 class MonitorList;
 class MonitorPool;
+class NativeOptimizationList;
 class NullPointerHandler;
 class OatFileManager;
 class Plugin;
+class ProfileCompilationInfo;
 struct RuntimeArgumentMap;
 class RuntimeCallbacks;
 class SignalCatcher;
@@ -282,6 +286,20 @@ class Runtime {
     return monitor_pool_;
   }
 
+  LockContentionProfiler* GetLockContentionProfiler() const {
+    return lock_contention_profiler_.get();
+  }
+
+  // Returns the list given with -Xnative-optimization-list, null if there is none.
+  const NativeOptimizationList* GetNativeOptimizationList() const {
+    return native_optimization_list_.get();
+  }
+
+  // Returns how the dex cache arrays of `dex_file` should be sized. Fixed unless the runtime
+  // was started with -Xadaptive-dex-caches:true, in which case dex files that are hot in the
+  // -Xdex-cache-hotness-profile get arrays holding every id.
+  DexCacheSizing GetDexCacheSizing(const DexFile& dex_file) const;
+
   // Is the given object the special object used to mark a cleared JNI weak global?
   bool IsClearedJniWeakGlobal(ObjPtr<mirror::Object> obj) REQUIRES_SHARED(Locks::mutator_lock_);
 
@@ -499,13 +517,13 @@ class Runtime {
   void RecordWriteArray(mirror::Array* array, size_t index, uint64_t value) const
       REQUIRES_SHARED(Locks::mutator_lock_);
   void RecordStrongStringInsertion(ObjPtr<mirror::String> s) const
-      REQUIRES(Locks::intern_table_lock_);
+      REQUIRES_SHARED(Locks::mutator_lock_);
   void RecordWeakStringInsertion(ObjPtr<mirror::String> s) const
-      REQUIRES(Locks::intern_table_lock_);
+      REQUIRES_SHARED(Locks::mutator_lock_);
   void RecordStrongStringRemoval(ObjPtr<mirror::String> s) const
-      REQUIRES(Locks::intern_table_lock_);
+      REQUIRES_SHARED(Locks::mutator_lock_);
   void RecordWeakStringRemoval(ObjPtr<mirror::String> s) const
-      REQUIRES(Locks::intern_table_lock_);
+      REQUIRES_SHARED(Locks::mutator_lock_);
   void RecordResolveString(ObjPtr<mirror::DexCache> dex_cache, dex::StringIndex string_idx) const
       REQUIRES_SHARED(Locks::mutator_lock_);
 
@@ -522,12 +540,19 @@ class Runtime {
     return !implicit_so_checks_;
   }
 
+  // Whether the SuspensionHandler is installed, i.e. whether code compiled with
+  // --implicit-suspend-checks can run.
+  bool ImplicitSuspendChecks() const {
+    return implicit_suspend_checks_;
+  }
+
   void DisableVerifier();
   bool IsVerificationEnabled() const;
   bool IsVerificationSoftFail() const;
 
   void SetHiddenApiEnforcementPolicy(hiddenapi::EnforcementPolicy policy) {
     hidden_api_policy_ = policy;
+    InvalidateHiddenApiDecisions();
   }
 
   hiddenapi::EnforcementPolicy GetHiddenApiEnforcementPolicy() const {
@@ -540,6 +565,7 @@ class Runtime {
 
   void SetHiddenApiExemptions(const std::vector<std::string>& exemptions) {
     hidden_api_exemptions_ = exemptions;
+    InvalidateHiddenApiDecisions();
   }
 
   const std::vector<std::string>& GetHiddenApiExemptions() {
@@ -552,6 +578,7 @@ class Runtime {
 
   void SetDedupeHiddenApiWarnings(bool value) {
     dedupe_hidden_api_warnings_ = value;
+    InvalidateHiddenApiDecisions();
   }
 
   bool ShouldDedupeHiddenApiWarnings() {
@@ -560,6 +587,7 @@ class Runtime {
 
   void AlwaysSetHiddenApiWarningFlag() {
     always_set_hidden_api_warning_flag_ = true;
+    InvalidateHiddenApiDecisions();
   }
 
   bool ShouldAlwaysSetHiddenApiWarningFlag() const {
@@ -574,6 +602,16 @@ class Runtime {
     return hidden_api_access_event_log_rate_;
   }
 
+  // Returns the generation of the hidden API settings. It changes with every setting that can
+  // change the outcome of a hidden API check, invalidating the decisions cached for members.
+  uint32_t GetHiddenApiSettingsGeneration() const {
+    return hidden_api_settings_generation_.load(std::memory_order_acquire);
+  }
+
+  void InvalidateHiddenApiDecisions() {
+    hidden_api_settings_generation_.fetch_add(1u, std::memory_order_acq_rel);
+  }
+
   const std::string& GetProcessPackageName() const {
     return process_package_name_;
   }
@@ -875,6 +913,18 @@ class Runtime {
   size_t max_spins_before_thin_lock_inflation_;
   MonitorList* monitor_list_;
   MonitorPool* monitor_pool_;
+  std::unique_ptr<LockContentionProfiler> lock_contention_profiler_;
+  std::unique_ptr<const NativeOptimizationList> native_optimization_list_;
+
+  // Profile of classes to preload in parallel before main starts, and the number of threads to
+  // use for that, zero meaning one per CPU.
+  std::string preload_classes_profile_;
+  unsigned int preload_classes_threads_;
+
+  // Whether dex cache arrays are sized from the dex file and the profile telling which dex files
+  // are hot enough for full-size arrays, see GetDexCacheSizing().
+  bool adaptive_dex_caches_;
+  std::unique_ptr<const ProfileCompilationInfo> dex_cache_hotness_profile_;
 
   ThreadList* thread_list_;
 
@@ -1040,6 +1090,9 @@ class Runtime {
   // (never) and 0x10000 (always).
   uint32_t hidden_api_access_event_log_rate_;
 
+  // See GetHiddenApiSettingsGeneration().
+  std::atomic<uint32_t> hidden_api_settings_generation_;
+
   // The package of the app running in this process.
   std::string process_package_name_;
 
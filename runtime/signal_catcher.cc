@@ -41,6 +41,7 @@
 #include "base/unix_file/fd_file.h"
 #include "base/utils.h"
 #include "class_linker.h"
+#include "gc/allocation_sampler.h"
 #include "gc/heap.h"
 #include "jit/profile_saver.h"
 #include "runtime.h"
@@ -171,6 +172,11 @@ void SignalCatcher::HandleSigUsr1() {
   LOG(INFO) << "SIGUSR1 forcing GC (no HPROF) and profile save";
   Runtime::Current()->GetHeap()->CollectGarbage(/* clear_soft_references */ false);
   ProfileSaver::ForceProcessProfiles();
+  gc::AllocationSampler* allocation_sampler = Runtime::Current()->GetHeap()->GetAllocationSampler();
+  if (allocation_sampler->IsEnabled()) {
+    ScopedObjectAccess soa(Thread::Current());
+    allocation_sampler->WriteProfile();
+  }
 }
 
 int SignalCatcher::WaitForSignal(Thread* self, SignalSet& signals) {
@@ -56,6 +56,8 @@ inline void Thread::CheckSuspend() {
       FullSuspendCheck();
     } else if (ReadFlag(kEmptyCheckpointRequest)) {
       RunEmptyCheckpoint();
+    } else if (ReadFlag(kHandshakeRequest)) {
+      RunHandshakes();
     } else {
       break;
     }
@@ -193,9 +195,16 @@ inline void Thread::TransitionToSuspendedAndRunCheckpoints(ThreadState new_state
       RunEmptyCheckpoint();
       continue;
     }
+    if (UNLIKELY((old_state_and_flags.as_struct.flags & kHandshakeRequest) != 0)) {
+      // Requesting threads only run our handshakes on our behalf when they find us suspended, so
+      // run the pending ones before suspending.
+      RunHandshakes();
+      continue;
+    }
     // Change the state but keep the current flags (kCheckpointRequest is clear).
     DCHECK_EQ((old_state_and_flags.as_struct.flags & kCheckpointRequest), 0);
     DCHECK_EQ((old_state_and_flags.as_struct.flags & kEmptyCheckpointRequest), 0);
+    DCHECK_EQ((old_state_and_flags.as_struct.flags & kHandshakeRequest), 0);
     new_state_and_flags.as_struct.flags = old_state_and_flags.as_struct.flags;
     new_state_and_flags.as_struct.state = new_state;
 
@@ -291,6 +300,12 @@ inline ThreadState Thread::TransitionFromSuspendedToRunnable() {
         DCHECK_EQ(old_state_and_flags.as_struct.state, old_state);
       }
       DCHECK_EQ(GetSuspendCount(), 0);
+    } else if ((old_state_and_flags.as_struct.flags & kHandshakeRequest) != 0) {
+      // Other threads may be running our handshakes on our behalf, see
+      // RequestSynchronousCheckpoint.
+      if (TransitionFromSuspendedToRunnableForHandshakes()) {
+        break;
+      }
     }
   } while (true);
   // Run the flip function, if set.
@@ -64,17 +64,20 @@
 #include "entrypoints/quick/quick_alloc_entrypoints.h"
 #include "gc/accounting/card_table-inl.h"
 #include "gc/accounting/heap_bitmap-inl.h"
+#include "gc/allocation_sampler.h"
 #include "gc/allocator/rosalloc.h"
 #include "gc/heap.h"
 #include "gc/space/space-inl.h"
 #include "gc_root.h"
 #include "handle_scope-inl.h"
+#include "hidden_api.h"
 #include "indirect_reference_table-inl.h"
 #include "interpreter/interpreter.h"
 #include "interpreter/shadow_frame-inl.h"
 #include "java_frame_root_info.h"
 #include "jni/java_vm_ext.h"
 #include "jni/jni_internal.h"
+#include "lock_contention_profiler.h"
 #include "mirror/class-inl.h"
 #include "mirror/class_loader.h"
 #include "mirror/object_array-inl.h"
@@ -170,6 +173,12 @@ void Thread::ResetQuickAllocEntryPointsForThread(bool is_marking) {
     is_marking = true;
   }
   ResetQuickAllocEntryPoints(&tlsPtr_.quick_entrypoints, is_marking);
+  UpdateThreadLocalInlineEnd();
+}
+
+void Thread::UpdateThreadLocalInlineEnd() {
+  tlsPtr_.thread_local_inline_end =
+      CanInlineQuickAllocFastPath() ? tlsPtr_.thread_local_end : nullptr;
 }
 
 class DeoptimizationContextRecord {
@@ -1333,6 +1342,7 @@ bool Thread::PassActiveSuspendBarriers(Thread* self) {
     }
     AtomicClearFlag(kActiveSuspendBarrier);
   }
+  suspend_barrier_pass_time_ns_.store(NanoTime(), std::memory_order_relaxed);
 
   uint32_t barrier_count = 0;
   for (uint32_t i = 0; i < kMaxSuspendBarriers; i++) {
@@ -1451,26 +1461,14 @@ bool Thread::RequestEmptyCheckpoint() {
   return success;
 }
 
-class BarrierClosure : public Closure {
- public:
-  explicit BarrierClosure(Closure* wrapped) : wrapped_(wrapped), barrier_(0) {}
-
-  void Run(Thread* self) override {
-    wrapped_->Run(self);
-    barrier_.Pass(self);
-  }
-
-  void Wait(Thread* self, ThreadState suspend_state) {
-    if (suspend_state != ThreadState::kRunnable) {
-      barrier_.Increment<Barrier::kDisallowHoldingLocks>(self, 1);
-    } else {
-      barrier_.Increment<Barrier::kAllowHoldingLocks>(self, 1);
-    }
-  }
+struct Thread::HandshakeRequest {
+  explicit HandshakeRequest(Closure* function_in)
+      : function(function_in), done(false), run(false) {}
 
- private:
-  Closure* wrapped_;
-  Barrier barrier_;
+  Closure* const function;
+  // Set once the request has been dealt with, `run` tells whether the closure was run.
+  bool done;
+  bool run;
 };
 
 // RequestSynchronousCheckpoint releases the thread_list_lock_ as a part of its execution.
@@ -1492,91 +1490,139 @@ bool Thread::RequestSynchronousCheckpoint(Closure* function, ThreadState suspend
     return false;
   }
 
-  struct ScopedThreadListLockUnlock {
-    explicit ScopedThreadListLockUnlock(Thread* self_in) RELEASE(*Locks::thread_list_lock_)
-        : self_thread(self_in) {
-      Locks::thread_list_lock_->AssertHeld(self_thread);
-      Locks::thread_list_lock_->Unlock(self_thread);
-    }
-
-    ~ScopedThreadListLockUnlock() ACQUIRE(*Locks::thread_list_lock_) {
-      Locks::thread_list_lock_->AssertNotHeld(self_thread);
-      Locks::thread_list_lock_->Lock(self_thread);
+  HandshakeRequest request(function);
+  {
+    MutexLock mu(self, *handshake_lock_);
+    if (handshakes_closed_) {
+      Locks::thread_list_lock_->ExclusiveUnlock(self);
+      return false;
     }
-
-    Thread* self_thread;
-  };
-
-  for (;;) {
-    Locks::thread_list_lock_->AssertExclusiveHeld(self);
-    // If this thread is runnable, try to schedule a checkpoint. Do some gymnastics to not hold the
-    // suspend-count lock for too long.
-    if (GetState() == ThreadState::kRunnable) {
-      BarrierClosure barrier_closure(function);
-      bool installed = false;
-      {
-        MutexLock mu(self, *Locks::thread_suspend_count_lock_);
-        installed = RequestCheckpoint(&barrier_closure);
-      }
-      if (installed) {
-        // Relinquish the thread-list lock. We should not wait holding any locks. We cannot
-        // reacquire it since we don't know if 'this' hasn't been deleted yet.
-        Locks::thread_list_lock_->ExclusiveUnlock(self);
-        ScopedThreadStateChange sts(self, suspend_state);
-        barrier_closure.Wait(self, suspend_state);
-        return true;
-      }
-      // Fall-through.
+    handshakes_.push_back(&request);
+    ++handshake_waiters_;
+    AtomicSetFlag(kHandshakeRequest);
+    TriggerSuspend();
+  }
+  // This thread cannot be deleted before we are done with it, see FinishHandshakes, so we do not
+  // need the thread_list_lock_ any more.
+  Locks::thread_list_lock_->ExclusiveUnlock(self);
+
+  ScopedThreadStateChange sts(self, suspend_state);
+  handshake_lock_->ExclusiveLock(self);
+  while (!request.done) {
+    // A suspended thread with pending handshakes cannot become runnable without acquiring the
+    // handshake_lock_, see TransitionFromSuspendedToRunnableForHandshakes. If it is suspended run
+    // all its pending handshakes on its behalf, otherwise it runs them at its next suspend check.
+    if (handshake_in_progress_.load(std::memory_order_relaxed) ||
+        handshakes_.empty() ||
+        GetState() == ThreadState::kRunnable) {
+      handshake_cond_->Wait(self);
+      continue;
     }
-
-    // This thread is not runnable, make sure we stay suspended, then run the checkpoint.
-    // Note: ModifySuspendCountInternal also expects the thread_list_lock to be held in
-    //       certain situations.
+    std::vector<HandshakeRequest*> requests;
+    requests.swap(handshakes_);
+    handshake_in_progress_.store(true, std::memory_order_seq_cst);
+    handshake_lock_->ExclusiveUnlock(self);
     {
-      MutexLock mu2(self, *Locks::thread_suspend_count_lock_);
-
-      if (!ModifySuspendCount(self, +1, nullptr, SuspendReason::kInternal)) {
-        // Just retry the loop.
-        sched_yield();
-        continue;
+      // Closures expect the mutator lock, as when this thread runs them at a suspend check.
+      ScopedObjectAccess soa(self);
+      for (HandshakeRequest* pending : requests) {
+        pending->function->Run(this);
       }
     }
-
-    {
-      // Release for the wait. The suspension will keep us from being deleted. Reacquire after so
-      // that we can call ModifySuspendCount without racing against ThreadList::Unregister.
-      ScopedThreadListLockUnlock stllu(self);
-      {
-        ScopedThreadStateChange sts(self, suspend_state);
-        while (GetState() == ThreadState::kRunnable) {
-          // We became runnable again. Wait till the suspend triggered in ModifySuspendCount
-          // moves us to suspended.
-          sched_yield();
-        }
-      }
-
-      function->Run(this);
+    handshake_lock_->ExclusiveLock(self);
+    for (HandshakeRequest* pending : requests) {
+      pending->done = true;
+      pending->run = true;
     }
+    if (handshakes_.empty()) {
+      AtomicClearFlag(kHandshakeRequest);
+    }
+    handshake_in_progress_.store(false, std::memory_order_seq_cst);
+    handshake_cond_->Broadcast(self);
+  }
+  --handshake_waiters_;
+  if (handshake_waiters_ == 0u && handshakes_closed_) {
+    // The thread is waiting to exit in FinishHandshakes.
+    handshake_cond_->Broadcast(self);
+  }
+  bool run = request.run;
+  handshake_lock_->ExclusiveUnlock(self);
+  return run;
+}
 
-    {
-      MutexLock mu2(self, *Locks::thread_suspend_count_lock_);
+void Thread::RunHandshakes() {
+  DCHECK_EQ(Thread::Current(), this);
+  std::vector<HandshakeRequest*> requests;
+  {
+    MutexLock mu(this, *handshake_lock_);
+    requests.swap(handshakes_);
+    AtomicClearFlag(kHandshakeRequest);
+  }
+  ScopedTrace trace("Run handshakes");
+  for (HandshakeRequest* request : requests) {
+    request->function->Run(this);
+  }
+  MutexLock mu(this, *handshake_lock_);
+  for (HandshakeRequest* request : requests) {
+    request->done = true;
+    request->run = true;
+  }
+  handshake_cond_->Broadcast(this);
+}
 
-      DCHECK_NE(GetState(), ThreadState::kRunnable);
-      bool updated = ModifySuspendCount(self, -1, nullptr, SuspendReason::kInternal);
-      DCHECK(updated);
+bool Thread::TransitionFromSuspendedToRunnableForHandshakes() {
+  // Same as the suspend request path of TransitionFromSuspendedToRunnable, we may be called
+  // while the runtime is shutting down.
+  Thread* thread_to_pass = nullptr;
+  if (kIsDebugBuild && !IsDaemon()) {
+    thread_to_pass = this;
+  }
+  bool transitioned = false;
+  {
+    MutexLock mu(thread_to_pass, *handshake_lock_);
+    while (handshake_in_progress_.load(std::memory_order_relaxed)) {
+      handshake_cond_->Wait(thread_to_pass);
     }
-
-    {
-      // Imitate ResumeAll, the thread may be waiting on Thread::resume_cond_ since we raised its
-      // suspend count. Now the suspend_count_ is lowered so we must do the broadcast.
-      MutexLock mu2(self, *Locks::thread_suspend_count_lock_);
-      Thread::resume_cond_->Broadcast(self);
+    union StateAndFlags old_state_and_flags;
+    old_state_and_flags.as_int = tls32_.state_and_flags.as_int;
+    if (handshakes_.empty()) {
+      // Our handshakes were run on our behalf, retry the fast path.
+      AtomicClearFlag(kHandshakeRequest);
+    } else if ((old_state_and_flags.as_struct.flags & ~kHandshakeRequest) == 0) {
+      // Become runnable with kHandshakeRequest still set so that the handshakes are run at the
+      // next suspend check, rather than in the middle of the transition.
+      union StateAndFlags new_state_and_flags;
+      new_state_and_flags.as_int = old_state_and_flags.as_int;
+      new_state_and_flags.as_struct.state = kRunnable;
+      transitioned =
+          tls32_.state_and_flags.as_atomic_int.CompareAndSetStrongSequentiallyConsistent(
+          old_state_and_flags.as_int, new_state_and_flags.as_int);
     }
+  }
+  if (transitioned) {
+    // Mark the acquisition of a share of the mutator_lock_, outside the lower level
+    // handshake_lock_.
+    Locks::mutator_lock_->TransitionFromSuspendedToRunnable(this);
+  }
+  return transitioned;
+}
 
-    // Release the thread_list_lock_ to be consistent with the barrier-closure path.
-    Locks::thread_list_lock_->ExclusiveUnlock(self);
-
-    return true;  // We're done, break out of the loop.
+void Thread::FinishHandshakes() {
+  DCHECK_EQ(Thread::Current(), this);
+  DCHECK_NE(GetState(), ThreadState::kRunnable);
+  MutexLock mu(this, *handshake_lock_);
+  handshakes_closed_ = true;
+  while (handshake_in_progress_.load(std::memory_order_relaxed)) {
+    handshake_cond_->Wait(this);
+  }
+  for (HandshakeRequest* request : handshakes_) {
+    request->done = true;
+  }
+  handshakes_.clear();
+  AtomicClearFlag(kHandshakeRequest);
+  handshake_cond_->Broadcast(this);
+  while (handshake_waiters_ != 0u) {
+    handshake_cond_->Wait(this);
   }
 }
 
@@ -2117,9 +2163,23 @@ void Thread::NotifyThreadGroup(ScopedObjectAccessAlreadyRunnable& soa, jobject t
 Thread::Thread(bool daemon)
     : tls32_(daemon),
       wait_monitor_(nullptr),
-      is_runtime_thread_(false) {
+      is_runtime_thread_(false),
+      alloc_sample_pending_(false),
+      alloc_sample_bytes_left_(0u),
+      alloc_sample_rng_state_(0u),
+      alloc_sample_buffer_(nullptr),
+      lock_contention_buffer_(nullptr),
+      hidden_api_member_action_cache_(nullptr),
+      suspend_barrier_pass_time_ns_(0u),
+      handshake_waiters_(0u),
+      handshakes_closed_(false),
+      handshake_in_progress_(false),
+      biased_reader_mutex_(nullptr) {
   wait_mutex_ = new Mutex("a thread wait mutex");
   wait_cond_ = new ConditionVariable("a thread wait condition variable", *wait_mutex_);
+  handshake_lock_ = new Mutex("a thread handshake lock", kThreadHandshakeLock);
+  handshake_cond_ =
+      new ConditionVariable("a thread handshake condition variable", *handshake_lock_);
   tlsPtr_.instrumentation_stack = new std::deque<instrumentation::InstrumentationStackFrame>;
   tlsPtr_.name = new std::string(kThreadNameDuringStartup);
 
@@ -2261,6 +2321,12 @@ void Thread::Destroy() {
   {
     ScopedObjectAccess soa(self);
     Runtime::Current()->GetHeap()->RevokeThreadLocalBuffers(this);
+    if (alloc_sample_buffer_ != nullptr) {
+      Runtime::Current()->GetHeap()->GetAllocationSampler()->DrainThread(this);
+    }
+    if (lock_contention_buffer_ != nullptr) {
+      Runtime::Current()->GetLockContentionProfiler()->MergeThread(this);
+    }
     if (kUseReadBarrier) {
       Runtime::Current()->GetHeap()->ConcurrentCopyingCollector()->RevokeThreadLocalMarkStack(this);
     }
@@ -2294,6 +2360,8 @@ Thread::~Thread() {
 
   delete wait_cond_;
   delete wait_mutex_;
+  delete handshake_cond_;
+  delete handshake_lock_;
 
   if (tlsPtr_.long_jump_context != nullptr) {
     delete tlsPtr_.long_jump_context;
@@ -2309,6 +2377,9 @@ Thread::~Thread() {
   delete tlsPtr_.instrumentation_stack;
   delete tlsPtr_.name;
   delete tlsPtr_.deps_or_stack_trace_sample.stack_trace_sample;
+  delete alloc_sample_buffer_;
+  delete lock_contention_buffer_;
+  delete hidden_api_member_action_cache_;
 
   Runtime::Current()->GetHeap()->AssertThreadLocalBuffersAreRevoked(this);
 
@@ -2459,6 +2530,14 @@ void Thread::NotifyLocked(Thread* self) {
   }
 }
 
+hiddenapi::MemberActionCache* Thread::GetHiddenApiMemberActionCache() {
+  DCHECK_EQ(this, Thread::Current());
+  if (UNLIKELY(hidden_api_member_action_cache_ == nullptr)) {
+    hidden_api_member_action_cache_ = new hiddenapi::MemberActionCache();
+  }
+  return hidden_api_member_action_cache_;
+}
+
 void Thread::SetClassLoaderOverride(jobject class_loader_override) {
   if (tlsPtr_.class_loader_override != nullptr) {
     GetJniEnv()->DeleteGlobalRef(tlsPtr_.class_loader_override);
@@ -3167,6 +3246,9 @@ void Thread::DumpThreadOffset(std::ostream& os, uint32_t offset) {
   DO_THREAD_OFFSET(TopShadowFrameOffset<ptr_size>(), "top_shadow_frame")
   DO_THREAD_OFFSET(TopHandleScopeOffset<ptr_size>(), "top_handle_scope")
   DO_THREAD_OFFSET(ThreadSuspendTriggerOffset<ptr_size>(), "suspend_trigger")
+  DO_THREAD_OFFSET(ThreadLocalPosOffset<ptr_size>(), "thread_local_pos")
+  DO_THREAD_OFFSET(ThreadLocalInlineEndOffset<ptr_size>(), "thread_local_inline_end")
+  DO_THREAD_OFFSET(ThreadLocalObjectsOffset<ptr_size>(), "thread_local_objects")
 #undef DO_THREAD_OFFSET
 
 #define JNI_ENTRY_POINT_INFO(x) \
@@ -3810,6 +3892,12 @@ void Thread::VisitRoots(RootVisitor* visitor) {
   for (instrumentation::InstrumentationStackFrame& frame : *GetInstrumentationStack()) {
     visitor->VisitRootIfNonNull(&frame.this_object_, RootInfo(kRootVMInternal, thread_id));
   }
+  if (alloc_sample_buffer_ != nullptr) {
+    alloc_sample_buffer_->VisitRoots(visitor);
+  }
+  if (lock_contention_buffer_ != nullptr) {
+    lock_contention_buffer_->VisitRoots(visitor);
+  }
 }
 
 void Thread::VisitRoots(RootVisitor* visitor, VisitRootFlags flags) {
@@ -3868,6 +3956,7 @@ void Thread::SetTlab(uint8_t* start, uint8_t* end, uint8_t* limit) {
   tlsPtr_.thread_local_end = end;
   tlsPtr_.thread_local_limit = limit;
   tlsPtr_.thread_local_objects = 0;
+  UpdateThreadLocalInlineEnd();
 }
 
 bool Thread::HasTlab() const {
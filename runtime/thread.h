@@ -25,6 +25,7 @@
 #include <list>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "arch/context.h"
 #include "arch/instruction_set.h"
@@ -58,8 +59,13 @@ template<class T> class AtomicStack;
 namespace collector {
 class SemiSpace;
 }  // namespace collector
+class AllocationSampleBuffer;
 }  // namespace gc
 
+namespace hiddenapi {
+class MemberActionCache;
+}  // namespace hiddenapi
+
 namespace mirror {
 class Array;
 class Class;
@@ -89,6 +95,7 @@ class DexFile;
 class FrameIdToShadowFrame;
 class JavaVMExt;
 class JNIEnvExt;
+class LockContentionBuffer;
 class Monitor;
 class RootVisitor;
 class ScopedObjectAccessAlreadyRunnable;
@@ -121,6 +128,8 @@ enum ThreadFlag {
   kCheckpointRequest = 2,  // Request that the thread do some checkpoint work and then continue.
   kEmptyCheckpointRequest = 4,  // Request that the thread do empty checkpoint and then continue.
   kActiveSuspendBarrier = 8,  // Register that at least 1 suspend barrier needs to be passed.
+  kHandshakeRequest = 16,  // Request that the thread run the closures queued for it by other
+                           // threads, see Thread::RequestSynchronousCheckpoint.
 };
 
 enum class StackedShadowFrameType {
@@ -260,7 +269,8 @@ class Thread {
     union StateAndFlags state_and_flags;
     state_and_flags.as_int = tls32_.state_and_flags.as_int;
     return state_and_flags.as_struct.state != kRunnable &&
-        (state_and_flags.as_struct.flags & kSuspendRequest) != 0;
+        ((state_and_flags.as_struct.flags & kSuspendRequest) != 0 ||
+         handshake_in_progress_.load(std::memory_order_seq_cst));
   }
 
   // If delta > 0 and (this != self or suspend_barrier is not null), this function may temporarily
@@ -287,6 +297,9 @@ class Thread {
   // due to the fact that Thread::Current() needs to go to sleep to allow the targeted thread to
   // execute the checkpoint for us if it is Runnable. The suspend_state is the state that the thread
   // will go into while it is awaiting the checkpoint to be run.
+  // The checkpoint is a handshake with this thread only: the closure is queued on this thread and
+  // run by it at its next suspend check, or run by the calling thread while this thread is held
+  // suspended. Other threads and the global suspend locks are not involved.
   // NB Passing ThreadState::kRunnable may cause the current thread to wait in a condition variable
   // while holding the mutator_lock_.  Callers should ensure that this will not cause any problems
   // for the closure or the rest of the system.
@@ -788,6 +801,12 @@ class Thread {
                                                                 thread_local_end));
   }
 
+  template<PointerSize pointer_size>
+  static constexpr ThreadOffset<pointer_size> ThreadLocalInlineEndOffset() {
+    return ThreadOffsetFromTlsPtr<pointer_size>(OFFSETOF_MEMBER(tls_ptr_sized_values,
+                                                                thread_local_inline_end));
+  }
+
   template<PointerSize pointer_size>
   static constexpr ThreadOffset<pointer_size> ThreadLocalObjectsOffset() {
     return ThreadOffsetFromTlsPtr<pointer_size>(OFFSETOF_MEMBER(tls_ptr_sized_values,
@@ -1106,6 +1125,15 @@ class Thread {
     tlsPtr_.held_mutexes[level] = mutex;
   }
 
+  // The reader-biased mutex this thread holds a share of through its reader slot, if any.
+  const ReaderWriterMutex* GetBiasedReaderMutex() const {
+    return biased_reader_mutex_;
+  }
+
+  void SetBiasedReaderMutex(const ReaderWriterMutex* mutex) {
+    biased_reader_mutex_ = mutex;
+  }
+
   void ClearSuspendBarrier(AtomicInteger* target)
       REQUIRES(Locks::thread_suspend_count_lock_);
 
@@ -1141,6 +1169,9 @@ class Thread {
   void ExpandTlab(size_t bytes) {
     tlsPtr_.thread_local_end += bytes;
     DCHECK_LE(tlsPtr_.thread_local_end, tlsPtr_.thread_local_limit);
+    if (tlsPtr_.thread_local_inline_end != nullptr) {
+      tlsPtr_.thread_local_inline_end = tlsPtr_.thread_local_end;
+    }
   }
 
   // Doesn't check that there is room.
@@ -1188,6 +1219,57 @@ class Thread {
     return tlsPtr_.thread_local_objects;
   }
 
+  // Allocation sampling support, see gc::AllocationSampler.
+  size_t GetAllocSampleBytesLeft() const {
+    return alloc_sample_bytes_left_;
+  }
+
+  void SetAllocSampleBytesLeft(size_t bytes) {
+    alloc_sample_bytes_left_ = bytes;
+  }
+
+  bool IsAllocSamplePending() const {
+    return alloc_sample_pending_;
+  }
+
+  void SetAllocSamplePending(bool pending) {
+    alloc_sample_pending_ = pending;
+  }
+
+  gc::AllocationSampleBuffer* GetAllocSampleBuffer() const {
+    return alloc_sample_buffer_;
+  }
+
+  void SetAllocSampleBuffer(gc::AllocationSampleBuffer* buffer) {
+    alloc_sample_buffer_ = buffer;
+  }
+
+  uint32_t GetAllocSampleRngState() const {
+    return alloc_sample_rng_state_;
+  }
+
+  void SetAllocSampleRngState(uint32_t state) {
+    alloc_sample_rng_state_ = state;
+  }
+
+  // Monitor contention recorded for the LockContentionProfiler.
+  LockContentionBuffer* GetLockContentionBuffer() const {
+    return lock_contention_buffer_;
+  }
+
+  void SetLockContentionBuffer(LockContentionBuffer* buffer) {
+    lock_contention_buffer_ = buffer;
+  }
+
+  // Hidden API decisions taken on this thread, see hiddenapi::GetMemberAction(). Only accessed
+  // by this thread.
+  hiddenapi::MemberActionCache* GetHiddenApiMemberActionCache();
+
+  // NanoTime() at which this thread last passed a suspend barrier, or 0 if it never did.
+  uint64_t GetSuspendBarrierPassTime() const {
+    return suspend_barrier_pass_time_ns_.load(std::memory_order_relaxed);
+  }
+
   void* GetRosAllocRun(size_t index) const {
     return tlsPtr_.rosalloc_runs[index];
   }
@@ -1381,6 +1463,8 @@ class Thread {
   void InitCpu();
   void CleanupCpu();
   void InitTlsEntryPoints();
+  // Keeps thread_local_inline_end in sync with the TLAB and the allocation entrypoints.
+  void UpdateThreadLocalInlineEnd();
   void InitTid();
   void InitPthreadKeySelf();
   bool InitStackHwm();
@@ -1421,6 +1505,19 @@ class Thread {
   void RunCheckpointFunction();
   void RunEmptyCheckpoint();
 
+  // Run the closures queued by RequestSynchronousCheckpoint. Called by this thread while runnable.
+  void RunHandshakes();
+
+  // Slow path of TransitionFromSuspendedToRunnable when kHandshakeRequest is set. Waits for
+  // another thread running our handshakes to be done, then either clears the flag if nothing is
+  // left to run or becomes runnable and leaves the closures to the next suspend check. Returns
+  // true if the thread is now runnable.
+  bool TransitionFromSuspendedToRunnableForHandshakes();
+
+  // Fail the queued handshakes and wait for the threads that requested them to be done with this
+  // thread. Called by this thread once it can no longer be found in the thread list.
+  void FinishHandshakes();
+
   bool PassActiveSuspendBarriers(Thread* self)
       REQUIRES(!Locks::thread_suspend_count_lock_);
 
@@ -1603,7 +1700,7 @@ class Thread {
       mterp_alt_ibase(nullptr), thread_local_alloc_stack_top(nullptr),
       thread_local_alloc_stack_end(nullptr),
       flip_function(nullptr), method_verifier(nullptr), thread_local_mark_stack(nullptr),
-      async_exception(nullptr) {
+      async_exception(nullptr), thread_local_inline_end(nullptr) {
       std::fill(held_mutexes, held_mutexes + kLockLevelCount, nullptr);
     }
 
@@ -1763,6 +1860,11 @@ class Thread {
 
     // The pending async-exception or null.
     mirror::Throwable* async_exception;
+
+    // The TLAB end compiled code checks against when it bump-allocates inline. It is either equal
+    // to thread_local_end or null while the allocation entrypoints must not be bypassed, for
+    // example when they are instrumented.
+    uint8_t* thread_local_inline_end;
   } tlsPtr_;
 
   // Small thread-local cache to be used from the interpreter.
@@ -1797,6 +1899,54 @@ class Thread {
   // True if the thread is some form of runtime thread (ex, GC or JIT).
   bool is_runtime_thread_;
 
+  // True if the next allocation should be recorded by the allocation sampler.
+  bool alloc_sample_pending_;
+
+  // Bytes this thread may obtain through TLAB refills before its next allocation is sampled.
+  size_t alloc_sample_bytes_left_;
+
+  // Random state for the allocation sampling intervals of this thread, 0 until first used.
+  uint32_t alloc_sample_rng_state_;
+
+  // Samples recorded by this thread and not yet drained by the allocation sampler. Lazily
+  // allocated on the first sample.
+  gc::AllocationSampleBuffer* alloc_sample_buffer_;
+
+  // Monitor contention recorded by this thread and not yet merged by the lock contention
+  // profiler. Lazily allocated on the first contention.
+  LockContentionBuffer* lock_contention_buffer_;
+
+  // Lazily allocated on the first check of a hidden member.
+  hiddenapi::MemberActionCache* hidden_api_member_action_cache_;
+
+  // NanoTime() at which this thread last passed a suspend barrier, used to name the slowest
+  // thread to respond to a suspend request.
+  Atomic<uint64_t> suspend_barrier_pass_time_ns_;
+
+  // Guards the handshake members below.
+  Mutex* handshake_lock_;
+
+  // Signalled when handshakes have been run or a requesting thread is done with this thread.
+  ConditionVariable* handshake_cond_ GUARDED_BY(handshake_lock_);
+
+  // Closures queued by other threads in RequestSynchronousCheckpoint. kHandshakeRequest is set
+  // whenever this is not empty.
+  struct HandshakeRequest;
+  std::vector<HandshakeRequest*> handshakes_ GUARDED_BY(handshake_lock_);
+
+  // Number of threads waiting in RequestSynchronousCheckpoint for handshakes with this thread.
+  size_t handshake_waiters_ GUARDED_BY(handshake_lock_);
+
+  // Set once the thread is exiting, no handshake can be requested after that.
+  bool handshakes_closed_ GUARDED_BY(handshake_lock_);
+
+  // True while another thread runs our handshakes on our behalf. This thread cannot become
+  // runnable in the meantime and so counts as suspended. Only written with handshake_lock_ held.
+  Atomic<bool> handshake_in_progress_;
+
+  // See GetBiasedReaderMutex.
+  const ReaderWriterMutex* biased_reader_mutex_;
+
   friend class Dbg;  // For SetStateUnsafe.
   friend class gc::collector::SemiSpace;  // For getting stack traces.
   friend class Runtime;  // For CreatePeer.
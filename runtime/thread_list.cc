@@ -76,6 +76,7 @@ ThreadList::ThreadList(uint64_t thread_suspend_timeout_ns)
       debug_suspend_all_count_(0),
       unregistering_count_(0),
       suspend_all_historam_("suspend all histogram", 16, 64),
+      slowest_suspend_all_time_(0u),
       long_suspend_(false),
       shut_down_(false),
       thread_suspend_timeout_ns_(thread_suspend_timeout_ns),
@@ -150,6 +151,10 @@ void ThreadList::DumpForSigQuit(std::ostream& os) {
       Histogram<uint64_t>::CumulativeData data;
       suspend_all_historam_.CreateHistogram(&data);
       suspend_all_historam_.PrintConfidenceIntervals(os, 0.99, data);  // Dump time to suspend.
+      if (!slowest_suspend_all_straggler_.empty()) {
+        os << "Slowest suspend all: " << PrettyDuration(slowest_suspend_all_time_)
+           << ", last to suspend: " << slowest_suspend_all_straggler_ << "\n";
+      }
     }
   }
   bool dump_native_stack = Runtime::Current()->GetDumpNativeStackOnSigQuit();
@@ -674,8 +679,16 @@ void ThreadList::SuspendAll(const char* cause, bool long_suspend) {
     const uint64_t end_time = NanoTime();
     const uint64_t suspend_time = end_time - start_time;
     suspend_all_historam_.AdjustAndAddValue(suspend_time);
+    // Only look for the thread that held up the suspension when the suspension is long enough to
+    // be reported, this walks the thread list while all the threads are suspended.
     if (suspend_time > kLongThreadSuspendThreshold) {
-      LOG(WARNING) << "Suspending all threads took: " << PrettyDuration(suspend_time);
+      std::string straggler = DescribeSuspendStraggler(start_time);
+      if (suspend_time > slowest_suspend_all_time_ && !straggler.empty()) {
+        slowest_suspend_all_time_ = suspend_time;
+        slowest_suspend_all_straggler_ = straggler;
+      }
+      LOG(WARNING) << "Suspending all threads took: " << PrettyDuration(suspend_time)
+          << (straggler.empty() ? "" : ", last to suspend: ") << straggler;
     }
 
     if (kDebugLocking) {
@@ -715,7 +728,9 @@ void ThreadList::SuspendAllInternal(Thread* self,
   //    kNative) and will never begin executing Java code without first checking
   //    the suspend-request flag.
 
-  // The atomic counter for number of threads that need to pass the barrier.
+  // The atomic counter for number of threads that need to pass the barrier. All the suspend
+  // requests are posted before waiting on it once, so the time to suspend depends on the slowest
+  // thread rather than on the sum of the threads' response times.
   AtomicInteger pending_threads;
   uint32_t num_ignored = 0;
   if (ignore1 != nullptr) {
@@ -732,7 +747,10 @@ void ThreadList::SuspendAllInternal(Thread* self,
     if (reason == SuspendReason::kForDebugger) {
       ++debug_suspend_all_count_;
     }
+    // Start from the number of threads to suspend so that the counter stays positive if a thread
+    // passes the barrier while ModifySuspendCount() retries with the lock released.
     pending_threads.store(list_.size() - num_ignored, std::memory_order_relaxed);
+    int32_t already_suspended = 0;
     // Increment everybody's suspend count (except those that should be ignored).
     for (const auto& thread : list_) {
       if (thread == ignore1 || thread == ignore2) {
@@ -748,31 +766,40 @@ void ThreadList::SuspendAllInternal(Thread* self,
       if (thread->IsSuspended()) {
         // Only clear the counter for the current thread.
         thread->ClearSuspendBarrier(&pending_threads);
-        pending_threads.fetch_sub(1, std::memory_order_seq_cst);
+        ++already_suspended;
       }
     }
+    // Passing the barrier requires the thread_suspend_count_lock_, so the threads that were
+    // already suspended can be accounted for with a single atomic update rather than one each.
+    pending_threads.fetch_sub(already_suspended, std::memory_order_seq_cst);
   }
 
-  // Wait for the barrier to be passed by all runnable threads. This wait
-  // is done with a timeout so that we can detect problems.
+  // Wait for the barrier to be passed by all runnable threads.
+  WaitForSuspendBarrier(&pending_threads);
+}
+
+// Wait on the futex of the suspend barrier until it counts down to zero. This wait is done with a
+// timeout so that we can detect problems.
+void ThreadList::WaitForSuspendBarrier(AtomicInteger* pending_threads) {
 #if ART_USE_FUTEXES
   timespec wait_timeout;
   InitTimeSpec(false, CLOCK_MONOTONIC, NsToMs(thread_suspend_timeout_ns_), 0, &wait_timeout);
 #endif
   const uint64_t start_time = NanoTime();
   while (true) {
-    int32_t cur_val = pending_threads.load(std::memory_order_relaxed);
+    int32_t cur_val = pending_threads->load(std::memory_order_relaxed);
     if (LIKELY(cur_val > 0)) {
 #if ART_USE_FUTEXES
-      if (futex(pending_threads.Address(), FUTEX_WAIT, cur_val, &wait_timeout, nullptr, 0) != 0) {
+      if (futex(pending_threads->Address(), FUTEX_WAIT, cur_val, &wait_timeout, nullptr, 0) != 0) {
         // EAGAIN and EINTR both indicate a spurious failure, try again from the beginning.
         if ((errno != EAGAIN) && (errno != EINTR)) {
           if (errno == ETIMEDOUT) {
             LOG(kIsDebugBuild ? ::android::base::FATAL : ::android::base::ERROR)
                 << "Timed out waiting for threads to suspend, waited for "
-                << PrettyDuration(NanoTime() - start_time);
+                << PrettyDuration(NanoTime() - start_time) << ", "
+                << pending_threads->load(std::memory_order_relaxed) << " threads still running";
           } else {
-            PLOG(FATAL) << "futex wait failed for SuspendAllInternal()";
+            PLOG(FATAL) << "futex wait failed for WaitForSuspendBarrier()";
           }
         }
       }  // else re-check pending_threads in the next iteration (this may be a spurious wake-up).
@@ -787,6 +814,27 @@ void ThreadList::SuspendAllInternal(Thread* self,
   }
 }
 
+std::string ThreadList::DescribeSuspendStraggler(uint64_t start_time) {
+  Thread* self = Thread::Current();
+  MutexLock mu(self, *Locks::thread_list_lock_);
+  Thread* straggler = nullptr;
+  uint64_t last_pass_time = start_time;
+  for (const auto& thread : list_) {
+    uint64_t pass_time = thread->GetSuspendBarrierPassTime();
+    if (pass_time >= last_pass_time) {
+      straggler = thread;
+      last_pass_time = pass_time;
+    }
+  }
+  if (straggler == nullptr) {
+    return "";
+  }
+  std::ostringstream oss;
+  straggler->ShortDump(oss);
+  oss << " after " << PrettyDuration(last_pass_time - start_time);
+  return oss.str();
+}
+
 void ThreadList::ResumeAll() {
   Thread* self = Thread::Current();
 
@@ -1480,6 +1528,8 @@ void ThreadList::Unregister(Thread* self) {
     }
     // We failed to remove the thread due to a suspend request, loop and try again.
   }
+  // Threads that requested a handshake with us before we left the list may still refer to us.
+  self->FinishHandshakes();
   delete self;
 
   // Release the thread ID after the thread is finished and deleted to avoid cases where we can
@@ -27,6 +27,7 @@
 
 #include <bitset>
 #include <list>
+#include <string>
 #include <vector>
 
 namespace art {
@@ -207,6 +208,15 @@ class ThreadList {
   void AssertThreadsAreSuspended(Thread* self, Thread* ignore1, Thread* ignore2 = nullptr)
       REQUIRES(!Locks::thread_list_lock_, !Locks::thread_suspend_count_lock_);
 
+  // Wait until every thread that was handed `pending_threads` as a suspend barrier has passed it.
+  void WaitForSuspendBarrier(AtomicInteger* pending_threads)
+      REQUIRES(!Locks::thread_list_lock_, !Locks::thread_suspend_count_lock_);
+
+  // Describe the thread that passed a suspend barrier last since `start_time`, that is the thread
+  // that was the slowest to respond to a suspend request. Returns an empty string if none did.
+  std::string DescribeSuspendStraggler(uint64_t start_time)
+      REQUIRES(!Locks::thread_list_lock_);
+
   std::bitset<kMaxThreadId> allocated_ids_ GUARDED_BY(Locks::allocated_thread_ids_lock_);
 
   // The actual list of all threads.
@@ -223,6 +233,10 @@ class ThreadList {
   // by mutator lock ensures no thread can read when another thread is modifying it.
   Histogram<uint64_t> suspend_all_historam_ GUARDED_BY(Locks::mutator_lock_);
 
+  // The longest time to suspend all threads so far, and the thread that was the last to suspend.
+  uint64_t slowest_suspend_all_time_ GUARDED_BY(Locks::mutator_lock_);
+  std::string slowest_suspend_all_straggler_ GUARDED_BY(Locks::mutator_lock_);
+
   // Whether or not the current thread suspension is long.
   bool long_suspend_;
 
@@ -22,6 +22,8 @@
 
 #include <pthread.h>
 
+#include <algorithm>
+
 #include <android-base/logging.h>
 #include <android-base/stringprintf.h>
 
@@ -39,6 +41,64 @@ using android::base::StringPrintf;
 
 static constexpr bool kMeasureWaitTime = false;
 
+static_assert(IsPowerOfTwo(WorkStealingDeque::kCapacity), "Deque capacity must be a power of 2");
+
+WorkStealingDeque::WorkStealingDeque() : top_(0), bottom_(0) {
+  for (Atomic<Task*>& slot : buffer_) {
+    slot.store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+bool WorkStealingDeque::Push(Task* task) {
+  const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+  const int64_t top = top_.load(std::memory_order_acquire);
+  if (bottom - top >= static_cast<int64_t>(kCapacity)) {
+    return false;
+  }
+  buffer_[bottom & (kCapacity - 1)].store(task, std::memory_order_relaxed);
+  // Publish the task before the new bottom.
+  std::atomic_thread_fence(std::memory_order_release);
+  bottom_.store(bottom + 1, std::memory_order_relaxed);
+  return true;
+}
+
+Task* WorkStealingDeque::Pop() {
+  const int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+  bottom_.store(bottom, std::memory_order_relaxed);
+  // Order the bottom update before reading top, thieves do the opposite.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  int64_t top = top_.load(std::memory_order_relaxed);
+  if (top > bottom) {
+    // Empty.
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  Task* task = buffer_[bottom & (kCapacity - 1)].load(std::memory_order_relaxed);
+  if (top == bottom) {
+    // Last task, race against the thieves for it.
+    if (!top_.CompareAndSetStrongSequentiallyConsistent(top, top + 1)) {
+      task = nullptr;
+    }
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+  }
+  return task;
+}
+
+Task* WorkStealingDeque::Steal() {
+  int64_t top = top_.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  const int64_t bottom = bottom_.load(std::memory_order_acquire);
+  if (top >= bottom) {
+    return nullptr;
+  }
+  Task* task = buffer_[top & (kCapacity - 1)].load(std::memory_order_relaxed);
+  if (!top_.CompareAndSetStrongSequentiallyConsistent(top, top + 1)) {
+    // Lost the race with the owner or another thief.
+    return nullptr;
+  }
+  return task;
+}
+
 ThreadPoolWorker::ThreadPoolWorker(ThreadPool* thread_pool, const std::string& name,
                                    size_t stack_size)
     : thread_pool_(thread_pool),
@@ -110,9 +170,30 @@ void* ThreadPoolWorker::Callback(void* arg) {
   return nullptr;
 }
 
-void ThreadPool::AddTask(Thread* self, Task* task) {
+void ThreadPool::AddTask(Thread* self, Task* task, TaskPriority priority) {
+  if (priority == TaskPriority::kNormal) {
+    // Tasks added by a running task stay with its worker unless another worker is idle and steals
+    // them, without contending on the task queue lock.
+    ThreadPoolWorker* worker = FindWorker(self);
+    if (worker != nullptr && worker->deque_.Push(task)) {
+      // Waiting workers count themselves before checking the deques for the last time, see
+      // GetTask, so either they see the new task or we see them waiting.
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (waiting_count_.load(std::memory_order_seq_cst) != 0) {
+        MutexLock mu(self, task_queue_lock_);
+        if (started_ && waiting_count_ != 0) {
+          task_queue_condition_.Signal(self);
+        }
+      }
+      return;
+    }
+  }
   MutexLock mu(self, task_queue_lock_);
-  tasks_.push_back(task);
+  if (priority == TaskPriority::kHigh) {
+    high_priority_tasks_.push_back(task);
+  } else {
+    tasks_.push_back(task);
+  }
   // If we have any waiters, signal one.
   if (started_ && waiting_count_ != 0) {
     task_queue_condition_.Signal(self);
@@ -122,6 +203,43 @@ void ThreadPool::AddTask(Thread* self, Task* task) {
 void ThreadPool::RemoveAllTasks(Thread* self) {
   MutexLock mu(self, task_queue_lock_);
   tasks_.clear();
+  high_priority_tasks_.clear();
+  for (ThreadPoolWorker* worker : threads_) {
+    while (!worker->deque_.IsEmpty()) {
+      worker->deque_.Steal();
+    }
+  }
+}
+
+ThreadPoolWorker* ThreadPool::FindWorker(Thread* self) const {
+  for (ThreadPoolWorker* worker : threads_) {
+    if (worker->GetThread() == self) {
+      return worker;
+    }
+  }
+  return nullptr;
+}
+
+Task* ThreadPool::StealTask(ThreadPoolWorker* self_worker) {
+  const size_t thread_count = GetThreadCount();
+  if (thread_count == 0u) {
+    return nullptr;
+  }
+  // Start with the worker after ourselves so that thieves spread over the victims.
+  size_t start = 0u;
+  if (self_worker != nullptr) {
+    start = std::find(threads_.begin(), threads_.end(), self_worker) - threads_.begin() + 1u;
+  }
+  for (size_t i = 0; i != thread_count; ++i) {
+    ThreadPoolWorker* victim = threads_[(start + i) % thread_count];
+    if (victim != self_worker) {
+      Task* task = victim->deque_.Steal();
+      if (task != nullptr) {
+        return task;
+      }
+    }
+  }
+  return nullptr;
 }
 
 ThreadPool::ThreadPool(const char* name, size_t num_threads, bool create_peers)
@@ -183,14 +301,34 @@ void ThreadPool::StopWorkers(Thread* self) {
 }
 
 Task* ThreadPool::GetTask(Thread* self) {
-  MutexLock mu(self, task_queue_lock_);
-  while (!IsShuttingDown()) {
+  ThreadPoolWorker* const worker = FindWorker(self);
+  while (true) {
+    // Lock-free fast path: tasks this worker added, then tasks added by other workers. A worker
+    // over the active worker limit leaves the tasks in its deque to be stolen and goes to wait.
+    if (worker != nullptr &&
+        GetThreadCount() - waiting_count_.load(std::memory_order_relaxed) <=
+            max_active_workers_.load(std::memory_order_relaxed)) {
+      Task* task = worker->deque_.Pop();
+      if (task == nullptr && started_.load(std::memory_order_relaxed)) {
+        task = StealTask(worker);
+      }
+      if (task != nullptr) {
+        return task;
+      }
+    }
+
+    MutexLock mu(self, task_queue_lock_);
+    if (IsShuttingDown()) {
+      // We are shutting down, return null to tell the worker thread to stop looping.
+      return nullptr;
+    }
     const size_t thread_count = GetThreadCount();
     // Ensure that we don't use more threads than the maximum active workers.
     const size_t active_threads = thread_count - waiting_count_;
     // <= since self is considered an active worker.
-    if (active_threads <= max_active_workers_) {
-      Task* task = TryGetTaskLocked();
+    const bool may_run = active_threads <= max_active_workers_;
+    if (may_run) {
+      Task* task = TryGetTaskLocked(worker);
       if (task != nullptr) {
         return task;
       }
@@ -201,31 +339,40 @@ Task* ThreadPool::GetTask(Thread* self) {
       // We may be done, lets broadcast to the completion condition.
       completion_condition_.Broadcast(self);
     }
-    const uint64_t wait_start = kMeasureWaitTime ? NanoTime() : 0;
-    task_queue_condition_.Wait(self);
-    if (kMeasureWaitTime) {
-      const uint64_t wait_end = NanoTime();
-      total_wait_time_ += wait_end - std::max(wait_start, start_time_);
+    // Workers only signal new tasks in their deques if they see a waiting worker, so check the
+    // deques again now that we are counted as waiting.
+    if (!may_run || !HasOutstandingTasks()) {
+      const uint64_t wait_start = kMeasureWaitTime ? NanoTime() : 0;
+      task_queue_condition_.Wait(self);
+      if (kMeasureWaitTime) {
+        const uint64_t wait_end = NanoTime();
+        total_wait_time_ += wait_end - std::max(wait_start, start_time_);
+      }
     }
     --waiting_count_;
   }
-
-  // We are shutting down, return null to tell the worker thread to stop looping.
-  return nullptr;
 }
 
 Task* ThreadPool::TryGetTask(Thread* self) {
   MutexLock mu(self, task_queue_lock_);
-  return TryGetTaskLocked();
+  return TryGetTaskLocked(FindWorker(self));
 }
 
-Task* ThreadPool::TryGetTaskLocked() {
-  if (HasOutstandingTasks()) {
+Task* ThreadPool::TryGetTaskLocked(ThreadPoolWorker* self_worker) {
+  if (!started_) {
+    return nullptr;
+  }
+  if (!high_priority_tasks_.empty()) {
+    Task* task = high_priority_tasks_.front();
+    high_priority_tasks_.pop_front();
+    return task;
+  }
+  if (!tasks_.empty()) {
     Task* task = tasks_.front();
     tasks_.pop_front();
     return task;
   }
-  return nullptr;
+  return StealTask(self_worker);
 }
 
 void ThreadPool::Wait(Thread* self, bool do_work, bool may_hold_locks) {
@@ -250,7 +397,11 @@ void ThreadPool::Wait(Thread* self, bool do_work, bool may_hold_locks) {
 
 size_t ThreadPool::GetTaskCount(Thread* self) {
   MutexLock mu(self, task_queue_lock_);
-  return tasks_.size();
+  size_t count = tasks_.size() + high_priority_tasks_.size();
+  for (ThreadPoolWorker* worker : threads_) {
+    count += worker->deque_.Size();
+  }
+  return count;
 }
 
 void ThreadPool::SetPthreadPriority(int priority) {
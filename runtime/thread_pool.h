@@ -17,10 +17,13 @@
 #ifndef ART_RUNTIME_THREAD_POOL_H_
 #define ART_RUNTIME_THREAD_POOL_H_
 
+#include <algorithm>
 #include <deque>
+#include <memory>
 #include <vector>
 
 #include "barrier.h"
+#include "base/atomic.h"
 #include "base/mem_map.h"
 #include "base/mutex.h"
 
@@ -48,6 +51,50 @@ class SelfDeletingTask : public Task {
   }
 };
 
+// Priority of a task added to a ThreadPool. Queued high priority tasks are run before any queued
+// normal priority task.
+enum class TaskPriority : uint8_t {
+  kNormal,
+  kHigh,
+};
+
+// A bounded Chase-Lev work-stealing deque of tasks. The owning worker pushes and pops tasks at
+// the bottom without any synchronization beyond a fence, other threads steal tasks from the top.
+class WorkStealingDeque {
+ public:
+  // Must be a power of 2.
+  static constexpr size_t kCapacity = 1024;
+
+  WorkStealingDeque();
+
+  // Owner only. Returns false if the deque is full.
+  bool Push(Task* task);
+
+  // Owner only. Returns the most recently pushed task, or null if the deque is empty.
+  Task* Pop();
+
+  // Returns the oldest task, or null if the deque is empty or another thread took that task
+  // first.
+  Task* Steal();
+
+  size_t Size() const {
+    int64_t bottom = bottom_.load(std::memory_order_seq_cst);
+    int64_t top = top_.load(std::memory_order_seq_cst);
+    return bottom > top ? static_cast<size_t>(bottom - top) : 0u;
+  }
+
+  bool IsEmpty() const {
+    return Size() == 0u;
+  }
+
+ private:
+  Atomic<int64_t> top_;
+  Atomic<int64_t> bottom_;
+  Atomic<Task*> buffer_[kCapacity];
+
+  DISALLOW_COPY_AND_ASSIGN(WorkStealingDeque);
+};
+
 class ThreadPoolWorker {
  public:
   static const size_t kDefaultStackSize = 1 * MB;
@@ -74,12 +121,18 @@ class ThreadPoolWorker {
   MemMap stack_;
   pthread_t pthread_;
   Thread* thread_;
+  // Tasks added by this worker while running a task.
+  WorkStealingDeque deque_;
 
  private:
   friend class ThreadPool;
   DISALLOW_COPY_AND_ASSIGN(ThreadPoolWorker);
 };
 
+// Tasks added by a worker of the pool go to that worker's WorkStealingDeque, where the worker takes
+// them back without locking and idle workers steal them. Tasks added by other threads go to shared
+// queues guarded by task_queue_lock_.
+//
 // Note that thread pool workers will set Thread#setCanCallIntoJava to false.
 class ThreadPool {
  public:
@@ -100,7 +153,15 @@ class ThreadPool {
 
   // Add a new task, the first available started worker will process it. Does not delete the task
   // after running it, it is the caller's responsibility.
-  void AddTask(Thread* self, Task* task) REQUIRES(!task_queue_lock_);
+  void AddTask(Thread* self, Task* task, TaskPriority priority = TaskPriority::kNormal)
+      REQUIRES(!task_queue_lock_);
+
+  // Run `fn(index)` for every index in [begin, end) with `num_tasks` tasks, on the workers and on
+  // the calling thread. Indexes are handed out `grain` at a time from a shared counter, not through
+  // the task queues. Starts the workers and returns once every index has been processed.
+  template <typename Fn>
+  void ParallelFor(Thread* self, size_t begin, size_t end, size_t grain, size_t num_tasks, Fn fn)
+      REQUIRES(!task_queue_lock_);
 
   // Remove all tasks in the queue.
   void RemoveAllTasks(Thread* self) REQUIRES(!task_queue_lock_);
@@ -138,7 +199,13 @@ class ThreadPool {
 
   // Try to get a task, returning null if there is none available.
   Task* TryGetTask(Thread* self) REQUIRES(!task_queue_lock_);
-  Task* TryGetTaskLocked() REQUIRES(task_queue_lock_);
+  Task* TryGetTaskLocked(ThreadPoolWorker* self_worker) REQUIRES(task_queue_lock_);
+
+  // Steal a task from the deque of a worker other than `self_worker`, which may be null.
+  Task* StealTask(ThreadPoolWorker* self_worker);
+
+  // Returns the worker running on `self`, or null if `self` is not a worker of this pool.
+  ThreadPoolWorker* FindWorker(Thread* self) const;
 
   // Are we shutting down?
   bool IsShuttingDown() const REQUIRES(task_queue_lock_) {
@@ -146,33 +213,94 @@ class ThreadPool {
   }
 
   bool HasOutstandingTasks() const REQUIRES(task_queue_lock_) {
-    return started_ && !tasks_.empty();
+    if (!started_) {
+      return false;
+    }
+    if (!tasks_.empty() || !high_priority_tasks_.empty()) {
+      return true;
+    }
+    for (ThreadPoolWorker* worker : threads_) {
+      if (!worker->deque_.IsEmpty()) {
+        return true;
+      }
+    }
+    return false;
   }
 
   const std::string name_;
   Mutex task_queue_lock_;
   ConditionVariable task_queue_condition_ GUARDED_BY(task_queue_lock_);
   ConditionVariable completion_condition_ GUARDED_BY(task_queue_lock_);
-  volatile bool started_ GUARDED_BY(task_queue_lock_);
+  // Only written with task_queue_lock_ held, workers read it without the lock before stealing.
+  Atomic<bool> started_;
   volatile bool shutting_down_ GUARDED_BY(task_queue_lock_);
-  // How many worker threads are waiting on the condition.
-  volatile size_t waiting_count_ GUARDED_BY(task_queue_lock_);
+  // How many worker threads are waiting on the condition. Only written with task_queue_lock_ held,
+  // workers adding a task to their deque read it without the lock to decide whether to signal.
+  Atomic<size_t> waiting_count_;
   std::deque<Task*> tasks_ GUARDED_BY(task_queue_lock_);
+  std::deque<Task*> high_priority_tasks_ GUARDED_BY(task_queue_lock_);
   // TODO: make this immutable/const?
   std::vector<ThreadPoolWorker*> threads_;
   // Work balance detection.
   uint64_t start_time_ GUARDED_BY(task_queue_lock_);
   uint64_t total_wait_time_;
   Barrier creation_barier_;
-  size_t max_active_workers_ GUARDED_BY(task_queue_lock_);
+  // Only written with task_queue_lock_ held, workers read it without the lock before taking a
+  // task from a deque.
+  Atomic<size_t> max_active_workers_;
   const bool create_peers_;
 
  private:
   friend class ThreadPoolWorker;
-  friend class WorkStealingWorker;
   DISALLOW_COPY_AND_ASSIGN(ThreadPool);
 };
 
+template <typename Fn>
+class ParallelForTask : public Task {
+ public:
+  ParallelForTask(Atomic<size_t>* next_index, size_t end, size_t grain, Fn* fn)
+      : next_index_(next_index), end_(end), grain_(grain), fn_(fn) {}
+
+  void Run(Thread* self ATTRIBUTE_UNUSED) override {
+    while (true) {
+      const size_t begin = next_index_->fetch_add(grain_, std::memory_order_relaxed);
+      if (begin >= end_) {
+        break;
+      }
+      const size_t end = std::min(begin + grain_, end_);
+      for (size_t index = begin; index != end; ++index) {
+        (*fn_)(index);
+      }
+    }
+  }
+
+ private:
+  Atomic<size_t>* const next_index_;
+  const size_t end_;
+  const size_t grain_;
+  Fn* const fn_;
+};
+
+template <typename Fn>
+void ThreadPool::ParallelFor(Thread* self,
+                             size_t begin,
+                             size_t end,
+                             size_t grain,
+                             size_t num_tasks,
+                             Fn fn) {
+  CHECK_GT(grain, 0u);
+  CHECK_GT(num_tasks, 0u);
+  Atomic<size_t> next_index(begin);
+  std::vector<std::unique_ptr<ParallelForTask<Fn>>> tasks;
+  tasks.reserve(num_tasks);
+  for (size_t i = 0; i < num_tasks; ++i) {
+    tasks.emplace_back(new ParallelForTask<Fn>(&next_index, end, grain, &fn));
+    AddTask(self, tasks.back().get());
+  }
+  StartWorkers(self);
+  Wait(self, /* do_work */ true, /* may_hold_locks */ false);
+}
+
 }  // namespace art
 
 #endif  // ART_RUNTIME_THREAD_POOL_H_
@@ -16,7 +16,9 @@
 
 #include "thread_pool.h"
 
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "base/atomic.h"
 #include "common_runtime_test.h"
@@ -160,6 +162,129 @@ TEST_F(ThreadPoolTest, RecursiveTest) {
   EXPECT_EQ((1 << depth) - 1, count.load(std::memory_order_seq_cst));
 }
 
+// Records how many tasks run at the same time. Like TreeTask, spawns its children from the worker
+// running it so that they go to that worker's deque.
+class ConcurrencyTask : public Task {
+ public:
+  ConcurrencyTask(ThreadPool* thread_pool,
+                  AtomicInteger* running,
+                  AtomicInteger* max_running,
+                  int depth)
+      : thread_pool_(thread_pool),
+        running_(running),
+        max_running_(max_running),
+        depth_(depth) {}
+
+  void Run(Thread* self) override {
+    int32_t running = running_->fetch_add(1) + 1;
+    int32_t max_running = max_running_->load();
+    while (running > max_running && !max_running_->CompareAndSetWeakRelaxed(max_running, running)) {
+      max_running = max_running_->load();
+    }
+    if (depth_ > 1) {
+      for (size_t i = 0; i != 2u; ++i) {
+        thread_pool_->AddTask(
+            self, new ConcurrencyTask(thread_pool_, running_, max_running_, depth_ - 1));
+      }
+    }
+    usleep(100);
+    running_->fetch_sub(1);
+  }
+
+  void Finalize() override {
+    delete this;
+  }
+
+ private:
+  ThreadPool* const thread_pool_;
+  AtomicInteger* const running_;
+  AtomicInteger* const max_running_;
+  const int depth_;
+};
+
+// Test that workers do not take tasks from the deques beyond the maximum active worker count.
+TEST_F(ThreadPoolTest, MaxActiveWorkers) {
+  Thread* self = Thread::Current();
+  ThreadPool thread_pool("Thread pool test thread pool", num_threads);
+  AtomicInteger running(0);
+  AtomicInteger max_running(0);
+  thread_pool.SetMaxActiveWorkers(1);
+  thread_pool.AddTask(self, new ConcurrencyTask(&thread_pool, &running, &max_running, 6));
+  thread_pool.StartWorkers(self);
+  thread_pool.Wait(self, /* do_work */ false, false);
+  EXPECT_EQ(1, max_running.load());
+}
+
+TEST_F(ThreadPoolTest, WorkStealingDeque) {
+  WorkStealingDeque deque;
+  std::vector<std::unique_ptr<Task>> tasks;
+  for (size_t i = 0; i != 3u; ++i) {
+    tasks.emplace_back(new CountTask(nullptr));
+    ASSERT_TRUE(deque.Push(tasks.back().get()));
+  }
+  EXPECT_EQ(3u, deque.Size());
+  // The owner takes the newest task, thieves the oldest one.
+  EXPECT_EQ(tasks[2].get(), deque.Pop());
+  EXPECT_EQ(tasks[0].get(), deque.Steal());
+  EXPECT_EQ(tasks[1].get(), deque.Pop());
+  EXPECT_TRUE(deque.IsEmpty());
+  EXPECT_EQ(nullptr, deque.Pop());
+  EXPECT_EQ(nullptr, deque.Steal());
+  // A full deque rejects new tasks.
+  for (size_t i = 0; i != WorkStealingDeque::kCapacity; ++i) {
+    ASSERT_TRUE(deque.Push(tasks[0].get()));
+  }
+  EXPECT_FALSE(deque.Push(tasks[0].get()));
+}
+
+class RecordTask : public Task {
+ public:
+  RecordTask(std::vector<int>* order, int id) : order_(order), id_(id) {}
+
+  void Run(Thread* self ATTRIBUTE_UNUSED) override {
+    order_->push_back(id_);
+  }
+
+  void Finalize() override {
+    delete this;
+  }
+
+ private:
+  std::vector<int>* const order_;
+  const int id_;
+};
+
+// Test that queued high priority tasks run before queued normal priority tasks.
+TEST_F(ThreadPoolTest, TaskPriority) {
+  Thread* self = Thread::Current();
+  // A single worker runs the tasks one after the other.
+  ThreadPool thread_pool("Thread pool test thread pool", 1);
+  std::vector<int> order;
+  thread_pool.AddTask(self, new RecordTask(&order, 0));
+  thread_pool.AddTask(self, new RecordTask(&order, 1));
+  thread_pool.AddTask(self, new RecordTask(&order, 2), TaskPriority::kHigh);
+  thread_pool.AddTask(self, new RecordTask(&order, 3), TaskPriority::kHigh);
+  thread_pool.StartWorkers(self);
+  thread_pool.Wait(self, /* do_work */ false, false);
+  EXPECT_EQ((std::vector<int>{2, 3, 0, 1}), order);
+}
+
+TEST_F(ThreadPoolTest, ParallelFor) {
+  Thread* self = Thread::Current();
+  ThreadPool thread_pool("Thread pool test thread pool", num_threads);
+  static constexpr size_t kBegin = 3u;
+  static constexpr size_t kEnd = 1000u;
+  std::vector<AtomicInteger> visits(kEnd);
+  thread_pool.ParallelFor(self, kBegin, kEnd, /* grain */ 7u, num_threads, [&](size_t index) {
+    ++visits[index];
+  });
+  thread_pool.StopWorkers(self);
+  // Every index in the range is processed exactly once.
+  for (size_t i = 0; i != kEnd; ++i) {
+    EXPECT_EQ(i >= kBegin ? 1 : 0, visits[i].load(std::memory_order_seq_cst)) << i;
+  }
+}
+
 class PeerTask : public Task {
  public:
   PeerTask() {}
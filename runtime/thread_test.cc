@@ -0,0 +1,233 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "thread.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <atomic>
+#include <functional>
+
+#include "base/mutex.h"
+#include "base/time_utils.h"
+#include "common_runtime_test.h"
+#include "scoped_thread_state_change-inl.h"
+#include "thread-inl.h"
+#include "thread_list.h"
+#include "thread_pool.h"
+
+namespace art {
+
+class ThreadHandshakeTest : public CommonRuntimeTest {};
+
+// Runs `body` on a new native thread attached to the runtime. The thread is in the kNative state
+// when `body` starts and detaches once it returns.
+class AttachedThread {
+ public:
+  explicit AttachedThread(std::function<void(Thread*)> body) : body_(std::move(body)) {
+    CHECK_PTHREAD_CALL(pthread_create,
+                       (&pthread_, nullptr, &AttachedThread::Main, this),
+                       "handshake test thread");
+  }
+
+  void Join() {
+    CHECK_PTHREAD_CALL(pthread_join, (pthread_, nullptr), "handshake test thread shutdown");
+  }
+
+ private:
+  static void* Main(void* arg) {
+    AttachedThread* thread = reinterpret_cast<AttachedThread*>(arg);
+    Runtime* runtime = Runtime::Current();
+    CHECK(runtime->AttachCurrentThread("handshake test thread",
+                                       /* as_daemon */ true,
+                                       /* thread_group */ nullptr,
+                                       /* create_peer */ false));
+    thread->body_(Thread::Current());
+    runtime->DetachCurrentThread();
+    return nullptr;
+  }
+
+  std::function<void(Thread*)> body_;
+  pthread_t pthread_;
+};
+
+// Records which thread ran the handshake and checks that a target whose handshake is run by
+// another thread is held suspended meanwhile.
+class RecordingClosure : public Closure {
+ public:
+  explicit RecordingClosure(std::function<void()> on_run = nullptr)
+      : on_run_(std::move(on_run)) {}
+
+  void Run(Thread* target) override {
+    Thread* self = Thread::Current();
+    if (self != target && (!target->IsSuspended() || target->GetState() == kRunnable)) {
+      ++errors_;
+    }
+    last_runner_.store(self);
+    if (on_run_ != nullptr) {
+      on_run_();
+    }
+    ++runs_;
+  }
+
+  size_t GetRuns() const { return runs_.load(); }
+  size_t GetErrors() const { return errors_.load(); }
+  Thread* GetLastRunner() const { return last_runner_.load(); }
+
+ private:
+  std::function<void()> on_run_;
+  std::atomic<size_t> runs_{0u};
+  std::atomic<size_t> errors_{0u};
+  std::atomic<Thread*> last_runner_{nullptr};
+};
+
+static Thread* WaitForThread(const std::atomic<Thread*>& thread) {
+  Thread* result;
+  while ((result = thread.load()) == nullptr) {
+    sched_yield();
+  }
+  return result;
+}
+
+// RequestSynchronousCheckpoint expects the thread_list_lock_ and releases it.
+static bool RequestHandshake(Thread* self, Thread* target, Closure* closure) {
+  ScopedObjectAccess soa(self);
+  Locks::thread_list_lock_->ExclusiveLock(self);
+  return target->RequestSynchronousCheckpoint(closure);
+}
+
+// A runnable target runs the handshake itself at its next suspend check.
+TEST_F(ThreadHandshakeTest, RunnableTarget) {
+  std::atomic<Thread*> target{nullptr};
+  std::atomic<bool> stop{false};
+  AttachedThread target_thread([&](Thread* self) {
+    ScopedObjectAccess soa(self);
+    target.store(self);
+    while (!stop.load()) {
+      self->CheckSuspend();
+    }
+  });
+  Thread* t = WaitForThread(target);
+
+  RecordingClosure closure;
+  EXPECT_TRUE(RequestHandshake(Thread::Current(), t, &closure));
+  EXPECT_EQ(1u, closure.GetRuns());
+  EXPECT_EQ(t, closure.GetLastRunner());
+  EXPECT_FALSE(t->ReadFlag(kHandshakeRequest));
+
+  stop.store(true);
+  target_thread.Join();
+}
+
+// The handshake of a suspended target is run by the requesting thread, and the target cannot
+// become runnable until it is done.
+TEST_F(ThreadHandshakeTest, SuspendedTarget) {
+  std::atomic<Thread*> target{nullptr};
+  std::atomic<bool> stop{false};
+  std::atomic<bool> became_runnable{false};
+  AttachedThread target_thread([&](Thread* self) {
+    target.store(self);
+    while (!stop.load()) {
+      sched_yield();
+    }
+    ScopedObjectAccess soa(self);
+    became_runnable.store(true);
+  });
+  Thread* t = WaitForThread(target);
+
+  bool runnable_during_handshake = false;
+  RecordingClosure closure([&]() {
+    // Let the target try to become runnable while we are running its handshake.
+    stop.store(true);
+    NanoSleep(MsToNs(10));
+    runnable_during_handshake = became_runnable.load();
+  });
+  EXPECT_TRUE(RequestHandshake(Thread::Current(), t, &closure));
+  EXPECT_EQ(1u, closure.GetRuns());
+  EXPECT_EQ(0u, closure.GetErrors());
+  EXPECT_EQ(Thread::Current(), closure.GetLastRunner());
+  EXPECT_FALSE(runnable_during_handshake);
+
+  target_thread.Join();
+  EXPECT_TRUE(became_runnable.load());
+}
+
+// A handshake still queued when the target starts exiting is run by the target before it leaves
+// the runnable state, and the exiting thread waits for the requester to be done with it.
+TEST_F(ThreadHandshakeTest, PendingWhenTargetExits) {
+  std::atomic<Thread*> target{nullptr};
+  std::atomic<bool> stop{false};
+  AttachedThread target_thread([&](Thread* self) {
+    ScopedObjectAccess soa(self);
+    target.store(self);
+    // Do not check for suspension, keep the handshake pending until we exit.
+    while (!stop.load()) {
+      sched_yield();
+    }
+  });
+  Thread* t = WaitForThread(target);
+
+  RecordingClosure closure;
+  std::atomic<bool> result{false};
+  AttachedThread requester([&](Thread* self) {
+    result.store(RequestHandshake(self, t, &closure));
+  });
+  while (!t->ReadFlag(kHandshakeRequest)) {
+    sched_yield();
+  }
+  EXPECT_EQ(0u, closure.GetRuns());
+
+  stop.store(true);
+  target_thread.Join();
+  requester.Join();
+  EXPECT_TRUE(result.load());
+  EXPECT_EQ(1u, closure.GetRuns());
+  EXPECT_EQ(t, closure.GetLastRunner());
+}
+
+// Handshakes keep completing while the target is suspended and resumed by suspend-all requests
+// and goes in and out of the runnable state.
+TEST_F(ThreadHandshakeTest, RaceWithSuspension) {
+  static constexpr size_t kNumHandshakes = 1000u;
+  std::atomic<Thread*> target{nullptr};
+  std::atomic<bool> stop{false};
+  AttachedThread target_thread([&](Thread* self) {
+    target.store(self);
+    while (!stop.load()) {
+      ScopedObjectAccess soa(self);
+      self->CheckSuspend();
+    }
+  });
+  AttachedThread suspender([&](Thread* self ATTRIBUTE_UNUSED) {
+    while (!stop.load()) {
+      ScopedSuspendAll ssa("ThreadHandshakeTest");
+    }
+  });
+  Thread* t = WaitForThread(target);
+
+  RecordingClosure closure;
+  for (size_t i = 0; i != kNumHandshakes; ++i) {
+    EXPECT_TRUE(RequestHandshake(Thread::Current(), t, &closure));
+  }
+  stop.store(true);
+  target_thread.Join();
+  suspender.Join();
+  EXPECT_EQ(kNumHandshakes, closure.GetRuns());
+  EXPECT_EQ(0u, closure.GetErrors());
+}
+
+}  // namespace art
@@ -255,7 +255,6 @@ void Transaction::RecordWeakStringRemoval(ObjPtr<mirror::String> s) {
 }
 
 void Transaction::LogInternedString(InternStringLog&& log) {
-  Locks::intern_table_lock_->AssertExclusiveHeld(Thread::Current());
   MutexLock mu(Thread::Current(), log_lock_);
   intern_string_logs_.push_front(std::move(log));
 }
@@ -263,14 +262,19 @@ void Transaction::LogInternedString(InternStringLog&& log) {
 void Transaction::Rollback() {
   Thread* self = Thread::Current();
   self->AssertNoPendingException();
-  MutexLock mu1(self, *Locks::intern_table_lock_);
-  MutexLock mu2(self, log_lock_);
   rolling_back_ = true;
   CHECK(!Runtime::Current()->IsActiveTransaction());
-  UndoObjectModifications();
-  UndoArrayModifications();
-  UndoInternStringTableModifications();
-  UndoResolveStringModifications();
+  std::list<InternStringLog> intern_string_logs;
+  {
+    MutexLock mu(self, log_lock_);
+    UndoObjectModifications();
+    UndoArrayModifications();
+    intern_string_logs.swap(intern_string_logs_);
+    UndoResolveStringModifications();
+  }
+  // The intern table locks the shard of each string, which must not be done while holding
+  // log_lock_ since interning records into the log with the shard lock held.
+  UndoInternStringTableModifications(intern_string_logs);
   rolling_back_ = false;
 }
 
@@ -292,14 +296,14 @@ void Transaction::UndoArrayModifications() {
   array_logs_.clear();
 }
 
-void Transaction::UndoInternStringTableModifications() {
+void Transaction::UndoInternStringTableModifications(
+    const std::list<InternStringLog>& intern_string_logs) {
   InternTable* const intern_table = Runtime::Current()->GetInternTable();
   // We want to undo each operation from the most recent to the oldest. List has been filled so the
   // most recent operation is at list begin so just have to iterate over it.
-  for (const InternStringLog& string_log : intern_string_logs_) {
+  for (const InternStringLog& string_log : intern_string_logs) {
     string_log.Undo(intern_table);
   }
-  intern_string_logs_.clear();
 }
 
 void Transaction::UndoResolveStringModifications() {
@@ -109,16 +109,12 @@ class Transaction final {
 
   // Record intern string table changes.
   void RecordStrongStringInsertion(ObjPtr<mirror::String> s)
-      REQUIRES(Locks::intern_table_lock_)
       REQUIRES(!log_lock_);
   void RecordWeakStringInsertion(ObjPtr<mirror::String> s)
-      REQUIRES(Locks::intern_table_lock_)
       REQUIRES(!log_lock_);
   void RecordStrongStringRemoval(ObjPtr<mirror::String> s)
-      REQUIRES(Locks::intern_table_lock_)
       REQUIRES(!log_lock_);
   void RecordWeakStringRemoval(ObjPtr<mirror::String> s)
-      REQUIRES(Locks::intern_table_lock_)
       REQUIRES(!log_lock_);
 
   // Record resolve string.
@@ -237,8 +233,7 @@ class Transaction final {
     InternStringLog(ObjPtr<mirror::String> s, StringKind kind, StringOp op);
 
     void Undo(InternTable* intern_table) const
-        REQUIRES_SHARED(Locks::mutator_lock_)
-        REQUIRES(Locks::intern_table_lock_);
+        REQUIRES_SHARED(Locks::mutator_lock_);
     void VisitRoots(RootVisitor* visitor) REQUIRES_SHARED(Locks::mutator_lock_);
 
     InternStringLog() = default;
@@ -268,7 +263,6 @@ class Transaction final {
   };
 
   void LogInternedString(InternStringLog&& log)
-      REQUIRES(Locks::intern_table_lock_)
       REQUIRES(!log_lock_);
 
   void UndoObjectModifications()
@@ -277,9 +271,8 @@ class Transaction final {
   void UndoArrayModifications()
       REQUIRES(log_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
-  void UndoInternStringTableModifications()
-      REQUIRES(Locks::intern_table_lock_)
-      REQUIRES(log_lock_)
+  void UndoInternStringTableModifications(const std::list<InternStringLog>& intern_string_logs)
+      REQUIRES(!log_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
   void UndoResolveStringModifications()
       REQUIRES(log_lock_)
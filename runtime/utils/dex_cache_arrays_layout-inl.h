@@ -19,6 +19,8 @@
 
 #include "dex_cache_arrays_layout.h"
 
+#include <algorithm>
+
 #include <android-base/logging.h>
 
 #include "base/bit_utils.h"
@@ -26,30 +28,71 @@
 #include "dex/primitive.h"
 #include "gc_root.h"
 #include "mirror/dex_cache.h"
+#include "runtime.h"
 
 namespace art {
 
 inline DexCacheArraysLayout::DexCacheArraysLayout(PointerSize pointer_size,
                                                   const DexFile::Header& header,
-                                                  uint32_t num_call_sites)
+                                                  uint32_t num_call_sites,
+                                                  DexCacheSizing sizing)
     : pointer_size_(pointer_size),
+      num_types_(
+          CacheSize(header.type_ids_size_, mirror::DexCache::kDexCacheTypeCacheSize, sizing)),
+      num_methods_(
+          CacheSize(header.method_ids_size_, mirror::DexCache::kDexCacheMethodCacheSize, sizing)),
+      num_strings_(
+          CacheSize(header.string_ids_size_, mirror::DexCache::kDexCacheStringCacheSize, sizing)),
+      num_fields_(
+          CacheSize(header.field_ids_size_, mirror::DexCache::kDexCacheFieldCacheSize, sizing)),
+      num_method_types_(CacheSize(header.proto_ids_size_,
+                                  mirror::DexCache::kDexCacheMethodTypeCacheSize,
+                                  sizing)),
       /* types_offset_ is always 0u, so it's constexpr */
       methods_offset_(
-          RoundUp(types_offset_ + TypesSize(header.type_ids_size_), MethodsAlignment())),
+          RoundUp(types_offset_ + TypesSize(num_types_), MethodsAlignment())),
       strings_offset_(
-          RoundUp(methods_offset_ + MethodsSize(header.method_ids_size_), StringsAlignment())),
+          RoundUp(methods_offset_ + MethodsSize(num_methods_), StringsAlignment())),
       fields_offset_(
-          RoundUp(strings_offset_ + StringsSize(header.string_ids_size_), FieldsAlignment())),
+          RoundUp(strings_offset_ + StringsSize(num_strings_), FieldsAlignment())),
       method_types_offset_(
-          RoundUp(fields_offset_ + FieldsSize(header.field_ids_size_), MethodTypesAlignment())),
+          RoundUp(fields_offset_ + FieldsSize(num_fields_), MethodTypesAlignment())),
     call_sites_offset_(
-        RoundUp(method_types_offset_ + MethodTypesSize(header.proto_ids_size_),
+        RoundUp(method_types_offset_ + MethodTypesSize(num_method_types_),
                 MethodTypesAlignment())),
       size_(RoundUp(call_sites_offset_ + CallSitesSize(num_call_sites), Alignment())) {
 }
 
 inline DexCacheArraysLayout::DexCacheArraysLayout(PointerSize pointer_size, const DexFile* dex_file)
-    : DexCacheArraysLayout(pointer_size, dex_file->GetHeader(), dex_file->NumCallSiteIds()) {
+    : DexCacheArraysLayout(pointer_size,
+                           dex_file->GetHeader(),
+                           dex_file->NumCallSiteIds(),
+                           GetSizing(dex_file)) {
+}
+
+inline uint32_t DexCacheArraysLayout::CacheSize(uint32_t num_ids,
+                                                uint32_t fixed_size,
+                                                DexCacheSizing sizing) {
+  DCHECK(IsPowerOfTwo(fixed_size));
+  uint32_t cache_size = fixed_size;
+  switch (sizing) {
+    case DexCacheSizing::kFixed:
+      break;
+    case DexCacheSizing::kAdaptive:
+      // Aim for a quarter of the ids; the resolved working set of a dex file is usually
+      // a small fraction of it and conflicts fall off quickly once the array exceeds it.
+      cache_size = std::max(cache_size,
+                            std::min(RoundUpToPowerOfTwo(num_ids / 4u), kMaxAdaptiveCacheSize));
+      break;
+    case DexCacheSizing::kFull:
+      return num_ids;
+  }
+  return std::min(num_ids, cache_size);
+}
+
+inline DexCacheSizing DexCacheArraysLayout::GetSizing(const DexFile* dex_file) {
+  Runtime* runtime = Runtime::Current();
+  return (runtime != nullptr) ? runtime->GetDexCacheSizing(*dex_file) : DexCacheSizing::kFixed;
 }
 
 inline size_t DexCacheArraysLayout::Alignment() const {
@@ -76,16 +119,12 @@ constexpr PointerSize GcRootAsPointerSize() {
 }
 
 inline size_t DexCacheArraysLayout::TypeOffset(dex::TypeIndex type_idx) const {
-  return types_offset_ + ElementOffset(PointerSize::k64,
-                                       type_idx.index_ % mirror::DexCache::kDexCacheTypeCacheSize);
+  uint32_t type_hash = mirror::DexCache::SlotIndexForSize(type_idx.index_, num_types_);
+  return types_offset_ + ElementOffset(PointerSize::k64, type_hash);
 }
 
 inline size_t DexCacheArraysLayout::TypesSize(size_t num_elements) const {
-  size_t cache_size = mirror::DexCache::kDexCacheTypeCacheSize;
-  if (num_elements < cache_size) {
-    cache_size = num_elements;
-  }
-  return PairArraySize(GcRootAsPointerSize<mirror::Class>(), cache_size);
+  return PairArraySize(GcRootAsPointerSize<mirror::Class>(), num_elements);
 }
 
 inline size_t DexCacheArraysLayout::TypesAlignment() const {
@@ -97,11 +136,7 @@ inline size_t DexCacheArraysLayout::MethodOffset(uint32_t method_idx) const {
 }
 
 inline size_t DexCacheArraysLayout::MethodsSize(size_t num_elements) const {
-  size_t cache_size = mirror::DexCache::kDexCacheMethodCacheSize;
-  if (num_elements < cache_size) {
-    cache_size = num_elements;
-  }
-  return PairArraySize(pointer_size_, cache_size);
+  return PairArraySize(pointer_size_, num_elements);
 }
 
 inline size_t DexCacheArraysLayout::MethodsAlignment() const {
@@ -109,16 +144,12 @@ inline size_t DexCacheArraysLayout::MethodsAlignment() const {
 }
 
 inline size_t DexCacheArraysLayout::StringOffset(uint32_t string_idx) const {
-  uint32_t string_hash = string_idx % mirror::DexCache::kDexCacheStringCacheSize;
+  uint32_t string_hash = mirror::DexCache::SlotIndexForSize(string_idx, num_strings_);
   return strings_offset_ + ElementOffset(PointerSize::k64, string_hash);
 }
 
 inline size_t DexCacheArraysLayout::StringsSize(size_t num_elements) const {
-  size_t cache_size = mirror::DexCache::kDexCacheStringCacheSize;
-  if (num_elements < cache_size) {
-    cache_size = num_elements;
-  }
-  return PairArraySize(GcRootAsPointerSize<mirror::String>(), cache_size);
+  return PairArraySize(GcRootAsPointerSize<mirror::String>(), num_elements);
 }
 
 inline size_t DexCacheArraysLayout::StringsAlignment() const {
@@ -128,16 +159,12 @@ inline size_t DexCacheArraysLayout::StringsAlignment() const {
 }
 
 inline size_t DexCacheArraysLayout::FieldOffset(uint32_t field_idx) const {
-  uint32_t field_hash = field_idx % mirror::DexCache::kDexCacheFieldCacheSize;
+  uint32_t field_hash = mirror::DexCache::SlotIndexForSize(field_idx, num_fields_);
   return fields_offset_ + 2u * static_cast<size_t>(pointer_size_) * field_hash;
 }
 
 inline size_t DexCacheArraysLayout::FieldsSize(size_t num_elements) const {
-  size_t cache_size = mirror::DexCache::kDexCacheFieldCacheSize;
-  if (num_elements < cache_size) {
-    cache_size = num_elements;
-  }
-  return PairArraySize(pointer_size_, cache_size);
+  return PairArraySize(pointer_size_, num_elements);
 }
 
 inline size_t DexCacheArraysLayout::FieldsAlignment() const {
@@ -145,12 +172,7 @@ inline size_t DexCacheArraysLayout::FieldsAlignment() const {
 }
 
 inline size_t DexCacheArraysLayout::MethodTypesSize(size_t num_elements) const {
-  size_t cache_size = mirror::DexCache::kDexCacheMethodTypeCacheSize;
-  if (num_elements < cache_size) {
-    cache_size = num_elements;
-  }
-
-  return ArraySize(PointerSize::k64, cache_size);
+  return ArraySize(PointerSize::k64, num_elements);
 }
 
 inline size_t DexCacheArraysLayout::MethodTypesAlignment() const {
@@ -17,11 +17,19 @@
 #ifndef ART_RUNTIME_UTILS_DEX_CACHE_ARRAYS_LAYOUT_H_
 #define ART_RUNTIME_UTILS_DEX_CACHE_ARRAYS_LAYOUT_H_
 
+#include "base/globals.h"
 #include "dex/dex_file.h"
 #include "dex/dex_file_types.h"
 
 namespace art {
 
+// How the hashed dex cache arrays of a dex file are sized.
+enum class DexCacheSizing : uint8_t {
+  kFixed,     // At most the mirror::DexCache::kDexCache*CacheSize entries per array.
+  kAdaptive,  // Scaled with the number of ids in the dex file, up to kMaxAdaptiveCacheSize.
+  kFull,      // One entry per id, so that lookups never conflict.
+};
+
 /**
  * @class DexCacheArraysLayout
  * @details This class provides the layout information for the type, method, field and
@@ -33,6 +41,11 @@ class DexCacheArraysLayout {
   DexCacheArraysLayout()
       : /* types_offset_ is always 0u */
         pointer_size_(kRuntimePointerSize),
+        num_types_(0u),
+        num_methods_(0u),
+        num_strings_(0u),
+        num_fields_(0u),
+        num_method_types_(0u),
         methods_offset_(0u),
         strings_offset_(0u),
         fields_offset_(0u),
@@ -44,11 +57,22 @@ class DexCacheArraysLayout {
   // Construct a layout for a particular dex file header.
   DexCacheArraysLayout(PointerSize pointer_size,
                        const DexFile::Header& header,
-                       uint32_t num_call_sites);
+                       uint32_t num_call_sites,
+                       DexCacheSizing sizing = DexCacheSizing::kFixed);
 
-  // Construct a layout for a particular dex file.
+  // Construct a layout for a particular dex file, sized as the current runtime requests.
   DexCacheArraysLayout(PointerSize pointer_size, const DexFile* dex_file);
 
+  // Upper bound for the arrays of dex files using DexCacheSizing::kAdaptive.
+  static constexpr uint32_t kMaxAdaptiveCacheSize = 16 * KB;
+
+  // Returns the number of entries of a hashed array for `num_ids` ids. Unless the array holds
+  // every id, the result is a power of two so that ids can be mapped to slots with a mask.
+  static uint32_t CacheSize(uint32_t num_ids, uint32_t fixed_size, DexCacheSizing sizing);
+
+  // Returns the sizing the current runtime requests for the dex cache arrays of `dex_file`.
+  static DexCacheSizing GetSizing(const DexFile* dex_file);
+
   bool Valid() const {
     return Size() != 0u;
   }
@@ -61,6 +85,26 @@ class DexCacheArraysLayout {
 
   static constexpr size_t Alignment(PointerSize pointer_size);
 
+  uint32_t NumTypes() const {
+    return num_types_;
+  }
+
+  uint32_t NumMethods() const {
+    return num_methods_;
+  }
+
+  uint32_t NumStrings() const {
+    return num_strings_;
+  }
+
+  uint32_t NumFields() const {
+    return num_fields_;
+  }
+
+  uint32_t NumMethodTypes() const {
+    return num_method_types_;
+  }
+
   size_t TypesOffset() const {
     return types_offset_;
   }
@@ -120,6 +164,12 @@ class DexCacheArraysLayout {
  private:
   static constexpr size_t types_offset_ = 0u;
   const PointerSize pointer_size_;  // Must be first for construction initialization order.
+  // Numbers of entries in the hashed arrays, must precede the offsets for the same reason.
+  const uint32_t num_types_;
+  const uint32_t num_methods_;
+  const uint32_t num_strings_;
+  const uint32_t num_fields_;
+  const uint32_t num_method_types_;
   const size_t methods_offset_;
   const size_t strings_offset_;
   const size_t fields_offset_;
@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import annotations.ConstantMethodHandle;
+import java.lang.invoke.MethodHandle;
+
+public final class Main {
+    private final int value;
+
+    private Main(int value) {
+        this.value = value;
+    }
+
+    private static void unreachable() {
+        throw new Error("Unreachable");
+    }
+
+    private static void assertEquals(int expected, int actual) {
+        if (expected != actual) {
+            throw new AssertionError("Expected " + expected + " got " + actual);
+        }
+    }
+
+    static int staticAdd(int x, int y) {
+        return x + y;
+    }
+
+    int instanceAdd(int x) {
+        return value + x;
+    }
+
+    private int privateAdd(int x) {
+        return value + x + 10;
+    }
+
+    @ConstantMethodHandle(
+            kind = ConstantMethodHandle.INVOKE_STATIC,
+            owner = "Main",
+            fieldOrMethodName = "staticAdd",
+            descriptor = "(II)I")
+    private static MethodHandle staticAddHandle() {
+        unreachable();
+        return null;
+    }
+
+    @ConstantMethodHandle(
+            kind = ConstantMethodHandle.INVOKE_VIRTUAL,
+            owner = "Main",
+            fieldOrMethodName = "instanceAdd",
+            descriptor = "(I)I")
+    private static MethodHandle instanceAddHandle() {
+        unreachable();
+        return null;
+    }
+
+    @ConstantMethodHandle(
+            kind = ConstantMethodHandle.INVOKE_SPECIAL,
+            owner = "Main",
+            fieldOrMethodName = "privateAdd",
+            descriptor = "(I)I")
+    private static MethodHandle privateAddHandle() {
+        unreachable();
+        return null;
+    }
+
+    @ConstantMethodHandle(
+            kind = ConstantMethodHandle.INVOKE_SPECIAL,
+            owner = "Main",
+            fieldOrMethodName = "instanceAdd",
+            descriptor = "(I)I")
+    private static MethodHandle superInstanceAddHandle() {
+        unreachable();
+        return null;
+    }
+
+    @ConstantMethodHandle(
+            kind = ConstantMethodHandle.INVOKE_INTERFACE,
+            owner = "Adder",
+            fieldOrMethodName = "add",
+            descriptor = "(I)I",
+            ownerIsInterface = true)
+    private static MethodHandle interfaceAddHandle() {
+        unreachable();
+        return null;
+    }
+
+    @ConstantMethodHandle(
+            kind = ConstantMethodHandle.INVOKE_STATIC,
+            owner = "Other",
+            fieldOrMethodName = "add",
+            descriptor = "(II)I")
+    private static MethodHandle otherAddHandle() {
+        unreachable();
+        return null;
+    }
+
+    /// CHECK-START: int Main.$noinline$staticInvoke(int, int) inliner (before)
+    /// CHECK:     LoadMethodHandle
+    /// CHECK:     InvokePolymorphic
+
+    /// CHECK-START: int Main.$noinline$staticInvoke(int, int) inliner (after)
+    /// CHECK-NOT: InvokePolymorphic
+    /// CHECK-NOT: InvokeStaticOrDirect
+
+    /// CHECK-START: int Main.$noinline$staticInvoke(int, int) inliner (after)
+    /// CHECK-NOT: LoadMethodHandle
+    private static int $noinline$staticInvoke(int x, int y) throws Throwable {
+        return (int) staticAddHandle().invokeExact(x, y);
+    }
+
+    /// CHECK-START: int Main.$noinline$instanceInvoke(Main, int) inliner (before)
+    /// CHECK:     InvokePolymorphic
+
+    /// CHECK-START: int Main.$noinline$instanceInvoke(Main, int) inliner (after)
+    /// CHECK-NOT: InvokePolymorphic
+    /// CHECK-NOT: InvokeVirtual
+    private static int $noinline$instanceInvoke(Main m, int x) throws Throwable {
+        return (int) instanceAddHandle().invokeExact(m, x);
+    }
+
+    /// CHECK-START: int Main.$noinline$privateInvoke(Main, int) inliner (before)
+    /// CHECK:     InvokePolymorphic
+
+    /// CHECK-START: int Main.$noinline$privateInvoke(Main, int) inliner (after)
+    /// CHECK-NOT: InvokePolymorphic
+    /// CHECK-NOT: InvokeStaticOrDirect
+    private static int $noinline$privateInvoke(Main m, int x) throws Throwable {
+        return (int) privateAddHandle().invokeExact(m, x);
+    }
+
+    // The call site boxes the first argument, so the handle needs an asType() conversion.
+
+    /// CHECK-START: int Main.$noinline$convertingInvoke(java.lang.Integer, int) inliner (after)
+    /// CHECK:     InvokePolymorphic
+    private static int $noinline$convertingInvoke(Integer x, int y) throws Throwable {
+        return (int) staticAddHandle().invoke(x, y);
+    }
+
+    /// CHECK-START: int Main.$noinline$interfaceInvoke(Adder, int) inliner (after)
+    /// CHECK:     InvokePolymorphic
+    private static int $noinline$interfaceInvoke(Adder adder, int x) throws Throwable {
+        return (int) interfaceAddHandle().invokeExact(adder, x);
+    }
+
+    // A kInvokeDirect handle on a non-private method has invoke-super semantics. It is only
+    // compiled, not run.
+
+    /// CHECK-START: int Main.$noinline$superInvoke(Main, int) inliner (after)
+    /// CHECK:     InvokePolymorphic
+    private static int $noinline$superInvoke(Main m, int x) throws Throwable {
+        return (int) superInstanceAddHandle().invokeExact(m, x);
+    }
+
+    // Invoking the handle must initialize Other, which the inlined code would not do.
+
+    /// CHECK-START: int Main.$noinline$uninitializedStaticInvoke(int, int) inliner (after)
+    /// CHECK:     InvokePolymorphic
+    private static int $noinline$uninitializedStaticInvoke(int x, int y) throws Throwable {
+        return (int) otherAddHandle().invokeExact(x, y);
+    }
+
+    // Calls the handle targets directly so that the compiler sees them resolved. Not run, so
+    // that Other is first initialized by its method handle.
+    private static int resolveTargets(Main m) {
+        return staticAdd(1, 2) + m.instanceAdd(3) + m.privateAdd(4) + Other.add(5, 6);
+    }
+
+    public static void main(String[] args) throws Throwable {
+        Main m = new Main(1);
+        assertEquals(5, $noinline$staticInvoke(2, 3));
+        assertEquals(3, $noinline$instanceInvoke(m, 2));
+        assertEquals(13, $noinline$privateInvoke(m, 2));
+        assertEquals(5, $noinline$convertingInvoke(2, 3));
+        assertEquals(102, $noinline$interfaceInvoke(new AdderImpl(), 2));
+        System.out.println("Before Other");
+        assertEquals(1005, $noinline$uninitializedStaticInvoke(2, 3));
+        try {
+            $noinline$instanceInvoke(null, 2);
+            throw new AssertionError("Expected a NullPointerException");
+        } catch (NullPointerException expected) {
+        }
+        System.out.println("passed");
+    }
+}
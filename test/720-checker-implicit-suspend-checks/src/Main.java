@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class Main {
+  static volatile boolean sStop = false;
+  static volatile boolean sStarted = false;
+
+  static class Counter {
+    int value;
+  }
+
+  /// CHECK-START-ARM64: int Main.$noinline$spin() disassembly (after)
+  /// CHECK:                SuspendCheck loop:B{{\d+}}
+  /// CHECK:                  ldr x{{\d+}}, [tr, #{{\d+}}]
+  /// CHECK-NEXT:             ldr wzr, [x{{\d+}}]
+
+  /// CHECK-START-ARM64: int Main.$noinline$spin() disassembly (after)
+  /// CHECK-NOT:              ldrh w{{\d+}}, [tr
+  static int $noinline$spin() {
+    sStarted = true;
+    int iterations = 0;
+    while (!sStop) {
+      ++iterations;
+    }
+    return iterations;
+  }
+
+  // The loop polls the suspend trigger, and the null check on `counter` is implicit. A fault on
+  // a null `counter` must still throw a NullPointerException rather than be taken for a suspend
+  // request.
+  /// CHECK-START-ARM64: void Main.$noinline$increment(Main$Counter, int) disassembly (after)
+  /// CHECK:                SuspendCheck loop:B{{\d+}}
+  /// CHECK:                  ldr x{{\d+}}, [tr, #{{\d+}}]
+  /// CHECK-NEXT:             ldr wzr, [x{{\d+}}]
+  static void $noinline$increment(Counter counter, int times) {
+    for (int i = 0; i < times; ++i) {
+      counter.value++;
+    }
+  }
+
+  // Graphs with SIMD keep testing the thread flags, the suspension handler would not preserve
+  // the upper halves of the vector registers.
+  /// CHECK-START-ARM64: void Main.$noinline$simd(int[]) disassembly (after)
+  /// CHECK:                VecAdd
+
+  /// CHECK-START-ARM64: void Main.$noinline$simd(int[]) disassembly (after)
+  /// CHECK-NOT:              ldr wzr, [x{{\d+}}]
+  static void $noinline$simd(int[] array) {
+    for (int i = 0; i < array.length; ++i) {
+      array[i] += 1;
+    }
+  }
+
+  static void assertEquals(int expected, int actual) {
+    if (expected != actual) {
+      throw new Error("Expected " + expected + ", got " + actual);
+    }
+  }
+
+  public static void main(String[] args) throws Exception {
+    // Suspend a thread spinning in a loop that has no other safepoint: each of the garbage
+    // collections, stack trace requests and checkpoints below relies on the fault handler
+    // redirecting the faulting poll to the suspend check entrypoint.
+    Thread spinner = new Thread(new Runnable() {
+      public void run() {
+        $noinline$spin();
+      }
+    });
+    spinner.start();
+    while (!sStarted) {
+      Thread.yield();
+    }
+    for (int i = 0; i < 20; ++i) {
+      Runtime.getRuntime().gc();
+      StackTraceElement[] trace = spinner.getStackTrace();
+      if (trace.length == 0) {
+        throw new Error("Empty stack trace for the spinning thread");
+      }
+      Thread.getAllStackTraces();
+    }
+    sStop = true;
+    spinner.join();
+
+    Counter counter = new Counter();
+    $noinline$increment(counter, 1000);
+    assertEquals(1000, counter.value);
+    $noinline$increment(null, 0);
+    try {
+      $noinline$increment(null, 1);
+      throw new Error("Expected NullPointerException");
+    } catch (NullPointerException expected) {
+      // Expected.
+    }
+
+    int[] array = new int[100];
+    $noinline$simd(array);
+    assertEquals(1, array[99]);
+
+    System.out.println("passed");
+  }
+}
@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+import java.lang.reflect.Method;
+
+public class Main {
+  static Object sink;
+  static volatile boolean sStop = false;
+  static volatile Throwable sFailure = null;
+
+  static class Small {
+    int value;
+
+    /// CHECK-START-X86_64: Main$Small Main$Small.$noinline$create() disassembly (after)
+    /// CHECK:      NewInstance
+    /// CHECK:      ; thread_local_pos
+    /// CHECK:      ; thread_local_inline_end
+    /// CHECK:      NewObjectSlowPathX86_64
+    /// CHECK:      ; pAllocObjectInitialized
+
+    // The class of a static method is initialized when it runs, so it is allocated inline.
+    static Small $noinline$create() {
+      return new Small();
+    }
+  }
+
+  static class Uninitialized {
+    static {
+      sink = "Uninitialized";
+    }
+  }
+
+  static class Finalizable {
+    @Override
+    protected void finalize() {}
+  }
+
+  /// CHECK-START-X86_64: int[] Main.$noinline$allocateSmallArray() disassembly (after)
+  /// CHECK:      NewArray
+  /// CHECK:      ; thread_local_pos
+  /// CHECK:      ; thread_local_inline_end
+  /// CHECK:      NewObjectSlowPathX86_64
+  /// CHECK:      ; pAllocArrayResolved32
+
+  static int[] $noinline$allocateSmallArray() {
+    return new int[8];
+  }
+
+  /// CHECK-START-X86_64: int[] Main.$noinline$allocateLargeArray() disassembly (after)
+  /// CHECK-NOT:  ; thread_local_inline_end
+  /// CHECK-NOT:  NewObjectSlowPathX86_64
+
+  /// CHECK-START-X86_64: int[] Main.$noinline$allocateLargeArray() disassembly (after)
+  /// CHECK:      NewArray
+  /// CHECK:      ; pAllocArrayResolved32
+
+  // Over 1KB, left to the entrypoint.
+  static int[] $noinline$allocateLargeArray() {
+    return new int[300];
+  }
+
+  /// CHECK-START-X86_64: int[] Main.$noinline$allocateArray(int) disassembly (after)
+  /// CHECK-NOT:  ; thread_local_inline_end
+  /// CHECK-NOT:  NewObjectSlowPathX86_64
+
+  static int[] $noinline$allocateArray(int length) {
+    return new int[length];
+  }
+
+  /// CHECK-START-X86_64: java.lang.Object Main.$noinline$allocateUninitialized() disassembly (after)
+  /// CHECK-NOT:  ; thread_local_inline_end
+  /// CHECK-NOT:  NewObjectSlowPathX86_64
+
+  /// CHECK-START-X86_64: java.lang.Object Main.$noinline$allocateUninitialized() disassembly (after)
+  /// CHECK:      NewInstance
+  /// CHECK:      ; pAllocObjectResolved
+
+  static Object $noinline$allocateUninitialized() {
+    return new Uninitialized();
+  }
+
+  /// CHECK-START-X86_64: java.lang.Object Main.$noinline$allocateFinalizable() disassembly (after)
+  /// CHECK-NOT:  ; thread_local_inline_end
+  /// CHECK-NOT:  NewObjectSlowPathX86_64
+
+  /// CHECK-START-X86_64: java.lang.Object Main.$noinline$allocateFinalizable() disassembly (after)
+  /// CHECK:      NewInstance
+  /// CHECK:      ; pAllocObjectWithChecks
+
+  static Object $noinline$allocateFinalizable() {
+    return new Finalizable();
+  }
+
+  static final int KIND_GLOBAL_ALLOCATED_OBJECTS = 1;
+  static final int ITERATIONS = 1000;
+  static final int TOGGLES = 100;
+
+  static Method startAllocCounting;
+  static Method stopAllocCounting;
+  static Method resetAllocCount;
+  static Method getAllocCount;
+
+  static void assertEquals(Object expected, Object actual) {
+    if (expected != actual) {
+      throw new Error("Expected: " + expected + ", found: " + actual);
+    }
+  }
+
+  static void assertEquals(int expected, int actual) {
+    if (expected != actual) {
+      throw new Error("Expected: " + expected + ", found: " + actual);
+    }
+  }
+
+  static void allocate() {
+    Small small = Small.$noinline$create();
+    assertEquals(Small.class, small.getClass());
+    assertEquals(0, small.value);
+    int[] array = $noinline$allocateSmallArray();
+    assertEquals(8, array.length);
+    for (int value : array) {
+      assertEquals(0, value);
+    }
+    sink = array;
+  }
+
+  // The entrypoints are instrumented while allocations are counted, compiled code must then
+  // call them instead of bumping the TLAB pointer itself.
+  static void testCountedAllocations() throws Exception {
+    resetAllocCount.invoke(null, KIND_GLOBAL_ALLOCATED_OBJECTS);
+    startAllocCounting.invoke(null);
+    for (int i = 0; i != ITERATIONS; ++i) {
+      sink = Small.$noinline$create();
+      sink = $noinline$allocateSmallArray();
+    }
+    stopAllocCounting.invoke(null);
+    int count = (int) getAllocCount.invoke(null, KIND_GLOBAL_ALLOCATED_OBJECTS);
+    if (count < 2 * ITERATIONS) {
+      throw new Error("Expected at least " + (2 * ITERATIONS) + " allocations, counted " + count);
+    }
+  }
+
+  // Allocate from another thread while the instrumentation is toggled.
+  static void testAllocationsAcrossToggles() throws Exception {
+    sStop = false;
+    Thread allocator = new Thread() {
+      public void run() {
+        try {
+          while (!sStop) {
+            allocate();
+          }
+        } catch (Throwable t) {
+          sFailure = t;
+        }
+      }
+    };
+    allocator.start();
+    for (int i = 0; i != TOGGLES; ++i) {
+      startAllocCounting.invoke(null);
+      allocate();
+      stopAllocCounting.invoke(null);
+      allocate();
+    }
+    sStop = true;
+    allocator.join();
+    if (sFailure != null) {
+      throw new Error(sFailure);
+    }
+  }
+
+  public static void main(String[] args) throws Exception {
+    Class<?> vmDebug = Class.forName("dalvik.system.VMDebug");
+    startAllocCounting = vmDebug.getDeclaredMethod("startAllocCounting");
+    stopAllocCounting = vmDebug.getDeclaredMethod("stopAllocCounting");
+    resetAllocCount = vmDebug.getDeclaredMethod("resetAllocCount", Integer.TYPE);
+    getAllocCount = vmDebug.getDeclaredMethod("getAllocCount", Integer.TYPE);
+
+    assertEquals(300, $noinline$allocateLargeArray().length);
+    assertEquals(5, $noinline$allocateArray(5).length);
+    assertEquals(Uninitialized.class, $noinline$allocateUninitialized().getClass());
+    assertEquals("Uninitialized", sink);
+    assertEquals(Finalizable.class, $noinline$allocateFinalizable().getClass());
+
+    allocate();
+    testCountedAllocations();
+    testAllocationsAcrossToggles();
+    testCountedAllocations();
+    System.out.println("passed");
+  }
+}